@@ -66,6 +66,8 @@ static const int IDL_SPECTROGRAM_VIEW_RANGE     = 4006;
 static const int IDL_SPECTROGRAM_FFT_LENGTH     = 4007;
 
 static const int IDB_SET_SPECTROGRAM_DEFAULTS = 4010;
+static const int IDC_SHOW_FORMANTS            = 4011;
+static const int IDB_CALC_FORMANTS            = 4012;
 
 // IDs for F0 estimator settings
 
@@ -100,6 +102,8 @@ BEGIN_EVENT_TABLE(AnalysisSettingsDialog, wxDialog)
   EVT_COMMAND_SCROLL(IDS_SPECTROGRAM_VIEW_RANGE, AnalysisSettingsDialog::OnViewRangeChanged)
   EVT_COMMAND_SCROLL(IDS_SPECTROGRAM_FFT_LENGTH, AnalysisSettingsDialog::OnFftLengthChanged)
   EVT_BUTTON(IDB_SET_SPECTROGRAM_DEFAULTS, AnalysisSettingsDialog::OnSetSpectrogramDefaults)
+  EVT_CHECKBOX(IDC_SHOW_FORMANTS, AnalysisSettingsDialog::OnShowFormants)
+  EVT_BUTTON(IDB_CALC_FORMANTS, AnalysisSettingsDialog::OnCalcFormants)
 
   // Page for F0 settings
   EVT_CHECKBOX(IDC_SHOW_F0, AnalysisSettingsDialog::OnShowF0)
@@ -392,6 +396,16 @@ wxPanel *AnalysisSettingsDialog::initSpectrogramPage(wxWindow *parent)
   wxButton *button = new wxButton(page, IDB_SET_SPECTROGRAM_DEFAULTS, "Set default values");
   topLevelSizer->Add(button, 0, wxALL, 3);
 
+  // ****************************************************************
+  // Formant tracks.
+  // ****************************************************************
+
+  chkShowFormants = new wxCheckBox(page, IDC_SHOW_FORMANTS, "Show formants (F1-F4)");
+  topLevelSizer->Add(chkShowFormants, 0, wxALL, 5);
+
+  button = new wxButton(page, IDB_CALC_FORMANTS, "Calculate formants");
+  topLevelSizer->Add(button, 0, wxALL, 3);
+
   // ****************************************************************
   // Set the top-level-sizer for this page
   // ****************************************************************
@@ -625,6 +639,8 @@ void AnalysisSettingsDialog::updateSpectrogramPage()
   scrViewRange->SetThumbPosition(newPos);
   st = wxString::Format("%d Hz", viewRange_Hz);
   labViewRange->SetLabel(st);
+
+  chkShowFormants->SetValue( data->showFormants );
 }
 
 // ****************************************************************************
@@ -633,8 +649,8 @@ void AnalysisSettingsDialog::updateSpectrogramPage()
 void AnalysisSettingsDialog::updateF0Page()
 {
   chkShowF0->SetValue( data->showF0 );
-  txtF0Threshold->SetLabel( wxString::Format("%2.2f", data->f0EstimatorYin->differenceFunctionThreshold) );
-  txtF0TimeStep->SetLabel( wxString::Format("%2.3f", data->f0EstimatorYin->timeStep_s) );
+  txtF0Threshold->SetLabel( wxString::Format("%2.2f", data->getF0Estimator()->differenceFunctionThreshold) );
+  txtF0TimeStep->SetLabel( wxString::Format("%2.3f", data->getF0Estimator()->timeStep_s) );
 }
 
 // ****************************************************************************
@@ -804,10 +820,10 @@ void AnalysisSettingsDialog::OnThresholdLostFocus(wxFocusEvent &event)
   {
     if (x < MIN_DIFFERENCE_FUNCTION_THRESHOLD) { x = MIN_DIFFERENCE_FUNCTION_THRESHOLD; }
     if (x > MAX_DIFFERENCE_FUNCTION_THRESHOLD) { x = MAX_DIFFERENCE_FUNCTION_THRESHOLD; }
-    data->f0EstimatorYin->differenceFunctionThreshold = x;
+    data->getF0Estimator()->differenceFunctionThreshold = x;
   }
 
-  x = data->f0EstimatorYin->differenceFunctionThreshold;
+  x = data->getF0Estimator()->differenceFunctionThreshold;
   txtF0Threshold->SetValue(wxString::Format("%2.2f", x));
 
   // Important: Also call the base class handler.
@@ -826,7 +842,7 @@ void AnalysisSettingsDialog::OnF0TimeStepLostFocus(wxFocusEvent &event)
   {
     if (x < MIN_TIME_STEP_S) { x = MIN_TIME_STEP_S; }
     if (x > MAX_TIME_STEP_S) { x = MAX_TIME_STEP_S; }
-    data->f0EstimatorYin->timeStep_s = x;
+    data->getF0Estimator()->timeStep_s = x;
   }
   updateF0Page();
 
@@ -854,6 +870,31 @@ void AnalysisSettingsDialog::OnCalcF0(wxCommandEvent &event)
 }
 
 
+// ****************************************************************************
+// ****************************************************************************
+
+void AnalysisSettingsDialog::OnShowFormants(wxCommandEvent &event)
+{
+  data->showFormants = !data->showFormants;
+  updateWidgets();
+}
+
+
+// ****************************************************************************
+/// Calculate the formant tracks. Only the parts of the track that changed
+/// since the last calculation are analyzed again.
+// ****************************************************************************
+
+void AnalysisSettingsDialog::OnCalcFormants(wxCommandEvent &event)
+{
+  data->estimateFormants(this);
+
+  wxCommandEvent e(updateRequestEvent);
+  e.SetInt(REFRESH_PICTURES);
+  wxPostEvent(updateEventReceiver, e);
+}
+
+
 // ****************************************************************************
 // ****************************************************************************
 
@@ -81,6 +81,7 @@ private:
   wxStaticText *labViewRange;
   wxScrollBar *scrFftLength;
   wxStaticText *labFftLength;
+  wxCheckBox *chkShowFormants;
 
   // The F0 page controls
 
@@ -128,6 +129,8 @@ private:
   void OnViewRangeChanged(wxScrollEvent &event);
   void OnFftLengthChanged(wxScrollEvent &event);
   void OnSetSpectrogramDefaults(wxCommandEvent &event);
+  void OnShowFormants(wxCommandEvent &event);
+  void OnCalcFormants(wxCommandEvent &event);
 
   // Event handler for F0 settings
   
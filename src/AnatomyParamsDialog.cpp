@@ -382,6 +382,7 @@ void AnatomyParamsDialog::OnGetParamsFromVocalTract(wxCommandEvent &event)
 void AnatomyParamsDialog::OnSetParamsForVocalTract(wxCommandEvent &event)
 {
   params->setFor(data->vocalTract);
+  data->invalidateVocalTract();
 
   updateWidgets();
   updateVocalTract();
@@ -436,6 +437,7 @@ void AnatomyParamsDialog::OnScrollEvent(wxScrollEvent &event)
   }
 
   params->setFor(data->vocalTract);
+  data->invalidateVocalTract();
 
   // Bacause the shape list was also transformed, refill the list in 
   // the corresponding dialog.
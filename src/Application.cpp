@@ -22,6 +22,8 @@
 #include "Application.h"
 #include "Data.h"
 #include "IconsXpm.h"
+#include "GlottisSweep.h"
+#include "PreviewSynthesizer.h"
 
 #ifdef WIN32
 #include <windows.h>
@@ -64,6 +66,83 @@ bool Application::OnInit()
 
   wxPrintf("=== Console output for VocalTractLab 2.3 (built %s) ===\n\n", __DATE__);
 
+  // ****************************************************************
+  // Command line options:
+  // --exit-after-startup: Quit as soon as the main window is shown,
+  //   e.g., to benchmark the startup time and memory.
+  // --serve <socket>: Run the synthesis server without windows.
+  // --load-test <socket> <ges|tube|tract> <file> <requests> <clients>:
+  //   Send requests to a running synthesis server and quit.
+  // --glottis-sweep <definition file> <results file>: Run a glottis
+  //   parameter sweep (see GlottisSweep) with the default speaker and 
+  //   quit.
+  // --preview-test <gestural score file> <sampling rate>: Compare the
+  //   fast preview synthesis at the given rate with the full-rate 
+  //   synthesis and quit.
+  // --worker-test <gestural score file>: Compare the parallel 
+  //   calculations (quick rendering, EMA trajectories) with one and
+  //   with all workers and quit.
+  // --checkpoint-test <gestural score file>: Compare the synthesis that
+  //   continues from a checkpoint after a change of the score with the
+  //   synthesis from the beginning and quit.
+  // ****************************************************************
+
+  int i;
+  wxString serverSocketPath;
+  wxString sweepDefinitionFileName;
+  wxString sweepResultsFileName;
+  wxString previewTestFileName;
+  int previewTestSamplingRate = 0;
+  wxString workerTestFileName;
+  wxString checkpointTestFileName;
+  exitAfterStartup = false;
+  synthesisServer = NULL;
+  commandLineResult = -1;
+
+  for (i=1; i < argc; i++)
+  {
+    if (argv[i] == "--exit-after-startup")
+    {
+      exitAfterStartup = true;
+    }
+    else
+    if ((argv[i] == "--serve") && (i + 1 < argc))
+    {
+      serverSocketPath = argv[++i];
+    }
+    else
+    if ((argv[i] == "--load-test") && (i + 5 < argc))
+    {
+      commandLineResult = SynthesisServer::runLoadTest(argv[i+1], argv[i+2], argv[i+3], 
+        wxAtoi(argv[i+4]), wxAtoi(argv[i+5]));
+      return true;
+    }
+    else
+    if ((argv[i] == "--glottis-sweep") && (i + 2 < argc))
+    {
+      sweepDefinitionFileName = argv[i+1];
+      sweepResultsFileName = argv[i+2];
+      i+= 2;
+    }
+    else
+    if ((argv[i] == "--preview-test") && (i + 2 < argc))
+    {
+      previewTestFileName = argv[i+1];
+      previewTestSamplingRate = wxAtoi(argv[i+2]);
+      i+= 2;
+    }
+    else
+    if ((argv[i] == "--worker-test") && (i + 1 < argc))
+    {
+      workerTestFileName = argv[++i];
+    }
+    else
+    if ((argv[i] == "--checkpoint-test") && (i + 1 < argc))
+    {
+      checkpointTestFileName = argv[++i];
+    }
+  }
+
   // Init the data class at the very beginning.
   
   Data *data = Data::getInstance();
@@ -72,6 +151,94 @@ bool Application::OnInit()
     wxPrintf("Error: At least the default command line argument is expected.\n");
   }
   data->init(argv[0]);
+  startupStopWatch.Start();
+
+  if (sweepDefinitionFileName.IsEmpty() == false)
+  {
+    GlottisSweep sweep;
+    commandLineResult = 1;
+    if ((sweep.readDefinition(sweepDefinitionFileName)) && (sweep.run()))
+    {
+      if (sweep.writeResults(sweepResultsFileName))
+      {
+        wxPrintf("The results were written to %s.\n", sweepResultsFileName.c_str());
+        commandLineResult = 0;
+      }
+    }
+    return true;
+  }
+
+  if (previewTestFileName.IsEmpty() == false)
+  {
+    bool allValuesInRange = true;
+    commandLineResult = 1;
+    if (data->gesturalScore->loadGesturesXml(previewTestFileName.ToStdString(), allValuesInRange))
+    {
+      data->gesturalScore->glottis = data->getSelectedGlottis();
+      if (PreviewSynthesizer::compare(data->gesturalScore, data->tdsModel, previewTestSamplingRate))
+      {
+        commandLineResult = 0;
+      }
+    }
+    else
+    {
+      wxPrintf("Error: Failed to load the gestural score %s.\n", previewTestFileName.c_str());
+    }
+    return true;
+  }
+
+  if (workerTestFileName.IsEmpty() == false)
+  {
+    bool allValuesInRange = true;
+    commandLineResult = 1;
+    if (data->gesturalScore->loadGesturesXml(workerTestFileName.ToStdString(), allValuesInRange))
+    {
+      data->gesturalScore->calcCurves();
+      if (data->compareWorkerCounts(data->gesturalScore))
+      {
+        commandLineResult = 0;
+      }
+    }
+    else
+    {
+      wxPrintf("Error: Failed to load the gestural score %s.\n", workerTestFileName.c_str());
+    }
+    return true;
+  }
+
+  if (checkpointTestFileName.IsEmpty() == false)
+  {
+    bool allValuesInRange = true;
+    commandLineResult = 1;
+    if (data->gesturalScore->loadGesturesXml(checkpointTestFileName.ToStdString(), allValuesInRange))
+    {
+      data->gesturalScore->calcCurves();
+      if (data->compareResumedSynthesis())
+      {
+        commandLineResult = 0;
+      }
+    }
+    else
+    {
+      wxPrintf("Error: Failed to load the gestural score %s.\n", checkpointTestFileName.c_str());
+    }
+    return true;
+  }
+
+  // In the server mode, the warm models of the server are created from
+  // the default speaker and no window is shown.
+
+  if (serverSocketPath.IsEmpty() == false)
+  {
+    synthesisServer = new SynthesisServer();
+    if (synthesisServer->start(serverSocketPath, wxThread::GetCPUCount()) == false)
+    {
+      delete synthesisServer;
+      synthesisServer = NULL;
+      return false;
+    }
+    return true;
+  }
 
   // Create and show the main window.
 
@@ -87,6 +254,8 @@ bool Application::OnInit()
   SetTopWindow(mainWindow);
   mainWindow->Show();
 
+  data->addStartupStep("Main window", startupStopWatch);
+
 
   // After the vocal tract page and the vocal tract dialog were 
   // initialzed, tell some of the non-modal dialogs about it.
@@ -106,9 +275,32 @@ bool Application::OnInit()
   vocalTractDialog->SetParent(mainWindow);
   vocalTractDialog->Show(true);
 
+  data->addStartupStep("Dialogs", startupStopWatch);
+
+  // Called when the event loop runs, i.e., after the window was shown.
+  CallAfter(&Application::finishStartup);
+
   return true;
 }
 
+
+// ****************************************************************************
+/// Completes the startup report with the time until the event loop processes
+/// the first events (time-to-first-window) and prints it.
+// ****************************************************************************
+
+void Application::finishStartup()
+{
+  Data *data = Data::getInstance();
+  data->addStartupStep("Showing the main window", startupStopWatch);
+  data->printStartupReport();
+
+  if (exitAfterStartup)
+  {
+    ExitMainLoop();
+  }
+}
+
 // ****************************************************************************
 // ****************************************************************************
 
@@ -176,13 +368,36 @@ void Application::createConsole()
 #endif
 }
 
+// ****************************************************************************
+/// Returns the exit code of a command line task (--load-test,
+/// --glottis-sweep, --preview-test, --worker-test or --checkpoint-test) 
+/// without running the main loop.
+// ****************************************************************************
+
+int Application::OnRun()
+{
+  if (commandLineResult != -1)
+  {
+    return commandLineResult;
+  }
+  return wxApp::OnRun();
+}
+
 // ****************************************************************************
 
-#ifdef __linux__
-  int Application::OnExit()
+int Application::OnExit()
+{
+  if (synthesisServer != NULL)
   {
-    return fclose(stderr);
+    delete synthesisServer;
+    synthesisServer = NULL;
   }
+
+#ifdef __linux__
+  return fclose(stderr);
+#else
+  return wxApp::OnExit();
 #endif
+}
 
 
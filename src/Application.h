@@ -21,6 +21,7 @@
 
 #include <wx/wx.h>
 #include "MainWindow.h"
+#include "SynthesisServer.h"
 
 // ****************************************************************************
 // ****************************************************************************
@@ -29,12 +30,17 @@ class Application : public wxApp
 {
 public:
 	virtual bool OnInit();
-#ifdef __linux__
+	virtual int OnRun();
 	virtual int OnExit();
-#endif
 
   void createConsole();
+  void finishStartup();
 
+private:
+  wxStopWatch startupStopWatch;
+  bool exitAfterStartup;
+  SynthesisServer *synthesisServer;
+  int commandLineResult;    ///< Exit code of a command line task, or -1
 };
 
 DECLARE_APP(Application)
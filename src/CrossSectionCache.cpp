@@ -0,0 +1,255 @@
+// ****************************************************************************
+// This file is part of VocalTractLab.
+// Copyright (C) 2020, Peter Birkholz, Dresden, Germany
+// www.vocaltractlab.de
+// author: Peter Birkholz
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//
+// ****************************************************************************
+
+
+#include "CrossSectionCache.h"
+
+
+// ****************************************************************************
+/// Constructor.
+// ****************************************************************************
+
+CrossSectionCache::CrossSectionCache()
+{
+  tract = NULL;
+  isValid = false;
+
+  numHits = 0;
+  numMisses = 0;
+  numRebuilds = 0;
+}
+
+
+// ****************************************************************************
+/// Returns the cut plane and the cross-sections with and without the tongue
+/// at the position pos_cm along the center line (rounded to the nearest 
+/// multiple of the profile sample length), or at the tongue rib closest to 
+/// pos_cm, when onTongueRib is true. The returned entry is valid
+/// until the next call of a non-static function of this class.
+// ****************************************************************************
+
+const CrossSectionCache::Entry *CrossSectionCache::getEntry(VocalTract *tract, 
+  double pos_cm, bool onTongueRib)
+{
+  Entry *entry = NULL;
+
+  update(tract);
+
+  if (onTongueRib)
+  {
+    int index = getTongueRibIndex(pos_cm);
+    map<int, Entry>::iterator it = tongueRibEntry.find(index);
+    if (it == tongueRibEntry.end())
+    {
+      entry = &tongueRibEntry[index];
+      entry->P = tract->tongueRib[index].point;
+      entry->v = tract->tongueRib[index].normal;
+      entry->hasProfiles = false;
+    }
+    else
+    {
+      entry = &it->second;
+    }
+  }
+  else
+  {
+    Point2D P, v;
+    getCutVector(tract, pos_cm, P, v);
+    entry = &centerLineEntry[getCenterLineIndex(pos_cm)];
+  }
+
+  if (entry->hasProfiles)
+  {
+    numHits++;
+  }
+  else
+  {
+    calcProfiles(tract, *entry);
+    numMisses++;
+  }
+
+  return entry;
+}
+
+
+// ****************************************************************************
+/// Returns the point P on the center line at the position pos_cm (rounded
+/// to the nearest multiple of the profile sample length) and the normal vector 
+/// v of the cut plane at that point.
+// ****************************************************************************
+
+void CrossSectionCache::getCutVector(VocalTract *tract, double pos_cm, Point2D &P, Point2D &v)
+{
+  int index;
+
+  update(tract);
+
+  index = getCenterLineIndex(pos_cm);
+  map<int, Entry>::iterator it = centerLineEntry.find(index);
+  if (it == centerLineEntry.end())
+  {
+    // Only for very long center lines -> start over when the cache 
+    // gets too big.
+    if ((int)centerLineEntry.size() >= MAX_ENTRIES)
+    {
+      centerLineEntry.clear();
+    }
+
+    Entry &entry = centerLineEntry[index];
+    tract->getCutVector(index*VocalTract::PROFILE_SAMPLE_LENGTH, entry.P, entry.v);
+    entry.hasProfiles = false;
+    P = entry.P;
+    v = entry.v;
+  }
+  else
+  {
+    P = it->second.P;
+    v = it->second.v;
+  }
+}
+
+
+// ****************************************************************************
+/// Clears the cache. Must be called after each change of the geometry (or
+/// the anatomy) of the vocal tract.
+// ****************************************************************************
+
+void CrossSectionCache::invalidate()
+{
+  isValid = false;
+}
+
+
+// ****************************************************************************
+/// Returns the index of the tongue rib closest to the position pos_cm. The 
+/// tongue ribs are 0.5 cm apart.
+// ****************************************************************************
+
+int CrossSectionCache::getTongueRibIndex(double pos_cm)
+{
+  int index = (int)(pos_cm*2.0);
+  if (index < 0) { index = 0; }
+  if (index >= VocalTract::NUM_TONGUE_RIBS) { index = VocalTract::NUM_TONGUE_RIBS-1; }
+  return index;
+}
+
+
+// ****************************************************************************
+/// Returns the index of the cut plane closest to the position pos_cm along
+/// the center line. The cut planes are VocalTract::PROFILE_SAMPLE_LENGTH 
+/// apart, so that scrubbing the cut plane mostly hits existing entries.
+// ****************************************************************************
+
+int CrossSectionCache::getCenterLineIndex(double pos_cm)
+{
+  int index = (int)(pos_cm / VocalTract::PROFILE_SAMPLE_LENGTH + 0.5);
+  if (index < 0) { index = 0; }
+  return index;
+}
+
+
+// ****************************************************************************
+/// Returns the index of the tube section (relative to 
+/// Tube::FIRST_PHARYNX_SECTION) of the pharynx and mouth that contains the 
+/// position pos_cm, or -1, if the position is outside of the tube. ratio 
+/// receives the relative position within the section (0..1).
+/// The sections are contiguous, so that the section is found by a binary
+/// search for the first section that ends at or behind pos_cm.
+// ****************************************************************************
+
+int CrossSectionCache::getTubeSection(Tube *tube, double pos_cm, double &ratio)
+{
+  int left = 0;
+  int right = Tube::NUM_PHARYNX_MOUTH_SECTIONS - 1;
+  int middle;
+  Tube::Section *ts = NULL;
+
+  ratio = 0.0;
+
+  while (left < right)
+  {
+    middle = (left + right) / 2;
+    ts = &tube->pharynxMouthSection[middle];
+    if (ts->pos_cm + ts->length_cm >= pos_cm)
+    {
+      right = middle;
+    }
+    else
+    {
+      left = middle + 1;
+    }
+  }
+
+  ts = &tube->pharynxMouthSection[left];
+  if ((pos_cm < ts->pos_cm) || (pos_cm > ts->pos_cm + ts->length_cm))
+  {
+    return -1;
+  }
+
+  double length_cm = ts->length_cm;
+  if (length_cm < 0.000001)
+  {
+    length_cm = 0.000001;
+  }
+  ratio = (pos_cm - ts->pos_cm) / length_cm;
+
+  return left;
+}
+
+
+// ****************************************************************************
+/// Clears all entries when the cache was invalidated since the entries were
+/// calculated or when they belong to another vocal tract.
+// ****************************************************************************
+
+void CrossSectionCache::update(VocalTract *tract)
+{
+  if ((isValid) && (tract == this->tract))
+  {
+    return;
+  }
+
+  this->tract = tract;
+  centerLineEntry.clear();
+  tongueRibEntry.clear();
+  isValid = true;
+  numRebuilds++;
+}
+
+
+// ****************************************************************************
+/// Calculates the profiles and cross-sections of the given entry.
+// ****************************************************************************
+
+void CrossSectionCache::calcProfiles(VocalTract *tract, Entry &entry)
+{
+  int i;
+
+  for (i=0; i < 2; i++)
+  {
+    tract->getCrossProfiles(entry.P, entry.v, entry.upperProfile[i], entry.lowerProfile[i], 
+      (i == 1), entry.articulator[i]);
+    tract->getCrossSection(entry.upperProfile[i], entry.lowerProfile[i], &entry.crossSection[i]);
+  }
+  entry.hasProfiles = true;
+}
+
+// ****************************************************************************
@@ -0,0 +1,106 @@
+// ****************************************************************************
+// This file is part of VocalTractLab.
+// Copyright (C) 2020, Peter Birkholz, Dresden, Germany
+// www.vocaltractlab.de
+// author: Peter Birkholz
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//
+// ****************************************************************************
+
+
+#ifndef __CROSS_SECTION_CACHE_H__
+#define __CROSS_SECTION_CACHE_H__
+
+#include <map>
+#include "VocalTractLabBackend/VocalTract.h"
+#include "VocalTractLabBackend/Tube.h"
+
+using namespace std;
+
+// ****************************************************************************
+/// Keeps the cut planes and cross-sections of the vocal tract that were
+/// requested for the current geometry, so that the cross-section picture,
+/// the cut plane in the vocal tract picture and the exports only look them
+/// up while the user scrubs the cut plane. A cross-section is either defined
+/// by a position along the center line, which is rounded to a multiple of 
+/// VocalTract::PROFILE_SAMPLE_LENGTH, or by one of the tongue ribs.
+/// The cache must be invalidated whenever the geometry of the vocal tract 
+/// changes (Data does this for each calculation of the main vocal tract).
+// ****************************************************************************
+
+class CrossSectionCache
+{
+  // **************************************************************************
+  // Public data.
+  // **************************************************************************
+
+public:
+  struct Entry
+  {
+    Point2D P;
+    Point2D v;
+    bool hasProfiles;
+    // The profiles and the resulting cross-section without [0] and 
+    // with [1] the tongue.
+    double upperProfile[2][VocalTract::NUM_PROFILE_SAMPLES];
+    double lowerProfile[2][VocalTract::NUM_PROFILE_SAMPLES];
+    Tube::Articulator articulator[2];
+    VocalTract::CrossSection crossSection[2];
+  };
+
+  // Statistics
+  int numHits;
+  int numMisses;
+  int numRebuilds;
+
+  // **************************************************************************
+  // Public functions.
+  // **************************************************************************
+
+public:
+  CrossSectionCache();
+  const Entry *getEntry(VocalTract *tract, double pos_cm, bool onTongueRib);
+  void getCutVector(VocalTract *tract, double pos_cm, Point2D &P, Point2D &v);
+  void invalidate();
+
+  static int getTongueRibIndex(double pos_cm);
+  static int getCenterLineIndex(double pos_cm);
+  static int getTubeSection(Tube *tube, double pos_cm, double &ratio);
+
+  // **************************************************************************
+  // Private data.
+  // **************************************************************************
+
+private:
+  /// Max. number of cached cross-sections along the center line
+  static const int MAX_ENTRIES = 1024;
+
+  VocalTract *tract;
+  bool isValid;
+  map<int, Entry> centerLineEntry;
+  map<int, Entry> tongueRibEntry;
+
+  // **************************************************************************
+  // Private functions.
+  // **************************************************************************
+
+private:
+  void update(VocalTract *tract);
+  void calcProfiles(VocalTract *tract, Entry &entry);
+};
+
+#endif
+
+// ****************************************************************************
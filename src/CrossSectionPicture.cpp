@@ -41,7 +41,6 @@ void CrossSectionPicture::draw(wxDC &dc)
 {
   int width, height;
   double zoom;
-  Tube::Articulator articulator;
   Data *data = Data::getInstance();
   VocalTract *tract = data->vocalTract;
   double pos = picVocalTract->cutPlanePos_cm;
@@ -85,8 +84,8 @@ void CrossSectionPicture::draw(wxDC &dc)
 
   int INVALID = (int)VocalTract::INVALID_PROFILE_SAMPLE;
 
-  double upperProfile[VocalTract::NUM_PROFILE_SAMPLES];
-  double lowerProfile[VocalTract::NUM_PROFILE_SAMPLES];
+  const double *upperProfile = NULL;
+  const double *lowerProfile = NULL;
 
   int leftX, rightX;
   int leftIndex  = VocalTract::NUM_PROFILE_SAMPLES/2;
@@ -98,35 +97,18 @@ void CrossSectionPicture::draw(wxDC &dc)
   // Calculation of the profiles.
   // ****************************************************************
 
-  Point2D P, v;
-
-  if (picVocalTract->showTongueCrossSections)
-  {
-    i = (int)(pos*2.0);
-    if (i < 0) { i = 0; }
-    if (i >= VocalTract::NUM_TONGUE_RIBS) { i = VocalTract::NUM_TONGUE_RIBS-1; }
-    P = tract->tongueRib[i].point;
-    v = tract->tongueRib[i].normal;
-  }
-  else
-  {
-    tract->getCutVector(pos, P, v);
-  }
+  // The profiles are only calculated once per vocal tract geometry and
+  // cut position.
+  const CrossSectionCache::Entry *crossSection = 
+    data->crossSections.getEntry(tract, pos, picVocalTract->showTongueCrossSections);
 
   // ****************************************************************
   // Draw the upper and lower profile WITHOUT the tongue.
   // ****************************************************************
 
-  bool debug = false;
+  upperProfile = crossSection->upperProfile[0];
+  lowerProfile = crossSection->lowerProfile[0];
 
-/*
-  if (pos > 16.0)
-  {
-    debug = true;
-  }
-*/
-
-  tract->getCrossProfiles(P, v, upperProfile, lowerProfile, false, articulator, debug);
   leftX = (int)(centerX - 0.5*VocalTract::PROFILE_LENGTH*zoom);
 
   auto pen = *wxMEDIUM_GREY_PEN;
@@ -159,9 +141,8 @@ void CrossSectionPicture::draw(wxDC &dc)
   // Draw the upper and lower profile WITH the tongue.
   // ****************************************************************
 
-  debug = false;
-
-  tract->getCrossProfiles(P, v, upperProfile, lowerProfile, true, articulator, debug);
+  upperProfile = crossSection->upperProfile[1];
+  lowerProfile = crossSection->lowerProfile[1];
   
   leftX = (int)(centerX - 0.5*VocalTract::PROFILE_LENGTH*zoom);
 
@@ -230,11 +211,8 @@ void CrossSectionPicture::draw(wxDC &dc)
   // Print the area and circumference.
   // ****************************************************************
 
-  VocalTract::CrossSection crossSection;
-  tract->getCrossSection(upperProfile, lowerProfile, &crossSection);
-
   wxString st = wxString::Format("A: %2.2f cm^2  C: %2.2f cm", 
-    crossSection.area, crossSection.circ);
+    crossSection->crossSection[1].area, crossSection->crossSection[1].circ);
   dc.SetPen(wxPen(*wxBLACK, lineWidth));
   dc.SetBackgroundMode(wxTRANSPARENT);
   dc.SetFont(wxFont(9, wxFONTFAMILY_DEFAULT, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL));
@@ -244,7 +222,7 @@ void CrossSectionPicture::draw(wxDC &dc)
   // Print the name of the lower articulator.
   // ****************************************************************
 
-  switch (articulator)
+  switch (crossSection->articulator[1])
   {
   case Tube::OTHER_ARTICULATOR: st = "Other articulator"; break;
   case Tube::TONGUE: st = "Tongue"; break;
@@ -25,8 +25,21 @@
 #include <wx/choicdlg.h>
 #include <wx/clipbrd.h>
 #include <wx/busyinfo.h>
+#include <wx/dir.h>
+#include <wx/file.h>
 #include <iomanip>
 #include <iostream>
+#include <limits>
+#include <sstream>
+#include <cstring>
+#include <cstdio>
+
+#if defined(__linux__)
+#include <unistd.h>
+#elif defined(WIN32)
+#include <windows.h>
+#include <psapi.h>
+#endif
 
 #include "Data.h"
 #include "GlottisDialog.h"
@@ -35,6 +48,9 @@
 #include "VocalTractLabBackend/XmlNode.h"
 #include "SoundLib.h"
 #include "VocalTractLabBackend/Synthesizer.h"
+#include "ParallelJob.h"
+#include "GlottisSweep.h"
+#include "SynthesisThread.h"
 
 
 // Define a custom event type to be used for command events.
@@ -92,6 +108,7 @@ Data *Data::getInstance()
 void Data::init(const wxString &arg0)
 {
   int i;
+  wxStopWatch stopWatch;
 
   // ****************************************************************
   // Determine the program path from arg0. The option
@@ -109,14 +126,37 @@ void Data::init(const wxString &arg0)
   // ****************************************************************
 
   vocalTract = new VocalTract();
-  vocalTract->calculateAll();
+  calculateVocalTract(vocalTract);
 
   tlModel = new TlModel();
   poleZeroPlan = new PoleZeroPlan();
   anatomyParams = new AnatomyParams();
 
+  // Invalid geometry, so that the first update marks all sections as changed.
+  for (i = 0; i < Tube::NUM_SECTIONS; i++)
+  {
+    tlCacheSectionArea_cm2[i] = -1.0;
+    tlCacheSectionLength_cm[i] = -1.0;
+    tlCacheSectionArticulator[i] = -1;
+  }
+  tlCacheOptions = tlModel->options;
+  tlFirstChangedSection = -1;
+  tlLastChangedSection = -1;
+  tlCacheGeneration = 0;
+
+  for (i = 0; i <= Tube::NUM_PHARYNX_MOUTH_SECTIONS; i++)
+  {
+    noiseSweepSpectrum[i] = new ComplexSignal(0);
+  }
+  noiseSweepShaping = new ComplexSignal(0);
+  noiseSweepSpectrumLength = 0;
+  noiseSweepCutoffFreq = 0.0;
+  noiseSweepGeneration = -1;
+
   updateTlModelGeometry(vocalTract);
 
+  pzSingleFactorPlan = new PoleZeroPlan();
+
   // Phonetic parameters; The range of all these parameters is
   // between 0 and 1.
 
@@ -130,7 +170,10 @@ void Data::init(const wxString &arg0)
 
   transitionPos = 0.0;    // 0 <= x <= 1
 
-  formantOptimizationDialog = new FormantOptimizationDialog(NULL, vocalTract);
+  addStartupStep("Vocal tract and acoustic models", stopWatch);
+
+  // Created with the first call of getFormantOptimizationDialog().
+  formantOptimizationDialog = NULL;
 
 
   // ****************************************************************
@@ -142,6 +185,7 @@ void Data::init(const wxString &arg0)
 
   // For the preview of turbulence noise spectra.
   noiseFilterCutoffFreq = 1500;    
+  randomSeed = 1;
 
   // ****************************************************************
   // Oscillogram variables
@@ -149,7 +193,8 @@ void Data::init(const wxString &arg0)
 
   for (i=0; i < NUM_TRACKS; i++)
   {
-    track[i] = new Signal16(TRACK_DURATION_S*SAMPLING_RATE);
+    track[i] = new Signal16(TRACK_PAGE_DURATION_S*SAMPLING_RATE);
+    trackGeneration[i] = 0;
   }
 
   showTrack[MAIN_TRACK] = true;
@@ -192,7 +237,9 @@ void Data::init(const wxString &arg0)
   int currWindowLength_pt = 0;
   int currWindowShape = -1;
 
-  // Some classes for analysis tasks
+  // Some classes for analysis tasks. They stay eager, because the time
+  // steps of the (empty) F0 and voice quality signals are taken from 
+  // them. The time steps are set again after each estimation.
   
   f0EstimatorYin = new F0EstimatorYin();
   voiceQualityEstimator = new VoiceQualityEstimator();
@@ -210,6 +257,8 @@ void Data::init(const wxString &arg0)
   // For the spectra calculated from the impulse responses in the time domain.
   tdsSpectrum = new ComplexSignal(512);
 
+  addStartupStep("Audio tracks and analysis", stopWatch);
+
   // ****************************************************************
   // TDS data.
   // ****************************************************************
@@ -227,10 +276,27 @@ void Data::init(const wxString &arg0)
   showSubglottalSystem = true;
   showAnimation = false;
   normalizeAmplitude = true;
+  fastPreview = false;
+  quickRender = false;
+  previewSamplingRate = 22050;
   synthesisSpeed_percent = 100;
 
   // Default folder for saving video frames of the vocal tract, equations sets files, etc.
   videoFramesFolder = wxStandardPaths::Get().GetTempDir();
+  videoStreamFileName = "";
+  videoFrameFormat = VIDEO_FRAMES_PNG;
+  videoFrameRate = 30;
+  videoFrameWidth = 0;
+  videoFrameHeight = 0;
+  geometrySequenceFolder = wxStandardPaths::Get().GetTempDir();
+  geometrySequenceFileName = "";
+  geometrySequenceFormat = GEOMETRY_SEQUENCE_OBJ;
+  geometrySequenceFrameRate_Hz = 30.0;
+
+  emaBatchFolder = wxStandardPaths::Get().GetTempDir();
+  emaFileFormat = EMA_FILE_TEXT;
+  emaFrameRate_Hz = 200.0;
+  emaPointNames = "";
   equationSetsFolder = wxStandardPaths::Get().GetTempDir();
 
   tdsPressureTimeGraph = NULL;
@@ -304,6 +370,8 @@ void Data::init(const wxString &arg0)
 
   ColorScale::getYellowBlueScale(NUM_TDS_SCALE_COLORS, tdsScaleColor);
 
+  addStartupStep("TDS model, glottis models and tube sequences", stopWatch);
+
   // ****************************************************************
   // Load the default speaker file (after everything else was 
   // initialized).
@@ -318,6 +386,8 @@ void Data::init(const wxString &arg0)
 
   resetTdsBuffers();
 
+  addStartupStep("Speaker file", stopWatch);
+
   // ****************************************************************
   // Create the configuration object and read the configuration.
   // ****************************************************************
@@ -325,6 +395,131 @@ void Data::init(const wxString &arg0)
   config = new wxFileConfig("VocalTractLab", "Birkholz",  
     programPath + "config.ini", "", wxCONFIG_USE_LOCAL_FILE);
   readConfig();
+
+  addStartupStep("Configuration", stopWatch);
+}
+
+
+// ****************************************************************************
+/// Adds a step of the program start with the time elapsed on the given stop
+/// watch to the startup report and restarts the stop watch for the next step.
+// ****************************************************************************
+
+void Data::addStartupStep(const wxString &name, wxStopWatch &stopWatch)
+{
+  startupStepName.push_back(name);
+  startupStepTime_ms.push_back((double)stopWatch.Time());
+  stopWatch.Start();
+}
+
+
+// ****************************************************************************
+/// Prints the time needed for the single steps of the program start and the
+/// resident memory of the process.
+// ****************************************************************************
+
+void Data::printStartupReport()
+{
+  int i;
+  double total_ms = 0.0;
+  long memory_kB = getResidentMemory_kB();
+
+  wxPrintf("\n=== Startup report ===\n");
+  for (i=0; i < (int)startupStepName.size(); i++)
+  {
+    wxPrintf("%-50s %8.0f ms\n", startupStepName[i], startupStepTime_ms[i]);
+    total_ms+= startupStepTime_ms[i];
+  }
+  wxPrintf("%-50s %8.0f ms\n", "Total", total_ms);
+
+  if (memory_kB >= 0)
+  {
+    wxPrintf("%-50s %8ld kB\n", "Resident memory", memory_kB);
+  }
+  wxPrintf("\n");
+}
+
+
+// ****************************************************************************
+/// Returns the resident memory (working set) of this process in kB, or -1 if
+/// it can't be determined on this platform.
+// ****************************************************************************
+
+long Data::getResidentMemory_kB()
+{
+#if defined(__linux__)
+  long totalPages = 0;
+  long residentPages = 0;
+  FILE *file = fopen("/proc/self/statm", "r");
+  if (file == NULL)
+  {
+    return -1;
+  }
+  if (fscanf(file, "%ld %ld", &totalPages, &residentPages) != 2)
+  {
+    residentPages = -1;
+  }
+  fclose(file);
+  if (residentPages < 0)
+  {
+    return -1;
+  }
+  return residentPages * (sysconf(_SC_PAGESIZE) / 1024);
+#elif defined(WIN32)
+  PROCESS_MEMORY_COUNTERS counters;
+  if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) == 0)
+  {
+    return -1;
+  }
+  return (long)(counters.WorkingSetSize / 1024);
+#else
+  return -1;
+#endif
+}
+
+
+// ****************************************************************************
+/// Returns the dialog for the formant optimization. It is created with the
+/// first call of this function.
+// ****************************************************************************
+
+FormantOptimizationDialog *Data::getFormantOptimizationDialog()
+{
+  if (formantOptimizationDialog == NULL)
+  {
+    formantOptimizationDialog = new FormantOptimizationDialog(NULL, vocalTract);
+  }
+  return formantOptimizationDialog;
+}
+
+
+// ****************************************************************************
+/// Returns the F0 estimator. It is created with the first call of this
+/// function, if init() has not created it yet.
+// ****************************************************************************
+
+F0EstimatorYin *Data::getF0Estimator()
+{
+  if (f0EstimatorYin == NULL)
+  {
+    f0EstimatorYin = new F0EstimatorYin();
+  }
+  return f0EstimatorYin;
+}
+
+
+// ****************************************************************************
+/// Returns the voice quality estimator. It is created with the first call of
+/// this function, if init() has not created it yet.
+// ****************************************************************************
+
+VoiceQualityEstimator *Data::getVoiceQualityEstimator()
+{
+  if (voiceQualityEstimator == NULL)
+  {
+    voiceQualityEstimator = new VoiceQualityEstimator();
+  }
+  return voiceQualityEstimator;
 }
 
 
@@ -532,17 +727,17 @@ int Data::synthesizeVowelFormantLf(LfPulse &lfPulse, int startPos, bool isLongVo
   ComplexSignal radiationSpectrum(IMPULSE_RESPONSE_LENGTH);
   Signal window(IMPULSE_RESPONSE_LENGTH);
 
-  poleZeroPlan->getPoleZeroSpectrum(&poleZeroSpectrum, IMPULSE_RESPONSE_LENGTH, 8000.0);
+  getPoleZeroSpectrum(&poleZeroSpectrum, IMPULSE_RESPONSE_LENGTH, 8000.0);
   
   if (poleZeroPlan->higherPoleCorrection)
   {
     ComplexSignal hpc(IMPULSE_RESPONSE_LENGTH);
     double effectiveLength_cm = 17.0;
-    poleZeroPlan->getHigherPoleCorrection(&hpc, IMPULSE_RESPONSE_LENGTH, effectiveLength_cm);
+    getHigherPoleCorrection(&hpc, IMPULSE_RESPONSE_LENGTH, effectiveLength_cm);
     poleZeroSpectrum*= hpc;
   }
 
-  tlModel->getSpectrum(TlModel::RADIATION, &radiationSpectrum, IMPULSE_RESPONSE_LENGTH, 0);
+  getTlModelSpectrum(TlModel::RADIATION, &radiationSpectrum, IMPULSE_RESPONSE_LENGTH, 0);
   poleZeroSpectrum*= radiationSpectrum; 
 
   // Apply a low-pass filter at 6 kHz.
@@ -621,6 +816,7 @@ int Data::synthesizeVowelFormantLf(LfPulse &lfPulse, int startPos, bool isLongVo
     filteredValue = 4000.0*filter.getOutputSample(pressureSignal.getValue(i));
     track[MAIN_TRACK]->setValue(startPos+i, (short)filteredValue);
   }
+  trackChanged(MAIN_TRACK);
 
   // Restore the pulse params
 
@@ -787,6 +983,7 @@ int Data::synthesizeVowelLf(TlModel *tlModel, LfPulse &lfPulse, int startPos, bo
     filteredValue = 2000.0 * filter.getOutputSample(pressureSignal.getValue(i));
     track[MAIN_TRACK]->setValue(startPos+i, (short)filteredValue);
   }
+  trackChanged(MAIN_TRACK);
 
   // Restore the pulse params
 
@@ -797,2417 +994,5611 @@ int Data::synthesizeVowelLf(TlModel *tlModel, LfPulse &lfPulse, int startPos, bo
 
 
 // ****************************************************************************
-/// Calculates the user spectrum that is obtained from the signal in the main
-/// track and displayed in the simple spectrum picture.
+/// Calculates the spectra of the vocal tract impulse responses of a range of
+/// frames. Each item is one frame, which is calculated with the vocal tract
+/// and TL model of the worker.
 // ****************************************************************************
 
-void Data::calcUserSpectrum()
+class ScoreImpulseResponseJob : public ParallelJob
 {
-  int i;
+public:
+  static const int IMPULSE_RESPONSE_EXPONENT = 9;
+  static const int IMPULSE_RESPONSE_LENGTH = 1 << IMPULSE_RESPONSE_EXPONENT;
+  static const int FFT_EXPONENT = IMPULSE_RESPONSE_EXPONENT + 1;
+  static const int FFT_LENGTH = 1 << FFT_EXPONENT;
+
+  vector<VocalTract*> workerTract;
+  vector<TlModel*> workerModel;
+  const vector<double> *frameParams;    // NUM_PARAMS values per frame
+  vector<double> *spectrumRe;           // FFT_LENGTH values per frame
+  vector<double> *spectrumIm;
+
+  virtual void processItem(int workerIndex, int itemIndex)
+  {
+    VocalTract *vt = workerTract[workerIndex];
+    TlModel *model = workerModel[workerIndex];
+    Signal impulseResponse(IMPULSE_RESPONSE_LENGTH);
+    ComplexSignal spectrum(FFT_LENGTH);
+    int i;
 
-  // ****************************************************************
-  // An ordinary short-time spectrum
-  // ****************************************************************
+    for (i=0; i < VocalTract::NUM_PARAMS; i++)
+    {
+      vt->param[i].x = (*frameParams)[itemIndex*VocalTract::NUM_PARAMS + i];
+    }
+    Data::getInstance()->calculateVocalTract(vt);
+    vt->getTube(&model->tube);
+    model->tube.setGlottisArea(0.0);
+    model->getImpulseResponse(&impulseResponse, IMPULSE_RESPONSE_EXPONENT);
 
-  if (userSpectrumType == NORMAL_SPECTRUM)
-  {
-    int e = getFrameLengthExponent(spectrumWindowLength_pt);
-    int frameLength = (int)1 << e;
-    userSpectrum->reset(frameLength);
-    Signal window(spectrumWindowLength_pt);
+    // Zero-padded to the FFT length for the linear convolution.
+    for (i=0; i < FFT_LENGTH; i++)
+    {
+      spectrum.re[i] = (i < IMPULSE_RESPONSE_LENGTH) ? impulseResponse.x[i] : 0.0;
+      spectrum.im[i] = 0.0;
+    }
+    complexFFT(spectrum, FFT_EXPONENT, false);
 
-    getWindow(window, spectrumWindowLength_pt, HAMMING_WINDOW);
-    int start = mark_pt - spectrumWindowLength_pt/2;
-    for (i=0; i < spectrumWindowLength_pt; i++)
+    for (i=0; i < FFT_LENGTH; i++)
     {
-      userSpectrum->re[i] = track[MAIN_TRACK]->getValue(start + i) * window.x[i];      
+      (*spectrumRe)[itemIndex*FFT_LENGTH + i] = spectrum.re[i];
+      (*spectrumIm)[itemIndex*FFT_LENGTH + i] = spectrum.im[i];
     }
-    // The result of the FFT will be in userSpectrum again.
-    realFFT(*userSpectrum, e, true);
   }
-  else
+};
+
+
+// ****************************************************************************
+/// Renders the gestural score quasi-statically in the frequency domain, 
+/// which is much faster than the time-domain simulation and meant for the
+/// preview. The vocal tract impulse responses are calculated with the TL
+/// model every HOP_LENGTH samples (in parallel, and only once for frames 
+/// with the same shape). The source is an LF pulse train with the F0 and 
+/// lung pressure of the score. Segments of the source with a Hann window of 
+/// two hops are convolved with the impulse response of their center frame
+/// and overlap-added, so that the filters cross-fade between the frames.
+/// There is neither a noise source nor a glottal abduction, i.e., voiceless
+/// sounds are rendered as voiced. The samples have the scaling of the main
+/// track.
+// ****************************************************************************
+
+bool Data::quickRenderGesturalScore(GesturalScore *score, LfPulse &lfPulse, vector<double> &audio)
+{
+  const int HOP_LENGTH = ScoreImpulseResponseJob::IMPULSE_RESPONSE_LENGTH / 2;
+  const int SEGMENT_LENGTH = 2*HOP_LENGTH;
+  const int FFT_EXPONENT = ScoreImpulseResponseJob::FFT_EXPONENT;
+  const int FFT_LENGTH = ScoreImpulseResponseJob::FFT_LENGTH;
+  const double REFERENCE_PRESSURE_DPA = 8000.0;
+  const double MIN_F0_HZ = 20.0;
+  const int NUM_LOWPASS_POLES = 6;
+
+  int duration_pt = score->getDuration_pt();
+  double tractParams[VocalTract::NUM_PARAMS];
+  double glottisParams[256];
+  vector<double> frameParams;
+  vector<double> uniqueParams;
+  vector<int> frameSpectrum;
+  vector<double> spectrumRe;
+  vector<double> spectrumIm;
+  vector<double> source;
+  vector<double> output;
+  LfPulse origLfPulse = lfPulse;
+  Signal singlePulse;
+  ComplexSignal segment(FFT_LENGTH);
+  IirFilter filter;
+  double f0_Hz, pressure_dPa;
+  double window;
+  double re, im;
+  int numFrames, numUniqueFrames;
+  int numWorkers;
+  int pos, pulseLength;
+  int start, index;
+  bool isEqual;
+  int i, k;
+
+  audio.clear();
+  if (duration_pt < 1)
+  {
+    return false;
+  }
 
   // ****************************************************************
-  // The cepstrum.
+  // Get the vocal tract parameters of the frames and find the frames
+  // that have the same shape as the previous one.
   // ****************************************************************
 
-  if (userSpectrumType == CEPSTRUM)
+  numFrames = duration_pt / HOP_LENGTH + 2;
+  frameParams.resize(numFrames * VocalTract::NUM_PARAMS);
+  frameSpectrum.resize(numFrames);
+  numUniqueFrames = 0;
+
+  for (k=0; k < numFrames; k++)
   {
-    int e = getFrameLengthExponent(spectrumWindowLength_pt);
-    int frameLength = (int)1 << e;
-    ComplexSignal s(frameLength);
-    Signal window(spectrumWindowLength_pt);
+    score->getParams((double)(k*HOP_LENGTH) / (double)SAMPLING_RATE, tractParams, glottisParams);
 
-    getWindow(window, spectrumWindowLength_pt, HAMMING_WINDOW);
-    int start = mark_pt - spectrumWindowLength_pt/2;
-    for (i=0; i < spectrumWindowLength_pt; i++)
+    isEqual = (k > 0);
+    for (i=0; (i < VocalTract::NUM_PARAMS) && (isEqual); i++)
     {
-      s.re[i] = track[MAIN_TRACK]->getValue(start + i) * window.x[i];      
+      if (tractParams[i] != frameParams[(k-1)*VocalTract::NUM_PARAMS + i])
+      {
+        isEqual = false;
+      }
     }
-    // The result of the FFT will be in s again.
-    realFFT(s, e, true);
-
-    // Take the logarithm of the magnitude of the spectrum.
-    for (i=0; i < frameLength; i++)
+    for (i=0; i < VocalTract::NUM_PARAMS; i++)
     {
-      s.re[i] = log(s.getMagnitude(i));
-      s.im[i] = 0.0;
+      frameParams[k*VocalTract::NUM_PARAMS + i] = tractParams[i];
     }
 
-    // Go into the time domain again.
-    realIFFT(s, e, false);
-
-    // Get the final user spectrum.
-    userSpectrum->reset(spectrumWindowLength_pt);
-    for (i=0; i < spectrumWindowLength_pt; i++)
+    if (isEqual)
     {
-      userSpectrum->re[i] = s.re[i];
-      userSpectrum->im[i] = 0.0;
+      frameSpectrum[k] = frameSpectrum[k-1];
+    }
+    else
+    {
+      frameSpectrum[k] = numUniqueFrames++;
+      uniqueParams.insert(uniqueParams.end(), tractParams, tractParams + VocalTract::NUM_PARAMS);
     }
   }
-  else
 
   // ****************************************************************
-  // Average spectrum of several time shifted windows of the signal.
+  // Calculate the impulse response spectra. All workers use copies of
+  // the main vocal tract, which is left untouched.
   // ****************************************************************
 
-  if (userSpectrumType == AVERAGE_SPECTRUM)
+  ScoreImpulseResponseJob job;
+  job.frameParams = &uniqueParams;
+  job.spectrumRe = &spectrumRe;
+  job.spectrumIm = &spectrumIm;
+  spectrumRe.resize(numUniqueFrames * FFT_LENGTH);
+  spectrumIm.resize(numUniqueFrames * FFT_LENGTH);
+
+  numWorkers = createWorkerTracts(vocalTract, 
+    ParallelJob::getNumWorkers(numUniqueFrames), job.workerTract);
+  if (numWorkers < 1)
   {
-    if (isValidSelection() == false)
-    {
-      wxMessageBox("You must select a region of the main signal for the analysis!", 
-        "Invalid selection");
-      return;
-    }
+    return false;
+  }
 
-    int regionLength_pt = selectionMark_pt[1] - selectionMark_pt[0] + 1;
-    if (spectrumWindowLength_pt > regionLength_pt)
+  for (k=0; k < numWorkers; k++)
+  {
+    TlModel *model = new TlModel();
+    model->options = tlModel->options;
+    job.workerModel.push_back(model);
+  }
+
+  job.run(numUniqueFrames, numWorkers);
+
+  for (k=0; k < numWorkers; k++)
+  {
+    delete job.workerModel[k];
+  }
+  deleteWorkerTracts(job.workerTract);
+
+  // ****************************************************************
+  // Create the LF pulse train with the F0 and lung pressure of the 
+  // score. The pulses are scaled down with increasing F0 like in 
+  // synthesizeVowelLf(...).
+  // ****************************************************************
+
+  source.assign(numFrames*HOP_LENGTH + SEGMENT_LENGTH, 0.0);
+  pos = 0;
+
+  while (pos < duration_pt)
+  {
+    score->getParams((double)pos / (double)SAMPLING_RATE, tractParams, glottisParams);
+    f0_Hz = glottisParams[Glottis::FREQUENCY];
+    pressure_dPa = glottisParams[Glottis::PRESSURE];
+    if (f0_Hz < MIN_F0_HZ)
     {
-      wxMessageBox("The length of the selected region must be at least the window length!", 
-        "Length of selected region to short");
-      return;
+      f0_Hz = MIN_F0_HZ;
     }
+    pulseLength = (int)((double)SAMPLING_RATE / f0_Hz);
 
-    // Avoid division by zero.
-    if (averageSpectrumTimeStep_ms < 1.0)
+    if (pressure_dPa > 0.0)
     {
-      averageSpectrumTimeStep_ms = 1.0;
+      lfPulse.F0 = f0_Hz;
+      lfPulse.AMP = 500.0 * pressure_dPa / REFERENCE_PRESSURE_DPA;
+      lfPulse.getPulse(singlePulse, pulseLength, false);
+      for (k=0; (k < pulseLength) && (pos + k < (int)source.size()); k++)
+      {
+        source[pos + k] = singlePulse.getValue(k) * 80.0 / f0_Hz;
+      }
     }
-    int timeStep_pt = (int)(SAMPLING_RATE*averageSpectrumTimeStep_ms/1000.0);
+    pos+= pulseLength;
+  }
 
-    int numFrames = 1 + (regionLength_pt - spectrumWindowLength_pt) / timeStep_pt;
-    int frame;
-    int startPos;
-    int e = getFrameLengthExponent(spectrumWindowLength_pt);
-    int frameLength = (int)1 << e;
-    ComplexSignal s(frameLength);
-    Signal sumSignal(frameLength);
-    
-    Signal window(spectrumWindowLength_pt);
-    getWindow(window, spectrumWindowLength_pt, HAMMING_WINDOW);
+  lfPulse = origLfPulse;
 
-    wxPrintf("Averaging %d spectra... ", numFrames);
+  // ****************************************************************
+  // Convolve the windowed source segments with the impulse responses 
+  // of their center frames and overlap-add them. The segment of frame
+  // k starts one hop before the frame.
+  // ****************************************************************
 
-    for (frame = 0; frame < numFrames; frame++)
-    {
-      startPos = selectionMark_pt[0] + frame*timeStep_pt;
-      s.reset(frameLength);   // Make all signal samples zero.
-      for (i=0; i < spectrumWindowLength_pt; i++)
-      {
-        s.re[i] = track[MAIN_TRACK]->getValue(startPos + i) * window.x[i];      
-      }
-      // The result of the FFT will be in s again.
-      realFFT(s, e, true);
+  output.assign(source.size() + FFT_LENGTH, 0.0);
 
-      for (i=0; i < frameLength; i++)
+  for (k=0; k < numFrames; k++)
+  {
+    start = (k-1)*HOP_LENGTH;
+    for (i=0; i < FFT_LENGTH; i++)
+    {
+      segment.re[i] = 0.0;
+      segment.im[i] = 0.0;
+    }
+    for (i=0; i < SEGMENT_LENGTH; i++)
+    {
+      if ((start + i >= 0) && (start + i < (int)source.size()))
       {
-        sumSignal.x[i]+= s.getMagnitude(i);
+        window = 0.5 - 0.5*cos(2.0*M_PI*i / (double)SEGMENT_LENGTH);
+        segment.re[i] = source[start + i] * window;
       }
     }
 
-    // Get the final user spectrum.
-
-    userSpectrum->reset(frameLength);
-    for (i=0; i < frameLength; i++)
+    complexFFT(segment, FFT_EXPONENT, false);
+    index = frameSpectrum[k]*FFT_LENGTH;
+    for (i=0; i < FFT_LENGTH; i++)
     {
-      userSpectrum->re[i] = sumSignal.x[i] / numFrames;
+      re = segment.re[i]*spectrumRe[index + i] - segment.im[i]*spectrumIm[index + i];
+      im = segment.re[i]*spectrumIm[index + i] + segment.im[i]*spectrumRe[index + i];
+      segment.re[i] = re;
+      segment.im[i] = im;
     }
+    complexIFFT(segment, FFT_EXPONENT, true);
 
-    wxPrintf("Done.\n");
+    for (i=0; i < FFT_LENGTH; i++)
+    {
+      if (start + i >= 0)
+      {
+        output[start + i]+= segment.re[i];
+      }
+    }
   }
-  else
 
   // ****************************************************************
-  // A test signal.
+  // Low-pass filter and scale the result.
   // ****************************************************************
 
-  if (userSpectrumType == TEST_SPECTRUM)
+  filter.createChebyshev((double)SYNTHETIC_SPEECH_BANDWIDTH_HZ / (double)SAMPLING_RATE, false, NUM_LOWPASS_POLES);
+  audio.resize(duration_pt);
+  for (i=0; i < duration_pt; i++)
   {
-    userSpectrum->reset(512);
-
-    for (i=0; i < userSpectrum->N; i++)
-    {
-      userSpectrum->re[i] = track[MAIN_TRACK]->getValue(mark_pt + i);
-    }
+    audio[i] = 2000.0 * filter.getOutputSample(output[i]);
   }
+
+  return true;
 }
 
 
 // ****************************************************************************
-/// Calculates the spectrum of the radiated noise that is generated by a 
-/// lumped dipole noise source in the TL model at the position 
-/// noiseSourcePos_cm. The spectrum of the source is that of a 2nd-order 
-/// lowpass filter with the given cutoff frequency. Since the diploe sources 
-/// in the TL model can only be located at the intersections of two tube sections, 
-/// the source at the given position is actually split in two sources at the
-/// two nearest tube section ends.
+/// Prepares the time-domain simulation of the gestural score with the 
+/// selected glottis model. When the score was synthesized before with the 
+/// same settings, the models are set to the last checkpoint of that 
+/// synthesis before the first change of the parameter trajectories, and the
+/// audio signal before it is taken over into the main track. Otherwise, 
+/// the synthesis starts from the beginning. Returns the position from which
+/// the synthesis continues.
 // ****************************************************************************
 
-bool Data::calcRadiatedNoiseSpectrum(double noiseSourcePos_cm, double noiseFilterCutoffFreq,
-  int spectrumLength, ComplexSignal *spectrum)
+int Data::startGesturalScoreSynthesis()
 {
+  TdsCheckpointList *checkpoints = &gesturalScoreCheckpoints;
+  TdsCheckpoint *checkpoint = NULL;
+  TdsModel::Options *tdsOptions = &tdsModel->options;
+  vector<double> settingsKey;
+  double change_s;
+  double lastOutputFlow_cm3_s;
   int i;
-  Tube *tube = &tlModel->tube;
 
+  // The checkpoints depend on the selected glottis model with its static
+  // parameters and on the options of the TDS model. The output pressure
+  // filter is created once in init() and never changes.
 
-  // ************************************************************
-  // Find the tube section of the noise source.
-  // ************************************************************
+  settingsKey.push_back((double)selectedGlottis);
+  for (i=0; i < (int)getSelectedGlottis()->staticParam.size(); i++)
+  {
+    settingsKey.push_back(getSelectedGlottis()->staticParam[i].x);
+  }
 
-  Tube::Section *ts = NULL;
-  int noiseSourceSection = -1;
-  double ratio = 0.0;
-  double ratio1 = 1.0;
+  settingsKey.push_back(tdsOptions->turbulenceLosses ? 1.0 : 0.0);
+  settingsKey.push_back(tdsOptions->softWalls ? 1.0 : 0.0);
+  settingsKey.push_back(tdsOptions->generateNoiseSources ? 1.0 : 0.0);
+  settingsKey.push_back(tdsOptions->radiationFromSkin ? 1.0 : 0.0);
+  settingsKey.push_back(tdsOptions->piriformFossa ? 1.0 : 0.0);
+  settingsKey.push_back(tdsOptions->innerLengthCorrections ? 1.0 : 0.0);
+  settingsKey.push_back(tdsOptions->transvelarCoupling ? 1.0 : 0.0);
+  settingsKey.push_back((double)tdsOptions->solverType);
 
-  for (i = 0; (i < Tube::NUM_PHARYNX_MOUTH_SECTIONS) && (noiseSourceSection == -1); i++)
+  scoreTrajectory.update(gesturalScore);
+
+  if (settingsKey == checkpoints->settingsKey)
   {
-    ts = &tube->pharynxMouthSection[i];
-    if ((noiseSourcePos_cm >= ts->pos_cm) && (noiseSourcePos_cm <= ts->pos_cm + ts->length_cm))
+    change_s = scoreTrajectory.getFirstDifference_s(checkpoints->trajectory);
+    if (change_s < 0.0)
+    {
+      change_s = gesturalScore->getDuration_pt() / (double)SAMPLING_RATE;
+    }
+    else
     {
-      noiseSourceSection = Tube::FIRST_PHARYNX_SECTION + i;
-      double length_cm = ts->length_cm;
-      if (length_cm < 0.000001)
+      // The cached trajectories are interpolated linearly between the
+      // samples, so the score may differ already one control period 
+      // before the first different sample.
+      change_s-= 1.0 / ScoreTrajectoryCache::CONTROL_RATE_HZ;
+      if (change_s < 0.0)
       {
-        length_cm = 0.000001;
+        change_s = 0.0;
       }
-      ratio = (noiseSourcePos_cm - ts->pos_cm) / length_cm;
-      ratio1 = 1.0 - ratio;
     }
+    checkpoint = checkpoints->getLastBefore((int)(change_s*SAMPLING_RATE));
   }
 
-  // ****************************************************************
-  // Error: The noise source position is invalid -> return a
-  // constant spectrum.
-  // ****************************************************************
-
-  if (noiseSourceSection == -1)
+  if ((checkpoint != NULL) &&
+    (checkpoint->restore(gesturalScore, tdsModel, getSelectedGlottis(), 
+      &outputPressureFilter, lastOutputFlow_cm3_s)))
   {
-    spectrum->reset(spectrumLength);
-    for (i = 0; i < spectrumLength; i++)
+    // Stepping the score forward calculated the main vocal tract.
+    vocalTractCalculatedExternally();
+    resetTdsBuffers();
+    checkpoints->removeAfter(checkpoint->pos_pt);
+    for (i=0; i < checkpoint->pos_pt; i++)
     {
-      spectrum->setValue(i, 1.0);
+      track[MAIN_TRACK]->setValue(i, checkpoints->audio[i]);
     }
-    return false;
-  }
-
-  // ****************************************************************
-  // The noise source position is valid.
-  // ****************************************************************
-
-  // Calc. two transfer functions from a noise sources at the
-  // beginning and the end of the given tube section.
-
-  ComplexSignal spectrum1(spectrumLength);
-  ComplexSignal spectrum2(spectrumLength);
-
-  if (noiseSourceSection < Tube::LAST_MOUTH_SECTION)
-  {
-    tlModel->getSpectrum(TlModel::PRESSURE_SOURCE_TF,
-      &spectrum1, spectrumLength, noiseSourceSection);
-    tlModel->getSpectrum(TlModel::PRESSURE_SOURCE_TF,
-      &spectrum2, spectrumLength, noiseSourceSection + 1);
+    outputFlow[(checkpoint->pos_pt - 1) & TDS_BUFFER_MASK] = lastOutputFlow_cm3_s;
+    wxPrintf("Continuing the synthesis from the checkpoint at %2.3f s.\n", 
+      checkpoint->pos_pt / (double)SAMPLING_RATE);
   }
   else
   {
-    tlModel->getSpectrum(TlModel::PRESSURE_SOURCE_TF,
-      &spectrum1, spectrumLength, noiseSourceSection);
-    // The section -1 means the end of the last mouth section.
-    tlModel->getSpectrum(TlModel::PRESSURE_SOURCE_TF,
-      &spectrum2, spectrumLength, -1);
-  }
-
-  // Calc. the weighted superposition of the two spectra and
-  // apply the noise shaping filter.
-
-  ComplexValue c;
-  IirFilter filter;
-  double freq;
-
-  const double Q = 1.0 / sqrt(2.0);
-  filter.createSecondOrderLowpass(noiseFilterCutoffFreq / (double)SAMPLING_RATE, Q);
-
-  spectrum->reset(spectrumLength);
-  for (i = 0; i < spectrumLength; i++)
-  {
-    c = ratio1 * spectrum1.getValue(i) + ratio * spectrum2.getValue(i);
-    // Noise shaping filter
-    freq = (double)SAMPLING_RATE * i / spectrumLength;
-    c *= filter.getFrequencyResponse(freq / (double)SAMPLING_RATE);
-    spectrum->setValue(i, c);
+    gesturalScore->resetSequence();
+    tdsModel->resetMotion();
+    resetTdsBuffers();
+    checkpoints->clear();
   }
 
-  ComplexSignal radiationSpectrum(spectrumLength);
-  tlModel->getSpectrum(TlModel::RADIATION, &radiationSpectrum, spectrumLength, 0);
-  (*spectrum) *= radiationSpectrum;
-  (*spectrum) *= 30000.0;           // Arbitrary scaling
+  checkpoints->settingsKey = settingsKey;
+  scoreTrajectory.getSamples(checkpoints->trajectory);
 
-  return true;
+  return gesturalScore->getPos_pt();
 }
 
 
 // ****************************************************************************
-/// Exports the virtual EMA trajectories calculated from the current gestural
-/// score.
+/// Synthesizes the loaded gestural score with the TDS, changes the target of
+/// the first F0 gesture in its second half, and synthesizes it again, once 
+/// continued from the checkpoints of the first synthesis and once from the
+/// beginning. Returns true, if both signals are identical.
 // ****************************************************************************
 
-bool Data::exportEmaTrajectories(const wxString &fileName)
+bool Data::compareResumedSynthesis()
 {
-  if (fileName.IsEmpty())
-  {
-    return false;
-  }
-
-  ofstream os(fileName.ToStdString());
+  const double F0_CHANGE_ST = 2.0;
+  int duration_pt = gesturalScore->getDuration_pt();
+  GestureSequence *sequence = &gesturalScore->gestures[GesturalScore::F0_GESTURE];
+  vector<short> audio[2];
+  int startPos_pt[2];
+  int gestureIndex;
+  int numDifferences;
+  int firstDifference;
   int i, k;
 
-  if (!os)
+  if ((duration_pt < 1) || (sequence->numGestures() < 1))
   {
-    wxMessageBox(wxString("Could not open ") + fileName + wxString(" for writing."),
-      "Error!");
+    wxPrintf("Error: The gestural score has no F0 gestures.\n");
     return false;
   }
 
-  // ****************************************************************
-  // Write the header.
-  // ****************************************************************
-
-  VocalTract::EmaPoint *p;
-  int numEmaPoints = (int)vocalTract->emaPoints.size();
-
-  os << "time[s] ";
-  for (i=0; i < numEmaPoints; i++)
-  {
-    p = &vocalTract->emaPoints[i];
-    os << p->name << "-x[cm] " << p->name << "-y[cm] ";
-  }
-  os << endl;
-
-  // ****************************************************************
-  // Keep in mind the current vocal tract state.
-  // ****************************************************************
-
-  double oldTractParams[VocalTract::NUM_PARAMS];
-  for (i=0; i < VocalTract::NUM_PARAMS; i++)
-  {
-    oldTractParams[i] = vocalTract->param[i].x;
-  }
+  gesturalScore->glottis = getSelectedGlottis();
+  synthesisType = SYNTHESIS_GESMOD;
+  growTracks(duration_pt);
+  gesturalScoreCheckpoints.clear();
+  gesturalScoreCheckpoints.settingsKey.clear();
 
   // ****************************************************************
-  // Write the data.
+  // Synthesize the score with checkpoints, change it, and synthesize
+  // it continued from the checkpoints (k = 0) and from the beginning
+  // (k = 1).
   // ****************************************************************
 
-  double tractParams[VocalTract::NUM_PARAMS];
-  double glottisParams[256];
-  double t_s;
-  Point3D Q;
-
-  const double EMA_SAMPLING_RATE_HZ = 200.0;
-  int numFrames = (int)(gesturalScore->getScoreDuration_s() * EMA_SAMPLING_RATE_HZ);
-
-  os << setprecision(8);
-
-  for (k=0; k < numFrames; k++)
+  for (k=-1; k < 2; k++)
   {
-    t_s = (double)k / (double)EMA_SAMPLING_RATE_HZ;
-    gesturalScore->getParams(t_s, tractParams, glottisParams);
+    if (k == 0)
+    {
+      gestureIndex = sequence->numGestures() - 1;
+      for (i=sequence->numGestures() - 1; i >= 0; i--)
+      {
+        if (sequence->getGestureBegin_s(i)*SAMPLING_RATE >= duration_pt / 2)
+        {
+          gestureIndex = i;
+        }
+      }
+      sequence->getGesture(gestureIndex)->dVal+= F0_CHANGE_ST;
+      gesturalScore->calcCurves();
+      wxPrintf("Changed the F0 gesture at %2.3f s.\n", sequence->getGestureBegin_s(gestureIndex));
+    }
+    if (k == 1)
+    {
+      gesturalScoreCheckpoints.clear();
+    }
 
-    for (i=0; i < VocalTract::NUM_PARAMS; i++)
+    track[MAIN_TRACK]->setZero();
+    i = startGesturalScoreSynthesis();
+    if (k >= 0)
     {
-      vocalTract->param[i].x = tractParams[i];
+      startPos_pt[k] = i;
     }
-    vocalTract->calculateAll();
 
-    // Write data to file.
+    SynthesisThread *thread = new SynthesisThread(NULL, gesturalScore, wxTHREAD_JOINABLE);
+    thread->setCheckpoints(&gesturalScoreCheckpoints);
+    if ((thread->Create() != wxTHREAD_NO_ERROR) || (thread->Run() != wxTHREAD_NO_ERROR))
+    {
+      wxPrintf("Error: Failed to start the synthesis thread.\n");
+      delete thread;
+      return false;
+    }
+    thread->Wait();
+    delete thread;
+    vocalTractCalculatedExternally();
 
-    os << t_s << " ";
-    for (i=0; i < numEmaPoints; i++)
+    if (k >= 0)
     {
-      Q = vocalTract->getEmaPointCoord(i);
-      os << Q.x << " " << Q.y << " ";
+      audio[k].resize(duration_pt);
+      for (i=0; i < duration_pt; i++)
+      {
+        audio[k][i] = track[MAIN_TRACK]->getValue(i);
+      }
     }
-    os << endl;
   }
 
+  trackChanged(MAIN_TRACK);
+
   // ****************************************************************
-  // Set back the old vocal tract state.
+  // Compare the signals.
   // ****************************************************************
 
-  for (i=0; i < VocalTract::NUM_PARAMS; i++)
+  numDifferences = 0;
+  firstDifference = -1;
+  for (i=0; i < duration_pt; i++)
   {
-    vocalTract->param[i].x = oldTractParams[i];
+    if (audio[0][i] != audio[1][i])
+    {
+      if (firstDifference == -1)
+      {
+        firstDifference = i;
+      }
+      numDifferences++;
+    }
   }
-  vocalTract->calculateAll();
 
-  // ****************************************************************
-  // Close the file.
-  // ****************************************************************
+  wxPrintf("The resumed synthesis started at %2.3f s (the full one at %2.3f s).\n",
+    startPos_pt[0] / (double)SAMPLING_RATE, startPos_pt[1] / (double)SAMPLING_RATE);
 
-  os.close();
+  if (startPos_pt[0] < 1)
+  {
+    wxPrintf("Error: No checkpoint before the change was found.\n");
+    return false;
+  }
 
+  if (numDifferences > 0)
+  {
+    wxPrintf("Error: %d of %d samples differ (the first at %2.4f s).\n", 
+      numDifferences, duration_pt, firstDifference / (double)SAMPLING_RATE);
+    return false;
+  }
+
+  wxPrintf("The resumed and the full synthesis are identical (%d samples).\n", duration_pt);
   return true;
 }
 
 
 // ****************************************************************************
-/// Exports video frames of the vocal tract from a gestural score at a fixed
-/// frame rate into the given folder.
+/// Calculates the user spectrum that is obtained from the signal in the main
+/// track and displayed in the simple spectrum picture.
 // ****************************************************************************
 
-bool Data::exportVocalTractVideoFrames(const wxString &folderName)
+void Data::calcUserSpectrum()
 {
-  const int VIDEO_FRAME_RATE = 30;
-  double duration_s = gesturalScore->getDuration_pt() / (double)SAMPLING_RATE;
-  int numFrames = (int)(duration_s*VIDEO_FRAME_RATE);
   int i;
-  int frameIndex;
-  double time_s;
-  double oldVocalTractParams[VocalTract::NUM_PARAMS];
-  double vocalTractParams[VocalTract::NUM_PARAMS];
-  double glottisParams[256];
 
   // ****************************************************************
-  // Keep in mind the current vocal tract state.
+  // An ordinary short-time spectrum
   // ****************************************************************
 
-  for (i=0; i < VocalTract::NUM_PARAMS; i++)
+  if (userSpectrumType == NORMAL_SPECTRUM)
   {
-    oldVocalTractParams[i] = vocalTract->param[i].x;    
+    int e = getFrameLengthExponent(spectrumWindowLength_pt);
+    int frameLength = (int)1 << e;
+    userSpectrum->reset(frameLength);
+    Signal window(spectrumWindowLength_pt);
+
+    getWindow(window, spectrumWindowLength_pt, HAMMING_WINDOW);
+    int start = mark_pt - spectrumWindowLength_pt/2;
+    for (i=0; i < spectrumWindowLength_pt; i++)
+    {
+      userSpectrum->re[i] = track[MAIN_TRACK]->getValue(start + i) * window.x[i];      
+    }
+    // The result of the FFT will be in userSpectrum again.
+    realFFT(*userSpectrum, e, true);
   }
+  else
 
   // ****************************************************************
-  // Save one image file for each video frame.
+  // The cepstrum.
   // ****************************************************************
 
-  for (frameIndex=0; frameIndex < numFrames; frameIndex++)
+  if (userSpectrumType == CEPSTRUM)
   {
-    wxPrintf("frame #: %d\n", frameIndex);
-
-    // Calculate the vocal tract shape at the current frame.
-
-    time_s = (double)frameIndex / (double)VIDEO_FRAME_RATE;
-    gesturalScore->getParams(time_s, vocalTractParams, glottisParams);
+    int e = getFrameLengthExponent(spectrumWindowLength_pt);
+    int frameLength = (int)1 << e;
+    ComplexSignal s(frameLength);
+    Signal window(spectrumWindowLength_pt);
 
-    for (i=0; i < VocalTract::NUM_PARAMS; i++)
+    getWindow(window, spectrumWindowLength_pt, HAMMING_WINDOW);
+    int start = mark_pt - spectrumWindowLength_pt/2;
+    for (i=0; i < spectrumWindowLength_pt; i++)
     {
-      vocalTract->param[i].x = vocalTractParams[i];    
+      s.re[i] = track[MAIN_TRACK]->getValue(start + i) * window.x[i];      
     }
-    vocalTract->calculateAll();
-
-    // Update the vocal tract dialog.
+    // The result of the FFT will be in s again.
+    realFFT(s, e, true);
 
-    VocalTractDialog *vocalTractDialog = VocalTractDialog::getInstance(NULL);
-    if (vocalTractDialog->IsShownOnScreen() == false)
+    // Take the logarithm of the magnitude of the spectrum.
+    for (i=0; i < frameLength; i++)
     {
-      vocalTractDialog->Show(true);
+      s.re[i] = log(s.getMagnitude(i));
+      s.im[i] = 0.0;
     }
-    vocalTractDialog->Refresh();
-    vocalTractDialog->Update();
-    wxYield();
 
-    // Save the current vocal tract shape as an image (video frame).
-    wxString frameFileName = folderName;
-    wxChar pathSeparator = wxFileName::GetPathSeparator();
-    if (frameFileName.EndsWith( &pathSeparator ) == false)
+    // Go into the time domain again.
+    realIFFT(s, e, false);
+
+    // Get the final user spectrum.
+    userSpectrum->reset(spectrumWindowLength_pt);
+    for (i=0; i < spectrumWindowLength_pt; i++)
     {
-      frameFileName+= pathSeparator;
+      userSpectrum->re[i] = s.re[i];
+      userSpectrum->im[i] = 0.0;
     }
-    frameFileName+= "vt" + wxString::Format("%03d", frameIndex) + ".bmp";
-    vocalTractDialog->getVocalTractPicture()->saveImageBmp(frameFileName);
   }
-
+  else
 
   // ****************************************************************
-  // Restore the old vocal tract state.
+  // Average spectrum of several time shifted windows of the signal.
   // ****************************************************************
 
-  for (i=0; i < VocalTract::NUM_PARAMS; i++)
+  if (userSpectrumType == AVERAGE_SPECTRUM)
   {
-    vocalTract->param[i].x = oldVocalTractParams[i];
-  }
-  vocalTract->calculateAll();
-
-  VocalTractDialog *vocalTractDialog = VocalTractDialog::getInstance(NULL);
-  vocalTractDialog->Refresh();
-  vocalTractDialog->Update();
+    if (isValidSelection() == false)
+    {
+      wxMessageBox("You must select a region of the main signal for the analysis!", 
+        "Invalid selection");
+      return;
+    }
 
-  wxPrintf("Finished exporting %d video frames for a frame rate of %d Hz.\n", 
-    numFrames, VIDEO_FRAME_RATE);
+    int regionLength_pt = selectionMark_pt[1] - selectionMark_pt[0] + 1;
+    if (spectrumWindowLength_pt > regionLength_pt)
+    {
+      wxMessageBox("The length of the selected region must be at least the window length!", 
+        "Length of selected region to short");
+      return;
+    }
 
-  return true;
-}
+    // Avoid division by zero.
+    if (averageSpectrumTimeStep_ms < 1.0)
+    {
+      averageSpectrumTimeStep_ms = 1.0;
+    }
+    int timeStep_pt = (int)(SAMPLING_RATE*averageSpectrumTimeStep_ms/1000.0);
 
+    int numFrames = 1 + (regionLength_pt - spectrumWindowLength_pt) / timeStep_pt;
+    int frame;
+    int startPos;
+    int e = getFrameLengthExponent(spectrumWindowLength_pt);
+    int frameLength = (int)1 << e;
+    ComplexSignal s(frameLength);
+    Signal sumSignal(frameLength);
+    
+    Signal window(spectrumWindowLength_pt);
+    getWindow(window, spectrumWindowLength_pt, HAMMING_WINDOW);
 
-// ****************************************************************************
-/// Exports the volume velocity transfer functions (closed glottis condition)
-/// for every single millisecond in a gestural score.
-// ****************************************************************************
+    wxPrintf("Averaging %d spectra... ", numFrames);
 
-bool Data::exportTransferFunctionsFromScore(const wxString &fileName)
-{
-  const int SPECTRUM_LENGTH = 8192;
-  const int FRAME_RATE = 1000;
-  double duration_s = gesturalScore->getDuration_pt() / (double)SAMPLING_RATE;
-  int numFrames = (int)(duration_s*FRAME_RATE);
-  int i;
-  int frameIndex;
-  double time_s;
-  double oldVocalTractParams[VocalTract::NUM_PARAMS];
-  double vocalTractParams[VocalTract::NUM_PARAMS];
-  double glottisParams[256];
-  ComplexSignal spectrum(SPECTRUM_LENGTH);
+    for (frame = 0; frame < numFrames; frame++)
+    {
+      startPos = selectionMark_pt[0] + frame*timeStep_pt;
+      s.reset(frameLength);   // Make all signal samples zero.
+      for (i=0; i < spectrumWindowLength_pt; i++)
+      {
+        s.re[i] = track[MAIN_TRACK]->getValue(startPos + i) * window.x[i];      
+      }
+      // The result of the FFT will be in s again.
+      realFFT(s, e, true);
 
-  // ****************************************************************
-  // Keep in mind the current vocal tract state.
-  // ****************************************************************
+      for (i=0; i < frameLength; i++)
+      {
+        sumSignal.x[i]+= s.getMagnitude(i);
+      }
+    }
 
-  for (i = 0; i < VocalTract::NUM_PARAMS; i++)
-  {
-    oldVocalTractParams[i] = vocalTract->param[i].x;
-  }
+    // Get the final user spectrum.
 
-  // ****************************************************************
-  // Save one transfer function spectrum every millisecond
-  // (all into the same file).
-  // ****************************************************************
-
-  // Open the text file.
-
-  ofstream os(fileName.ToStdString());
+    userSpectrum->reset(frameLength);
+    for (i=0; i < frameLength; i++)
+    {
+      userSpectrum->re[i] = sumSignal.x[i] / numFrames;
+    }
 
-  if (!os)
-  {
-    wxMessageBox(wxString("Could not open ") + fileName + wxString(" for writing."),
-      "Error!");
-    return false;
+    wxPrintf("Done.\n");
   }
+  else
 
-  // Write the header.
-
-  os << "# This file contains " << numFrames << " volume velocity transfer functions between "
-    "the glottis and the lips for the closed-glottis condition obtained from a gestural score. "
-    "There is one transfer function for every millisecond of the gestural score. "
-    "Each transfer function has 8192 samples that represent the frequencies from 0 to 44100 Hz. "
-    "The samples 0 ... 4095 (= 0 ... 22050 Hz) represent the positive frequencies, and the "
-    "remaining samples the negative frequencies (mirror image of the positive frequency part). "
-    "The frequency resolution of the transfer functions is hence 44100/8192 = 5.38 Hz. "
-    "There are two text lines per transfer function: The first line contains the magnitude "
-    "samples and the second line contains the phase samples in rad." << endl;
-  
-  os << setprecision(5);    // 5 post-decimal positions for floating point numbers
-
-  // Write all the transfer functions in a loop.
-
-  wxWindowDisabler disableAll;
-  wxBusyInfo wait("Please wait ...");
-
-  wxPrintf("Writing %d transfer functions to text file .", numFrames);
+  // ****************************************************************
+  // A test signal.
+  // ****************************************************************
 
-  for (frameIndex = 0; frameIndex < numFrames; frameIndex++)
+  if (userSpectrumType == TEST_SPECTRUM)
   {
-    if ((frameIndex % 10) == 0)
+    userSpectrum->reset(512);
+
+    for (i=0; i < userSpectrum->N; i++)
     {
-      wxPrintf(".");
+      userSpectrum->re[i] = track[MAIN_TRACK]->getValue(mark_pt + i);
     }
+  }
+}
 
-    // Calculate the vocal tract shape at the current frame.
 
-    time_s = (double)frameIndex / (double)FRAME_RATE;
-    gesturalScore->getParams(time_s, vocalTractParams, glottisParams);
+// ****************************************************************************
+/// Calculates the spectrum of the radiated noise that is generated by a 
+/// lumped dipole noise source in the TL model at the position 
+/// noiseSourcePos_cm. The spectrum of the source is that of a 2nd-order 
+/// lowpass filter with the given cutoff frequency. Since the diploe sources 
+/// in the TL model can only be located at the intersections of two tube sections, 
+/// the source at the given position is actually split in two sources at the
+/// two nearest tube section ends.
+// ****************************************************************************
 
-    for (i = 0; i < VocalTract::NUM_PARAMS; i++)
-    {
-      vocalTract->param[i].x = vocalTractParams[i];
-    }
-    vocalTract->calculateAll();
+bool Data::calcRadiatedNoiseSpectrum(double noiseSourcePos_cm, double noiseFilterCutoffFreq,
+  int spectrumLength, ComplexSignal *spectrum)
+{
+  int i;
+  Tube *tube = &tlModel->tube;
 
-    // Update the vocal tract dialog, if it is shown on the screen.
 
-    VocalTractDialog *vocalTractDialog = VocalTractDialog::getInstance(NULL);
-    if (vocalTractDialog->IsShownOnScreen())
-    {
-      vocalTractDialog->Refresh();
-      vocalTractDialog->Update();
-      wxYield();
-    }
+  // ************************************************************
+  // Find the tube section of the noise source.
+  // ************************************************************
 
-    // Set the latest vocal tract geometry for the transmission line model.   
-    updateTlModelGeometry(vocalTract);
+  int noiseSourceSection = -1;
+  double ratio = 0.0;
+  double ratio1 = 1.0;
 
-    // Obtain the volume velocity transfer function.
-    tlModel->getSpectrum(TlModel::FLOW_SOURCE_TF, &spectrum, SPECTRUM_LENGTH, Tube::FIRST_PHARYNX_SECTION);
+  i = CrossSectionCache::getTubeSection(tube, noiseSourcePos_cm, ratio);
+  if (i != -1)
+  {
+    noiseSourceSection = Tube::FIRST_PHARYNX_SECTION + i;
+    ratio1 = 1.0 - ratio;
+  }
 
-    // Write magnitude.
-    for (i = 0; i < SPECTRUM_LENGTH; i++)
-    {
-      os << spectrum.getMagnitude(i) << " ";
-    }
-    os << endl;
+  // ****************************************************************
+  // Error: The noise source position is invalid -> return a
+  // constant spectrum.
+  // ****************************************************************
 
-    // Write phase.
-    for (i = 0; i < SPECTRUM_LENGTH; i++)
+  if (noiseSourceSection == -1)
+  {
+    spectrum->reset(spectrumLength);
+    for (i = 0; i < spectrumLength; i++)
     {
-      os << spectrum.getPhase(i) << " ";
+      spectrum->setValue(i, 1.0);
     }
-    os << endl;
+    return false;
   }
 
-  wxPrintf(" done.\n");
-
   // ****************************************************************
-  // Restore the old vocal tract state.
+  // The noise source position is valid. The spectrum is the
+  // weighted superposition of the spectra for sources at the
+  // beginning and the end of the tube section.
   // ****************************************************************
 
-  for (i = 0; i < VocalTract::NUM_PARAMS; i++)
+  prepareNoiseSweep(noiseFilterCutoffFreq, spectrumLength);
+
+  int boundary = noiseSourceSection - Tube::FIRST_PHARYNX_SECTION;
+  ComplexSignal *spectrum1 = getNoiseSweepSpectrum(boundary);
+  ComplexSignal *spectrum2 = getNoiseSweepSpectrum(boundary + 1);
+
+  spectrum->reset(spectrumLength);
+  for (i = 0; i < spectrumLength; i++)
   {
-    vocalTract->param[i].x = oldVocalTractParams[i];
+    spectrum->re[i] = ratio1 * spectrum1->re[i] + ratio * spectrum2->re[i];
+    spectrum->im[i] = ratio1 * spectrum1->im[i] + ratio * spectrum2->im[i];
   }
-  vocalTract->calculateAll();
-  updateTlModelGeometry(vocalTract);
-
-  VocalTractDialog *vocalTractDialog = VocalTractDialog::getInstance(NULL);
-  vocalTractDialog->Refresh();
-  vocalTractDialog->Update();
 
   return true;
 }
 
 
 // ****************************************************************************
-/// Run through all raw vocal tract shapes (which end with "-raw") and 
-/// calculate where the manually set point (TRX, TRY) projects on the horizontal
-/// line that will later be used for the automatic calculation of (TRX, TRY)
-/// similar to the approach in the Mermelstein vocal tract model.
-/// For each raw shape, three values are written in one row of the clipboard:
-/// The name of the shape, the hyoid-tongue distance, and the position of TRX 
-/// on the horizontal line that crosses the hyoid-tongue tangent.
-/// These data can then be copied into an Excel sheet, for example.
+/// Calculates the radiated noise spectra for dipole sources at all boundaries
+/// of the pharynx and mouth sections in one pass. Subsequent calls of 
+/// calcRadiatedNoiseSpectrum(...) with the same cutoff frequency and spectrum
+/// length are then only interpolations, as long as the geometry does not 
+/// change.
 // ****************************************************************************
 
-void Data::calcTongueRootData()
+void Data::calcRadiatedNoiseSweep(double noiseFilterCutoffFreq, int spectrumLength)
 {
-  const wxString NEW_LINE = "\r\n";
-  int i, k;
-  int numShapes = (int)vocalTract->shapes.size();
-  wxString name;
-  wxString clipboardString;
-  wxString st;
-  Point2D H, T, Q;
-  double hyoidTongueDistance_cm;
-
-  // This is the caption string.
-  clipboardString = "name hyoid-tongue-center-distance TRX TRY TCX TCY HX_cm HY_cm" + NEW_LINE;
+  int i;
 
-  for (i=0; i < numShapes; i++)
+  prepareNoiseSweep(noiseFilterCutoffFreq, spectrumLength);
+  for (i = 0; i <= Tube::NUM_PHARYNX_MOUTH_SECTIONS; i++)
   {
-    name = wxString( vocalTract->shapes[i].name );
-    if (name.Contains("-raw"))
-    {
+    getNoiseSweepSpectrum(i);
+  }
+}
 
-      // Set the parameters of this shape and re-calculate the VT.
-      for (k=0; k < VocalTract::NUM_PARAMS; k++)
-      {
-        vocalTract->param[k].x = vocalTract->shapes[i].param[k];
-      }
-      vocalTract->calculateAll();
 
-      vocalTract->getHyoidTongueTangent(H, T);    // To get H!
+// ****************************************************************************
+/// Exports the magnitude spectra of the radiated noise for dipole sources at
+/// all boundaries of the pharynx and mouth sections of the current vocal tract
+/// shape ("noise map").
+// ****************************************************************************
 
-      Point2D M(vocalTract->param[VocalTract::TCX].x, vocalTract->param[VocalTract::TCY].x);
-      hyoidTongueDistance_cm = (H - M).magnitude();
+bool Data::exportRadiatedNoiseMap(const wxString &fileName)
+{
+  const int SPECTRUM_LENGTH = 8192;
+  int i, k;
 
-      // Write name, hyoidTongueDistance_cm, etc. into the clipboard.
-      st = name + wxString::Format(" %2.2f %2.2f %2.2f %2.2f %2.2f %2.2f %2.2f", 
-        hyoidTongueDistance_cm, 
-        vocalTract->param[VocalTract::TRX].x,
-        vocalTract->param[VocalTract::TRY].x,
-        vocalTract->param[VocalTract::TCX].x,
-        vocalTract->param[VocalTract::TCY].x,
-        H.x, H.y) + NEW_LINE;
-      clipboardString+= st;
-    }
+  if (fileName.IsEmpty())
+  {
+    return false;
   }
 
-  // This data objects are held by the clipboard, 
-  // so do not delete them in the app.
+  ofstream os(fileName.ToStdString());
 
-  if (wxTheClipboard->Open())
+  if (!os)
   {
-    wxTheClipboard->SetData( new wxTextDataObject(clipboardString) );
-    wxTheClipboard->Close();
+    wxMessageBox(wxString("Could not open ") + fileName + wxString(" for writing."),
+      "Error!");
+    return false;
   }
-}
-
 
-// ****************************************************************************
-/// Optimize the parameters of the given vocal tract so that the formants
-/// match the given formant target values as well as possible.
-// ****************************************************************************
-
-void Data::optimizeFormantsVowel(wxWindow *updateParent, VocalTract *tract, 
-  double targetF1, double targetF2, double targetF3, 
-  double maxParamChange_cm, double minAdvisedArea_cm2, bool paramFixed[])
-{
-  const int MAX_RUNS = 100;
+  updateTlModelGeometry(vocalTract);
+  calcRadiatedNoiseSweep(noiseFilterCutoffFreq, SPECTRUM_LENGTH);
 
-  double F1, F2, F3;
-  double minArea_cm2;
-  double changeStep[VocalTract::NUM_PARAMS];
-  int stepsTaken[VocalTract::NUM_PARAMS];   // Cummulated steps gone by a parameter
-  double currParamValue;
-  double bestError;
-  double currError;
-  double newError;
-  double bestParamChange;
-  int bestParam;
-  int i;
-  char st[1024];
-  wxCommandEvent event(updateRequestEvent);
+  // Write the header.
 
-  VocalTractDialog *vocalTractDialog = VocalTractDialog::getInstance(NULL);
+  os << "# This file contains the magnitude spectra of the radiated sound pressure for a "
+    "dipole noise source at each of the " << Tube::NUM_PHARYNX_MOUTH_SECTIONS + 1 << " boundaries "
+    "of the pharynx and mouth tube sections. The noise source is shaped by a 2nd-order lowpass "
+    "filter with a cutoff frequency of " << noiseFilterCutoffFreq << " Hz. "
+    "Each line starts with the position of the source along the tube in cm, followed by "
+    << SPECTRUM_LENGTH / 2 << " magnitude samples that represent the frequencies from 0 to "
+    << SAMPLING_RATE / 2 << " Hz." << endl;
 
+  os << setprecision(5);
 
-  // ****************************************************************
-  // Make sure that all areas are above the given threshold.
-  // ****************************************************************
+  Tube::Section *ts = NULL;
+  ComplexSignal *spectrum = NULL;
+  double pos_cm;
 
-  getVowelFormants(tract, F1, F2, F3, minArea_cm2);
-  if (minArea_cm2 < minAdvisedArea_cm2)
+  for (i = 0; i <= Tube::NUM_PHARYNX_MOUTH_SECTIONS; i++)
   {
-    wxString st = wxString::Format(
-      "There are cross-sectional areas below the threshold of %2.2f cm^2.\n"
-      "Press OK to let it be corrected before the optimization.", 
-      minAdvisedArea_cm2);
-
-    if (wxMessageBox(st, "Areas to small", wxOK | wxCANCEL) == wxOK)
+    if (i < Tube::NUM_PHARYNX_MOUTH_SECTIONS)
     {
-      createMinVocalTractArea(updateParent, tract, minAdvisedArea_cm2);
+      pos_cm = tlModel->tube.pharynxMouthSection[i].pos_cm;
     }
     else
     {
-      return;
+      ts = &tlModel->tube.pharynxMouthSection[Tube::NUM_PHARYNX_MOUTH_SECTIONS - 1];
+      pos_cm = ts->pos_cm + ts->length_cm;
     }
+
+    spectrum = getNoiseSweepSpectrum(i);
+
+    os << pos_cm << " ";
+    for (k = 0; k < SPECTRUM_LENGTH / 2; k++)
+    {
+      os << spectrum->getMagnitude(k) << " ";
+    }
+    os << endl;
   }
 
-  double initialError = getFormantError(F1, F2, F3, targetF1, targetF2, targetF3);
-  wxPrintf("\n=== Before vowel optimization ===\n");
-  wxPrintf("F1:%d  F2:%d  F3:%d   F1':%d  F2':%d  F3':%d   error:%2.2f percent\n",
-    (int)F1, (int)F2, (int)F3, (int)targetF1, (int)targetF2, (int)targetF3, initialError);
+  os.close();
 
-  // ****************************************************************
-  // Define the steps by which the individual parameters are adjusted
-  // incrementally. A step value of 0.0 means that the parameters is
-  // not supposed to be adjusted at all.
-  // ****************************************************************
+  return true;
+}
 
-  // How many steps are maximally allowed per parameter in one direction ?
-  const double STEP_SIZE_CM = 0.05;   // = 1/2 mm
-  int maxSteps = (int)((maxParamChange_cm / STEP_SIZE_CM) + 0.5);
-  if (maxSteps < 1)
-  {
-    maxSteps = 1;
-  }
-  if (maxSteps > 20)
+
+// ****************************************************************************
+/// Discards the radiated noise spectra of the section boundaries when the 
+/// geometry, the TL model options, the cutoff frequency or the spectrum 
+/// length changed, and recalculates the noise shaping and radiation spectrum
+/// that is common to all boundaries.
+// ****************************************************************************
+
+void Data::prepareNoiseSweep(double noiseFilterCutoffFreq, int spectrumLength)
+{
+  int i;
+
+  if (tlCacheOptionsChanged())
   {
-    maxSteps = 20;    // Corresponds to 1.0 cm
+    invalidateTlModelSpectra();
   }
-  wxPrintf("The vocal tract shape may change by at most %1.1f mm.\n", maxSteps*STEP_SIZE_CM*10.0);
 
-  for (i=0; i < VocalTract::NUM_PARAMS; i++)
+  if ((noiseSweepGeneration == tlCacheGeneration) && 
+    (noiseSweepSpectrumLength == spectrumLength) &&
+    (noiseSweepCutoffFreq == noiseFilterCutoffFreq))
   {
-    changeStep[i] = 0.0;
-    stepsTaken[i] = 0;
+    return;
   }
 
-  changeStep[VocalTract::HX] = STEP_SIZE_CM / 1.5;
-  changeStep[VocalTract::HY] = STEP_SIZE_CM;
-  changeStep[VocalTract::JX] = STEP_SIZE_CM;
-  changeStep[VocalTract::JA] = 0.05;    // -5 .. 0 deg
-  changeStep[VocalTract::LP] = 0.05;    // -1 .. +1
-  changeStep[VocalTract::LD] = STEP_SIZE_CM;
-  changeStep[VocalTract::VS] = 1.0 / (0.5/STEP_SIZE_CM);   // 0 .. 1 corr. to diff. of 0.5 cm
+  noiseSweepGeneration = tlCacheGeneration;
+  noiseSweepSpectrumLength = spectrumLength;
+  noiseSweepCutoffFreq = noiseFilterCutoffFreq;
 
-  changeStep[VocalTract::TCX] = STEP_SIZE_CM;
-  changeStep[VocalTract::TCY] = STEP_SIZE_CM;
-  changeStep[VocalTract::TTX] = STEP_SIZE_CM;
-  changeStep[VocalTract::TTY] = STEP_SIZE_CM;
+  for (i = 0; i <= Tube::NUM_PHARYNX_MOUTH_SECTIONS; i++)
+  {
+    // A spectrum length of 0 marks a spectrum as not calculated.
+    noiseSweepSpectrum[i]->reset(0);
+  }
 
-  changeStep[VocalTract::TBX] = STEP_SIZE_CM;
-  changeStep[VocalTract::TBY] = STEP_SIZE_CM;
-  changeStep[VocalTract::TRX] = STEP_SIZE_CM;
-  changeStep[VocalTract::TRY] = STEP_SIZE_CM;
+  // Noise shaping filter times radiation characteristic.
 
-  changeStep[VocalTract::TS1] = 0.05;    // 0 .. +1
-  changeStep[VocalTract::TS2] = 0.05;    // 0 .. +1
-  changeStep[VocalTract::TS3] = 0.05;    // -1 .. +1
+  IirFilter filter;
+  double freq;
 
-  // Set the change step to zero for parameters that are supposed to be fixed.
+  const double Q = 1.0 / sqrt(2.0);
+  filter.createSecondOrderLowpass(noiseFilterCutoffFreq / (double)SAMPLING_RATE, Q);
 
-  for (i=0; i < VocalTract::NUM_PARAMS; i++)
+  getTlModelSpectrum(TlModel::RADIATION, noiseSweepShaping, spectrumLength, 0);
+  for (i = 0; i < spectrumLength; i++)
   {
-    if (paramFixed[i])
-    {
-      changeStep[i] = 0.0;
-    }
+    freq = (double)SAMPLING_RATE * i / spectrumLength;
+    noiseSweepShaping->setValue(i, noiseSweepShaping->getValue(i) * 
+      filter.getFrequencyResponse(freq / (double)SAMPLING_RATE));
   }
-  
-  // ****************************************************************
-  // Init. the progress dialog.
-  // ****************************************************************
+  (*noiseSweepShaping) *= 30000.0;           // Arbitrary scaling
+}
 
-  wxGenericProgressDialog progressDialog("Please wait", "The formant optimization is running...",
-    MAX_RUNS, NULL, wxPD_CAN_ABORT | wxPD_APP_MODAL | wxPD_AUTO_HIDE);
 
-  // ****************************************************************
-  // ****************************************************************
+// ****************************************************************************
+/// Returns the radiated noise spectrum for a source at the given boundary of
+/// the pharynx and mouth sections, and calculates it, if necessary.
+/// prepareNoiseSweep(...) must have been called before.
+// ****************************************************************************
 
-  bool paramChanged = false;
-  bool doContinue = false;
-  int runCounter = 0;
+ComplexSignal *Data::getNoiseSweepSpectrum(int boundary)
+{
+  ComplexSignal *spectrum = noiseSweepSpectrum[boundary];
 
-  do
+  if (spectrum->N != noiseSweepSpectrumLength)
   {
-    paramChanged = false;
-    getVowelFormants(tract, F1, F2, F3, minArea_cm2);
-    currError = getFormantError(F1, F2, F3, targetF1, targetF2, targetF3);
-
-    // **************************************************************
-    // Find out the improvement of the error when each parameter is 
-    // changed individually by a positive changeStep[i] starting 
-    // from the current configuration.
-    // **************************************************************
-    
-    bestError = currError;
-    bestParam = -1;
-    bestParamChange = 0.0;
-
-    for (i=0; i < VocalTract::NUM_PARAMS; i++)
+    // The section -1 means the end of the last mouth section.
+    int section = -1;
+    if (boundary < Tube::NUM_PHARYNX_MOUTH_SECTIONS)
     {
-      currParamValue = tract->param[i].x;
+      section = Tube::FIRST_PHARYNX_SECTION + boundary;
+    }
 
-      if (changeStep[i] > 0.0)
-      {
-        // Apply a POSITIVE change to parameter i.
-        
-        if (stepsTaken[i] < maxSteps)
-        {
-          tract->param[i].x = currParamValue + changeStep[i];
-          getVowelFormants(tract, F1, F2, F3, minArea_cm2);
-          
-          // Check that the minimum area stays above the threshold.
-          if (minArea_cm2 >= minAdvisedArea_cm2)
-          {
-            newError = getFormantError(F1, F2, F3, targetF1, targetF2, targetF3);
-            if (newError < bestError)
-            {
-              bestError = newError;
-              bestParam = i;
-              bestParamChange = changeStep[i];
-            }
-          }
-        }
+    tlModel->getSpectrum(TlModel::PRESSURE_SOURCE_TF, spectrum, noiseSweepSpectrumLength, section);
+    (*spectrum) *= (*noiseSweepShaping);
+  }
 
-        // Apply a NEGATIVE change to parameter i.
+  return spectrum;
+}
 
-        if (stepsTaken[i] > -maxSteps)
-        {
-          tract->param[i].x = currParamValue - changeStep[i];
-          getVowelFormants(tract, F1, F2, F3, minArea_cm2);
-          
-          // Check that the minimum area stays above the threshold.
-          if (minArea_cm2 >= minAdvisedArea_cm2)
-          {
-            newError = getFormantError(F1, F2, F3, targetF1, targetF2, targetF3);
-            if (newError < bestError)
-            {
-              bestError = newError;
-              bestParam = i;
-              bestParamChange = -changeStep[i];
-            }
-          }
-        }
 
-        // Set the parameter value back to its original value.
-        tract->param[i].x = currParamValue;
-      }
-    }
+// ****************************************************************************
+/// Calculates the EMA point coordinates of a range of frames. Each item is
+/// one frame, which is calculated with the vocal tract of the worker.
+// ****************************************************************************
 
-    // **************************************************************
-    // Change the parameter with the best error reduction.
-    // **************************************************************
+class EmaTrajectoryJob : public ParallelJob
+{
+public:
+  vector<VocalTract*> *tract;     // One vocal tract per worker
+  const vector<double> *frameParams;    // NUM_PARAMS values per frame
+  const vector<int> *pointIndices;
+  vector<double> *coord;
+  int numFrames;
 
-    sprintf(st, "no change");
+  virtual void processItem(int workerIndex, int itemIndex)
+  {
+    VocalTract *vt = (*tract)[workerIndex];
+    int numPoints = (int)pointIndices->size();
+    Point3D Q;
+    int i;
 
-    if ((bestParam != -1) && (bestError < currError))
+    for (i=0; i < VocalTract::NUM_PARAMS; i++)
     {
-      tract->param[bestParam].x+= bestParamChange;
-      if (bestParamChange > 0.0)
-      {
-        stepsTaken[bestParam]++;
-        sprintf(st, "%s up", tract->param[bestParam].name.c_str());
-      }
-      else
-      {
-        stepsTaken[bestParam]--;
-        sprintf(st, "%s down", tract->param[bestParam].name.c_str());
-      }
+      vt->param[i].x = (*frameParams)[itemIndex*VocalTract::NUM_PARAMS + i];
+    }
+    Data::getInstance()->calculateVocalTract(vt);
 
-      paramChanged = true;
+    // The coordinates are stored column by column.
+    for (i=0; i < numPoints; i++)
+    {
+      Q = vt->getEmaPointCoord((*pointIndices)[i]);
+      (*coord)[(2*i)*numFrames + itemIndex] = Q.x;
+      (*coord)[(2*i + 1)*numFrames + itemIndex] = Q.y;
     }
+  }
+};
 
-    printf("Run %d: %s. Error=%2.2f\n", runCounter, st, bestError);
 
-    // Update the pictures on the parent page.
+// ****************************************************************************
+/// Returns the indices of the EMA points of the vocal tract with the given
+/// (space-separated) names. An empty string selects all EMA points.
+/// Returns false, if a name is unknown.
+// ****************************************************************************
 
-    if (updateParent != NULL)
+bool Data::getEmaPointIndices(const wxString &pointNames, vector<int> &pointIndices)
+{
+  int i;
+  int numEmaPoints = (int)vocalTract->emaPoints.size();
+  wxString name;
+  wxString names = pointNames;
+
+  pointIndices.clear();
+
+  if (names.Trim().Trim(false).empty())
+  {
+    for (i=0; i < numEmaPoints; i++)
     {
-      // Calculate the vocal tract area function.
-      tract->calculateAll();
-      // Set the latest vocal tract geometry for the transmission line model.   
-      updateTlModelGeometry(tract);
+      pointIndices.push_back(i);
+    }
+    return true;
+  }
 
-      event.SetInt(UPDATE_PICTURES_AND_CONTROLS);
-      wxPostEvent(updateParent, event);
+  wxStringTokenizer tokenizer(names, " ");
+  while (tokenizer.HasMoreTokens())
+  {
+    name = tokenizer.GetNextToken();
+    if (name.empty())
+    {
+      continue;
+    }
 
-      if (vocalTractDialog->IsShown())
+    for (i=0; i < numEmaPoints; i++)
+    {
+      if (name == wxString(vocalTract->emaPoints[i].name))
       {
-        vocalTractDialog->Refresh();
-        vocalTractDialog->Update();
+        pointIndices.push_back(i);
+        break;
       }
+    }
 
-      wxYield();
+    if (i >= numEmaPoints)
+    {
+      wxPrintf("Error: There is no EMA point with the name %s.\n", name.c_str());
+      return false;
     }
+  }
 
-    doContinue = progressDialog.Update(runCounter);
+  return true;
+}
 
-    runCounter++;
 
-  } while ((paramChanged) && (doContinue) && (runCounter < MAX_RUNS));
+// ****************************************************************************
+/// Calculates the trajectories of the given EMA points from the given 
+/// gestural score at the given frame rate. The frames are distributed over
+/// a number of copies of the vocal tract created with createWorkerTracts(...),
+/// which can be passed in workerTracts (e.g., to reuse them for many scores).
+/// Otherwise, the copies are created here. The main vocal tract is not used.
+/// The coordinates (in cm) are returned column by column, i.e., the x- and
+/// y-coordinates of point i of all frames are at 
+/// coord[(2*i + 0|1)*numFrames + frame].
+// ****************************************************************************
 
-  // Hide the progress dialog.
-  progressDialog.Update(MAX_RUNS);
+bool Data::calcEmaTrajectories(GesturalScore *score, double frameRate_Hz, 
+  const vector<int> &pointIndices, vector<double> &coord, int &numFrames, 
+  vector<VocalTract*> *workerTracts)
+{
+  vector<VocalTract*> ownTracts;
+  vector<VocalTract*> *tracts = workerTracts;
+
+  if (frameRate_Hz <= 0.0)
+  {
+    return false;
+  }
 
   // ****************************************************************
-  // The velo-pharyngeal port must be closed.
+  // The vocal tract parameters of all frames are calculated here 
+  // in advance, because the gestural score is shared by all workers.
   // ****************************************************************
 
-  if (tract->param[VocalTract::VO].x > 0.0)
+  vector<double> frameParams;
+  numFrames = calcScoreFrameParams(score, frameRate_Hz, frameParams);
+  coord.assign(2 * pointIndices.size() * numFrames, 0.0);
+  if (numFrames < 1)
   {
-    tract->param[VocalTract::VO].x = 0.0;
+    return true;
   }
 
   // ****************************************************************
+  // Create the copies of the vocal tract for the workers.
   // ****************************************************************
 
-  getVowelFormants(tract, F1, F2, F3, minArea_cm2);
-  double finalError = getFormantError(F1, F2, F3, targetF1, targetF2, targetF3);
-  wxPrintf("=== After optimization ===\n");
-  wxPrintf("F1:%d  F2:%d  F3:%d   F1':%d  F2':%d  F3':%d   Error:%2.2f percent\n",
-    (int)F1, (int)F2, (int)F3, (int)targetF1, (int)targetF2, (int)targetF3, finalError);
-  wxPrintf("The error reduced from %2.2f to %2.2f percent.\n", initialError, finalError);
+  if (tracts == NULL)
+  {
+    if (createWorkerTracts(vocalTract, ParallelJob::getNumWorkers(numFrames), ownTracts) < 1)
+    {
+      return false;
+    }
+    tracts = &ownTracts;
+  }
+
+  // ****************************************************************
+  // Calculate the frames.
+  // ****************************************************************
+
+  EmaTrajectoryJob job;
+  job.tract = tracts;
+  job.frameParams = &frameParams;
+  job.pointIndices = &pointIndices;
+  job.coord = &coord;
+  job.numFrames = numFrames;
+  job.run(numFrames, (int)tracts->size());
+
+  deleteWorkerTracts(ownTracts);
+
+  return true;
 }
 
 
 // ****************************************************************************
-/// This function optimizes the formant frequencies right after the release of
-/// a stop consonant (at vowel onset). The formant error is calculated for a
-/// vocal tract shape between the given full consonantal shape and the context 
-/// vowel shape at the place where the minimal area is just the given
-/// minArea_cm2
+/// Writes EMA trajectories calculated with calcEmaTrajectories(...) to a 
+/// file. The text format has one line per frame with the time and the x- and
+/// y-coordinates of the points. The binary format has the following header
+/// (all numbers in little-endian byte order as on x86/ARM):
+///   char[8]  "VTLEMA1" terminated by 0
+///   int32    number of frames
+///   int32    number of columns (2 per EMA point)
+///   float32  frame rate in Hz
+///   column names as 0-terminated strings ("TT-x", "TT-y", ...)
+/// After the header follow the columns, each with one float32 coordinate 
+/// (in cm) per frame. The coordinates are only converted to float32 for the
+/// binary format.
 // ****************************************************************************
 
-void Data::optimizeFormantsConsonant(wxWindow *updateParent, VocalTract *tract, 
-  const wxString &contextVowel, double targetF1, double targetF2, double targetF3, 
-  double maxParamChange_cm, double minArea_cm2, double releaseArea_cm2, bool paramFixed[])
+bool Data::writeEmaTrajectories(const wxString &fileName, EmaFileFormat format, double frameRate_Hz,
+  const vector<int> &pointIndices, const vector<double> &coord, int numFrames)
 {
-  const int MAX_RUNS = 100;
-
-  double F1, F2, F3;
-  double changeStep[VocalTract::NUM_PARAMS];
-  int stepsTaken[VocalTract::NUM_PARAMS];   // Cummulated steps gone by a parameter
-  double currParamValue;
-  double bestError;
-  double currError;
-  double newError;
-  double bestParamChange;
-  int bestParam;
+  int numPoints = (int)pointIndices.size();
   int i, k;
-  char st[1024];
-  wxCommandEvent event(updateRequestEvent);
+  VocalTract::EmaPoint *p;
 
-  VocalTractDialog *vocalTractDialog = VocalTractDialog::getInstance(NULL);
+  ofstream os;
+  if (format == EMA_FILE_BINARY)
+  {
+    os.open(fileName.ToStdString(), ios::binary);
+  }
+  else
+  {
+    os.open(fileName.ToStdString());
+  }
 
+  if (!os)
+  {
+    wxPrintf("Error: Could not open %s for writing.\n", fileName.c_str());
+    return false;
+  }
 
-  // ****************************************************************
-  // Find the start and end positions of the constricted region,
-  // where the area is allowed to be smaller than minArea_cm2.
-  // ****************************************************************
+  if (format == EMA_FILE_BINARY)
+  {
+    const char MAGIC[8] = "VTLEMA1";
+    int numColumns = 2*numPoints;
+    float rate = (float)frameRate_Hz;
 
-  double constrictionStartPos_cm = 0.0;
-  double constrictionEndPos_cm = 0.0;
-  
-  k = 0;   // Index of the cross-section with the smallest area
-  for (i=1; i < VocalTract::NUM_CENTERLINE_POINTS; i++)
-  {
-    if (tract->crossSection[i].area < tract->crossSection[k].area)
-    {
-      k = i;
-    }    
-  }
-
-  // Find the region that is close to the minimum area within an epsilon range.
-  
-  const double POS_MARGIN_CM = 1.5;
-  const double DELTA_AREA_CM2 = 0.1;   // = 10 mm2
-  double constrictionArea_cm2 = tract->crossSection[k].area;
+    os.write(MAGIC, 8);
+    os.write((char*)&numFrames, sizeof(int));
+    os.write((char*)&numColumns, sizeof(int));
+    os.write((char*)&rate, sizeof(float));
 
-  i = k;
-  while ((i > 0) && (tract->crossSection[i].area < constrictionArea_cm2 + DELTA_AREA_CM2))
-  {
-    i--;
-  }
-  constrictionStartPos_cm = tract->crossSection[i].pos - POS_MARGIN_CM;
+    for (i=0; i < numPoints; i++)
+    {
+      p = &vocalTract->emaPoints[pointIndices[i]];
+      os << p->name << "-x" << '\0' << p->name << "-y" << '\0';
+    }
 
-  i = k;
-  while ((i < VocalTract::NUM_CENTERLINE_POINTS-1) && (tract->crossSection[i].area < constrictionArea_cm2 + DELTA_AREA_CM2))
-  {
-    i++;
+    if ((numFrames > 0) && (numColumns > 0))
+    {
+      vector<float> floatCoord(coord.begin(), coord.begin() + numColumns * numFrames);
+      os.write((char*)&floatCoord[0], sizeof(float) * numColumns * numFrames);
+    }
   }
-  constrictionEndPos_cm = tract->crossSection[i].pos + POS_MARGIN_CM;
-
-  // ****************************************************************
-  // Make sure that all areas left and right of the constriction are 
-  // above the given threshold.
-  // ****************************************************************
-
-  double minAreaOutsideConstriction_cm2 = getMinAreaOutsideConstriction_cm2(tract, constrictionStartPos_cm, constrictionEndPos_cm);
-  if (minAreaOutsideConstriction_cm2 < minArea_cm2)
+  else
   {
-    wxString st = wxString::Format(
-      "There are cross-sectional areas left and right of the constriction\n"
-      "(between %2.1f and %2.1f cm) below the threshold of %2.2f cm^2.\n"
-      "Press OK to let it be corrected before the optimization.", 
-      constrictionStartPos_cm, constrictionEndPos_cm, minArea_cm2);
-
-    if (wxMessageBox(st, "Areas to small", wxOK | wxCANCEL) == wxOK)
+    os << "time[s] ";
+    for (i=0; i < numPoints; i++)
     {
-      createMinVocalTractArea(updateParent, tract, minArea_cm2, constrictionStartPos_cm, constrictionEndPos_cm);
+      p = &vocalTract->emaPoints[pointIndices[i]];
+      os << p->name << "-x[cm] " << p->name << "-y[cm] ";
     }
-    else
+    os << endl;
+
+    os << setprecision(8);
+
+    for (k=0; k < numFrames; k++)
     {
-      return;
+      os << (double)k / frameRate_Hz << " ";
+      for (i=0; i < numPoints; i++)
+      {
+        os << coord[(2*i)*numFrames + k] << " " << coord[(2*i + 1)*numFrames + k] << " ";
+      }
+      os << "\n";
     }
   }
 
+  bool ok = os.good();
+  os.close();
 
-  // ****************************************************************
-  // The velo-pharyngeal port must be closed.
-  // ****************************************************************
-
-  if (tract->param[VocalTract::VO].x > 0.0)
-  {
-    tract->param[VocalTract::VO].x = 0.0;
-  }
-
-  // ****************************************************************
-  // Get the initial error.
-  // ****************************************************************
+  return ok;
+}
 
-  getConsonantFormants(tract, contextVowel, releaseArea_cm2, F1, F2, F3);
-  double initialError = getFormantError(F1, F2, F3, targetF1, targetF2, targetF3);
 
-  wxPrintf("\n=== Before consonant formant optimization ===\n");
-  wxPrintf("F1:%d  F2:%d  F3:%d   F1':%d  F2':%d  F3':%d   error:%2.2f percent\n",
-    (int)F1, (int)F2, (int)F3, (int)targetF1, (int)targetF2, (int)targetF3, initialError);
+// ****************************************************************************
+/// Exports the virtual EMA trajectories calculated from the current gestural
+/// score at the given frame rate. pointNames selects the EMA points (see
+/// getEmaPointIndices(...)).
+// ****************************************************************************
 
-  // ****************************************************************
-  // Define the steps by which the individual parameters are adjusted
-  // incrementally. A step value of 0.0 means that the parameters is
-  // not supposed to be adjusted at all.
-  // ****************************************************************
+bool Data::exportEmaTrajectories(const wxString &fileName, EmaFileFormat format,
+  double frameRate_Hz, const wxString &pointNames)
+{
+  vector<int> pointIndices;
+  vector<double> coord;
+  int numFrames = 0;
 
-  // How many steps are maximally allowed per parameter in one direction ?
-  const double STEP_SIZE_CM = 0.05;   // = 1/2 mm
-  int maxSteps = (int)((maxParamChange_cm / STEP_SIZE_CM) + 0.5);
-  if (maxSteps < 1)
+  if (getEmaPointIndices(pointNames, pointIndices) == false)
   {
-    maxSteps = 1;
+    wxMessageBox("Unknown EMA point name in " + pointNames + ".", "Error!");
+    return false;
   }
-  if (maxSteps > 10)
+
+  wxStopWatch stopWatch;
+
+  if (calcEmaTrajectories(gesturalScore, frameRate_Hz, pointIndices, coord, numFrames) == false)
   {
-    maxSteps = 10;
+    wxMessageBox("Invalid frame rate for the EMA trajectories.", "Error!");
+    return false;
   }
-  wxPrintf("The vocal tract shape may change by at most %1.1f mm.\n", maxSteps*STEP_SIZE_CM*10.0);
 
-  for (i=0; i < VocalTract::NUM_PARAMS; i++)
+  if (writeEmaTrajectories(fileName, format, frameRate_Hz, pointIndices, coord, numFrames) == false)
   {
-    changeStep[i] = 0.0;
-    stepsTaken[i] = 0;
+    wxMessageBox(wxString("Could not write ") + fileName + wxString("."), "Error!");
+    return false;
   }
 
-  changeStep[VocalTract::HX] = STEP_SIZE_CM / 1.5;
-  changeStep[VocalTract::HY] = STEP_SIZE_CM;
-  changeStep[VocalTract::JX] = STEP_SIZE_CM;
-  changeStep[VocalTract::JA] = 0.05;    // -5 .. 0 deg
-  changeStep[VocalTract::LP] = 0.05;    // -1 .. +1
-  changeStep[VocalTract::LD] = STEP_SIZE_CM;
-  changeStep[VocalTract::VS] = 1.0 / (0.5/STEP_SIZE_CM);   // 0 .. 1 corr. to diff. of 0.5 cm
+  wxPrintf("Exported %d EMA frames of %d points in %d ms.\n", 
+    numFrames, (int)pointIndices.size(), (int)stopWatch.Time());
 
-  changeStep[VocalTract::TCX] = STEP_SIZE_CM;
-  changeStep[VocalTract::TCY] = STEP_SIZE_CM;
-  changeStep[VocalTract::TTX] = STEP_SIZE_CM;
-  changeStep[VocalTract::TTY] = STEP_SIZE_CM;
+  return true;
+}
 
-  changeStep[VocalTract::TBX] = STEP_SIZE_CM;
-  changeStep[VocalTract::TBY] = STEP_SIZE_CM;
-  changeStep[VocalTract::TRX] = STEP_SIZE_CM;
-  changeStep[VocalTract::TRY] = STEP_SIZE_CM;
 
-  changeStep[VocalTract::TS1] = 0.05;    // -1 .. +1
-  changeStep[VocalTract::TS2] = 0.05;    // -1 .. +1
-  changeStep[VocalTract::TS3] = 0.05;    // -1 .. +1
+// ****************************************************************************
+/// Exports the EMA trajectories of all gestural scores (*.ges) in the given
+/// folder. The trajectories of each score are written next to it with the
+/// extension .txt or .ema (binary format). The copies of the vocal tract for
+/// the worker threads are created once for all scores.
+/// Returns the number of exported files.
+// ****************************************************************************
 
-  // Set the change step to zero for parameters that are supposed to be fixed.
+int Data::exportEmaTrajectoriesBatch(const wxString &folderName, EmaFileFormat format,
+  double frameRate_Hz, const wxString &pointNames)
+{
+  wxArrayString fileNames;
+  vector<int> pointIndices;
+  vector<double> coord;
+  vector<VocalTract*> workerTracts;
+  int numFrames;
+  int numFiles;
+  int numExported = 0;
+  int i;
+  bool allValuesInRange;
 
-  for (i=0; i < VocalTract::NUM_PARAMS; i++)
+  if (getEmaPointIndices(pointNames, pointIndices) == false)
   {
-    if (paramFixed[i])
-    {
-      changeStep[i] = 0.0;
-    }
+    wxMessageBox("Unknown EMA point name in " + pointNames + ".", "Error!");
+    return 0;
+  }
+
+  wxDir::GetAllFiles(folderName, &fileNames, "*.ges", wxDIR_FILES);
+  fileNames.Sort();
+  numFiles = (int)fileNames.GetCount();
+  if (numFiles < 1)
+  {
+    wxMessageBox("There are no gestural scores (*.ges) in " + folderName + ".", "Error!");
+    return 0;
   }
-  
 
   // ****************************************************************
-  // Init. the progress dialog.
+  // Create the copies of the vocal tract for the workers.
   // ****************************************************************
 
-  wxGenericProgressDialog progressDialog("Please wait", "The formant optimization is running...",
-    MAX_RUNS, NULL, wxPD_CAN_ABORT | wxPD_APP_MODAL | wxPD_AUTO_HIDE);
+  if (createWorkerTracts(vocalTract, ParallelJob::getMaxNumWorkers(), workerTracts) < 1)
+  {
+    wxMessageBox("Failed to copy the vocal tract model.", "Error!");
+    return 0;
+  }
 
   // ****************************************************************
+  // Export the trajectories of one score after the other.
   // ****************************************************************
 
-  bool paramChanged = false;
-  bool doContinue = false;
-  int runCounter = 0;
-
-  do
-  {
-    paramChanged = false;
-    getConsonantFormants(tract, contextVowel, releaseArea_cm2, F1, F2, F3);
-    currError = getFormantError(F1, F2, F3, targetF1, targetF2, targetF3);
+  GesturalScore *score = new GesturalScore(vocalTract, getSelectedGlottis());
+  wxString outputFileName;
+  wxStopWatch stopWatch;
+  long totalNumFrames = 0;
 
-    // **************************************************************
-    // Find out the improvement of the error when each parameter is 
-    // changed individually by a positive changeStep[i] starting 
-    // from the current configuration.
-    // **************************************************************
-    
-    bestError = currError;
-    bestParam = -1;
-    bestParamChange = 0.0;
+  wxGenericProgressDialog progressDialog("Please wait", "The EMA trajectories are exported...",
+    numFiles, NULL, wxPD_CAN_ABORT | wxPD_APP_MODAL | wxPD_AUTO_HIDE);
 
-    for (i=0; (i < VocalTract::NUM_PARAMS) && (progressDialog.Update(runCounter)); i++)
+  for (i=0; i < numFiles; i++)
+  {
+    allValuesInRange = true;
+    if (score->loadGesturesXml(fileNames[i].ToStdString(), allValuesInRange) == false)
     {
-      currParamValue = tract->param[i].x;
-
-      if (changeStep[i] > 0.0)
-      {
-        // Apply a POSITIVE change to parameter i.
-        
-        if (stepsTaken[i] < maxSteps)
-        {
-          tract->param[i].x = currParamValue + changeStep[i];
-
-          // Do nothing when the VO parameter is changed above the threshold (velum open).
-          if ((i == VocalTract::VO) && (tract->param[i].x > 0.0))
-          {
-            // do nothing.
-          }
-          else
-          {
-            if ((getMinAreaOutsideConstriction_cm2(tract, constrictionStartPos_cm, constrictionEndPos_cm) >= minArea_cm2) &&
-                (getConsonantFormants(tract, contextVowel, releaseArea_cm2, F1, F2, F3)))
-            {
-              newError = getFormantError(F1, F2, F3, targetF1, targetF2, targetF3);
-              if (newError < bestError)
-              {
-                bestError = newError;
-                bestParam = i;
-                bestParamChange = changeStep[i];
-              }
-            }
-          }
-
-        }
-
-        // Apply a NEGATIVE change to parameter i.
-
-        if (stepsTaken[i] > -maxSteps)
-        {
-          tract->param[i].x = currParamValue - changeStep[i];
-          if ((getMinAreaOutsideConstriction_cm2(tract, constrictionStartPos_cm, constrictionEndPos_cm) >= minArea_cm2) &&
-              (getConsonantFormants(tract, contextVowel, releaseArea_cm2, F1, F2, F3)))
-          {
-            newError = getFormantError(F1, F2, F3, targetF1, targetF2, targetF3);
-            if (newError < bestError)
-            {
-              bestError = newError;
-              bestParam = i;
-              bestParamChange = -changeStep[i];
-            }
-          }
-        }
-
-        // Set the parameter value back to its original value.
-        tract->param[i].x = currParamValue;
-
-        // Some progress displaying...
-        wxPrintf(".");
-      }
+      wxPrintf("Error: Loading the gestural score %s failed.\n", fileNames[i].c_str());
     }
-    wxPrintf("\n");   // A line break after all the points.
-
-    // **************************************************************
-    // Change the parameter with the best error reduction.
-    // **************************************************************
+    else
+    {
+      score->calcCurves();
 
-    sprintf(st, "no change");
+      wxFileName fileName(fileNames[i]);
+      fileName.SetExt(format == EMA_FILE_BINARY ? "ema" : "txt");
+      outputFileName = fileName.GetFullPath();
 
-    if ((bestParam != -1) && (bestError < currError))
-    {
-      tract->param[bestParam].x+= bestParamChange;
-      if (bestParamChange > 0.0)
+      if ((calcEmaTrajectories(score, frameRate_Hz, pointIndices, coord, numFrames, &workerTracts)) &&
+        (writeEmaTrajectories(outputFileName, format, frameRate_Hz, pointIndices, coord, numFrames)))
       {
-        stepsTaken[bestParam]++;
-        sprintf(st, "%s up", tract->param[bestParam].name.c_str());
+        numExported++;
+        totalNumFrames+= numFrames;
       }
       else
       {
-        stepsTaken[bestParam]--;
-        sprintf(st, "%s down", tract->param[bestParam].name.c_str());
+        wxPrintf("Error: Exporting the EMA trajectories to %s failed.\n", outputFileName.c_str());
       }
-
-      paramChanged = true;
     }
 
-    getConsonantFormants(tract, contextVowel, releaseArea_cm2, F1, F2, F3);
-    wxPrintf("Run %d: %s. Formants: %d, %d, %d  Error=%2.2f\n",
-      runCounter + 1, st, (int)F1, (int)F2, (int)F3, bestError);
-
-    // Update the pictures on the parent page.
-
-    if (updateParent != NULL)
+    if (progressDialog.Update(i + 1) == false)
     {
-      // Calculate the vocal tract area function.
-      tract->calculateAll();
-      // Set the latest vocal tract geometry for the transmission line model.   
-      updateTlModelGeometry(tract);
-
-      event.SetInt(UPDATE_PICTURES_AND_CONTROLS);
-      wxPostEvent(updateParent, event);
-
-      if (vocalTractDialog->IsShown())
-      {
-        vocalTractDialog->Refresh();
-        vocalTractDialog->Update();
-      }
-
-      wxYield();
+      break;
     }
-
-    doContinue = progressDialog.Update(runCounter);
-
-    runCounter++;
-
-  } while ((paramChanged) && (doContinue) && (runCounter < MAX_RUNS));
+  }
 
   // Hide the progress dialog.
-  progressDialog.Update(MAX_RUNS);
+  progressDialog.Update(numFiles);
 
-  wxPrintf("\n");
-
-  // ****************************************************************
-  // ****************************************************************
+  delete score;
 
-  getConsonantFormants(tract, contextVowel, releaseArea_cm2, F1, F2, F3);
-  double finalError = getFormantError(F1, F2, F3, targetF1, targetF2, targetF3);
+  wxPrintf("Exported the EMA trajectories of %d of %d gestural scores (%ld frames) "
+    "in %2.1f s with %d worker threads.\n", numExported, numFiles, totalNumFrames, 
+    stopWatch.Time() / 1000.0, (int)workerTracts.size());
 
-  wxPrintf("=== After consonant formant optimization ===\n");
-  wxPrintf("F1:%d  F2:%d  F3:%d   F1':%d  F2':%d  F3':%d   Error:%2.2f percent\n",
-    (int)F1, (int)F2, (int)F3, (int)targetF1, (int)targetF2, (int)targetF3, finalError);
-  wxPrintf("The error reduced from %2.2f to %2.2f percent.\n", initialError, finalError);
+  deleteWorkerTracts(workerTracts);
 
+  return numExported;
 }
 
 
 // ****************************************************************************
-/// Finds the vocal tract shape on the linear transition from the given 
-/// consonant shape to the given vowel shape where the minimal cross-sectional
-/// area is just the given releaseArea_cm2.
-/// The position on the transition (between 0.0 and 1.0) is returned in
-/// releasePos, and the resulting shape parameters in releaseParams.
+/// Calculates the vocal tract geometry for a batch of video frames. The item
+/// i of the job is the frame firstFrame + i, which is calculated with the
+/// vocal tract tract[i].
 // ****************************************************************************
 
-bool Data::getReleaseShape(VocalTract *vt, double *consonantParams, double *vowelParams,
-  double *releaseParams, double &releasePos, double releaseArea_cm2)
+class VideoFrameGeometryJob : public ParallelJob
 {
-  int i;
-  double minAreaVowel_cm2 = 0.0;
-  double minAreaConsonant_cm2 = 0.0;
-  // Start and end pos. of the min. area search region.
-  double startPos_cm = 0.0;   
-  double endPos_cm = 1000.0;
+public:
+  vector<double> *frameParams;    // NUM_PARAMS values per frame
+  VocalTract **tract;
+  int firstFrame;
 
-  // ****************************************************************
-  // Keep in mind the original VT parameters.
-  // ****************************************************************
+  virtual void processItem(int workerIndex, int itemIndex)
+  {
+    VocalTract *vt = tract[itemIndex];
+    int i;
 
-  double origParams[VocalTract::NUM_PARAMS];
-  for (i=0; i < VocalTract::NUM_PARAMS; i++)
+    for (i=0; i < VocalTract::NUM_PARAMS; i++)
+    {
+      vt->param[i].x = (*frameParams)[(firstFrame + itemIndex)*VocalTract::NUM_PARAMS + i];
+    }
+    Data::getInstance()->calculateVocalTract(vt);
+  }
+};
+
+
+// ****************************************************************************
+/// Runs a VideoFrameGeometryJob in the background.
+// ****************************************************************************
+
+class VideoFrameGeometryThread : public wxThread
+{
+public:
+  VideoFrameGeometryThread(VideoFrameGeometryJob *job, int numItems, int numWorkers) : 
+    wxThread(wxTHREAD_JOINABLE)
   {
-    origParams[i] = vt->param[i].x;
+    this->job = job;
+    this->numItems = numItems;
+    this->numWorkers = numWorkers;
   }
 
-  // ****************************************************************
-  // Check the initial min. area of the vowel.
-  // ****************************************************************
+  virtual void *Entry()
+  {
+    job->run(numItems, numWorkers);
+    return NULL;
+  }
 
-  for (i=0; i < VocalTract::NUM_PARAMS; i++)
+private:
+  VideoFrameGeometryJob *job;
+  int numItems;
+  int numWorkers;
+};
+
+
+// ****************************************************************************
+/// Exports video frames of the vocal tract from a gestural score at the given
+/// frame rate. For the image formats, name is the folder for the numbered
+/// images, and for VIDEO_FRAMES_Y4M, it is the file name of the stream (which
+/// may also be a named pipe, e.g., to feed a video encoder).
+/// The geometry of the frames is calculated in batches on copies of the 
+/// vocal tract by worker threads, while the frames of the previous batch are
+/// rendered into a framebuffer object of the frame size in the GL context 
+/// of the vocal tract picture. A frame width and height of 0 means the size
+/// of the picture.
+// ****************************************************************************
+
+bool Data::exportVocalTractVideoFrames(const wxString &name, VideoFrameFormat format,
+  int frameRate, int frameWidth, int frameHeight)
+{
+  double duration_s = gesturalScore->getDuration_pt() / (double)SAMPLING_RATE;
+  int numFrames;
+  int i, k;
+  int frameIndex;
+  double time_s;
+  double vocalTractParams[VocalTract::NUM_PARAMS];
+  double glottisParams[256];
+
+  if (frameRate < 1)
+  {
+    frameRate = 1;
+  }
+  numFrames = (int)(duration_s*frameRate);
+  if (numFrames < 1)
   {
-    vt->param[i].x = vowelParams[i];
+    wxMessageBox("The gestural score is empty.", "Error!");
+    return false;
   }
-  minAreaVowel_cm2 = getMinArea_cm2(vt, 0.0, 1000.0);
 
   // ****************************************************************
-  // Check the initial min. area of the consonant.
+  // The vocal tract picture must be shown, so that its GL context
+  // has a drawable. The frames are rendered off the screen and 
+  // without going through the event loop.
   // ****************************************************************
 
-  for (i=0; i < VocalTract::NUM_PARAMS; i++)
+  VocalTractDialog *vocalTractDialog = VocalTractDialog::getInstance(NULL);
+  if (vocalTractDialog->IsShownOnScreen() == false)
   {
-    vt->param[i].x = consonantParams[i];
+    vocalTractDialog->Show(true);
   }
-  minAreaConsonant_cm2 = getMinArea_cm2(vt, 0.0, 1000.0);
+  vocalTractDialog->Refresh();
+  vocalTractDialog->Update();
+  wxYield();
 
-  // Get the start and end point of the region along the center line
-  // around this minimum.
+  VocalTractPicture *picture = vocalTractDialog->getVocalTractPicture();
 
-  const double AREA_EPSILON_CM2 = 0.01;   // = 1 mm^2
-  const double POS_MARGIN_CM = 2.0;
-  i = 0;
-  while ((i < VocalTract::NUM_CENTERLINE_POINTS) && 
-         (vt->crossSection[i].area > minAreaConsonant_cm2 + AREA_EPSILON_CM2))
+  // ****************************************************************
+  // Open the output stream.
+  // ****************************************************************
+
+  wxString folderName = name;
+  wxChar pathSeparator = wxFileName::GetPathSeparator();
+  if (folderName.EndsWith( &pathSeparator ) == false)
   {
-    i++;
+    folderName+= pathSeparator;
   }
-  if (i < VocalTract::NUM_CENTERLINE_POINTS)
+
+  ofstream os;
+  if (format == VIDEO_FRAMES_Y4M)
   {
-    startPos_cm = vt->crossSection[i].pos - POS_MARGIN_CM;
+    os.open(name.ToStdString(), ios::binary);
+    if (!os)
+    {
+      wxMessageBox(wxString("Could not open ") + name + wxString(" for writing."),
+        wxString("Error!"));
+      return false;
+    }
   }
-  else
+
+  // ****************************************************************
+  // Get the vocal tract parameters of all frames.
+  // ****************************************************************
+
+  vector<double> frameParams(numFrames*VocalTract::NUM_PARAMS);
+
+  for (frameIndex=0; frameIndex < numFrames; frameIndex++)
   {
-    startPos_cm = 0.0;
+    time_s = (double)frameIndex / (double)frameRate;
+    gesturalScore->getParams(time_s, vocalTractParams, glottisParams);
+
+    for (i=0; i < VocalTract::NUM_PARAMS; i++)
+    {
+      frameParams[frameIndex*VocalTract::NUM_PARAMS + i] = vocalTractParams[i];
+    }
   }
 
+  // ****************************************************************
+  // Two sets of vocal tract copies: One set is rendered while the
+  // geometry of the next batch is calculated with the other set.
+  // Without enough copies, the geometry of the frames is calculated
+  // with a single copy one after the other.
   // ****************************************************************
 
-  i = VocalTract::NUM_CENTERLINE_POINTS - 1;
-  while ((i >= 0) && (vt->crossSection[i].area > minAreaConsonant_cm2 + AREA_EPSILON_CM2))
+  int batchSize = ParallelJob::getNumWorkers(numFrames);
+  vector<VocalTract*> ownTracts;
+  vector<VocalTract*> frameTract;
+  bool isPipelined = true;
+
+  if (createWorkerTracts(vocalTract, 2*batchSize, ownTracts) < 1)
   {
-    i--;
+    wxMessageBox("Failed to copy the vocal tract model.", "Error!");
+    return false;
   }
-  if (i >= 0)
+
+  if ((int)ownTracts.size() < 2*batchSize)
   {
-    endPos_cm = vt->crossSection[i].pos + POS_MARGIN_CM;
+    while (ownTracts.size() > 1)
+    {
+      delete ownTracts.back();
+      ownTracts.pop_back();
+    }
+    batchSize = 1;
+    isPipelined = false;
   }
-  else
+
+  for (i=0; i < 2*batchSize; i++)
   {
-    endPos_cm = 1000.0;
+    frameTract.push_back(ownTracts[i % ownTracts.size()]);
   }
 
-  // The min. vowel area must be greater than the release area, and
-  // the min. consonant area must be less.
+  double oldVocalTractParams[VocalTract::NUM_PARAMS];
+  for (i=0; i < VocalTract::NUM_PARAMS; i++)
+  {
+    oldVocalTractParams[i] = vocalTract->param[i].x;
+  }
 
-  if ((minAreaConsonant_cm2 >= releaseArea_cm2) || (minAreaVowel_cm2 <= releaseArea_cm2))
+  VideoFrameGeometryJob job[2];
+  for (k=0; k < 2; k++)
   {
-    // Set back the original parameter values.
-    for (i=0; i < VocalTract::NUM_PARAMS; i++)
-    {
-      vt->param[i].x = origParams[i];
-    }
-    vt->calculateAll();
-    return false;
+    job[k].frameParams = &frameParams;
+    job[k].tract = &frameTract[k*batchSize];
+    job[k].firstFrame = 0;
   }
 
   // ****************************************************************
-  // Find the transition position where the minimum area is the
-  // given release are using the bisection method.
+  // Calculate the first batch and then render each batch while the
+  // next one is calculated.
   // ****************************************************************
 
-  const double AREA_TOLERANCE_CM2 = 0.001;    // = 0.1 mm^2
-  const int MAX_RUNS = 40;
-  int run = 0;
-  double intervalBegin = 0.0;
-  double intervalEnd = 1.0;
-  double intervalMidpoint = 0.5;
-  double minAreaIntervalBegin = minAreaConsonant_cm2;
-  double minAreaIntervalEnd = minAreaVowel_cm2;
-  double minAreaIntervalMidpoint = 0.0;
+  int numBatches = (numFrames + batchSize - 1) / batchSize;
+  int batchIndex;
+  int numBatchFrames;
+  int numExportedFrames = 0;
+  bool doContinue = true;
+  bool ok = true;
+  wxImage image;
+  wxStopWatch stopWatch;
 
-  bool solutionFound = false;
+  wxGenericProgressDialog progressDialog("Please wait", "The video frames are exported...",
+    numBatches, NULL, wxPD_CAN_ABORT | wxPD_APP_MODAL | wxPD_AUTO_HIDE);
 
-  while ((run < MAX_RUNS) && (solutionFound == false))
+  job[0].run(min(batchSize, numFrames), batchSize);
+
+  for (batchIndex=0; (batchIndex < numBatches) && (doContinue) && (ok); batchIndex++)
   {
-    intervalMidpoint = 0.5*(intervalBegin + intervalEnd);
+    VideoFrameGeometryJob *currJob = &job[batchIndex % 2];
+    VideoFrameGeometryJob *nextJob = &job[(batchIndex + 1) % 2];
+    VideoFrameGeometryThread *thread = NULL;
+    int numNextBatchFrames = 0;
 
-    // Find the min. area at the interval midpoint in the region
-    // between startPos_cm and endPos_cm in the area function.
-    
-    for (i=0; i < VocalTract::NUM_PARAMS; i++)
+    numBatchFrames = min(batchSize, numFrames - currJob->firstFrame);
+
+    if (batchIndex < numBatches - 1)
     {
-      vt->param[i].x = (1.0-intervalMidpoint)*consonantParams[i] + intervalMidpoint*vowelParams[i];
+      nextJob->firstFrame = currJob->firstFrame + batchSize;
+      numNextBatchFrames = min(batchSize, numFrames - nextJob->firstFrame);
+
+      if (isPipelined)
+      {
+        thread = new VideoFrameGeometryThread(nextJob, numNextBatchFrames, batchSize);
+        if (thread->Run() != wxTHREAD_NO_ERROR)
+        {
+          delete thread;
+          thread = NULL;
+        }
+      }
     }
-    minAreaIntervalMidpoint = getMinArea_cm2(vt, startPos_cm, endPos_cm);
 
-    if (fabs(minAreaIntervalMidpoint - releaseArea_cm2) < AREA_TOLERANCE_CM2)
+    // **************************************************************
+    // Render and write the frames of the current batch.
+    // **************************************************************
+
+    for (k=0; (k < numBatchFrames) && (ok); k++)
     {
-      solutionFound = true;
+      frameIndex = currJob->firstFrame + k;
+
+      picture->setVocalTract(currJob->tract[k]);
+      image = picture->renderImage(frameWidth, frameHeight);
+      if (image.IsOk() == false)
+      {
+        ok = false;
+        break;
+      }
+
+      if (format == VIDEO_FRAMES_Y4M)
+      {
+        int width = image.GetWidth();
+        int height = image.GetHeight();
+        int numPixels = width*height;
+        unsigned char *rgb = image.GetData();
+        vector<unsigned char> plane(3*numPixels);
+        double r, g, b;
+
+        // All frames of the stream have the size of the first one.
+        if (frameIndex == 0)
+        {
+          os << "YUV4MPEG2 W" << width << " H" << height << " F" << frameRate 
+            << ":1 Ip A1:1 C444" << "\n";
+          frameWidth = width;
+          frameHeight = height;
+        }
+
+        // Y'CbCr (ITU-R BT.601, studio range) without chroma subsampling.
+        for (i=0; i < numPixels; i++)
+        {
+          r = rgb[3*i];
+          g = rgb[3*i + 1];
+          b = rgb[3*i + 2];
+          plane[i]               = (unsigned char)(16.0 + 0.257*r + 0.504*g + 0.098*b + 0.5);
+          plane[numPixels + i]   = (unsigned char)(128.0 - 0.148*r - 0.291*g + 0.439*b + 0.5);
+          plane[2*numPixels + i] = (unsigned char)(128.0 + 0.439*r - 0.368*g - 0.071*b + 0.5);
+        }
+
+        os << "FRAME\n";
+        os.write((char*)&plane[0], 3*numPixels);
+        if (!os)
+        {
+          ok = false;
+        }
+      }
+      else
+      {
+        wxString frameFileName = folderName + "vt" + wxString::Format("%05d", frameIndex);
+        if (format == VIDEO_FRAMES_PNG)
+        {
+          ok = image.SaveFile(frameFileName + ".png", wxBITMAP_TYPE_PNG);
+        }
+        else
+        {
+          ok = image.SaveFile(frameFileName + ".bmp", wxBITMAP_TYPE_BMP);
+        }
+      }
+
+      if (ok)
+      {
+        numExportedFrames++;
+      }
     }
 
-    // Change either the beginning or the end of the interval.
+    // The picture must show the main vocal tract again before any
+    // event is processed.
+    picture->setVocalTract(vocalTract);
 
-    if (minAreaIntervalMidpoint < releaseArea_cm2)
+    // **************************************************************
+    // Wait for the geometry of the next batch.
+    // **************************************************************
+
+    if (thread != NULL)
     {
-      intervalBegin = intervalMidpoint;
-      minAreaIntervalBegin = minAreaIntervalMidpoint;
+      thread->Wait();
+      delete thread;
     }
     else
+    if (numNextBatchFrames > 0)
     {
-      intervalEnd = intervalMidpoint;
-      minAreaIntervalEnd = minAreaIntervalMidpoint;
+      nextJob->run(numNextBatchFrames, batchSize);
     }
 
-    run++;
+    doContinue = progressDialog.Update(batchIndex + 1);
   }
 
-  // Set the return values.
+  // Hide the progress dialog.
+  progressDialog.Update(numBatches);
 
-  releasePos = intervalMidpoint;
-  releaseArea_cm2 = minAreaIntervalMidpoint;
+  double exportTime_s = stopWatch.Time() / 1000.0;
+
+  // ****************************************************************
+  // Free the vocal tract copies and restore the old vocal tract 
+  // state.
+  // ****************************************************************
+
+  deleteWorkerTracts(ownTracts);
 
   for (i=0; i < VocalTract::NUM_PARAMS; i++)
   {
-    releaseParams[i] = vt->param[i].x;
+    vocalTract->param[i].x = oldVocalTractParams[i];
   }
+  calculateVocalTract(vocalTract);
 
-//  printf("runs: %d  is: %f cm2  target: %f cm2\n", run, minAreaIntervalMidpoint, releaseArea_cm2);
+  vocalTractDialog->Refresh();
+  vocalTractDialog->Update();
 
-  return true;
+  if (format == VIDEO_FRAMES_Y4M)
+  {
+    os.close();
+  }
+
+  if (ok == false)
+  {
+    wxMessageBox(wxString::Format("Failed to export video frame %d.", numExportedFrames),
+      "Error!");
+  }
+
+  wxPrintf("Finished exporting %d video frames for a frame rate of %d Hz "
+    "in %2.1f s (%2.1f frames/s, %d worker threads).\n", 
+    numExportedFrames, frameRate, exportTime_s, 
+    exportTime_s > 0.0 ? numExportedFrames / exportTime_s : 0.0, batchSize);
+
+  return ok;
 }
 
 
 // ****************************************************************************
-/// This function adjusts the parameters of the given vocal tract as long as
-/// the minimal cross-sectional area is smaller than the recommended minimal
-/// area for vowels.
+/// Calculates the vocal tract geometry of the frames of a geometry sequence.
+/// The item i of the job is the frame firstFrame + i, which is calculated
+/// with the vocal tract of the worker. The OBJ files are written directly by
+/// the workers. For the binary mesh sequence, the vertex coordinates of the
+/// selected surfaces are copied into vertexData.
 // ****************************************************************************
 
-void Data::createMinVocalTractArea(wxWindow *updateParent, VocalTract *tract, double minAdvisedArea_cm2,
-  double skipRegionStart_cm, double skipRegionEnd_cm)
+class GeometrySequenceJob : public ParallelJob
 {
-  const int MAX_RUNS = 30;
+public:
+  vector<VocalTract*> *tract;     // One vocal tract per worker
+  const vector<double> *frameParams;    // NUM_PARAMS values per frame
+  int firstFrame;
+  Data::GeometrySequenceFormat format;
+  bool renderBothSides;
+  wxString folderName;
+  const vector<int> *surfaceIndices;
+  vector<float> *vertexData;      // numFrameValues values per item
+  int numFrameValues;
+
+  virtual void processItem(int workerIndex, int itemIndex)
+  {
+    VocalTract *vt = (*tract)[workerIndex];
+    int frameIndex = firstFrame + itemIndex;
+    Surface *s = NULL;
+    int i, k, n;
 
-  int i;
-  double minArea_cm2;
-  int numRuns = 0;
-  int bestParam = -1;
-  double bestParamChange = 0.0;
-  double bestAreaChange = 0.0;
-  double currParamValue = 0.0;
-  double currMinArea_cm2 = 0.0;
-  double deltaMinArea_cm2 = 0.0;
-  char st[1024];
-  wxCommandEvent event(updateRequestEvent);
-  
-  VocalTractDialog *vocalTractDialog = VocalTractDialog::getInstance(NULL);
+    for (i=0; i < VocalTract::NUM_PARAMS; i++)
+    {
+      vt->param[i].x = (*frameParams)[frameIndex*VocalTract::NUM_PARAMS + i];
+    }
+    Data::getInstance()->calculateVocalTract(vt);
 
-  // ****************************************************************
-  // Determine the change step (increment) for the individual 
-  // parameters.
-  // ****************************************************************
+    if (format == Data::GEOMETRY_SEQUENCE_OBJ)
+    {
+      wxString fileName = folderName + "vt" + wxString::Format("%05d", frameIndex) + ".obj";
+      vt->saveAsObjFile(fileName.ToStdString(), renderBothSides);
+    }
+    else
+    {
+      n = itemIndex*numFrameValues;
+      for (i=0; i < (int)surfaceIndices->size(); i++)
+      {
+        s = &vt->surface[(*surfaceIndices)[i]];
+        for (k=0; k < s->numVertices; k++)
+        {
+          (*vertexData)[n++] = (float)s->vertex[k].coord.x;
+          (*vertexData)[n++] = (float)s->vertex[k].coord.y;
+          (*vertexData)[n++] = (float)s->vertex[k].coord.z;
+        }
+      }
+    }
+  }
+};
 
-  const double STEP_SIZE_CM = 0.025;   // = 1/4 mm
-  double changeStep[VocalTract::NUM_PARAMS];
 
-  for (i=0; i < VocalTract::NUM_PARAMS; i++)
+// ****************************************************************************
+/// Returns the vocal tract parameters of the frames of the given gestural 
+/// score at the given frame rate (NUM_PARAMS values per frame) and the number
+/// of frames.
+// ****************************************************************************
+
+int Data::calcScoreFrameParams(GesturalScore *score, double frameRate_Hz, 
+  vector<double> &frameParams)
+{
+  int i, k;
+  int numFrames;
+  double tractParams[VocalTract::NUM_PARAMS];
+  double glottisParams[256];
+
+  numFrames = (int)(score->getScoreDuration_s() * frameRate_Hz);
+  if (numFrames < 0)
   {
-    changeStep[i] = 0.0;
+    numFrames = 0;
   }
+  frameParams.resize(numFrames * VocalTract::NUM_PARAMS);
 
-  changeStep[VocalTract::HX] = STEP_SIZE_CM / 1.5;
-  changeStep[VocalTract::HY] = STEP_SIZE_CM;
-  changeStep[VocalTract::JX] = STEP_SIZE_CM;
-  changeStep[VocalTract::JA] = 0.05;    // -5 .. 0 deg
-  changeStep[VocalTract::LP] = 0.05;    // -1 .. +1
-  changeStep[VocalTract::LD] = STEP_SIZE_CM;
-  changeStep[VocalTract::VS] = 1.0 / (0.5/STEP_SIZE_CM);   // 0 .. 1 corr. to diff. of 0.5 cm
-
-  changeStep[VocalTract::TCX] = STEP_SIZE_CM;
-  changeStep[VocalTract::TCY] = STEP_SIZE_CM;
-  changeStep[VocalTract::TTX] = STEP_SIZE_CM;
-  changeStep[VocalTract::TTY] = STEP_SIZE_CM;
+  for (k=0; k < numFrames; k++)
+  {
+    score->getParams((double)k / frameRate_Hz, tractParams, glottisParams);
+    for (i=0; i < VocalTract::NUM_PARAMS; i++)
+    {
+      frameParams[k*VocalTract::NUM_PARAMS + i] = tractParams[i];
+    }
+  }
 
-  changeStep[VocalTract::TBX] = STEP_SIZE_CM;
-  changeStep[VocalTract::TBY] = STEP_SIZE_CM;
-  changeStep[VocalTract::TRX] = STEP_SIZE_CM;
-  changeStep[VocalTract::TRY] = STEP_SIZE_CM;
+  return numFrames;
+}
 
-  changeStep[VocalTract::TS1] = 0.05;    // -1 .. +1
-  changeStep[VocalTract::TS2] = 0.05;    // -1 .. +1
-  changeStep[VocalTract::TS3] = 0.05;    // -1 .. +1
 
-  // ****************************************************************
-  // Init. the progress dialog.
-  // ****************************************************************
+// ****************************************************************************
+/// Exports the 3D geometry of the vocal tract for all frames of the gestural
+/// score at the given frame rate. For GEOMETRY_SEQUENCE_OBJ and 
+/// GEOMETRY_SEQUENCE_SVG, name is the folder for the numbered files; for 
+/// GEOMETRY_SEQUENCE_MESH, it is the name of the mesh sequence file.
+/// The geometry is calculated on copies of the vocal tract by worker threads.
+/// The wireframe SVG files need the projection of the vocal tract picture
+/// and are therefore written one after the other in this thread.
+///
+/// The binary mesh sequence (all numbers in little-endian byte order) has 
+/// the topology of the surfaces in the header, which is the same for all 
+/// frames:
+///   char[8]  "VTLMESH" terminated by 0
+///   int32    number of surfaces
+///   int32    number of frames
+///   float32  frame rate in Hz
+///   per surface: the name as 0-terminated string, int32 number of vertices,
+///     int32 number of triangles, and 3 int32 vertex indices per triangle
+/// After the header follow the frames, each with the float32 x, y, z 
+/// coordinates (in cm) of the vertices of all surfaces.
+// ****************************************************************************
 
-  wxGenericProgressDialog progressDialog("Please wait", "The correction is running...",
-    MAX_RUNS, NULL, wxPD_CAN_ABORT | wxPD_APP_MODAL | wxPD_AUTO_HIDE);
+bool Data::exportGeometrySequence(const wxString &name, GeometrySequenceFormat format,
+  double frameRate_Hz, bool renderBothSides)
+{
+  // Surfaces of the mesh sequence like in the 3D solid display.
+  const int NUM_MESH_SURFACES = 11;
+  const int ONE_SIDED_SURFACE[NUM_MESH_SURFACES] =
+  {
+    VocalTract::TONGUE, VocalTract::UPPER_TEETH, VocalTract::LOWER_TEETH, 
+    VocalTract::UPPER_LIP, VocalTract::LOWER_LIP, VocalTract::UPPER_COVER, 
+    VocalTract::LOWER_COVER, VocalTract::LEFT_COVER, -1, 
+    VocalTract::EPIGLOTTIS, VocalTract::UVULA
+  };
+  const int TWO_SIDED_SURFACE[NUM_MESH_SURFACES] =
+  {
+    VocalTract::TONGUE, VocalTract::UPPER_TEETH_TWOSIDE, VocalTract::LOWER_TEETH_TWOSIDE,
+    VocalTract::UPPER_LIP_TWOSIDE, VocalTract::LOWER_LIP_TWOSIDE, VocalTract::UPPER_COVER_TWOSIDE, 
+    VocalTract::LOWER_COVER_TWOSIDE, VocalTract::LEFT_COVER, VocalTract::RIGHT_COVER, 
+    VocalTract::EPIGLOTTIS_TWOSIDE, VocalTract::UVULA_TWOSIDE
+  };
+  const char *MESH_SURFACE_NAME[NUM_MESH_SURFACES] =
+  {
+    "tongue", "upper-teeth", "lower-teeth", "upper-lip", "lower-lip", "upper-cover",
+    "lower-cover", "left-cover", "right-cover", "epiglottis", "uvula"
+  };
+  // Number of frames that are calculated before they are written to
+  // the mesh sequence file.
+  const int MESH_BATCH_SIZE = 64;
+
+  vector<double> frameParams;
+  vector<VocalTract*> workerTracts;
+  vector<int> surfaceIndices;
+  vector<const char*> surfaceNames;
+  vector<float> vertexData;
+  int numFrames;
+  int numWorkers;
+  int numFrameValues = 0;
+  int numExportedFrames = 0;
+  int i, k;
+  bool ok = true;
 
-  bool doContinue = true;
+  if (frameRate_Hz <= 0.0)
+  {
+    wxMessageBox("Invalid frame rate for the geometry sequence.", "Error!");
+    return false;
+  }
+
+  numFrames = calcScoreFrameParams(gesturalScore, frameRate_Hz, frameParams);
+  if (numFrames < 1)
+  {
+    wxMessageBox("The gestural score is empty.", "Error!");
+    return false;
+  }
+
+  wxString folderName = name;
+  wxChar pathSeparator = wxFileName::GetPathSeparator();
+  if (folderName.EndsWith( &pathSeparator ) == false)
+  {
+    folderName+= pathSeparator;
+  }
 
   // ****************************************************************
-  // The main loop.
+  // Create the copies of the vocal tract for the workers. The main
+  // vocal tract is not changed.
   // ****************************************************************
 
-  // Get the initial min area.
-  minArea_cm2 = getMinAreaOutsideConstriction_cm2(tract, skipRegionStart_cm, skipRegionEnd_cm);
-  //getVowelFormants(tract, F1, F2, F3, minArea_cm2);
-
-  while ((minArea_cm2 < minAdvisedArea_cm2) && (numRuns < MAX_RUNS) && (doContinue))
+  numWorkers = (format == GEOMETRY_SEQUENCE_SVG) ? 1 : ParallelJob::getNumWorkers(numFrames);
+  for (i=0; i < numWorkers; i++)
   {
-    currMinArea_cm2 = minArea_cm2;
-
-    // **************************************************************
-    // Find the parameter for which an incremental change in either
-    // of both directions gives the most increae of the minimal area.
-    // **************************************************************
+    VocalTract *clone = cloneVocalTract(vocalTract);
+    if (clone == NULL)
+    {
+      break;
+    }
+    workerTracts.push_back(clone);
+  }
 
-    bestParam = -1;
-    bestParamChange = 0.0;
-    bestAreaChange = 0.0;
+  if (workerTracts.empty())
+  {
+    wxMessageBox("Could not copy the vocal tract.", "Error!");
+    return false;
+  }
 
-    for (i=0; i < VocalTract::NUM_PARAMS; i++)
-    {
-      currParamValue = tract->param[i].x;
+  wxStopWatch stopWatch;
 
-      if (changeStep[i] > 0.0)
-      {
-        // Apply a POSITIVE change to parameter i.
-        
-        tract->param[i].x = currParamValue + changeStep[i];
-//        getVowelFormants(tract, F1, F2, F3, minArea_cm2);
-        minArea_cm2 = getMinAreaOutsideConstriction_cm2(tract, skipRegionStart_cm, skipRegionEnd_cm);
-        deltaMinArea_cm2 = minArea_cm2 - currMinArea_cm2;
+  GeometrySequenceJob job;
+  job.tract = &workerTracts;
+  job.frameParams = &frameParams;
+  job.firstFrame = 0;
+  job.format = format;
+  job.renderBothSides = renderBothSides;
+  job.folderName = folderName;
+  job.surfaceIndices = &surfaceIndices;
+  job.vertexData = &vertexData;
+  job.numFrameValues = 0;
 
-        if (deltaMinArea_cm2 > bestAreaChange)
-        {
-          bestParam = i;
-          bestParamChange = changeStep[i];
-          bestAreaChange = deltaMinArea_cm2;
-        }
+  // ****************************************************************
+  // One OBJ file per frame: The workers write the files themselves.
+  // ****************************************************************
 
-        // Apply a NEGATIVE change to parameter i.
-        
-        tract->param[i].x = currParamValue - changeStep[i];
-//        getVowelFormants(tract, F1, F2, F3, minArea_cm2);
-        minArea_cm2 = getMinAreaOutsideConstriction_cm2(tract, skipRegionStart_cm, skipRegionEnd_cm);
-        deltaMinArea_cm2 = minArea_cm2 - currMinArea_cm2;
+  if (format == GEOMETRY_SEQUENCE_OBJ)
+  {
+    wxBusyInfo wait("The geometry sequence is exported. Please wait...");
+    job.run(numFrames, (int)workerTracts.size());
+    numExportedFrames = numFrames;
+  }
+  else
 
-        if (deltaMinArea_cm2 > bestAreaChange)
-        {
-          bestParam = i;
-          bestParamChange = -changeStep[i];
-          bestAreaChange = deltaMinArea_cm2;
-        }
+  // ****************************************************************
+  // One wireframe SVG file per frame, written with the projection of
+  // the vocal tract picture.
+  // ****************************************************************
 
-        // Set the parameter value back to its original value.
-        tract->param[i].x = currParamValue;
-      }
+  if (format == GEOMETRY_SEQUENCE_SVG)
+  {
+    VocalTractDialog *vocalTractDialog = VocalTractDialog::getInstance(NULL);
+    if (vocalTractDialog->IsShownOnScreen() == false)
+    {
+      vocalTractDialog->Show(true);
     }
+    VocalTractPicture *picture = vocalTractDialog->getVocalTractPicture();
+    VocalTract *vt = workerTracts[0];
 
-    // **************************************************************
-    // Change the parameter with the best error reduction.
-    // **************************************************************
-
-    sprintf(st, "no change");
+    wxGenericProgressDialog progressDialog("Please wait", "The geometry sequence is exported...",
+      numFrames, NULL, wxPD_CAN_ABORT | wxPD_APP_MODAL | wxPD_AUTO_HIDE);
 
-    if (bestParam != -1)
+    for (k=0; (k < numFrames) && (ok); k++)
     {
-      tract->param[bestParam].x+= bestParamChange;
+      for (i=0; i < VocalTract::NUM_PARAMS; i++)
+      {
+        vt->param[i].x = frameParams[k*VocalTract::NUM_PARAMS + i];
+      }
 
-      if (bestParamChange > 0.0)
+      picture->setVocalTract(vt);
+      ok = picture->exportTractWireframeSVG(folderName + "vt" + wxString::Format("%05d", k) + ".svg", -1);
+      picture->setVocalTract(vocalTract);
+
+      if (ok)
       {
-        sprintf(st, "%s up.", tract->param[bestParam].name.c_str());
+        numExportedFrames++;
       }
-      else
+      if (progressDialog.Update(k + 1) == false)
       {
-        sprintf(st, "%s down.", tract->param[bestParam].name.c_str());
+        break;
       }
     }
+    progressDialog.Update(numFrames);
 
-    // Get the minimal area after the latest change.
-//    getVowelFormants(tract, F1, F2, F3, minArea_cm2);
-    minArea_cm2 = getMinAreaOutsideConstriction_cm2(tract, skipRegionStart_cm, skipRegionEnd_cm);
+    vocalTractDialog->Refresh();
+  }
+  else
 
-    printf("Run %d: %s. Min area=%2.2f cm^2\n", numRuns, st, minArea_cm2);
-    
-    // Terminate the loop when there was no improvement.
-    if (bestAreaChange <= 0.0)
+  // ****************************************************************
+  // One binary mesh sequence file with the shared topology in the 
+  // header.
+  // ****************************************************************
+
+  {
+    ofstream os(name.ToStdString(), ios::binary);
+    if (!os)
     {
-      numRuns = MAX_RUNS;
+      wxMessageBox(wxString("Could not open ") + name + wxString(" for writing."), "Error!");
+      ok = false;
     }
+    else
+    {
+      VocalTract *vt = workerTracts[0];
+      Surface *s = NULL;
+      const char MAGIC[8] = "VTLMESH";
+      float rate = (float)frameRate_Hz;
+      int numSurfaces;
 
-    // Update the pictures on the parent page.
+      for (i=0; i < NUM_MESH_SURFACES; i++)
+      {
+        k = renderBothSides ? TWO_SIDED_SURFACE[i] : ONE_SIDED_SURFACE[i];
+        if (k != -1)
+        {
+          surfaceIndices.push_back(k);
+          surfaceNames.push_back(MESH_SURFACE_NAME[i]);
+        }
+      }
+      numSurfaces = (int)surfaceIndices.size();
 
-    if (updateParent != NULL)
-    {
-      event.SetInt(UPDATE_PICTURES_AND_CONTROLS);
-      wxPostEvent(updateParent, event);
-      
-      if (vocalTractDialog->IsShown())
+      // The topology is taken from the first frame.
+      for (i=0; i < VocalTract::NUM_PARAMS; i++)
       {
-        vocalTractDialog->Refresh();
-        vocalTractDialog->Update();
+        vt->param[i].x = frameParams[i];
       }
+      calculateVocalTract(vt);
 
-      wxYield();
-    }
+      os.write(MAGIC, 8);
+      os.write((char*)&numSurfaces, sizeof(int));
+      os.write((char*)&numFrames, sizeof(int));
+      os.write((char*)&rate, sizeof(float));
 
-    doContinue = progressDialog.Update(numRuns);
+      for (i=0; i < numSurfaces; i++)
+      {
+        s = &vt->surface[surfaceIndices[i]];
+        os << surfaceNames[i] << '\0';
+        os.write((char*)&s->numVertices, sizeof(int));
+        os.write((char*)&s->numTriangles, sizeof(int));
+        for (k=0; k < s->numTriangles; k++)
+        {
+          os.write((char*)&s->triangle[k].vertex[0], 3*sizeof(int));
+        }
+        numFrameValues+= 3*s->numVertices;
+      }
 
-    numRuns++;
-  }
-}
+      // **************************************************************
+      // Calculate and write the frames batch by batch.
+      // **************************************************************
 
+      job.numFrameValues = numFrameValues;
+      vertexData.resize(MESH_BATCH_SIZE * numFrameValues);
 
-// ****************************************************************************
-/// Returns the mean squared difference between the current and the target
-/// formant values. If a target formant value is zero, it is not included in 
-/// the calculation ("don't care" value).
-// ****************************************************************************
+      int numBatches = (numFrames + MESH_BATCH_SIZE - 1) / MESH_BATCH_SIZE;
+      int numBatchFrames;
 
-double Data::getFormantError(double currentF1, double currentF2, 
-  double currentF3, double targetF1, double targetF2, double targetF3)
-{
-  const double EPSILON = 1.0;
-  double e = 0.0;
-  int numIncludedFormants = 0;
+      wxGenericProgressDialog progressDialog("Please wait", "The geometry sequence is exported...",
+        numBatches, NULL, wxPD_CAN_ABORT | wxPD_APP_MODAL | wxPD_AUTO_HIDE);
 
-  if (targetF1 >= EPSILON)
-  {
-    e += (1.0 - currentF1 / targetF1) * (1.0 - currentF1 / targetF1);
-    numIncludedFormants++;
-  }
+      for (k=0; (k < numBatches) && (ok); k++)
+      {
+        job.firstFrame = k*MESH_BATCH_SIZE;
+        numBatchFrames = min(MESH_BATCH_SIZE, numFrames - job.firstFrame);
+        job.run(numBatchFrames, (int)workerTracts.size());
 
-  if (targetF2 >= EPSILON)
-  {
-    e += (1.0 - currentF2 / targetF2) * (1.0 - currentF2 / targetF2);
-    numIncludedFormants++;
-  }
+        os.write((char*)&vertexData[0], sizeof(float) * numBatchFrames * numFrameValues);
+        ok = os.good();
+        if (ok)
+        {
+          numExportedFrames+= numBatchFrames;
+        }
 
-  if (targetF3 >= EPSILON)
-  {
-    e += (1.0 - currentF3 / targetF3) * (1.0 - currentF3 / targetF3);
-    numIncludedFormants++;
-  }
+        if (progressDialog.Update(k + 1) == false)
+        {
+          break;
+        }
+      }
+      progressDialog.Update(numBatches);
 
-  if (numIncludedFormants >= 1)
-  {
-    e /= (double)numIncludedFormants;
+      // Write the actual number of frames when the export was canceled.
+      if (numExportedFrames < numFrames)
+      {
+        os.seekp(8 + sizeof(int));
+        os.write((char*)&numExportedFrames, sizeof(int));
+      }
+      os.close();
+
+      if (ok == false)
+      {
+        wxMessageBox(wxString("Could not write ") + name + wxString("."), "Error!");
+      }
+    }
   }
-  else
+
+  double exportTime_s = stopWatch.Time() / 1000.0;
+
+  for (i=0; i < (int)workerTracts.size(); i++)
   {
-    e = 0.0;
+    delete workerTracts[i];
   }
 
-  e = sqrt(e);
-  e = e*100.0;    // The result is in percent
+  wxPrintf("Exported the geometry of %d of %d frames at %2.1f Hz in %2.1f s "
+    "with %d worker threads.\n", numExportedFrames, numFrames, frameRate_Hz, 
+    exportTime_s, (int)workerTracts.size());
 
-  return e;
+  return ok;
 }
 
 
 // ****************************************************************************
-/// Calculates the first three formants of the given vocal tract and the 
-/// minimum area of the corresponding area function. If the minimum area is 
-/// below a certain threshold, the formant values may not be useful.
-/// \param tract The vocal tract with adjusted variables.
-/// \param F1 Returns the first formant frequency.
-/// \param F2 Returns the second formant frequency.
-/// \param F3 Returns the third formant frequency.
-/// \param minArea_cm2 Returns the minimum area of the area function.
+/// Exports the volume velocity transfer functions (closed glottis condition)
+/// for every single millisecond in a gestural score.
 // ****************************************************************************
 
-bool Data::getVowelFormants(VocalTract *tract, double &F1_Hz, double &F2_Hz, double &F3_Hz, double &minArea_cm2)
+bool Data::exportTransferFunctionsFromScore(const wxString &fileName)
 {
-  const int MAX_FORMANTS = 3;
-  double formantFreq[MAX_FORMANTS];
-  double formantBw[MAX_FORMANTS];
-  int numFormants;
-  bool frictionNoise;
-  bool isClosure;
-  bool isNasal;
+  const int SPECTRUM_LENGTH = 8192;
+  const int FRAME_RATE = 1000;
+  double duration_s = gesturalScore->getDuration_pt() / (double)SAMPLING_RATE;
+  int numFrames = (int)(duration_s*FRAME_RATE);
   int i;
+  int frameIndex;
+  double time_s;
+  double oldVocalTractParams[VocalTract::NUM_PARAMS];
+  double vocalTractParams[VocalTract::NUM_PARAMS];
+  double glottisParams[256];
+  ComplexSignal spectrum(SPECTRUM_LENGTH);
 
-  // Default return values.
-  F1_Hz = 0.0;
-  F2_Hz = 0.0;
-  F3_Hz = 0.0;
-  minArea_cm2 = 0.0;
+  // ****************************************************************
+  // Keep in mind the current vocal tract state.
+  // ****************************************************************
 
-  // The velo-pharyngeal port must be closed.
-  if (tract->param[VocalTract::VO].x > 0.0)
+  for (i = 0; i < VocalTract::NUM_PARAMS; i++)
   {
-    tract->param[VocalTract::VO].x = 0.0;
+    oldVocalTractParams[i] = vocalTract->param[i].x;
   }
 
-  // Calculate the vocal tract area function.
-  tract->calculateAll();
+  // ****************************************************************
+  // Save one transfer function spectrum every millisecond
+  // (all into the same file).
+  // ****************************************************************
 
-  // Set the latest vocal tract geometry for the transmission line model.   
-  updateTlModelGeometry(tract);
+  // Open the text file.
 
-  // Find the minimum cross-sectional area.
-  minArea_cm2 = 10000.0;    // = extremely high
-  for (i = 0; i < VocalTract::NUM_TUBE_SECTIONS; i++)
+  ofstream os(fileName.ToStdString());
+
+  if (!os)
   {
-    if (tract->tubeSection[i].area < minArea_cm2)
+    wxMessageBox(wxString("Could not open ") + fileName + wxString(" for writing."),
+      "Error!");
+    return false;
+  }
+
+  // Write the header.
+
+  os << "# This file contains " << numFrames << " volume velocity transfer functions between "
+    "the glottis and the lips for the closed-glottis condition obtained from a gestural score. "
+    "There is one transfer function for every millisecond of the gestural score. "
+    "Each transfer function has 8192 samples that represent the frequencies from 0 to 44100 Hz. "
+    "The samples 0 ... 4095 (= 0 ... 22050 Hz) represent the positive frequencies, and the "
+    "remaining samples the negative frequencies (mirror image of the positive frequency part). "
+    "The frequency resolution of the transfer functions is hence 44100/8192 = 5.38 Hz. "
+    "There are two text lines per transfer function: The first line contains the magnitude "
+    "samples and the second line contains the phase samples in rad." << endl;
+  
+  os << setprecision(5);    // 5 post-decimal positions for floating point numbers
+
+  // Write all the transfer functions in a loop.
+
+  wxWindowDisabler disableAll;
+  wxBusyInfo wait("Please wait ...");
+
+  wxPrintf("Writing %d transfer functions to text file .", numFrames);
+
+  for (frameIndex = 0; frameIndex < numFrames; frameIndex++)
+  {
+    if ((frameIndex % 10) == 0)
     {
-      minArea_cm2 = tract->tubeSection[i].area;
+      wxPrintf(".");
+    }
+
+    // Calculate the vocal tract shape at the current frame.
+
+    time_s = (double)frameIndex / (double)FRAME_RATE;
+    gesturalScore->getParams(time_s, vocalTractParams, glottisParams);
+
+    for (i = 0; i < VocalTract::NUM_PARAMS; i++)
+    {
+      vocalTract->param[i].x = vocalTractParams[i];
+    }
+    calculateVocalTract(vocalTract);
+
+    // Update the vocal tract dialog, if it is shown on the screen.
+
+    VocalTractDialog *vocalTractDialog = VocalTractDialog::getInstance(NULL);
+    if (vocalTractDialog->IsShownOnScreen())
+    {
+      vocalTractDialog->Refresh();
+      vocalTractDialog->Update();
+      wxYield();
+    }
+
+    // Set the latest vocal tract geometry for the transmission line model.   
+    updateTlModelGeometry(vocalTract);
+
+    // Obtain the volume velocity transfer function.
+    tlModel->getSpectrum(TlModel::FLOW_SOURCE_TF, &spectrum, SPECTRUM_LENGTH, Tube::FIRST_PHARYNX_SECTION);
+
+    // Write magnitude.
+    for (i = 0; i < SPECTRUM_LENGTH; i++)
+    {
+      os << spectrum.getMagnitude(i) << " ";
+    }
+    os << endl;
+
+    // Write phase.
+    for (i = 0; i < SPECTRUM_LENGTH; i++)
+    {
+      os << spectrum.getPhase(i) << " ";
     }
+    os << endl;
   }
 
-  // Get the formant data.
-  tlModel->getFormants(formantFreq, formantBw, numFormants, MAX_FORMANTS, frictionNoise, isClosure, isNasal);
-  if (numFormants < MAX_FORMANTS)
+  wxPrintf(" done.\n");
+
+  // ****************************************************************
+  // Restore the old vocal tract state.
+  // ****************************************************************
+
+  for (i = 0; i < VocalTract::NUM_PARAMS; i++)
   {
-    return false;
+    vocalTract->param[i].x = oldVocalTractParams[i];
   }
+  calculateVocalTract(vocalTract);
+  updateTlModelGeometry(vocalTract);
 
-  F1_Hz = formantFreq[0];
-  F2_Hz = formantFreq[1];
-  F3_Hz = formantFreq[2];
+  VocalTractDialog *vocalTractDialog = VocalTractDialog::getInstance(NULL);
+  vocalTractDialog->Refresh();
+  vocalTractDialog->Update();
 
   return true;
 }
 
 
 // ****************************************************************************
-/// Calculates the first three formants of the given consonantal vocal tract 
-/// when it is shifted towards the given context vowel target until the minimal
-/// cross-sectional area is releaseArea_cm2.
+/// Run through all raw vocal tract shapes (which end with "-raw") and 
+/// calculate where the manually set point (TRX, TRY) projects on the horizontal
+/// line that will later be used for the automatic calculation of (TRX, TRY)
+/// similar to the approach in the Mermelstein vocal tract model.
+/// For each raw shape, three values are written in one row of the clipboard:
+/// The name of the shape, the hyoid-tongue distance, and the position of TRX 
+/// on the horizontal line that crosses the hyoid-tongue tangent.
+/// These data can then be copied into an Excel sheet, for example.
 // ****************************************************************************
 
-bool Data::getConsonantFormants(VocalTract *tract, const wxString &contextVowel, 
-	double releaseArea_cm2,	double &F1_Hz, double &F2_Hz, double &F3_Hz)
+void Data::calcTongueRootData()
+{
+  const wxString NEW_LINE = "\r\n";
+  int i, k;
+  int numShapes = (int)vocalTract->shapes.size();
+  wxString name;
+  wxString clipboardString;
+  wxString st;
+  Point2D H, T, Q;
+  double hyoidTongueDistance_cm;
+
+  // This is the caption string.
+  clipboardString = "name hyoid-tongue-center-distance TRX TRY TCX TCY HX_cm HY_cm" + NEW_LINE;
+
+  for (i=0; i < numShapes; i++)
+  {
+    name = wxString( vocalTract->shapes[i].name );
+    if (name.Contains("-raw"))
+    {
+
+      // Set the parameters of this shape and re-calculate the VT.
+      for (k=0; k < VocalTract::NUM_PARAMS; k++)
+      {
+        vocalTract->param[k].x = vocalTract->shapes[i].param[k];
+      }
+      calculateVocalTract(vocalTract);
+
+      vocalTract->getHyoidTongueTangent(H, T);    // To get H!
+
+      Point2D M(vocalTract->param[VocalTract::TCX].x, vocalTract->param[VocalTract::TCY].x);
+      hyoidTongueDistance_cm = (H - M).magnitude();
+
+      // Write name, hyoidTongueDistance_cm, etc. into the clipboard.
+      st = name + wxString::Format(" %2.2f %2.2f %2.2f %2.2f %2.2f %2.2f %2.2f", 
+        hyoidTongueDistance_cm, 
+        vocalTract->param[VocalTract::TRX].x,
+        vocalTract->param[VocalTract::TRY].x,
+        vocalTract->param[VocalTract::TCX].x,
+        vocalTract->param[VocalTract::TCY].x,
+        H.x, H.y) + NEW_LINE;
+      clipboardString+= st;
+    }
+  }
+
+  // This data objects are held by the clipboard, 
+  // so do not delete them in the app.
+
+  if (wxTheClipboard->Open())
+  {
+    wxTheClipboard->SetData( new wxTextDataObject(clipboardString) );
+    wxTheClipboard->Close();
+  }
+}
+
+
+// ****************************************************************************
+/// Optimize the parameters of the given vocal tract so that the formants
+/// match the given formant target values as well as possible.
+// ****************************************************************************
+
+void Data::optimizeFormantsVowel(wxWindow *updateParent, VocalTract *tract, 
+  double targetF1, double targetF2, double targetF3, 
+  double maxParamChange_cm, double minAdvisedArea_cm2, bool paramFixed[])
 {
+  const int MAX_RUNS = 100;
+
+  double F1, F2, F3;
+  double minArea_cm2;
+  double changeStep[VocalTract::NUM_PARAMS];
+  int stepsTaken[VocalTract::NUM_PARAMS];   // Cummulated steps gone by a parameter
+  double currParamValue;
+  double bestError;
+  double currError;
+  double newError;
+  double bestParamChange;
+  int bestParam;
   int i;
-  double consonantParams[VocalTract::NUM_PARAMS];
-  double vowelParams[VocalTract::NUM_PARAMS];
-  double releaseParams[VocalTract::NUM_PARAMS];
-  double releasePos;
+  char st[1024];
+  wxCommandEvent event(updateRequestEvent);
+
+  VocalTractDialog *vocalTractDialog = VocalTractDialog::getInstance(NULL);
+
 
   // ****************************************************************
-  // Init the return parameters for the error case.
+  // Make sure that all areas are above the given threshold.
   // ****************************************************************
-  
-  F1_Hz = 0.0;
-  F2_Hz = 0.0;
-  F3_Hz = 0.0;
+
+  getVowelFormants(tract, F1, F2, F3, minArea_cm2);
+  if (minArea_cm2 < minAdvisedArea_cm2)
+  {
+    wxString st = wxString::Format(
+      "There are cross-sectional areas below the threshold of %2.2f cm^2.\n"
+      "Press OK to let it be corrected before the optimization.", 
+      minAdvisedArea_cm2);
+
+    if (wxMessageBox(st, "Areas to small", wxOK | wxCANCEL) == wxOK)
+    {
+      createMinVocalTractArea(updateParent, tract, minAdvisedArea_cm2);
+    }
+    else
+    {
+      return;
+    }
+  }
+
+  double initialError = getFormantError(F1, F2, F3, targetF1, targetF2, targetF3);
+  wxPrintf("\n=== Before vowel optimization ===\n");
+  wxPrintf("F1:%d  F2:%d  F3:%d   F1':%d  F2':%d  F3':%d   error:%2.2f percent\n",
+    (int)F1, (int)F2, (int)F3, (int)targetF1, (int)targetF2, (int)targetF3, initialError);
 
   // ****************************************************************
-  // Fill in the parameter values for the consonant, vowel, and 
-  // release shape.
+  // Define the steps by which the individual parameters are adjusted
+  // incrementally. A step value of 0.0 means that the parameters is
+  // not supposed to be adjusted at all.
   // ****************************************************************
 
-  int vowelIndex = tract->getShapeIndex(contextVowel.ToStdString());
-  if (vowelIndex == -1)
+  // How many steps are maximally allowed per parameter in one direction ?
+  const double STEP_SIZE_CM = 0.05;   // = 1/2 mm
+  int maxSteps = (int)((maxParamChange_cm / STEP_SIZE_CM) + 0.5);
+  if (maxSteps < 1)
   {
-    return false;
+    maxSteps = 1;
+  }
+  if (maxSteps > 20)
+  {
+    maxSteps = 20;    // Corresponds to 1.0 cm
   }
+  wxPrintf("The vocal tract shape may change by at most %1.1f mm.\n", maxSteps*STEP_SIZE_CM*10.0);
 
   for (i=0; i < VocalTract::NUM_PARAMS; i++)
   {
-    consonantParams[i] = tract->param[i].x;
-    vowelParams[i] = tract->shapes[vowelIndex].param[i];
-    releaseParams[i] = tract->param[i].neutral;   // Default for error case.
+    changeStep[i] = 0.0;
+    stepsTaken[i] = 0;
   }
 
+  changeStep[VocalTract::HX] = STEP_SIZE_CM / 1.5;
+  changeStep[VocalTract::HY] = STEP_SIZE_CM;
+  changeStep[VocalTract::JX] = STEP_SIZE_CM;
+  changeStep[VocalTract::JA] = 0.05;    // -5 .. 0 deg
+  changeStep[VocalTract::LP] = 0.05;    // -1 .. +1
+  changeStep[VocalTract::LD] = STEP_SIZE_CM;
+  changeStep[VocalTract::VS] = 1.0 / (0.5/STEP_SIZE_CM);   // 0 .. 1 corr. to diff. of 0.5 cm
+
+  changeStep[VocalTract::TCX] = STEP_SIZE_CM;
+  changeStep[VocalTract::TCY] = STEP_SIZE_CM;
+  changeStep[VocalTract::TTX] = STEP_SIZE_CM;
+  changeStep[VocalTract::TTY] = STEP_SIZE_CM;
+
+  changeStep[VocalTract::TBX] = STEP_SIZE_CM;
+  changeStep[VocalTract::TBY] = STEP_SIZE_CM;
+  changeStep[VocalTract::TRX] = STEP_SIZE_CM;
+  changeStep[VocalTract::TRY] = STEP_SIZE_CM;
+
+  changeStep[VocalTract::TS1] = 0.05;    // 0 .. +1
+  changeStep[VocalTract::TS2] = 0.05;    // 0 .. +1
+  changeStep[VocalTract::TS3] = 0.05;    // -1 .. +1
+
+  // Set the change step to zero for parameters that are supposed to be fixed.
+
+  for (i=0; i < VocalTract::NUM_PARAMS; i++)
+  {
+    if (paramFixed[i])
+    {
+      changeStep[i] = 0.0;
+    }
+  }
+  
+  // ****************************************************************
+  // Init. the progress dialog.
+  // ****************************************************************
+
+  wxGenericProgressDialog progressDialog("Please wait", "The formant optimization is running...",
+    MAX_RUNS, NULL, wxPD_CAN_ABORT | wxPD_APP_MODAL | wxPD_AUTO_HIDE);
+
+  // ****************************************************************
+  // ****************************************************************
+
+  bool paramChanged = false;
+  bool doContinue = false;
+  int runCounter = 0;
+
+  do
+  {
+    paramChanged = false;
+    getVowelFormants(tract, F1, F2, F3, minArea_cm2);
+    currError = getFormantError(F1, F2, F3, targetF1, targetF2, targetF3);
+
+    // **************************************************************
+    // Find out the improvement of the error when each parameter is 
+    // changed individually by a positive changeStep[i] starting 
+    // from the current configuration.
+    // **************************************************************
+    
+    bestError = currError;
+    bestParam = -1;
+    bestParamChange = 0.0;
+
+    for (i=0; i < VocalTract::NUM_PARAMS; i++)
+    {
+      currParamValue = tract->param[i].x;
+
+      if (changeStep[i] > 0.0)
+      {
+        // Apply a POSITIVE change to parameter i.
+        
+        if (stepsTaken[i] < maxSteps)
+        {
+          tract->param[i].x = currParamValue + changeStep[i];
+          getVowelFormants(tract, F1, F2, F3, minArea_cm2);
+          
+          // Check that the minimum area stays above the threshold.
+          if (minArea_cm2 >= minAdvisedArea_cm2)
+          {
+            newError = getFormantError(F1, F2, F3, targetF1, targetF2, targetF3);
+            if (newError < bestError)
+            {
+              bestError = newError;
+              bestParam = i;
+              bestParamChange = changeStep[i];
+            }
+          }
+        }
+
+        // Apply a NEGATIVE change to parameter i.
+
+        if (stepsTaken[i] > -maxSteps)
+        {
+          tract->param[i].x = currParamValue - changeStep[i];
+          getVowelFormants(tract, F1, F2, F3, minArea_cm2);
+          
+          // Check that the minimum area stays above the threshold.
+          if (minArea_cm2 >= minAdvisedArea_cm2)
+          {
+            newError = getFormantError(F1, F2, F3, targetF1, targetF2, targetF3);
+            if (newError < bestError)
+            {
+              bestError = newError;
+              bestParam = i;
+              bestParamChange = -changeStep[i];
+            }
+          }
+        }
+
+        // Set the parameter value back to its original value.
+        tract->param[i].x = currParamValue;
+      }
+    }
+
+    // **************************************************************
+    // Change the parameter with the best error reduction.
+    // **************************************************************
+
+    sprintf(st, "no change");
+
+    if ((bestParam != -1) && (bestError < currError))
+    {
+      tract->param[bestParam].x+= bestParamChange;
+      if (bestParamChange > 0.0)
+      {
+        stepsTaken[bestParam]++;
+        sprintf(st, "%s up", tract->param[bestParam].name.c_str());
+      }
+      else
+      {
+        stepsTaken[bestParam]--;
+        sprintf(st, "%s down", tract->param[bestParam].name.c_str());
+      }
+
+      paramChanged = true;
+    }
+
+    printf("Run %d: %s. Error=%2.2f\n", runCounter, st, bestError);
+
+    // Update the pictures on the parent page.
+
+    if (updateParent != NULL)
+    {
+      // Calculate the vocal tract area function.
+      calculateVocalTract(tract);
+      // Set the latest vocal tract geometry for the transmission line model.   
+      updateTlModelGeometry(tract);
+
+      event.SetInt(UPDATE_PICTURES_AND_CONTROLS);
+      wxPostEvent(updateParent, event);
+
+      if (vocalTractDialog->IsShown())
+      {
+        vocalTractDialog->Refresh();
+        vocalTractDialog->Update();
+      }
+
+      wxYield();
+    }
+
+    doContinue = progressDialog.Update(runCounter);
+
+    runCounter++;
+
+  } while ((paramChanged) && (doContinue) && (runCounter < MAX_RUNS));
+
+  // Hide the progress dialog.
+  progressDialog.Update(MAX_RUNS);
+
+  // ****************************************************************
+  // The velo-pharyngeal port must be closed.
+  // ****************************************************************
+
+  if (tract->param[VocalTract::VO].x > 0.0)
+  {
+    tract->param[VocalTract::VO].x = 0.0;
+  }
+
+  // ****************************************************************
+  // ****************************************************************
+
+  getVowelFormants(tract, F1, F2, F3, minArea_cm2);
+  double finalError = getFormantError(F1, F2, F3, targetF1, targetF2, targetF3);
+  wxPrintf("=== After optimization ===\n");
+  wxPrintf("F1:%d  F2:%d  F3:%d   F1':%d  F2':%d  F3':%d   Error:%2.2f percent\n",
+    (int)F1, (int)F2, (int)F3, (int)targetF1, (int)targetF2, (int)targetF3, finalError);
+  wxPrintf("The error reduced from %2.2f to %2.2f percent.\n", initialError, finalError);
+}
+
+
+// ****************************************************************************
+/// Evaluates the formant errors for a list of candidate changes of the 
+/// consonant shape in optimizeFormantsConsonant(...). Each worker has its
+/// own vocal tract, TL model, and release shape search. The release shape
+/// search of each candidate is warm-started from startReleasePos, so that 
+/// the results don't depend on which worker gets which candidate.
+/// The worker 0 runs in the calling (GUI) thread and polls the progress 
+/// dialog for a cancel request after each candidate.
+// ****************************************************************************
+
+class ConsonantCandidateJob : public ParallelJob
+{
+public:
+  struct Candidate
+  {
+    int param;
+    double change;
+    bool isValid;
+    double error;
+  };
+
+  vector<Candidate> candidate;
+  double baseParams[VocalTract::NUM_PARAMS];
+
+  vector<VocalTract*> workerTract;
+  vector<TlModel*> workerModel;
+  vector<Data::ReleaseSearch> workerSearch;
+  double startReleasePos;
+
+  wxGenericProgressDialog *progressDialog;
+  int progressValue;
+
+  wxString contextVowel;
+  double targetF1;
+  double targetF2;
+  double targetF3;
+  double minArea_cm2;
+  double releaseArea_cm2;
+  double constrictionStartPos_cm;
+  double constrictionEndPos_cm;
+
+  virtual void processItem(int workerIndex, int itemIndex)
+  {
+    Data *data = Data::getInstance();
+    VocalTract *tract = workerTract[workerIndex];
+    Candidate &c = candidate[itemIndex];
+    double F1, F2, F3;
+    int i;
+
+    c.isValid = false;
+    c.error = 0.0;
+
+    if (isCancelled())
+    {
+      return;
+    }
+
+    for (i=0; i < VocalTract::NUM_PARAMS; i++)
+    {
+      tract->param[i].x = baseParams[i];
+    }
+    tract->param[c.param].x+= c.change;
+    workerSearch[workerIndex].lastReleasePos = startReleasePos;
+
+    if ((data->getMinAreaOutsideConstriction_cm2(tract, constrictionStartPos_cm, constrictionEndPos_cm) >= minArea_cm2) &&
+        (data->getConsonantFormants(tract, contextVowel, releaseArea_cm2, F1, F2, F3, 
+          workerModel[workerIndex], &workerSearch[workerIndex])))
+    {
+      c.isValid = true;
+      c.error = data->getFormantError(F1, F2, F3, targetF1, targetF2, targetF3);
+    }
+
+    if ((workerIndex == 0) && (progressDialog != NULL) && 
+      (progressDialog->Update(progressValue) == false))
+    {
+      wxCriticalSectionLocker locker(cancelCriticalSection);
+      cancelled = true;
+    }
+  }
+
+  bool isCancelled()
+  {
+    wxCriticalSectionLocker locker(cancelCriticalSection);
+    return cancelled;
+  }
+
+  ConsonantCandidateJob()
+  {
+    progressDialog = NULL;
+    progressValue = 0;
+    startReleasePos = -1.0;
+    cancelled = false;
+  }
+
+private:
+  bool cancelled;
+  wxCriticalSection cancelCriticalSection;
+};
+
+
+// ****************************************************************************
+/// This function optimizes the formant frequencies right after the release of
+/// a stop consonant (at vowel onset). The formant error is calculated for a
+/// vocal tract shape between the given full consonantal shape and the context 
+/// vowel shape at the place where the minimal area is just the given
+/// minArea_cm2
+// ****************************************************************************
+
+void Data::optimizeFormantsConsonant(wxWindow *updateParent, VocalTract *tract, 
+  const wxString &contextVowel, double targetF1, double targetF2, double targetF3, 
+  double maxParamChange_cm, double minArea_cm2, double releaseArea_cm2, bool paramFixed[])
+{
+  const int MAX_RUNS = 100;
+
+  double F1, F2, F3;
+  double changeStep[VocalTract::NUM_PARAMS];
+  int stepsTaken[VocalTract::NUM_PARAMS];   // Cummulated steps gone by a parameter
+  double bestError;
+  double currError;
+  double bestParamChange;
+  int bestParam;
+  int i, k;
+  char st[1024];
+  wxCommandEvent event(updateRequestEvent);
+
+  VocalTractDialog *vocalTractDialog = VocalTractDialog::getInstance(NULL);
+
+
+  // ****************************************************************
+  // Find the start and end positions of the constricted region,
+  // where the area is allowed to be smaller than minArea_cm2.
+  // ****************************************************************
+
+  double constrictionStartPos_cm = 0.0;
+  double constrictionEndPos_cm = 0.0;
+  
+  k = 0;   // Index of the cross-section with the smallest area
+  for (i=1; i < VocalTract::NUM_CENTERLINE_POINTS; i++)
+  {
+    if (tract->crossSection[i].area < tract->crossSection[k].area)
+    {
+      k = i;
+    }    
+  }
+
+  // Find the region that is close to the minimum area within an epsilon range.
+  
+  const double POS_MARGIN_CM = 1.5;
+  const double DELTA_AREA_CM2 = 0.1;   // = 10 mm2
+  double constrictionArea_cm2 = tract->crossSection[k].area;
+
+  i = k;
+  while ((i > 0) && (tract->crossSection[i].area < constrictionArea_cm2 + DELTA_AREA_CM2))
+  {
+    i--;
+  }
+  constrictionStartPos_cm = tract->crossSection[i].pos - POS_MARGIN_CM;
+
+  i = k;
+  while ((i < VocalTract::NUM_CENTERLINE_POINTS-1) && (tract->crossSection[i].area < constrictionArea_cm2 + DELTA_AREA_CM2))
+  {
+    i++;
+  }
+  constrictionEndPos_cm = tract->crossSection[i].pos + POS_MARGIN_CM;
+
+  // ****************************************************************
+  // Make sure that all areas left and right of the constriction are 
+  // above the given threshold.
+  // ****************************************************************
+
+  double minAreaOutsideConstriction_cm2 = getMinAreaOutsideConstriction_cm2(tract, constrictionStartPos_cm, constrictionEndPos_cm);
+  if (minAreaOutsideConstriction_cm2 < minArea_cm2)
+  {
+    wxString st = wxString::Format(
+      "There are cross-sectional areas left and right of the constriction\n"
+      "(between %2.1f and %2.1f cm) below the threshold of %2.2f cm^2.\n"
+      "Press OK to let it be corrected before the optimization.", 
+      constrictionStartPos_cm, constrictionEndPos_cm, minArea_cm2);
+
+    if (wxMessageBox(st, "Areas to small", wxOK | wxCANCEL) == wxOK)
+    {
+      createMinVocalTractArea(updateParent, tract, minArea_cm2, constrictionStartPos_cm, constrictionEndPos_cm);
+    }
+    else
+    {
+      return;
+    }
+  }
+
+
+  // ****************************************************************
+  // The velo-pharyngeal port must be closed.
+  // ****************************************************************
+
+  if (tract->param[VocalTract::VO].x > 0.0)
+  {
+    tract->param[VocalTract::VO].x = 0.0;
+  }
+
+  // ****************************************************************
+  // Get the initial error.
+  // ****************************************************************
+
+  ReleaseSearch releaseSearch;
+
+  getConsonantFormants(tract, contextVowel, releaseArea_cm2, F1, F2, F3, NULL, &releaseSearch);
+  double initialError = getFormantError(F1, F2, F3, targetF1, targetF2, targetF3);
+
+  wxPrintf("\n=== Before consonant formant optimization ===\n");
+  wxPrintf("F1:%d  F2:%d  F3:%d   F1':%d  F2':%d  F3':%d   error:%2.2f percent\n",
+    (int)F1, (int)F2, (int)F3, (int)targetF1, (int)targetF2, (int)targetF3, initialError);
+
+  // ****************************************************************
+  // Define the steps by which the individual parameters are adjusted
+  // incrementally. A step value of 0.0 means that the parameters is
+  // not supposed to be adjusted at all.
+  // ****************************************************************
+
+  // How many steps are maximally allowed per parameter in one direction ?
+  const double STEP_SIZE_CM = 0.05;   // = 1/2 mm
+  int maxSteps = (int)((maxParamChange_cm / STEP_SIZE_CM) + 0.5);
+  if (maxSteps < 1)
+  {
+    maxSteps = 1;
+  }
+  if (maxSteps > 10)
+  {
+    maxSteps = 10;
+  }
+  wxPrintf("The vocal tract shape may change by at most %1.1f mm.\n", maxSteps*STEP_SIZE_CM*10.0);
+
+  for (i=0; i < VocalTract::NUM_PARAMS; i++)
+  {
+    changeStep[i] = 0.0;
+    stepsTaken[i] = 0;
+  }
+
+  changeStep[VocalTract::HX] = STEP_SIZE_CM / 1.5;
+  changeStep[VocalTract::HY] = STEP_SIZE_CM;
+  changeStep[VocalTract::JX] = STEP_SIZE_CM;
+  changeStep[VocalTract::JA] = 0.05;    // -5 .. 0 deg
+  changeStep[VocalTract::LP] = 0.05;    // -1 .. +1
+  changeStep[VocalTract::LD] = STEP_SIZE_CM;
+  changeStep[VocalTract::VS] = 1.0 / (0.5/STEP_SIZE_CM);   // 0 .. 1 corr. to diff. of 0.5 cm
+
+  changeStep[VocalTract::TCX] = STEP_SIZE_CM;
+  changeStep[VocalTract::TCY] = STEP_SIZE_CM;
+  changeStep[VocalTract::TTX] = STEP_SIZE_CM;
+  changeStep[VocalTract::TTY] = STEP_SIZE_CM;
+
+  changeStep[VocalTract::TBX] = STEP_SIZE_CM;
+  changeStep[VocalTract::TBY] = STEP_SIZE_CM;
+  changeStep[VocalTract::TRX] = STEP_SIZE_CM;
+  changeStep[VocalTract::TRY] = STEP_SIZE_CM;
+
+  changeStep[VocalTract::TS1] = 0.05;    // -1 .. +1
+  changeStep[VocalTract::TS2] = 0.05;    // -1 .. +1
+  changeStep[VocalTract::TS3] = 0.05;    // -1 .. +1
+
+  // Set the change step to zero for parameters that are supposed to be fixed.
+
+  for (i=0; i < VocalTract::NUM_PARAMS; i++)
+  {
+    if (paramFixed[i])
+    {
+      changeStep[i] = 0.0;
+    }
+  }
+  
+
+  // ****************************************************************
+  // Prepare the parallel evaluation of the candidate changes. All
+  // workers use copies of the given vocal tract.
+  // ****************************************************************
+
+  ConsonantCandidateJob job;
+  job.contextVowel = contextVowel;
+  job.targetF1 = targetF1;
+  job.targetF2 = targetF2;
+  job.targetF3 = targetF3;
+  job.minArea_cm2 = minArea_cm2;
+  job.releaseArea_cm2 = releaseArea_cm2;
+  job.constrictionStartPos_cm = constrictionStartPos_cm;
+  job.constrictionEndPos_cm = constrictionEndPos_cm;
+
+  int numWorkers = createWorkerTracts(tract, 
+    ParallelJob::getNumWorkers(2*VocalTract::NUM_PARAMS), job.workerTract);
+  if (numWorkers < 1)
+  {
+    wxMessageBox("Failed to copy the vocal tract model.", "Error!");
+    return;
+  }
+
+  for (k=0; k < numWorkers; k++)
+  {
+    TlModel *model = new TlModel();
+    model->options = tlModel->options;
+    job.workerModel.push_back(model);
+    job.workerSearch.push_back(ReleaseSearch());
+  }
+
+  // ****************************************************************
+  // Init. the progress dialog.
+  // ****************************************************************
+
+  wxGenericProgressDialog progressDialog("Please wait", "The formant optimization is running...",
+    MAX_RUNS, NULL, wxPD_CAN_ABORT | wxPD_APP_MODAL | wxPD_AUTO_HIDE);
+
+  // ****************************************************************
+  // ****************************************************************
+
+  bool paramChanged = false;
+  bool doContinue = false;
+  int runCounter = 0;
+
+  do
+  {
+    paramChanged = false;
+    getConsonantFormants(tract, contextVowel, releaseArea_cm2, F1, F2, F3, NULL, &releaseSearch);
+    currError = getFormantError(F1, F2, F3, targetF1, targetF2, targetF3);
+
+    // **************************************************************
+    // Find out the improvement of the error when each parameter is 
+    // changed individually by a positive or negative changeStep[i] 
+    // starting from the current configuration.
+    // **************************************************************
+
+    job.candidate.clear();
+
+    for (i=0; i < VocalTract::NUM_PARAMS; i++)
+    {
+      if (changeStep[i] > 0.0)
+      {
+        ConsonantCandidateJob::Candidate c;
+        c.param = i;
+
+        // A POSITIVE change to parameter i. Do nothing when the VO 
+        // parameter is changed above the threshold (velum open).
+        
+        if ((stepsTaken[i] < maxSteps) &&
+          ((i != VocalTract::VO) || (tract->param[i].x + changeStep[i] <= 0.0)))
+        {
+          c.change = changeStep[i];
+          job.candidate.push_back(c);
+        }
+
+        // A NEGATIVE change to parameter i.
+
+        if (stepsTaken[i] > -maxSteps)
+        {
+          c.change = -changeStep[i];
+          job.candidate.push_back(c);
+        }
+      }
+    }
+
+    // The release shape search of every candidate starts from the
+    // release position of the current shape.
+
+    for (i=0; i < VocalTract::NUM_PARAMS; i++)
+    {
+      job.baseParams[i] = tract->param[i].x;
+    }
+    job.startReleasePos = releaseSearch.lastReleasePos;
+    job.progressDialog = &progressDialog;
+    job.progressValue = runCounter;
+
+    job.run((int)job.candidate.size(), numWorkers);
+
+    // Take the best candidate in the order of the list, so that the
+    // result does not depend on the number of workers. When the user
+    // cancelled during the evaluation, the candidates are incomplete
+    // and no change is made.
+
+    bestError = currError;
+    bestParam = -1;
+    bestParamChange = 0.0;
+
+    for (k=0; (k < (int)job.candidate.size()) && (job.isCancelled() == false); k++)
+    {
+      if ((job.candidate[k].isValid) && (job.candidate[k].error < bestError))
+      {
+        bestError = job.candidate[k].error;
+        bestParam = job.candidate[k].param;
+        bestParamChange = job.candidate[k].change;
+      }
+    }
+
+    // **************************************************************
+    // Change the parameter with the best error reduction.
+    // **************************************************************
+
+    sprintf(st, "no change");
+
+    if ((bestParam != -1) && (bestError < currError))
+    {
+      tract->param[bestParam].x+= bestParamChange;
+      if (bestParamChange > 0.0)
+      {
+        stepsTaken[bestParam]++;
+        sprintf(st, "%s up", tract->param[bestParam].name.c_str());
+      }
+      else
+      {
+        stepsTaken[bestParam]--;
+        sprintf(st, "%s down", tract->param[bestParam].name.c_str());
+      }
+
+      paramChanged = true;
+    }
+
+    getConsonantFormants(tract, contextVowel, releaseArea_cm2, F1, F2, F3, NULL, &releaseSearch);
+    wxPrintf("Run %d: %s. Formants: %d, %d, %d  Error=%2.2f\n",
+      runCounter + 1, st, (int)F1, (int)F2, (int)F3, bestError);
+
+    // Update the pictures on the parent page.
+
+    if (updateParent != NULL)
+    {
+      // Calculate the vocal tract area function.
+      calculateVocalTract(tract);
+      // Set the latest vocal tract geometry for the transmission line model.   
+      updateTlModelGeometry(tract);
+
+      event.SetInt(UPDATE_PICTURES_AND_CONTROLS);
+      wxPostEvent(updateParent, event);
+
+      if (vocalTractDialog->IsShown())
+      {
+        vocalTractDialog->Refresh();
+        vocalTractDialog->Update();
+      }
+
+      wxYield();
+    }
+
+    doContinue = (job.isCancelled() == false) && (progressDialog.Update(runCounter));
+
+    runCounter++;
+
+  } while ((paramChanged) && (doContinue) && (runCounter < MAX_RUNS));
+
+  // Hide the progress dialog.
+  progressDialog.Update(MAX_RUNS);
+
+  wxPrintf("\n");
+
+  // ****************************************************************
+  // Free the copies of the vocal tract and the worker models.
+  // ****************************************************************
+
+  for (k=0; k < numWorkers; k++)
+  {
+    delete job.workerModel[k];
+    releaseSearch.addStatistics(job.workerSearch[k]);
+  }
+  deleteWorkerTracts(job.workerTract);
+
+  // ****************************************************************
+  // ****************************************************************
+
+  getConsonantFormants(tract, contextVowel, releaseArea_cm2, F1, F2, F3, NULL, &releaseSearch);
+  double finalError = getFormantError(F1, F2, F3, targetF1, targetF2, targetF3);
+
+  wxPrintf("=== After consonant formant optimization ===\n");
+  wxPrintf("F1:%d  F2:%d  F3:%d   F1':%d  F2':%d  F3':%d   Error:%2.2f percent\n",
+    (int)F1, (int)F2, (int)F3, (int)targetF1, (int)targetF2, (int)targetF3, finalError);
+  wxPrintf("The error reduced from %2.2f to %2.2f percent.\n", initialError, finalError);
+  wxPrintf("Release shape search: %d searches (%d warm-started) with %d geometry evaluations.\n",
+    releaseSearch.numColdSearches + releaseSearch.numWarmSearches, releaseSearch.numWarmSearches,
+    releaseSearch.numGeometryEvaluations);
+  wxPrintf("About %d geometry evaluations were saved. %d thread(s) evaluated the candidates.\n",
+    releaseSearch.getNumSavedEvaluations(), numWorkers);
+
+}
+
+
+// ****************************************************************************
+/// Finds the vocal tract shape on the linear transition from the given 
+/// consonant shape to the given vowel shape where the minimal cross-sectional
+/// area is just the given releaseArea_cm2.
+/// The position on the transition (between 0.0 and 1.0) is returned in
+/// releasePos, and the resulting shape parameters in releaseParams.
+// ****************************************************************************
+
+bool Data::getReleaseShape(VocalTract *vt, double *consonantParams, double *vowelParams,
+  double *releaseParams, double &releasePos, double releaseArea_cm2, ReleaseSearch *search)
+{
+  int i;
+  double minAreaVowel_cm2 = 0.0;
+  double minAreaConsonant_cm2 = 0.0;
+  // Start and end pos. of the min. area search region.
+  double startPos_cm = 0.0;   
+  double endPos_cm = 1000.0;
+
+  // ****************************************************************
+  // Keep in mind the original VT parameters.
+  // ****************************************************************
+
+  double origParams[VocalTract::NUM_PARAMS];
+  for (i=0; i < VocalTract::NUM_PARAMS; i++)
+  {
+    origParams[i] = vt->param[i].x;
+  }
+
+  // ****************************************************************
+  // Check the initial min. area of the vowel, unless it is known
+  // from the previous search.
+  // ****************************************************************
+
+  bool vowelChanged = true;
+  if ((search != NULL) && (search->hasVowelArea))
+  {
+    vowelChanged = false;
+    for (i=0; i < VocalTract::NUM_PARAMS; i++)
+    {
+      if (search->vowelParams[i] != vowelParams[i])
+      {
+        vowelChanged = true;
+      }
+    }
+  }
+
+  if (vowelChanged)
+  {
+    for (i=0; i < VocalTract::NUM_PARAMS; i++)
+    {
+      vt->param[i].x = vowelParams[i];
+    }
+    minAreaVowel_cm2 = getMinArea_cm2(vt, 0.0, 1000.0);
+
+    if (search != NULL)
+    {
+      for (i=0; i < VocalTract::NUM_PARAMS; i++)
+      {
+        search->vowelParams[i] = vowelParams[i];
+      }
+      search->minAreaVowel_cm2 = minAreaVowel_cm2;
+      search->hasVowelArea = true;
+      search->numGeometryEvaluations++;
+    }
+  }
+  else
+  {
+    minAreaVowel_cm2 = search->minAreaVowel_cm2;
+    search->numCachedVowelAreas++;
+  }
+
+  // ****************************************************************
+  // Check the initial min. area of the consonant.
+  // ****************************************************************
+
+  for (i=0; i < VocalTract::NUM_PARAMS; i++)
+  {
+    vt->param[i].x = consonantParams[i];
+  }
+  minAreaConsonant_cm2 = getMinArea_cm2(vt, 0.0, 1000.0);
+  if (search != NULL)
+  {
+    search->numGeometryEvaluations++;
+  }
+
+  // Get the start and end point of the region along the center line
+  // around this minimum.
+
+  const double AREA_EPSILON_CM2 = 0.01;   // = 1 mm^2
+  const double POS_MARGIN_CM = 2.0;
+  i = 0;
+  while ((i < VocalTract::NUM_CENTERLINE_POINTS) && 
+         (vt->crossSection[i].area > minAreaConsonant_cm2 + AREA_EPSILON_CM2))
+  {
+    i++;
+  }
+  if (i < VocalTract::NUM_CENTERLINE_POINTS)
+  {
+    startPos_cm = vt->crossSection[i].pos - POS_MARGIN_CM;
+  }
+  else
+  {
+    startPos_cm = 0.0;
+  }
+
+  // ****************************************************************
+
+  i = VocalTract::NUM_CENTERLINE_POINTS - 1;
+  while ((i >= 0) && (vt->crossSection[i].area > minAreaConsonant_cm2 + AREA_EPSILON_CM2))
+  {
+    i--;
+  }
+  if (i >= 0)
+  {
+    endPos_cm = vt->crossSection[i].pos + POS_MARGIN_CM;
+  }
+  else
+  {
+    endPos_cm = 1000.0;
+  }
+
+  // The min. vowel area must be greater than the release area, and
+  // the min. consonant area must be less.
+
+  if ((minAreaConsonant_cm2 >= releaseArea_cm2) || (minAreaVowel_cm2 <= releaseArea_cm2))
+  {
+    // Set back the original parameter values.
+    for (i=0; i < VocalTract::NUM_PARAMS; i++)
+    {
+      vt->param[i].x = origParams[i];
+    }
+    calculateVocalTract(vt);
+    if (search != NULL)
+    {
+      search->numGeometryEvaluations++;
+    }
+    return false;
+  }
+
+  // ****************************************************************
+  // Find the transition position where the minimum area is the
+  // given release are using the bisection method.
+  // ****************************************************************
+
+  const double AREA_TOLERANCE_CM2 = 0.001;    // = 0.1 mm^2
+  const int MAX_RUNS = 40;
+  int run = 0;
+  double intervalBegin = 0.0;
+  double intervalEnd = 1.0;
+  double intervalMidpoint = 0.5;
+  double minAreaIntervalBegin = minAreaConsonant_cm2;
+  double minAreaIntervalEnd = minAreaVowel_cm2;
+  double minAreaIntervalMidpoint = 0.0;
+
+  bool solutionFound = false;
+
+  // ****************************************************************
+  // Warm start: Begin at the release position of the previous search
+  // and step towards the release area with doubling step sizes, 
+  // until the step leaves the interval that is known to contain the 
+  // solution. The shapes of successive searches during an 
+  // optimization differ only a little, so that the interval is much
+  // smaller than the whole transition when the bisection starts.
+  // ****************************************************************
+
+  bool isWarmStart = (search != NULL) && 
+    (search->lastReleasePos > 0.0) && (search->lastReleasePos < 1.0);
+
+  if (isWarmStart)
+  {
+    const double INITIAL_STEP = 1.0 / 64.0;
+    double step = INITIAL_STEP;
+    double pos = search->lastReleasePos;
+
+    while ((run < MAX_RUNS) && (solutionFound == false) && 
+      (pos > intervalBegin) && (pos < intervalEnd))
+    {
+      intervalMidpoint = pos;
+      minAreaIntervalMidpoint = getTransitionMinArea_cm2(vt, consonantParams, vowelParams, 
+        intervalMidpoint, startPos_cm, endPos_cm);
+
+      if (fabs(minAreaIntervalMidpoint - releaseArea_cm2) < AREA_TOLERANCE_CM2)
+      {
+        solutionFound = true;
+      }
+
+      if (minAreaIntervalMidpoint < releaseArea_cm2)
+      {
+        intervalBegin = intervalMidpoint;
+        minAreaIntervalBegin = minAreaIntervalMidpoint;
+        pos = intervalMidpoint + step;
+      }
+      else
+      {
+        intervalEnd = intervalMidpoint;
+        minAreaIntervalEnd = minAreaIntervalMidpoint;
+        pos = intervalMidpoint - step;
+      }
+
+      step*= 2.0;
+      run++;
+    }
+  }
+
+  // ****************************************************************
+  // Bisection.
+  // ****************************************************************
+
+  while ((run < MAX_RUNS) && (solutionFound == false))
+  {
+    intervalMidpoint = 0.5*(intervalBegin + intervalEnd);
+
+    // Find the min. area at the interval midpoint in the region
+    // between startPos_cm and endPos_cm in the area function.
+
+    minAreaIntervalMidpoint = getTransitionMinArea_cm2(vt, consonantParams, vowelParams, 
+      intervalMidpoint, startPos_cm, endPos_cm);
+
+    if (fabs(minAreaIntervalMidpoint - releaseArea_cm2) < AREA_TOLERANCE_CM2)
+    {
+      solutionFound = true;
+    }
+
+    // Change either the beginning or the end of the interval.
+
+    if (minAreaIntervalMidpoint < releaseArea_cm2)
+    {
+      intervalBegin = intervalMidpoint;
+      minAreaIntervalBegin = minAreaIntervalMidpoint;
+    }
+    else
+    {
+      intervalEnd = intervalMidpoint;
+      minAreaIntervalEnd = minAreaIntervalMidpoint;
+    }
+
+    run++;
+  }
+
+  // Set the return values.
+
+  releasePos = intervalMidpoint;
+  releaseArea_cm2 = minAreaIntervalMidpoint;
+
+  for (i=0; i < VocalTract::NUM_PARAMS; i++)
+  {
+    releaseParams[i] = vt->param[i].x;
+  }
+
+  if (search != NULL)
+  {
+    search->lastReleasePos = releasePos;
+    search->numGeometryEvaluations+= run;
+    if (isWarmStart)
+    {
+      search->numWarmSearches++;
+      search->numWarmRuns+= run;
+    }
+    else
+    {
+      search->numColdSearches++;
+      search->numColdRuns+= run;
+    }
+  }
+
+//  printf("runs: %d  is: %f cm2  target: %f cm2\n", run, minAreaIntervalMidpoint, releaseArea_cm2);
+
+  return true;
+}
+
+
+// ****************************************************************************
+/// Returns the min. area between startPos_cm and endPos_cm of the vocal tract
+/// shape at the position transitionPos (0.0 ... 1.0) on the linear transition
+/// from the given consonant to the given vowel shape.
+// ****************************************************************************
+
+double Data::getTransitionMinArea_cm2(VocalTract *vt, double *consonantParams, double *vowelParams,
+  double transitionPos, double startPos_cm, double endPos_cm)
+{
+  int i;
+  for (i=0; i < VocalTract::NUM_PARAMS; i++)
+  {
+    vt->param[i].x = (1.0-transitionPos)*consonantParams[i] + transitionPos*vowelParams[i];
+  }
+  return getMinArea_cm2(vt, startPos_cm, endPos_cm);
+}
+
+
+// ****************************************************************************
+/// Resets the warm start data and the statistics of the release shape search.
+// ****************************************************************************
+
+void Data::ReleaseSearch::reset()
+{
+  lastReleasePos = -1.0;
+  minAreaVowel_cm2 = 0.0;
+  hasVowelArea = false;
+
+  numColdSearches = 0;
+  numWarmSearches = 0;
+  numColdRuns = 0;
+  numWarmRuns = 0;
+  numGeometryEvaluations = 0;
+  numCachedVowelAreas = 0;
+}
+
+
+// ****************************************************************************
+/// Adds the statistics of the given search to the statistics of this one.
+// ****************************************************************************
+
+void Data::ReleaseSearch::addStatistics(const ReleaseSearch &search)
+{
+  numColdSearches+= search.numColdSearches;
+  numWarmSearches+= search.numWarmSearches;
+  numColdRuns+= search.numColdRuns;
+  numWarmRuns+= search.numWarmRuns;
+  numGeometryEvaluations+= search.numGeometryEvaluations;
+  numCachedVowelAreas+= search.numCachedVowelAreas;
+}
+
+
+// ****************************************************************************
+/// Returns the (estimated) number of geometry evaluations that were saved by
+/// the cached vowel area and by the warm starts. For the warm starts, the
+/// number of saved runs is estimated from the mean number of runs of the
+/// cold-started searches.
+// ****************************************************************************
+
+int Data::ReleaseSearch::getNumSavedEvaluations() const
+{
+  int numSaved = numCachedVowelAreas;
+
+  if ((numColdSearches > 0) && (numWarmSearches > 0))
+  {
+    double meanColdRuns = (double)numColdRuns / (double)numColdSearches;
+    int numSavedRuns = (int)(meanColdRuns*numWarmSearches + 0.5) - numWarmRuns;
+    if (numSavedRuns > 0)
+    {
+      numSaved+= numSavedRuns;
+    }
+  }
+
+  return numSaved;
+}
+
+
+// ****************************************************************************
+/// This function adjusts the parameters of the given vocal tract as long as
+/// the minimal cross-sectional area is smaller than the recommended minimal
+/// area for vowels.
+// ****************************************************************************
+
+void Data::createMinVocalTractArea(wxWindow *updateParent, VocalTract *tract, double minAdvisedArea_cm2,
+  double skipRegionStart_cm, double skipRegionEnd_cm)
+{
+  const int MAX_RUNS = 30;
+
+  int i;
+  double minArea_cm2;
+  int numRuns = 0;
+  int bestParam = -1;
+  double bestParamChange = 0.0;
+  double bestAreaChange = 0.0;
+  double currParamValue = 0.0;
+  double currMinArea_cm2 = 0.0;
+  double deltaMinArea_cm2 = 0.0;
+  char st[1024];
+  wxCommandEvent event(updateRequestEvent);
+  
+  VocalTractDialog *vocalTractDialog = VocalTractDialog::getInstance(NULL);
+
+  // ****************************************************************
+  // Determine the change step (increment) for the individual 
+  // parameters.
+  // ****************************************************************
+
+  const double STEP_SIZE_CM = 0.025;   // = 1/4 mm
+  double changeStep[VocalTract::NUM_PARAMS];
+
+  for (i=0; i < VocalTract::NUM_PARAMS; i++)
+  {
+    changeStep[i] = 0.0;
+  }
+
+  changeStep[VocalTract::HX] = STEP_SIZE_CM / 1.5;
+  changeStep[VocalTract::HY] = STEP_SIZE_CM;
+  changeStep[VocalTract::JX] = STEP_SIZE_CM;
+  changeStep[VocalTract::JA] = 0.05;    // -5 .. 0 deg
+  changeStep[VocalTract::LP] = 0.05;    // -1 .. +1
+  changeStep[VocalTract::LD] = STEP_SIZE_CM;
+  changeStep[VocalTract::VS] = 1.0 / (0.5/STEP_SIZE_CM);   // 0 .. 1 corr. to diff. of 0.5 cm
+
+  changeStep[VocalTract::TCX] = STEP_SIZE_CM;
+  changeStep[VocalTract::TCY] = STEP_SIZE_CM;
+  changeStep[VocalTract::TTX] = STEP_SIZE_CM;
+  changeStep[VocalTract::TTY] = STEP_SIZE_CM;
+
+  changeStep[VocalTract::TBX] = STEP_SIZE_CM;
+  changeStep[VocalTract::TBY] = STEP_SIZE_CM;
+  changeStep[VocalTract::TRX] = STEP_SIZE_CM;
+  changeStep[VocalTract::TRY] = STEP_SIZE_CM;
+
+  changeStep[VocalTract::TS1] = 0.05;    // -1 .. +1
+  changeStep[VocalTract::TS2] = 0.05;    // -1 .. +1
+  changeStep[VocalTract::TS3] = 0.05;    // -1 .. +1
+
+  // ****************************************************************
+  // Init. the progress dialog.
+  // ****************************************************************
+
+  wxGenericProgressDialog progressDialog("Please wait", "The correction is running...",
+    MAX_RUNS, NULL, wxPD_CAN_ABORT | wxPD_APP_MODAL | wxPD_AUTO_HIDE);
+
+  bool doContinue = true;
+
+  // ****************************************************************
+  // The main loop.
+  // ****************************************************************
+
+  // Get the initial min area.
+  minArea_cm2 = getMinAreaOutsideConstriction_cm2(tract, skipRegionStart_cm, skipRegionEnd_cm);
+  //getVowelFormants(tract, F1, F2, F3, minArea_cm2);
+
+  while ((minArea_cm2 < minAdvisedArea_cm2) && (numRuns < MAX_RUNS) && (doContinue))
+  {
+    currMinArea_cm2 = minArea_cm2;
+
+    // **************************************************************
+    // Find the parameter for which an incremental change in either
+    // of both directions gives the most increae of the minimal area.
+    // **************************************************************
+
+    bestParam = -1;
+    bestParamChange = 0.0;
+    bestAreaChange = 0.0;
+
+    for (i=0; i < VocalTract::NUM_PARAMS; i++)
+    {
+      currParamValue = tract->param[i].x;
+
+      if (changeStep[i] > 0.0)
+      {
+        // Apply a POSITIVE change to parameter i.
+        
+        tract->param[i].x = currParamValue + changeStep[i];
+//        getVowelFormants(tract, F1, F2, F3, minArea_cm2);
+        minArea_cm2 = getMinAreaOutsideConstriction_cm2(tract, skipRegionStart_cm, skipRegionEnd_cm);
+        deltaMinArea_cm2 = minArea_cm2 - currMinArea_cm2;
+
+        if (deltaMinArea_cm2 > bestAreaChange)
+        {
+          bestParam = i;
+          bestParamChange = changeStep[i];
+          bestAreaChange = deltaMinArea_cm2;
+        }
+
+        // Apply a NEGATIVE change to parameter i.
+        
+        tract->param[i].x = currParamValue - changeStep[i];
+//        getVowelFormants(tract, F1, F2, F3, minArea_cm2);
+        minArea_cm2 = getMinAreaOutsideConstriction_cm2(tract, skipRegionStart_cm, skipRegionEnd_cm);
+        deltaMinArea_cm2 = minArea_cm2 - currMinArea_cm2;
+
+        if (deltaMinArea_cm2 > bestAreaChange)
+        {
+          bestParam = i;
+          bestParamChange = -changeStep[i];
+          bestAreaChange = deltaMinArea_cm2;
+        }
+
+        // Set the parameter value back to its original value.
+        tract->param[i].x = currParamValue;
+      }
+    }
+
+    // **************************************************************
+    // Change the parameter with the best error reduction.
+    // **************************************************************
+
+    sprintf(st, "no change");
+
+    if (bestParam != -1)
+    {
+      tract->param[bestParam].x+= bestParamChange;
+
+      if (bestParamChange > 0.0)
+      {
+        sprintf(st, "%s up.", tract->param[bestParam].name.c_str());
+      }
+      else
+      {
+        sprintf(st, "%s down.", tract->param[bestParam].name.c_str());
+      }
+    }
+
+    // Get the minimal area after the latest change.
+//    getVowelFormants(tract, F1, F2, F3, minArea_cm2);
+    minArea_cm2 = getMinAreaOutsideConstriction_cm2(tract, skipRegionStart_cm, skipRegionEnd_cm);
+
+    printf("Run %d: %s. Min area=%2.2f cm^2\n", numRuns, st, minArea_cm2);
+    
+    // Terminate the loop when there was no improvement.
+    if (bestAreaChange <= 0.0)
+    {
+      numRuns = MAX_RUNS;
+    }
+
+    // Update the pictures on the parent page.
+
+    if (updateParent != NULL)
+    {
+      event.SetInt(UPDATE_PICTURES_AND_CONTROLS);
+      wxPostEvent(updateParent, event);
+      
+      if (vocalTractDialog->IsShown())
+      {
+        vocalTractDialog->Refresh();
+        vocalTractDialog->Update();
+      }
+
+      wxYield();
+    }
+
+    doContinue = progressDialog.Update(numRuns);
+
+    numRuns++;
+  }
+}
+
+
+// ****************************************************************************
+/// Returns the mean squared difference between the current and the target
+/// formant values. If a target formant value is zero, it is not included in 
+/// the calculation ("don't care" value).
+// ****************************************************************************
+
+double Data::getFormantError(double currentF1, double currentF2, 
+  double currentF3, double targetF1, double targetF2, double targetF3)
+{
+  const double EPSILON = 1.0;
+  double e = 0.0;
+  int numIncludedFormants = 0;
+
+  if (targetF1 >= EPSILON)
+  {
+    e += (1.0 - currentF1 / targetF1) * (1.0 - currentF1 / targetF1);
+    numIncludedFormants++;
+  }
+
+  if (targetF2 >= EPSILON)
+  {
+    e += (1.0 - currentF2 / targetF2) * (1.0 - currentF2 / targetF2);
+    numIncludedFormants++;
+  }
+
+  if (targetF3 >= EPSILON)
+  {
+    e += (1.0 - currentF3 / targetF3) * (1.0 - currentF3 / targetF3);
+    numIncludedFormants++;
+  }
+
+  if (numIncludedFormants >= 1)
+  {
+    e /= (double)numIncludedFormants;
+  }
+  else
+  {
+    e = 0.0;
+  }
+
+  e = sqrt(e);
+  e = e*100.0;    // The result is in percent
+
+  return e;
+}
+
+
+// ****************************************************************************
+/// Calculates the first three formants of the given vocal tract and the 
+/// minimum area of the corresponding area function. If the minimum area is 
+/// below a certain threshold, the formant values may not be useful.
+/// \param tract The vocal tract with adjusted variables.
+/// \param F1 Returns the first formant frequency.
+/// \param F2 Returns the second formant frequency.
+/// \param F3 Returns the third formant frequency.
+/// \param minArea_cm2 Returns the minimum area of the area function.
+// ****************************************************************************
+
+bool Data::getVowelFormants(VocalTract *tract, double &F1_Hz, double &F2_Hz, double &F3_Hz, double &minArea_cm2)
+{
+  const int MAX_FORMANTS = 3;
+  double formantFreq[MAX_FORMANTS];
+  double formantBw[MAX_FORMANTS];
+  int numFormants;
+  bool frictionNoise;
+  bool isClosure;
+  bool isNasal;
+  int i;
+
+  // Default return values.
+  F1_Hz = 0.0;
+  F2_Hz = 0.0;
+  F3_Hz = 0.0;
+  minArea_cm2 = 0.0;
+
+  // The velo-pharyngeal port must be closed.
+  if (tract->param[VocalTract::VO].x > 0.0)
+  {
+    tract->param[VocalTract::VO].x = 0.0;
+  }
+
+  // Calculate the vocal tract area function.
+  calculateVocalTract(tract);
+
+  // Set the latest vocal tract geometry for the transmission line model.   
+  updateTlModelGeometry(tract);
+
+  // Find the minimum cross-sectional area.
+  minArea_cm2 = 10000.0;    // = extremely high
+  for (i = 0; i < VocalTract::NUM_TUBE_SECTIONS; i++)
+  {
+    if (tract->tubeSection[i].area < minArea_cm2)
+    {
+      minArea_cm2 = tract->tubeSection[i].area;
+    }
+  }
+
+  // Get the formant data.
+  tlModel->getFormants(formantFreq, formantBw, numFormants, MAX_FORMANTS, frictionNoise, isClosure, isNasal);
+  if (numFormants < MAX_FORMANTS)
+  {
+    return false;
+  }
+
+  F1_Hz = formantFreq[0];
+  F2_Hz = formantFreq[1];
+  F3_Hz = formantFreq[2];
+
+  return true;
+}
+
+
+// ****************************************************************************
+/// Calculates the first three formants of the given consonantal vocal tract 
+/// when it is shifted towards the given context vowel target until the minimal
+/// cross-sectional area is releaseArea_cm2.
+/// When model is not NULL, the formants are calculated with this model
+/// instead of the main TL model, and when search is not NULL, the release
+/// shape search is warm-started from the previous search.
+// ****************************************************************************
+
+bool Data::getConsonantFormants(VocalTract *tract, const wxString &contextVowel, 
+	double releaseArea_cm2,	double &F1_Hz, double &F2_Hz, double &F3_Hz, TlModel *model,
+  ReleaseSearch *search)
+{
+  int i;
+  double consonantParams[VocalTract::NUM_PARAMS];
+  double vowelParams[VocalTract::NUM_PARAMS];
+  double releaseParams[VocalTract::NUM_PARAMS];
+  double releasePos;
+
+  // ****************************************************************
+  // Init the return parameters for the error case.
+  // ****************************************************************
+  
+  F1_Hz = 0.0;
+  F2_Hz = 0.0;
+  F3_Hz = 0.0;
+
+  // ****************************************************************
+  // Fill in the parameter values for the consonant, vowel, and 
+  // release shape.
+  // ****************************************************************
+
+  int vowelIndex = tract->getShapeIndex(contextVowel.ToStdString());
+  if (vowelIndex == -1)
+  {
+    return false;
+  }
+
+  for (i=0; i < VocalTract::NUM_PARAMS; i++)
+  {
+    consonantParams[i] = tract->param[i].x;
+    vowelParams[i] = tract->shapes[vowelIndex].param[i];
+    releaseParams[i] = tract->param[i].neutral;   // Default for error case.
+  }
+
+  // ****************************************************************
+  // Determine the vocal tract params for the release area.
+  // ****************************************************************
+
+  if (getReleaseShape(tract, consonantParams, vowelParams, releaseParams, 
+    releasePos, releaseArea_cm2, search) == false)
+  {
+    // Error: Set back the original parameters in the vocal tract 
+    // model and return.
+    for (i=0; i < VocalTract::NUM_PARAMS; i++)
+    {
+      tract->param[i].x = consonantParams[i];
+    }
+    calculateVocalTract(tract);
+    if (search != NULL)
+    {
+      search->numGeometryEvaluations++;
+    }
+
+    return false;
+  }
+   
+  // ****************************************************************
+  // For the release shape, determine the first three formants.
+  // ****************************************************************
+
+  const int MAX_FORMANTS = 3;
+  double formantFreq[MAX_FORMANTS];
+  double formantBw[MAX_FORMANTS];
+  int numFormants;
+  bool frictionNoise;
+  bool isClosure;
+  bool isNasal;
+
+  // Set the release shape params for the vocal tract model.
+  for (i=0; i < VocalTract::NUM_PARAMS; i++)
+  {
+    tract->param[i].x = releaseParams[i];
+  }
+
+  // The velo-pharyngeal port must be closed.
+  if (tract->param[VocalTract::VO].x > 0.0)
+  {
+    tract->param[VocalTract::VO].x = 0.0;
+  }
+
+  // Calculate the vocal tract area function.
+  calculateVocalTract(tract);
+
+  // Set the latest vocal tract geometry for the transmission line model.
+  // A separate model (of a worker thread) gets the tube geometry 
+  // directly, because the spectrum cache belongs to the main model.
+
+  if (model == NULL)
+  {
+    updateTlModelGeometry(tract);
+    model = tlModel;
+  }
+  else
+  {
+    tract->getTube(&model->tube);
+    model->tube.setGlottisArea(0.0);
+  }
+
+  // Get the formant data.
+  model->getFormants(formantFreq, formantBw, numFormants, MAX_FORMANTS, frictionNoise, isClosure, isNasal);
+
+  // Set back the original parameters in the vocal tract model.
+
+  for (i=0; i < VocalTract::NUM_PARAMS; i++)
+  {
+    tract->param[i].x = consonantParams[i];
+  }
+  calculateVocalTract(tract);
+
+  if (search != NULL)
+  {
+    search->numGeometryEvaluations+= 2;
+  }
+
+  // Set the final formant values.
+
+  if (numFormants < MAX_FORMANTS)
+  {
+    return false;
+  }
+
+  F1_Hz = formantFreq[0];
+  F2_Hz = formantFreq[1];
+  F3_Hz = formantFreq[2];
+
+  return true;
+}
+
+
+// ****************************************************************************
+/// Returns the minimum cross-sectional area of the current vocal tract.
+/// It also calculates the area function of the vocal tract first.
+// ****************************************************************************
+
+double Data::getMinArea_cm2(VocalTract *tract, double startPos_cm, double endPos_cm)
+{
+  int i;
+
+  // Calculate the vocal tract area function.
+  calculateVocalTract(tract);
+
+  // Find the minimum cross-sectional area.
+  double minArea_cm2 = 10000.0;    // = extremely high
+
+  for (i=0; i < VocalTract::NUM_CENTERLINE_POINTS; i++)
+  {
+    if ((tract->crossSection[i].pos >= startPos_cm) &&
+        (tract->crossSection[i].pos <= endPos_cm) &&
+        (tract->crossSection[i].area < minArea_cm2))
+    {
+      minArea_cm2 = tract->crossSection[i].area;
+    }
+  }
+
+  return minArea_cm2;
+}
+
+
+// ****************************************************************************
+/// Returns the minimum cross-sectional area of the current vocal tract outside
+/// the given region.
+/// It also calculates the area function of the vocal tract first.
+// ****************************************************************************
+
+double Data::getMinAreaOutsideConstriction_cm2(VocalTract *tract, double constrictionStartPos_cm, double constrictionEndPos_cm)
+{
+  int i;
+
+  // Calculate the vocal tract area function.
+  calculateVocalTract(tract);
+
+  // Find the minimum cross-sectional area.
+  double minArea_cm2 = 10000.0;    // = extremely high
+
+  for (i=0; i < VocalTract::NUM_CENTERLINE_POINTS; i++)
+  {
+    if (((tract->crossSection[i].pos < constrictionStartPos_cm) ||
+        (tract->crossSection[i].pos > constrictionEndPos_cm)) &&
+        (tract->crossSection[i].area < minArea_cm2))
+    {
+      minArea_cm2 = tract->crossSection[i].area;
+    }
+  }
+
+  return minArea_cm2;
+}
+
+
+// ****************************************************************************
+/// Returns a new vocal tract with the same anatomy, shapes, and parameter
+/// values as the given one, or NULL, if it could not be created. The anatomy
+/// and the shapes are passed via a temporary speaker file, which is written
+/// with the full precision of the doubles, so that the numbers are read back
+/// exactly. The caller must delete the returned object.
+// ****************************************************************************
+
+VocalTract *Data::cloneVocalTract(VocalTract *source)
+{
+  int i;
+  wxString fileName = wxFileName::CreateTempFileName("vtl");
+  if (fileName.IsEmpty())
+  {
+    return NULL;
+  }
+
+  ofstream os(fileName.ToStdString());
+  if (!os)
+  {
+    wxRemoveFile(fileName);
+    return NULL;
+  }
+
+  os << setprecision(numeric_limits<double>::max_digits10);
+  os << "<speaker>" << endl;
+  source->writeToXml(os, 2);
+  os << "</speaker>" << endl;
+  os.close();
+
+  VocalTract *clone = new VocalTract();
+
+  try
+  {
+    clone->readFromXml(fileName.ToStdString());
+  }
+  catch (std::string st)
+  {
+    wxPrintf("%s\n", st.c_str());
+    wxPrintf("Error: Failed to clone the vocal tract model.\n");
+    delete clone;
+    wxRemoveFile(fileName);
+    return NULL;
+  }
+
+  wxRemoveFile(fileName);
+
+  for (i=0; i < VocalTract::NUM_PARAMS; i++)
+  {
+    clone->param[i].x = source->param[i].x;
+  }
+  clone->calculateAll();
+
+  return clone;
+}
+
+
+// ****************************************************************************
+/// Creates the vocal tracts for the given number of workers of a parallel 
+/// job and returns how many were created (at least one, or 0 on failure). 
+/// Every worker gets a copy made with cloneVocalTract(...) and none gets the
+/// source itself, so that the result of an item does not depend on the 
+/// worker that calculates it, and hence not on the number of workers.
+/// The tracts must be freed with deleteWorkerTracts(...).
+// ****************************************************************************
+
+int Data::createWorkerTracts(VocalTract *source, int numWorkers, vector<VocalTract*> &tracts)
+{
+  int i;
+
+  tracts.clear();
+  for (i=0; i < numWorkers; i++)
+  {
+    VocalTract *clone = cloneVocalTract(source);
+    if (clone == NULL)
+    {
+      break;
+    }
+    tracts.push_back(clone);
+  }
+
+  return (int)tracts.size();
+}
+
+
+// ****************************************************************************
+/// Frees the vocal tracts created with createWorkerTracts(...).
+// ****************************************************************************
+
+void Data::deleteWorkerTracts(vector<VocalTract*> &tracts)
+{
+  int i;
+  for (i=0; i < (int)tracts.size(); i++)
+  {
+    delete tracts[i];
+  }
+  tracts.clear();
+}
+
+
+// ****************************************************************************
+/// Calculates the quick rendering and the EMA trajectories of all EMA points
+/// of the given gestural score once with a single worker and once with the
+/// maximal number of workers, and returns true, if the results are bitwise
+/// identical.
+// ****************************************************************************
+
+bool Data::compareWorkerCounts(GesturalScore *score)
+{
+  const double EMA_FRAME_RATE_HZ = 200.0;
+  int numWorkers[2] = { 1, ParallelJob::getMaxNumWorkers() };
+  vector<double> audio[2];
+  vector<double> coord[2];
+  vector<int> pointIndices;
+  int numFrames[2];
+  bool ok = true;
+  int k;
+
+  getEmaPointIndices("", pointIndices);
+
+  for (k=0; (k < 2) && (ok); k++)
+  {
+    ParallelJob::setMaxNumWorkers(numWorkers[k]);
+    if ((quickRenderGesturalScore(score, lfPulse, audio[k]) == false) ||
+      (calcEmaTrajectories(score, EMA_FRAME_RATE_HZ, pointIndices, coord[k], numFrames[k]) == false))
+    {
+      ok = false;
+    }
+  }
+  ParallelJob::setMaxNumWorkers(0);
+
+  if (ok == false)
+  {
+    wxPrintf("Error: The calculation with %d worker(s) failed.\n", numWorkers[k-1]);
+    return false;
+  }
+
+  bool audioEqual = (audio[0] == audio[1]);
+  bool coordEqual = (numFrames[0] == numFrames[1]) && (coord[0] == coord[1]);
+
+  wxPrintf("Comparison of 1 and %d worker(s):\n", numWorkers[1]);
+  wxPrintf("  Quick rendering (%d samples): %s\n", (int)audio[0].size(), 
+    audioEqual ? "identical" : "DIFFERENT");
+  wxPrintf("  EMA trajectories (%d points, %d frames): %s\n", (int)pointIndices.size(), 
+    numFrames[0], coordEqual ? "identical" : "DIFFERENT");
+
+  return (audioEqual && coordEqual);
+}
+
+
+// ****************************************************************************
+/// Returns a new glottis model of the given type (GlottisModel) with the same
+/// static parameters, shapes and control parameter values as the one used by
+/// this program, or NULL, if it could not be created. The data are passed via
+/// a temporary XML file like in the speaker file. The caller must delete the
+/// returned object.
+// ****************************************************************************
+
+Glottis *Data::cloneGlottis(int index)
+{
+  int i;
+
+  if ((index < 0) || (index >= NUM_GLOTTIS_MODELS))
+  {
+    return NULL;
+  }
+
+  Glottis *clone = SynthesisContext::createGlottis(index);
+
+  wxString fileName = wxFileName::CreateTempFileName("vtl");
+  if (fileName.IsEmpty())
+  {
+    delete clone;
+    return NULL;
+  }
+
+  ofstream os(fileName.ToStdString());
+  if (!os)
+  {
+    wxRemoveFile(fileName);
+    delete clone;
+    return NULL;
+  }
+
+  os << "<glottis_models>" << endl;
+  glottis[index]->writeToXml(os, 2, true);
+  os << "</glottis_models>" << endl;
+  os.close();
+
+  vector<XmlError> xmlErrors;
+  XmlNode *rootNode = xmlParseFile(fileName.ToStdString(), "glottis_models", &xmlErrors);
+  wxRemoveFile(fileName);
+
+  if ((rootNode == NULL) || (rootNode->childElement.size() < 1) || 
+    (clone->readFromXml(*rootNode->childElement[0]) == false))
+  {
+    xmlPrintErrors(xmlErrors);
+    wxPrintf("Error: Failed to clone the glottis model %d.\n", index);
+    delete rootNode;
+    delete clone;
+    return NULL;
+  }
+  delete rootNode;
+
+  for (i=0; (i < (int)clone->controlParam.size()) && (i < (int)glottis[index]->controlParam.size()); i++)
+  {
+    clone->controlParam[i].x = glottis[index]->controlParam[i].x;
+  }
+
+  return clone;
+}
+
+
+// ****************************************************************************
+/// Returns a new synthesis context with copies of the current vocal tract,
+/// glottis models and TDS options, or NULL, if it could not be created. The
+/// caller must delete the returned object.
+// ****************************************************************************
+
+SynthesisContext *Data::createSynthesisContext()
+{
+  int i;
+  Glottis *glottisCopy[NUM_GLOTTIS_MODELS];
+  VocalTract *tractCopy = cloneVocalTract(vocalTract);
+  bool ok = (tractCopy != NULL);
+
+  for (i=0; i < NUM_GLOTTIS_MODELS; i++)
+  {
+    glottisCopy[i] = cloneGlottis(i);
+    if (glottisCopy[i] == NULL)
+    {
+      ok = false;
+    }
+  }
+
+  if (ok == false)
+  {
+    delete tractCopy;
+    for (i=0; i < NUM_GLOTTIS_MODELS; i++)
+    {
+      delete glottisCopy[i];
+    }
+    return NULL;
+  }
+
+  SynthesisContext *context = new SynthesisContext();
+  context->setModels(tractCopy, glottisCopy, selectedGlottis);
+  context->tdsModel->options = tdsModel->options;
+
+  return context;
+}
+
+
+// ****************************************************************************
+/// Resets the parameter snapshot and the statistics of the calculation.
+// ****************************************************************************
+
+void Data::TractCalculation::reset()
+{
+  int i;
+
+  isValid = false;
+  for (i=0; i < VocalTract::NUM_PARAMS; i++)
+  {
+    inputParams[i] = 0.0;
+    outputParams[i] = 0.0;
+  }
+
+  numCalculations = 0;
+  numSkippedCalculations = 0;
+  calculationTime_ms = 0.0;
+}
+
+
+// ****************************************************************************
+/// Returns true, if the geometry of the tract corresponds to its current
+/// parameters, i.e., if the parameters equal the requested or the resulting
+/// parameters of the last calculation.
+// ****************************************************************************
+
+bool Data::TractCalculation::isUpToDate()
+{
+  int i;
+  bool inputChanged = false;
+  bool outputChanged = false;
+
+  if (isValid == false)
+  {
+    return false;
+  }
+
+  for (i=0; i < VocalTract::NUM_PARAMS; i++)
+  {
+    if (tract->param[i].x != inputParams[i])
+    {
+      inputChanged = true;
+    }
+    if (tract->param[i].x != outputParams[i])
+    {
+      outputChanged = true;
+    }
+  }
+
+  return ((inputChanged == false) || (outputChanged == false));
+}
+
+
+// ****************************************************************************
+/// Calculates the geometry of the given vocal tract from its current
+/// parameters. For the main vocal tract, the calculation is skipped when no
+/// parameter changed since the last call (the anatomy is not tracked, so
+/// invalidateVocalTract() must be called when it changes). Therefore, the
+/// main vocal tract must always be calculated with this function and never
+/// with VocalTract::calculateAll() directly. Other vocal tracts (copies in 
+/// worker threads etc.) are always calculated.
+/// Returns true, if the geometry was calculated.
+// ****************************************************************************
+
+bool Data::calculateVocalTract(VocalTract *tract, bool forceCalculation)
+{
+  int i;
+  TractCalculation *c = &vocalTractCalculation;
+
+  if (tract != vocalTract)
+  {
+    tract->calculateAll();
+    return true;
+  }
+
+  if (c->tract != tract)
+  {
+    c->tract = tract;
+    c->isValid = false;
+  }
+
+  if ((forceCalculation == false) && (c->isUpToDate()))
+  {
+    c->numSkippedCalculations++;
+    return false;
+  }
+
+  for (i=0; i < VocalTract::NUM_PARAMS; i++)
+  {
+    c->inputParams[i] = tract->param[i].x;
+  }
+
+  wxStopWatch stopWatch;
+  tract->calculateAll();
+  c->calculationTime_ms+= stopWatch.TimeInMicro().ToDouble() / 1000.0;
+  c->numCalculations++;
+
+  for (i=0; i < VocalTract::NUM_PARAMS; i++)
+  {
+    c->outputParams[i] = tract->param[i].x;
+  }
+  c->isValid = true;
+  crossSections.invalidate();
+
+  return true;
+}
+
+
+// ****************************************************************************
+/// Marks the geometry of the main vocal tract as outdated, e.g., after a
+/// change of the anatomy, so that the next call of calculateVocalTract()
+/// calculates it. The checkpoints of the gestural score synthesis are 
+/// dropped, because they were calculated with the old geometry.
+// ****************************************************************************
+
+void Data::invalidateVocalTract()
+{
+  vocalTractCalculation.isValid = false;
+  crossSections.invalidate();
+  gesturalScoreCheckpoints.clear();
+}
+
+
+// ****************************************************************************
+/// Must be called after the main vocal tract was calculated outside of 
+/// calculateVocalTract(), i.e., by the backend while a gestural score was
+/// synthesized (GesturalScore::getTube() sets the parameters of the tract
+/// and calculates it for every step). The next call of calculateVocalTract()
+/// then calculates the tract even when its parameters equal those of the
+/// last calculation, and the cached cross-sections are dropped. In contrast to invalidateVocalTract(), the checkpoints
+/// of the gestural score synthesis are kept, because the anatomy did not 
+/// change.
+// ****************************************************************************
+
+void Data::vocalTractCalculatedExternally()
+{
+  vocalTractCalculation.isValid = false;
+  crossSections.invalidate();
+}
+
+
+// ****************************************************************************
+/// Measures the time for the calculation of the main vocal tract geometry
+/// when each single parameter changes, compared to a full calculation with
+/// unchanged parameters and to a skipped calculation. The results are
+/// printed to the console.
+// ****************************************************************************
+
+void Data::benchmarkVocalTractCalculation(int numRepetitions)
+{
+  int i, k;
+  double oldParams[VocalTract::NUM_PARAMS];
+  double delta;
+  double fullTime_ms;
+  double changedTime_ms;
+  double skippedTime_us;
+  double sumChangedTime_ms = 0.0;
+  wxStopWatch stopWatch;
+
+  if (numRepetitions < 1)
+  {
+    numRepetitions = 1;
+  }
+
+  for (i=0; i < VocalTract::NUM_PARAMS; i++)
+  {
+    oldParams[i] = vocalTract->param[i].x;
+  }
+
+  // ****************************************************************
+  // Full calculation with unchanged parameters and skipped 
+  // calculation.
+  // ****************************************************************
+
+  calculateVocalTract(vocalTract, true);
+
+  stopWatch.Start();
+  for (k=0; k < numRepetitions; k++)
+  {
+    calculateVocalTract(vocalTract, true);
+  }
+  fullTime_ms = stopWatch.TimeInMicro().ToDouble() / (1000.0*numRepetitions);
+
+  stopWatch.Start();
+  for (k=0; k < numRepetitions; k++)
+  {
+    calculateVocalTract(vocalTract);
+  }
+  skippedTime_us = stopWatch.TimeInMicro().ToDouble() / numRepetitions;
+
+  wxPrintf("Vocal tract calculation (%d repetitions each):\n", numRepetitions);
+  wxPrintf("  Full calculation:    %8.3f ms\n", fullTime_ms);
+  wxPrintf("  Skipped calculation: %8.3f us\n", skippedTime_us);
+  wxPrintf("  Change of a single parameter:\n");
+
+  // ****************************************************************
+  // Change one parameter at a time by +/- 5% of its range.
+  // ****************************************************************
+
+  for (i=0; i < VocalTract::NUM_PARAMS; i++)
+  {
+    delta = 0.05*(vocalTract->param[i].max - vocalTract->param[i].min);
+    if (oldParams[i] + delta > vocalTract->param[i].max)
+    {
+      delta = -delta;
+    }
+
+    stopWatch.Start();
+    for (k=0; k < numRepetitions; k++)
+    {
+      vocalTract->param[i].x = oldParams[i] + ((k % 2) == 0 ? delta : 0.0);
+      calculateVocalTract(vocalTract);
+    }
+    changedTime_ms = stopWatch.TimeInMicro().ToDouble() / (1000.0*numRepetitions);
+    sumChangedTime_ms+= changedTime_ms;
+
+    vocalTract->param[i].x = oldParams[i];
+    calculateVocalTract(vocalTract);
+
+    wxPrintf("  %-4s %8.3f ms (%5.1f %% of the full calculation)\n", 
+      wxString(vocalTract->param[i].name).c_str(), changedTime_ms, 
+      fullTime_ms > 0.0 ? 100.0*changedTime_ms / fullTime_ms : 0.0);
+  }
+
+  wxPrintf("  Mean: %8.3f ms\n", sumChangedTime_ms / VocalTract::NUM_PARAMS);
+  wxPrintf("Calculations so far: %d, skipped: %d, total time: %2.1f ms.\n",
+    vocalTractCalculation.numCalculations, vocalTractCalculation.numSkippedCalculations,
+    vocalTractCalculation.calculationTime_ms);
+}
+
+
+// ****************************************************************************
+/// Reset all buffers related to the time-domain synthesis.
+// ****************************************************************************
+
+void Data::resetTdsBuffers()
+{
+  int i;
+
+  for (i = 0; i < TDS_BUFFER_LENGTH; i++)
+  {
+    userProbeFlow[i] = 0.0;
+    userProbePressure[i] = 0.0;
+    userProbeArea[i] = 0.0;
+    userProbeVelocity[i] = 0.0;
+
+    internalProbeFlow[i] = 0.0;
+    internalProbePressure[i] = 0.0;
+
+    outputFlow[i] = 0.0;
+    outputPressure[i] = 0.0;
+    filteredOutputPressure[i] = 0.0;
+  }
+  
+  outputPressureFilter.resetBuffers();
+}
+
+
+// ****************************************************************************
+/// Returns an instance of the selected tube sequence (the kind of synthesis).
+// ****************************************************************************
+
+TubeSequence *Data::getSelectedTubeSequence()
+{
+  TubeSequence *ts = staticPhone;
+
+  switch (synthesisType)
+  {
+    case SYNTHESIS_SUBGLOTTAL_INPUT_IMPEDANCE:    ts = subglottalInputImpedance; break;
+    case SYNTHESIS_SUPRAGLOTTAL_INPUT_IMPEDANCE:  ts = supraglottalInputImpedance; break;
+    case SYNTHESIS_TRANSFER_FUNCTION:             ts = transferFunction; break;
+    case SYNTHESIS_LF_VOWEL:                      ts = vowelLf; break;
+    case SYNTHESIS_PHONE:                         ts = staticPhone; break;
+    case SYNTHESIS_GESMOD:                        ts = gesturalScore; break;
+    default: break;
+  }
+
+  return ts;
+}
+
+
+// ****************************************************************************
+/// Returns a pointer to the selected gesture in the editor, or NULL, if no 
+/// gesture is selected.
+// ****************************************************************************
+
+Gesture *Data::getSelectedGesture()
+{
+  if ((selectedGestureType >= 0) && (selectedGestureType < GesturalScore::NUM_GESTURE_TYPES))
+  {
+    GestureSequence *s = &gesturalScore->gestures[selectedGestureType];
+    if ((selectedGestureIndex >= 0) && (selectedGestureIndex < s->numGestures()))
+    {
+      return s->getGesture(selectedGestureIndex);
+    }
+  }
+  
+  return NULL;
+}
+
+
+// ****************************************************************************
+/// Returns the currently selected glottis.
+// ****************************************************************************
+
+Glottis *Data::getSelectedGlottis()
+{
+  return glottis[selectedGlottis];
+}
+
+// ****************************************************************************
+/// Returns the index of the selected glottis.
+// ****************************************************************************
+
+int Data::getSelectedGlottisIndex()
+{
+  return selectedGlottis;
+}
+
+// ****************************************************************************
+/// Set the selected glottis in a save way.
+// ****************************************************************************
+
+void Data::selectGlottis(int index)
+{
+  if (index < 0)
+  {
+    index = 0;
+  }
+  if (index >= NUM_GLOTTIS_MODELS)
+  {
+    index = NUM_GLOTTIS_MODELS - 1;
+  }
+
+  selectedGlottis = index;
+  // Also set the glottis for the gestural score !
+  gesturalScore->glottis = glottis[index];
+}
+
+
+// ****************************************************************************
+// Updates the geometry data in the TL-model of the vocal tract.
+// ****************************************************************************
+
+void Data::updateTlModelGeometry(VocalTract *tract)
+{
+  int i;
+  Tube::Section *ts = NULL;
+
+  tract->getTube(&tlModel->tube);
+  tlModel->tube.setGlottisArea(0.0);
+
+  // ****************************************************************
+  // Find the span of tube sections that differ from the geometry of
+  // the cached spectra.
+  // ****************************************************************
+
+  tlFirstChangedSection = -1;
+  tlLastChangedSection = -1;
+
+  for (i = 0; i < Tube::NUM_SECTIONS; i++)
+  {
+    ts = tlModel->tube.section[i];
+    if ((ts->area_cm2 != tlCacheSectionArea_cm2[i]) ||
+      (ts->length_cm != tlCacheSectionLength_cm[i]) ||
+      ((int)ts->articulator != tlCacheSectionArticulator[i]))
+    {
+      if (tlFirstChangedSection == -1)
+      {
+        tlFirstChangedSection = i;
+      }
+      tlLastChangedSection = i;
+
+      tlCacheSectionArea_cm2[i] = ts->area_cm2;
+      tlCacheSectionLength_cm[i] = ts->length_cm;
+      tlCacheSectionArticulator[i] = (int)ts->articulator;
+    }
+  }
+
+  if (tlFirstChangedSection == -1)
+  {
+    return;
+  }
+
+  tlCacheGeneration++;
+
+  // ****************************************************************
+  // The radiation characteristic only depends on the mouth and nose
+  // openings and is kept when neither of them changed. All other
+  // spectra depend on the whole tube.
+  // ****************************************************************
+
+  bool openingsChanged =
+    ((tlFirstChangedSection <= Tube::LAST_MOUTH_SECTION) && (tlLastChangedSection >= Tube::LAST_MOUTH_SECTION)) ||
+    ((tlFirstChangedSection <= Tube::LAST_NOSE_SECTION) && (tlLastChangedSection >= Tube::LAST_NOSE_SECTION));
+
+  i = 0;
+  while (i < (int)tlSpectrumCache.size())
+  {
+    if ((tlSpectrumCache[i].type == TlModel::RADIATION) && (openingsChanged == false))
+    {
+      i++;
+    }
+    else
+    {
+      delete tlSpectrumCache[i].spectrum;
+      tlSpectrumCache.erase(tlSpectrumCache.begin() + i);
+    }
+  }
+}
+
+
+// ****************************************************************************
+/// Returns the requested spectrum of the TL model. Spectra are cached until
+/// the tube geometry or the model options change, so that repeated requests
+/// (e.g., repaints of the spectrum picture or moving the cut plane) do not
+/// repeat the calculation.
+// ****************************************************************************
+
+void Data::getTlModelSpectrum(TlModel::SpectrumType type, ComplexSignal *spectrum,
+  int spectrumLength, int section)
+{
+  int i, k;
+  TlSpectrumCacheEntry *entry = NULL;
+
+  if (tlCacheOptionsChanged())
+  {
+    invalidateTlModelSpectra();
+  }
+
+  for (i = 0; (i < (int)tlSpectrumCache.size()) && (entry == NULL); i++)
+  {
+    if ((tlSpectrumCache[i].type == type) &&
+      (tlSpectrumCache[i].spectrumLength == spectrumLength) &&
+      (tlSpectrumCache[i].section == section))
+    {
+      entry = &tlSpectrumCache[i];
+    }
+  }
+
+  if (entry == NULL)
+  {
+    TlSpectrumCacheEntry newEntry;
+    newEntry.type = type;
+    newEntry.spectrumLength = spectrumLength;
+    newEntry.section = section;
+    newEntry.spectrum = new ComplexSignal(spectrumLength);
+    tlModel->getSpectrum(type, newEntry.spectrum, spectrumLength, section);
+
+    tlSpectrumCache.push_back(newEntry);
+    entry = &tlSpectrumCache.back();
+  }
+
+  spectrum->reset(entry->spectrum->N);
+  for (k = 0; k < entry->spectrum->N; k++)
+  {
+    spectrum->re[k] = entry->spectrum->re[k];
+    spectrum->im[k] = entry->spectrum->im[k];
+  }
+}
+
+
+// ****************************************************************************
+/// Discards all cached TL model spectra.
+// ****************************************************************************
+
+void Data::invalidateTlModelSpectra()
+{
+  int i;
+  for (i = 0; i < (int)tlSpectrumCache.size(); i++)
+  {
+    delete tlSpectrumCache[i].spectrum;
+  }
+  tlSpectrumCache.clear();
+  tlCacheOptions = tlModel->options;
+  tlCacheGeneration++;
+}
+
+
+// ****************************************************************************
+/// Returns the spectrum of the pole-zero plan like 
+/// PoleZeroPlan::getPoleZeroSpectrum(...). The contributions of the individual
+/// poles and zeros are kept (separately for each spectrum length), and only
+/// those of the poles and zeros that were moved since the last call are 
+/// recalculated.
+// ****************************************************************************
+
+void Data::getPoleZeroSpectrum(ComplexSignal *spectrum, int spectrumLength, double upperFrequencyLimit)
+{
+  // Rebuild all factors now and then to avoid the accumulation of
+  // rounding errors in the sums.
+  const int MAX_INCREMENTAL_UPDATES = 256;
+
+  int i, k;
+  int numPoles = (int)poleZeroPlan->poles.size();
+  int numZeros = (int)poleZeroPlan->zeros.size();
+  PoleZeroPlan::Location *location = NULL;
+  PoleZeroFactor *factor = NULL;
+  PoleZeroSpectrumCache *cache = NULL;
+
+  // Find the cache for this spectrum length or add a new one.
+  for (i = 0; i < (int)pzCache.size(); i++)
+  {
+    if (pzCache[i].spectrumLength == spectrumLength)
+    {
+      cache = &pzCache[i];
+      break;
+    }
+  }
+  if (cache == NULL)
+  {
+    pzCache.push_back(PoleZeroSpectrumCache());
+    cache = &pzCache.back();
+    cache->spectrumLength = spectrumLength;
+    cache->numPoles = -1;
+    cache->numZeros = -1;
+  }
+
+  if ((upperFrequencyLimit != cache->upperFrequencyLimit) ||
+    (numPoles != cache->numPoles) || (numZeros != cache->numZeros) ||
+    (cache->numIncrementalUpdates >= MAX_INCREMENTAL_UPDATES))
+  {
+    rebuildPoleZeroFactors(*cache, upperFrequencyLimit);
+  }
+  else
+  {
+    for (i = 0; i < numPoles + numZeros; i++)
+    {
+      factor = &cache->factor[i];
+      if (i < numPoles)
+      {
+        location = &poleZeroPlan->poles[i];
+      }
+      else
+      {
+        location = &poleZeroPlan->zeros[i - numPoles];
+      }
+
+      if ((location->freq_Hz != factor->location.freq_Hz) || (location->bw_Hz != factor->location.bw_Hz))
+      {
+        // Replace the old contribution of the factor by the new one.
+        for (k = 0; k < spectrumLength; k++)
+        {
+          cache->logMagnitudeSum[k] -= factor->logMagnitude[k];
+          cache->phaseSum[k] -= factor->phase[k];
+        }
+
+        factor->location = *location;
+        calcPoleZeroFactor(*factor, spectrumLength, upperFrequencyLimit);
+
+        for (k = 0; k < spectrumLength; k++)
+        {
+          cache->logMagnitudeSum[k] += factor->logMagnitude[k];
+          cache->phaseSum[k] += factor->phase[k];
+        }
+        cache->numIncrementalUpdates++;
+      }
+    }
+  }
+
+  // ****************************************************************
+  // Convert the sums into the complex spectrum.
+  // ****************************************************************
+
+  double magnitude;
+  spectrum->reset(spectrumLength);
+  for (k = 0; k < spectrumLength; k++)
+  {
+    magnitude = exp(cache->logMagnitudeSum[k]);
+    spectrum->re[k] = magnitude * cos(cache->phaseSum[k]);
+    spectrum->im[k] = magnitude * sin(cache->phaseSum[k]);
+  }
+}
+
+
+// ****************************************************************************
+/// Returns the higher pole correction of the pole-zero plan. It only depends
+/// on the number of poles, so that it is kept (separately for each spectrum
+/// length) while poles are moved.
+// ****************************************************************************
+
+void Data::getHigherPoleCorrection(ComplexSignal *spectrum, int spectrumLength, double effectiveLength_cm)
+{
+  int i, k;
+  int numPoles = (int)poleZeroPlan->poles.size();
+  HigherPoleCorrectionCache *cache = NULL;
+
+  for (i = 0; i < (int)pzHpcCache.size(); i++)
+  {
+    if (pzHpcCache[i].spectrumLength == spectrumLength)
+    {
+      cache = &pzHpcCache[i];
+      break;
+    }
+  }
+  if (cache == NULL)
+  {
+    pzHpcCache.push_back(HigherPoleCorrectionCache());
+    cache = &pzHpcCache.back();
+    cache->spectrumLength = spectrumLength;
+    cache->numPoles = -1;
+  }
+
+  if ((effectiveLength_cm != cache->effectiveLength_cm) || (numPoles != cache->numPoles))
+  {
+    ComplexSignal hpc(spectrumLength);
+    poleZeroPlan->getHigherPoleCorrection(&hpc, spectrumLength, effectiveLength_cm);
+    cache->re.resize(spectrumLength);
+    cache->im.resize(spectrumLength);
+    for (k = 0; k < spectrumLength; k++)
+    {
+      cache->re[k] = hpc.re[k];
+      cache->im[k] = hpc.im[k];
+    }
+    cache->effectiveLength_cm = effectiveLength_cm;
+    cache->numPoles = numPoles;
+  }
+
+  spectrum->reset(spectrumLength);
+  for (k = 0; k < spectrumLength; k++)
+  {
+    spectrum->re[k] = cache->re[k];
+    spectrum->im[k] = cache->im[k];
+  }
+}
+
+
+// ****************************************************************************
+/// Recalculates the contributions of all poles and zeros of the pole-zero 
+/// plan for the spectrum length of the given cache.
+// ****************************************************************************
+
+void Data::rebuildPoleZeroFactors(PoleZeroSpectrumCache &cache, double upperFrequencyLimit)
+{
+  int i, k;
+  int numPoles = (int)poleZeroPlan->poles.size();
+  int numZeros = (int)poleZeroPlan->zeros.size();
+  int spectrumLength = cache.spectrumLength;
+
+  cache.upperFrequencyLimit = upperFrequencyLimit;
+  cache.numPoles = numPoles;
+  cache.numZeros = numZeros;
+  cache.numIncrementalUpdates = 0;
+
+  cache.factor.resize(numPoles + numZeros);
+  cache.logMagnitudeSum.assign(spectrumLength, 0.0);
+  cache.phaseSum.assign(spectrumLength, 0.0);
+
+  for (i = 0; i < numPoles + numZeros; i++)
+  {
+    if (i < numPoles)
+    {
+      cache.factor[i].location = poleZeroPlan->poles[i];
+      cache.factor[i].isPole = true;
+    }
+    else
+    {
+      cache.factor[i].location = poleZeroPlan->zeros[i - numPoles];
+      cache.factor[i].isPole = false;
+    }
+    calcPoleZeroFactor(cache.factor[i], spectrumLength, upperFrequencyLimit);
+
+    for (k = 0; k < spectrumLength; k++)
+    {
+      cache.logMagnitudeSum[k] += cache.factor[i].logMagnitude[k];
+      cache.phaseSum[k] += cache.factor[i].phase[k];
+    }
+  }
+}
+
+
+// ****************************************************************************
+/// Calculates the log-magnitude and phase of a single pole or zero using a
+/// plan that contains only this pole or zero.
+// ****************************************************************************
+
+void Data::calcPoleZeroFactor(PoleZeroFactor &factor, int spectrumLength, double upperFrequencyLimit)
+{
+  // Avoid log(0) for zeros that lie exactly on a frequency sample.
+  const double MIN_MAGNITUDE = 1.0e-12;
+
+  int k;
+  int N = spectrumLength;
+  ComplexSignal s(N);
+  double magnitude;
+
+  pzSingleFactorPlan->poles.clear();
+  pzSingleFactorPlan->zeros.clear();
+  if (factor.isPole)
+  {
+    pzSingleFactorPlan->poles.push_back(factor.location);
+  }
+  else
+  {
+    pzSingleFactorPlan->zeros.push_back(factor.location);
+  }
+  pzSingleFactorPlan->getPoleZeroSpectrum(&s, N, upperFrequencyLimit);
+
+  factor.logMagnitude.resize(N);
+  factor.phase.resize(N);
+  for (k = 0; k < N; k++)
+  {
+    magnitude = s.getMagnitude(k);
+    if (magnitude < MIN_MAGNITUDE)
+    {
+      magnitude = MIN_MAGNITUDE;
+    }
+    factor.logMagnitude[k] = log(magnitude);
+    factor.phase[k] = s.getPhase(k);
+  }
+}
+
+
+// ****************************************************************************
+/// Returns true, if the options of the TL model differ from those of the
+/// cached spectra.
+// ****************************************************************************
+
+bool Data::tlCacheOptionsChanged()
+{
+  TlModel::Options *o = &tlModel->options;
+
+  return ((o->radiation != tlCacheOptions.radiation) ||
+    (o->boundaryLayer != tlCacheOptions.boundaryLayer) ||
+    (o->heatConduction != tlCacheOptions.heatConduction) ||
+    (o->softWalls != tlCacheOptions.softWalls) ||
+    (o->hagenResistance != tlCacheOptions.hagenResistance) ||
+    (o->paranasalSinuses != tlCacheOptions.paranasalSinuses) ||
+    (o->piriformFossa != tlCacheOptions.piriformFossa) ||
+    (o->staticPressureDrops != tlCacheOptions.staticPressureDrops) ||
+    (o->lumpedElements != tlCacheOptions.lumpedElements) ||
+    (o->innerLengthCorrections != tlCacheOptions.innerLengthCorrections));
+}
+
+
+// ****************************************************************************
+/// Updates the parameters of the vocal tract and the glottis and repaint them
+/// in the dialogs.
+// ****************************************************************************
+
+void Data::updateModelsFromGesturalScore()
+{
+  int i;
+  int numGlottisParams = (int)gesturalScore->glottis->controlParam.size();
+  double tractParams[VocalTract::NUM_PARAMS];
+  double glottisParams[128];
+
   // ****************************************************************
-  // Determine the vocal tract params for the release area.
+  // Set the parameters for the glottis and vocal tract model.
   // ****************************************************************
 
-  if (getReleaseShape(tract, consonantParams, vowelParams, releaseParams, 
-    releasePos, releaseArea_cm2) == false)
+  scoreTrajectory.update(gesturalScore);
+  scoreTrajectory.getParams(gesturalScoreMark_s, tractParams, glottisParams);
+
+  for (i=0; i < VocalTract::NUM_PARAMS; i++)
   {
-    // Error: Set back the original parameters in the vocal tract 
-    // model and return.
-    for (i=0; i < VocalTract::NUM_PARAMS; i++)
-    {
-      tract->param[i].x = consonantParams[i];
-    }
-    tract->calculateAll();
+    gesturalScore->vocalTract->param[i].x = tractParams[i];
+  }
+  calculateVocalTract(gesturalScore->vocalTract);
 
-    return false;
+  for (i=0; i < numGlottisParams; i++)
+  {
+    gesturalScore->glottis->controlParam[i].x = glottisParams[i];
   }
-   
+  gesturalScore->glottis->calcGeometry();
+
   // ****************************************************************
-  // For the release shape, determine the first three formants.
+  // Update the pictures in the glottis/vocal tract dialogs.
   // ****************************************************************
 
-  const int MAX_FORMANTS = 3;
-  double formantFreq[MAX_FORMANTS];
-  double formantBw[MAX_FORMANTS];
-  int numFormants;
-  bool frictionNoise;
-  bool isClosure;
-  bool isNasal;
-
-  // Set the release shape params for the vocal tract model.
-  for (i=0; i < VocalTract::NUM_PARAMS; i++)
+  GlottisDialog *glottisDialog = GlottisDialog::getInstance();
+  if (glottisDialog->IsShown())
   {
-    tract->param[i].x = releaseParams[i];
+    glottisDialog->updateWidgets();
+    glottisDialog->Refresh();
+    glottisDialog->Update();
   }
 
-  // The velo-pharyngeal port must be closed.
-  if (tract->param[VocalTract::VO].x > 0.0)
+  VocalTractDialog *vocalTractDialog = VocalTractDialog::getInstance(NULL);
+  if (vocalTractDialog->IsShown())
   {
-    tract->param[VocalTract::VO].x = 0.0;
+    vocalTractDialog->updateWidgets();
+    vocalTractDialog->Refresh();
+    vocalTractDialog->Update();
   }
+}
 
-  // Calculate the vocal tract area function.
-  tract->calculateAll();
 
-  // Set the latest vocal tract geometry for the transmission line model.   
-  updateTlModelGeometry(tract);
+// ****************************************************************************
+// Returns the value of the selected quantity on the TDS page in the given
+// tube section. The values are read directly from the model, because the 
+// pictures only need one quantity per section.
+// ****************************************************************************
 
-  // Get the formant data.
-  tlModel->getFormants(formantFreq, formantBw, numFormants, MAX_FORMANTS, frictionNoise, isClosure, isNasal);
+void Data::getTubeSectionQuantity(TdsModel *model, int sectionIndex, double &leftValue, double &rightValue)
+{
+  double area;
 
-  // Set back the original parameters in the vocal tract model.
+  leftValue = 0.0;
+  rightValue = 0.0;
 
-  for (i=0; i < VocalTract::NUM_PARAMS; i++)
+  if ((sectionIndex < 0) || (sectionIndex >= Tube::NUM_SECTIONS))
   {
-    tract->param[i].x = consonantParams[i];
+    return;
   }
-  tract->calculateAll();
 
-  // Set the final formant values.
+  if (quantity == QUANTITY_FLOW)
+  {
+    model->getSectionFlow(sectionIndex, leftValue, rightValue);
+  }
+  else
 
-  if (numFormants < MAX_FORMANTS)
+  if (quantity == QUANTITY_PRESSURE)
   {
-    return false;
+    leftValue = model->getSectionPressure(sectionIndex);
+    rightValue = leftValue;
   }
+  else
 
-  F1_Hz = formantFreq[0];
-  F2_Hz = formantFreq[1];
-  F3_Hz = formantFreq[2];
+  if (quantity == QUANTITY_AREA)
+  {
+    leftValue = model->tubeSection[sectionIndex].area;
+    rightValue = leftValue;
+  }
+  else
 
-  return true;
+  if (quantity == QUANTITY_VELOCITY)
+  {
+    model->getSectionFlow(sectionIndex, leftValue, rightValue);
+    area = model->tubeSection[sectionIndex].area;
+    if (area < TdsModel::MIN_AREA_CM2)
+    {
+      area = TdsModel::MIN_AREA_CM2;
+    }
+    leftValue /= area;
+    rightValue /= area;
+  }
 }
 
 
 // ****************************************************************************
-/// Returns the minimum cross-sectional area of the current vocal tract.
-/// It also calculates the area function of the vocal tract first.
+/// Determines the geometric vocal tract parameters from the phonetic 
+/// parameters.
 // ****************************************************************************
 
-double Data::getMinArea_cm2(VocalTract *tract, double startPos_cm, double endPos_cm)
+void Data::phoneticParamsToVocalTract()
 {
   int i;
+  double x;
 
-  // Calculate the vocal tract area function.
-  tract->calculateAll();
+  // ****************************************************************
+  // Interpolate the vocal tract shape between [i], [a], and [u].
+  // ****************************************************************
 
-  // Find the minimum cross-sectional area.
-  double minArea_cm2 = 10000.0;    // = extremely high
+  int a_index = vocalTract->getShapeIndex("a");
+  int i_index = vocalTract->getShapeIndex("i");
+  int u_index = vocalTract->getShapeIndex("u");
 
-  for (i=0; i < VocalTract::NUM_CENTERLINE_POINTS; i++)
+  if ((a_index != -1) && (i_index != -1) && (u_index != -1))
   {
-    if ((tract->crossSection[i].pos >= startPos_cm) &&
-        (tract->crossSection[i].pos <= endPos_cm) &&
-        (tract->crossSection[i].area < minArea_cm2))
+    double frontness = phoneticParamValue[TONGUE_FRONTNESS];
+    double height = phoneticParamValue[TONGUE_HEIGHT];
+
+    for (i=0; i < VocalTract::NUM_PARAMS; i++)
     {
-      minArea_cm2 = tract->crossSection[i].area;
+      x = frontness * vocalTract->shapes[i_index].param[i] + 
+        (1.0-frontness) * vocalTract->shapes[u_index].param[i];
+
+      x = height*x + (1.0-height)*vocalTract->shapes[a_index].param[i];
+      
+      vocalTract->param[i].x = x;
     }
   }
 
-  return minArea_cm2;
-}
+  // ****************************************************************
+  // Set the velum position and the rounding of the lips.
+  // ****************************************************************
 
+  double vel = phoneticParamValue[VELUM_POSITION];
+  vocalTract->param[VocalTract::VO].x = vocalTract->param[VocalTract::VO].min + 
+    vel*(vocalTract->param[VocalTract::VO].max - vocalTract->param[VocalTract::VO].min);
 
-// ****************************************************************************
-/// Returns the minimum cross-sectional area of the current vocal tract outside
-/// the given region.
-/// It also calculates the area function of the vocal tract first.
-// ****************************************************************************
+  double rounding = phoneticParamValue[LIP_ROUNDING];
+  vocalTract->param[VocalTract::LP].x = vocalTract->param[VocalTract::LP].min + 
+    rounding*(vocalTract->param[VocalTract::LP].max - vocalTract->param[VocalTract::LP].min);
 
-double Data::getMinAreaOutsideConstriction_cm2(VocalTract *tract, double constrictionStartPos_cm, double constrictionEndPos_cm)
-{
-  int i;
+  vocalTract->param[VocalTract::LD].x = 1.2 - rounding*1.0;
 
-  // Calculate the vocal tract area function.
-  tract->calculateAll();
+  // ****************************************************************
+  // Superimpose the consonantal constrictions.
+  // ****************************************************************
 
-  // Find the minimum cross-sectional area.
-  double minArea_cm2 = 10000.0;    // = extremely high
+  // Coordinates of the base vowel in the 2D-vowel subspace
+  double alphaTongue;
+  double betaTongue;
+  double alphaLips;
+  double betaLips;
 
-  for (i=0; i < VocalTract::NUM_CENTERLINE_POINTS; i++)
+  double vowelParams[VocalTract::NUM_PARAMS];
+  double bParams[VocalTract::NUM_PARAMS];
+  double dParams[VocalTract::NUM_PARAMS];
+  double gParams[VocalTract::NUM_PARAMS];
+
+  for (i=0; i < VocalTract::NUM_PARAMS; i++)
   {
-    if (((tract->crossSection[i].pos < constrictionStartPos_cm) ||
-        (tract->crossSection[i].pos > constrictionEndPos_cm)) &&
-        (tract->crossSection[i].area < minArea_cm2))
-    {
-      minArea_cm2 = tract->crossSection[i].area;
-    }
+    vowelParams[i] = vocalTract->param[i].x;
   }
 
-  return minArea_cm2;
-}
+  // Get the coordinates of the vowel shape in the 2D-vowel subspace.
+  GesturalScore::mapToVowelSubspace(vocalTract, vowelParams, alphaTongue, betaTongue, alphaLips, betaLips);
+  GesturalScore::limitVowelSubspaceCoord(alphaTongue, betaTongue, alphaLips, betaLips);
 
+  // Get the context-dependent consonsnt targets for /b/, /d/, /g/.
+  GesturalScore::getContextDependentConsonant(vocalTract, "ll-labial-closure", 
+    alphaTongue, betaTongue, alphaLips, betaLips, bParams);
 
-// ****************************************************************************
-/// Reset all buffers related to the time-domain synthesis.
-// ****************************************************************************
+  GesturalScore::getContextDependentConsonant(vocalTract, "tt-alveolar-closure", 
+    alphaTongue, betaTongue, alphaLips, betaLips, dParams);
 
-void Data::resetTdsBuffers()
-{
-  int i;
+  GesturalScore::getContextDependentConsonant(vocalTract, "tb-velar-closure", 
+    alphaTongue, betaTongue, alphaLips, betaLips, gParams);
+
+  // Get the parameter vector difference between the consonant shapes and the vowel shape.
+  
+  double bDeltaParams[VocalTract::NUM_PARAMS];
+  double dDeltaParams[VocalTract::NUM_PARAMS];
+  double gDeltaParams[VocalTract::NUM_PARAMS];
+
+  for (i=0; i < VocalTract::NUM_PARAMS; i++)
+  {
+    bDeltaParams[i] = bParams[i] - vowelParams[i];
+    dDeltaParams[i] = dParams[i] - vowelParams[i];
+    gDeltaParams[i] = gParams[i] - vowelParams[i];
+  }
+
+  double b_degree = phoneticParamValue[LABIAL_CONSTRICTION_DEGREE];
+  double d_degree = phoneticParamValue[ALVEOLAR_CONSTRICTION_DEGREE];
+  double g_degree = phoneticParamValue[VELAR_CONSTRICTION_DEGREE];
+  
+  double alphaB, alphaD, alphaG;
+  double alphaSum;
+  double sum;
+  const double EPSILON = 0.000001;
+
+  // ****************************************************************
+  // Mix the differences to the three shapes for /b,d,g/ depending
+  // on the parameter under consideration.
+  // ****************************************************************
+
+  for (i=0; i < VocalTract::NUM_PARAMS; i++)
+  {
+    alphaB = b_degree;
+    alphaD = d_degree;
+    alphaG = g_degree;
+    
+    alphaSum = alphaB + alphaD + alphaG;
+
+    // The sum of the consonantal contributions may be not higher than 1.0.
+    if (alphaSum > 1.0)
+    {
+      // For the parameters LP, LD, the consonant "b" has priority.
+      if ((i == VocalTract::LP) || (i == VocalTract::LD))
+      {
+        // Reduce the contribution of "d" and "g".
+        sum = alphaD + alphaG;
+        if (sum < EPSILON)
+        {
+          sum = EPSILON;
+        }
+        alphaD*= (1.0 - alphaB) / sum;
+        alphaG*= (1.0 - alphaB) / sum;
+      }
+      else
+
+      // For the parameters TTX, TTY, TS4, the consonant "d" has priority.
+      if ((i == VocalTract::TTX) || (i == VocalTract::TTY) || (i == VocalTract::TS3))
+      {
+        // Reduce the contribution of "b" and "g".
+        sum = alphaB + alphaG;
+        if (sum < EPSILON)
+        {
+          sum = EPSILON;
+        }
+        alphaB*= (1.0 - alphaD) / sum;
+        alphaG*= (1.0 - alphaD) / sum;
+      }
+      else
 
-  for (i = 0; i < TDS_BUFFER_LENGTH; i++)
-  {
-    userProbeFlow[i] = 0.0;
-    userProbePressure[i] = 0.0;
-    userProbeArea[i] = 0.0;
-    userProbeVelocity[i] = 0.0;
+      // For the parameters TCX, TCY, TS2, the consonant "g" has priority.
+      if ((i == VocalTract::TCX) || (i == VocalTract::TCY) || (i == VocalTract::TS2))
+      {
+        // Reduce the contribution of "b" and "d".
+        sum = alphaB + alphaD;
+        if (sum < EPSILON)
+        {
+          sum = EPSILON;
+        }
+        alphaB*= (1.0 - alphaG) / sum;
+        alphaD*= (1.0 - alphaG) / sum;
+      }
+      else
 
-    internalProbeFlow[i] = 0.0;
-    internalProbePressure[i] = 0.0;
+      // Reduce all 3 contributions by equal amounts.
+      {
+        sum = alphaSum;
+        if (sum < EPSILON)
+        {
+          sum = EPSILON;
+        }
+        alphaB/= sum;
+        alphaD/= sum;
+        alphaG/= sum;
+      }
+    }
 
-    outputFlow[i] = 0.0;
-    outputPressure[i] = 0.0;
-    filteredOutputPressure[i] = 0.0;
+    vocalTract->param[i].x = vowelParams[i] + 
+      alphaB*bDeltaParams[i] + alphaD*dDeltaParams[i] + alphaG*gDeltaParams[i];
   }
-  
-  outputPressureFilter.resetBuffers();
+
+  // ****************************************************************
+
+  calculateVocalTract(vocalTract);
 }
 
 
 // ****************************************************************************
-/// Returns an instance of the selected tube sequence (the kind of synthesis).
+/// Makes all tracks at least numSamples long, so that longer recordings and
+/// synthesized utterances are not truncated. The tracks grow in steps of
+/// TRACK_PAGE_DURATION_S and keep their samples. They all have the same 
+/// length and are never shortened. Because the sample buffers are 
+/// reallocated, a running playback is stopped before.
+/// Returns true, if the tracks were enlarged.
 // ****************************************************************************
 
-TubeSequence *Data::getSelectedTubeSequence()
+bool Data::growTracks(int numSamples)
 {
-  TubeSequence *ts = staticPhone;
+  const int PAGE_LENGTH = TRACK_PAGE_DURATION_S*SAMPLING_RATE;
+  int oldLength = track[MAIN_TRACK]->N;
+  int newLength;
+  int i, k;
 
-  switch (synthesisType)
+  if (numSamples <= oldLength)
   {
-    case SYNTHESIS_SUBGLOTTAL_INPUT_IMPEDANCE:    ts = subglottalInputImpedance; break;
-    case SYNTHESIS_SUPRAGLOTTAL_INPUT_IMPEDANCE:  ts = supraglottalInputImpedance; break;
-    case SYNTHESIS_TRANSFER_FUNCTION:             ts = transferFunction; break;
-    case SYNTHESIS_LF_VOWEL:                      ts = vowelLf; break;
-    case SYNTHESIS_PHONE:                         ts = staticPhone; break;
-    case SYNTHESIS_GESMOD:                        ts = gesturalScore; break;
-    default: break;
+    return false;
   }
 
-  return ts;
-}
-
+  newLength = ((numSamples + PAGE_LENGTH - 1) / PAGE_LENGTH) * PAGE_LENGTH;
 
-// ****************************************************************************
-/// Returns a pointer to the selected gesture in the editor, or NULL, if no 
-/// gesture is selected.
-// ****************************************************************************
+  waveStopPlaying();
 
-Gesture *Data::getSelectedGesture()
-{
-  if ((selectedGestureType >= 0) && (selectedGestureType < GesturalScore::NUM_GESTURE_TYPES))
+  for (i=0; i < NUM_TRACKS; i++)
   {
-    GestureSequence *s = &gesturalScore->gestures[selectedGestureType];
-    if ((selectedGestureIndex >= 0) && (selectedGestureIndex < s->numGestures()))
+    Signal16 *newTrack = new Signal16(newLength);
+    newTrack->setZero();
+    for (k=0; k < track[i]->N; k++)
     {
-      return s->getGesture(selectedGestureIndex);
+      newTrack->x[k] = track[i]->x[k];
     }
+    delete track[i];
+    track[i] = newTrack;
   }
-  
-  return NULL;
-}
 
+  trackChanged();
 
-// ****************************************************************************
-/// Returns the currently selected glottis.
-// ****************************************************************************
+  wxPrintf("The audio tracks were enlarged from %2.1f s to %2.1f s.\n",
+    (double)oldLength / SAMPLING_RATE, (double)newLength / SAMPLING_RATE);
 
-Glottis *Data::getSelectedGlottis()
-{
-  return glottis[selectedGlottis];
+  return true;
 }
 
-// ****************************************************************************
-/// Returns the index of the selected glottis.
-// ****************************************************************************
-
-int Data::getSelectedGlottisIndex()
-{
-  return selectedGlottis;
-}
 
 // ****************************************************************************
-/// Set the selected glottis in a save way.
+/// Must be called from the GUI thread after the samples of the given track
+/// (or of all tracks for trackIndex = -1) were changed, so that cached
+/// drawings of the track are repainted.
 // ****************************************************************************
 
-void Data::selectGlottis(int index)
+void Data::trackChanged(int trackIndex)
 {
-  if (index < 0)
-  {
-    index = 0;
-  }
-  if (index >= NUM_GLOTTIS_MODELS)
+  int i;
+  for (i=0; i < NUM_TRACKS; i++)
   {
-    index = NUM_GLOTTIS_MODELS - 1;
+    if ((trackIndex == -1) || (trackIndex == i))
+    {
+      trackGeneration[i]++;
+    }
   }
-
-  selectedGlottis = index;
-  // Also set the glottis for the gestural score !
-  gesturalScore->glottis = glottis[index];
 }
 
 
 // ****************************************************************************
-// Updates the geometry data in the TL-model of the vocal tract.
+/// Returns the current length of the tracks in samples.
 // ****************************************************************************
 
-void Data::updateTlModelGeometry(VocalTract *tract)
+int Data::getTrackLength()
 {
-  tract->getTube(&tlModel->tube);
-  tlModel->tube.setGlottisArea(0.0);
+  return track[MAIN_TRACK]->N;
 }
 
 
 // ****************************************************************************
-/// Updates the parameters of the vocal tract and the glottis and repaint them
-/// in the dialogs.
+/// Normalize the audio amplitude in the given track to -1 dB below the max.
 // ****************************************************************************
 
-void Data::updateModelsFromGesturalScore()
+void Data::normalizeAudioAmplitude(int trackIndex)
 {
-  int i;
-  int numGlottisParams = (int)gesturalScore->glottis->controlParam.size();
-  double tractParams[VocalTract::NUM_PARAMS];
-  double glottisParams[128];
-
-  // ****************************************************************
-  // Set the parameters for the glottis and vocal tract model.
-  // ****************************************************************
-
-  gesturalScore->getParams(gesturalScoreMark_s, tractParams, glottisParams);
-
-  for (i=0; i < VocalTract::NUM_PARAMS; i++)
-  {
-    gesturalScore->vocalTract->param[i].x = tractParams[i];
-  }
-  gesturalScore->vocalTract->calculateAll();
-
-  for (i=0; i < numGlottisParams; i++)
+  if ((trackIndex < 0) || (trackIndex >= NUM_TRACKS))
   {
-    gesturalScore->glottis->controlParam[i].x = glottisParams[i];
+    return;
   }
-  gesturalScore->glottis->calcGeometry();
 
-  // ****************************************************************
-  // Update the pictures in the glottis/vocal tract dialogs.
-  // ****************************************************************
+  int i = 0;
+  int maxValue = 0;
+  int firstSample = 0;
+  int lastSample = track[trackIndex]->N - 1;
 
-  GlottisDialog *glottisDialog = GlottisDialog::getInstance();
-  if (glottisDialog->IsShown())
+  for (i = firstSample; i < lastSample; i++)
   {
-    glottisDialog->updateWidgets();
-    glottisDialog->Refresh();
-    glottisDialog->Update();
+    if (abs(track[trackIndex]->getValue(i)) > maxValue)
+    {
+      maxValue = abs(track[trackIndex]->getValue(i));
+    }
   }
 
-  VocalTractDialog *vocalTractDialog = VocalTractDialog::getInstance(NULL);
-  if (vocalTractDialog->IsShown())
+  if (maxValue >= 1)
   {
-    vocalTractDialog->updateWidgets();
-    vocalTractDialog->Refresh();
-    vocalTractDialog->Update();
+    // 0.89 corresponds to -1 dB.
+    double factor = 0.89*32767.0 / maxValue;
+    for (i = firstSample; i < lastSample; i++)
+    {
+      track[trackIndex]->setValue(i, (int)(factor*track[trackIndex]->getValue(i)));
+    }
+    trackChanged(trackIndex);
   }
 }
 
 
+
 // ****************************************************************************
-// Returns the value of the selected quantity on the TDS page in the given
-// tube section.
+/// Helper functions for the binary speaker snapshots.
 // ****************************************************************************
 
-void Data::getTubeSectionQuantity(TdsModel *model, int sectionIndex, double &leftValue, double &rightValue)
+static const char SPEAKER_SNAPSHOT_MAGIC[8] = "VTLSPK1";
+static const int MAX_SNAPSHOT_ITEMS = 100000;
+
+static void writeSnapshotString(ostream &os, const string &st)
 {
-  leftValue = 0.0;
-  rightValue = 0.0;
+  int length = (int)st.length();
+  os.write((char*)&length, sizeof(int));
+  os.write(st.c_str(), length);
+}
 
-  if (quantity == QUANTITY_FLOW)
+static bool readSnapshotString(istream &is, string &st)
+{
+  int length = 0;
+  is.read((char*)&length, sizeof(int));
+  if ((!is) || (length < 0) || (length > MAX_SNAPSHOT_ITEMS))
   {
-    model->getSectionFlow(sectionIndex, leftValue, rightValue);
+    return false;
   }
-  else
-
-  if (quantity == QUANTITY_PRESSURE)
+  st.resize(length);
+  if (length > 0)
   {
-    leftValue = model->getSectionPressure(sectionIndex);
-    rightValue = leftValue;
+    is.read(&st[0], length);
   }
-  else
+  return (bool)is;
+}
 
-  if (quantity == QUANTITY_AREA)
+static void writeSnapshotValues(ostream &os, const vector<double> &values)
+{
+  int n = (int)values.size();
+  os.write((char*)&n, sizeof(int));
+  if (n > 0)
   {
-    if ((sectionIndex >= 0) && (sectionIndex < Tube::NUM_SECTIONS))
-    {
-      leftValue = model->tubeSection[sectionIndex].area;
-      rightValue = leftValue;
-    }
+    os.write((char*)&values[0], n*sizeof(double));
   }
-  else
+}
 
-  if (quantity == QUANTITY_VELOCITY)
+static bool readSnapshotValues(istream &is, vector<double> &values)
+{
+  int n = 0;
+  is.read((char*)&n, sizeof(int));
+  if ((!is) || (n < 0) || (n > MAX_SNAPSHOT_ITEMS))
   {
-    if ((sectionIndex >= 0) && (sectionIndex < Tube::NUM_SECTIONS))
-    {
-      model->getSectionFlow(sectionIndex, leftValue, rightValue);
-      double area = model->tubeSection[sectionIndex].area;
-      if (area < TdsModel::MIN_AREA_CM2)
-      {
-        area = TdsModel::MIN_AREA_CM2;
-      }
-      leftValue /= area;
-      rightValue /= area;
-    }
+    return false;
+  }
+  values.resize(n);
+  if (n > 0)
+  {
+    is.read((char*)&values[0], n*sizeof(double));
   }
+  return (bool)is;
 }
 
 
 // ****************************************************************************
-/// Determines the geometric vocal tract parameters from the phonetic 
-/// parameters.
+/// Calculates a 64 bit hash (FNV-1a) of the content of the given file.
+/// Returns false, if the file could not be read.
 // ****************************************************************************
 
-void Data::phoneticParamsToVocalTract()
+bool Data::getFileContentHash(const wxString &fileName, unsigned long long &hash)
 {
-  int i;
-  double x;
-
-  // ****************************************************************
-  // Interpolate the vocal tract shape between [i], [a], and [u].
-  // ****************************************************************
+  const int BUFFER_SIZE = 65536;
+  char buffer[BUFFER_SIZE];
+  int i, n;
 
-  int a_index = vocalTract->getShapeIndex("a");
-  int i_index = vocalTract->getShapeIndex("i");
-  int u_index = vocalTract->getShapeIndex("u");
+  hash = 14695981039346656037ull;
 
-  if ((a_index != -1) && (i_index != -1) && (u_index != -1))
+  ifstream is(fileName.ToStdString(), ios::binary);
+  if (!is)
   {
-    double frontness = phoneticParamValue[TONGUE_FRONTNESS];
-    double height = phoneticParamValue[TONGUE_HEIGHT];
+    return false;
+  }
 
-    for (i=0; i < VocalTract::NUM_PARAMS; i++)
+  do
+  {
+    is.read(buffer, BUFFER_SIZE);
+    n = (int)is.gcount();
+    for (i=0; i < n; i++)
     {
-      x = frontness * vocalTract->shapes[i_index].param[i] + 
-        (1.0-frontness) * vocalTract->shapes[u_index].param[i];
-
-      x = height*x + (1.0-height)*vocalTract->shapes[a_index].param[i];
-      
-      vocalTract->param[i].x = x;
+      hash^= (unsigned char)buffer[i];
+      hash*= 1099511628211ull;
     }
-  }
-
-  // ****************************************************************
-  // Set the velum position and the rounding of the lips.
-  // ****************************************************************
-
-  double vel = phoneticParamValue[VELUM_POSITION];
-  vocalTract->param[VocalTract::VO].x = vocalTract->param[VocalTract::VO].min + 
-    vel*(vocalTract->param[VocalTract::VO].max - vocalTract->param[VocalTract::VO].min);
-
-  double rounding = phoneticParamValue[LIP_ROUNDING];
-  vocalTract->param[VocalTract::LP].x = vocalTract->param[VocalTract::LP].min + 
-    rounding*(vocalTract->param[VocalTract::LP].max - vocalTract->param[VocalTract::LP].min);
+  } while (n == BUFFER_SIZE);
 
-  vocalTract->param[VocalTract::LD].x = 1.2 - rounding*1.0;
+  return is.eof();
+}
 
-  // ****************************************************************
-  // Superimpose the consonantal constrictions.
-  // ****************************************************************
 
-  // Coordinates of the base vowel in the 2D-vowel subspace
-  double alphaTongue;
-  double betaTongue;
-  double alphaLips;
-  double betaLips;
+// ****************************************************************************
+/// Returns the name of the snapshot file for a speaker file with the given
+/// content hash. The snapshots are kept in the local data folder of the
+/// user (and not in the shared temp. folder), which is created if 
+/// necessary. An empty string is returned if the folder is not available.
+// ****************************************************************************
 
-  double vowelParams[VocalTract::NUM_PARAMS];
-  double bParams[VocalTract::NUM_PARAMS];
-  double dParams[VocalTract::NUM_PARAMS];
-  double gParams[VocalTract::NUM_PARAMS];
+wxString Data::getSpeakerSnapshotFileName(unsigned long long contentHash)
+{
+  wxString folderName = wxStandardPaths::Get().GetUserLocalDataDir();
+  wxChar pathSeparator = wxFileName::GetPathSeparator();
 
-  for (i=0; i < VocalTract::NUM_PARAMS; i++)
+  if ((wxFileName::DirExists(folderName) == false) &&
+    (wxFileName::Mkdir(folderName, wxS_DIR_DEFAULT & ~(wxS_IRWXG | wxS_IRWXO), wxPATH_MKDIR_FULL) == false))
   {
-    vowelParams[i] = vocalTract->param[i].x;
+    return wxEmptyString;
   }
 
-  // Get the coordinates of the vowel shape in the 2D-vowel subspace.
-  GesturalScore::mapToVowelSubspace(vocalTract, vowelParams, alphaTongue, betaTongue, alphaLips, betaLips);
-  GesturalScore::limitVowelSubspaceCoord(alphaTongue, betaTongue, alphaLips, betaLips);
+  if (folderName.EndsWith( &pathSeparator ) == false)
+  {
+    folderName+= pathSeparator;
+  }
 
-  // Get the context-dependent consonsnt targets for /b/, /d/, /g/.
-  GesturalScore::getContextDependentConsonant(vocalTract, "ll-labial-closure", 
-    alphaTongue, betaTongue, alphaLips, betaLips, bParams);
+  return folderName + wxString::Format("vtl-speaker-%08x%08x.snapshot", 
+    (unsigned int)(contentHash >> 32), (unsigned int)(contentHash & 0xFFFFFFFF));
+}
 
-  GesturalScore::getContextDependentConsonant(vocalTract, "tt-alveolar-closure", 
-    alphaTongue, betaTongue, alphaLips, betaLips, dParams);
 
-  GesturalScore::getContextDependentConsonant(vocalTract, "tb-velar-closure", 
-    alphaTongue, betaTongue, alphaLips, betaLips, gParams);
+// ****************************************************************************
+/// Writes the data of the first numModels glottis models, i.e., of those 
+/// that were read from a speaker file with the given content hash, into a 
+/// binary snapshot. The format is (in the byte order of the machine):
+///   char[8]  "VTLSPK1" terminated by 0
+///   uint64   content hash of the speaker file
+///   int32    index of the selected glottis model
+///   int32    number of glottis models in the snapshot
+///   per glottis model: the name, the static parameter values, the control
+///     parameter values, int32 number of shapes, and per shape the name and
+///     the control parameter values.
+/// Strings are stored as int32 length and characters, value lists as int32 
+/// number and float64 values.
+/// The file is created exclusively, i.e., an existing file (or link) with 
+/// the same name is never written to or followed.
+// ****************************************************************************
 
-  // Get the parameter vector difference between the consonant shapes and the vowel shape.
-  
-  double bDeltaParams[VocalTract::NUM_PARAMS];
-  double dDeltaParams[VocalTract::NUM_PARAMS];
-  double gDeltaParams[VocalTract::NUM_PARAMS];
+bool Data::writeSpeakerSnapshot(const wxString &fileName, unsigned long long contentHash, 
+  int numModels)
+{
+  vector<double> values;
+  ostringstream os(ios::binary);
+  string content;
+  int numShapes;
+  int i, k;
+  Glottis *g = NULL;
+  wxFile file;
 
-  for (i=0; i < VocalTract::NUM_PARAMS; i++)
+  if ((fileName.IsEmpty()) || (numModels < 0) || (numModels > NUM_GLOTTIS_MODELS))
   {
-    bDeltaParams[i] = bParams[i] - vowelParams[i];
-    dDeltaParams[i] = dParams[i] - vowelParams[i];
-    gDeltaParams[i] = gParams[i] - vowelParams[i];
+    return false;
   }
 
-  double b_degree = phoneticParamValue[LABIAL_CONSTRICTION_DEGREE];
-  double d_degree = phoneticParamValue[ALVEOLAR_CONSTRICTION_DEGREE];
-  double g_degree = phoneticParamValue[VELAR_CONSTRICTION_DEGREE];
-  
-  double alphaB, alphaD, alphaG;
-  double alphaSum;
-  double sum;
-  const double EPSILON = 0.000001;
-
-  // ****************************************************************
-  // Mix the differences to the three shapes for /b,d,g/ depending
-  // on the parameter under consideration.
-  // ****************************************************************
+  os.write(SPEAKER_SNAPSHOT_MAGIC, 8);
+  os.write((char*)&contentHash, sizeof(contentHash));
+  os.write((char*)&selectedGlottis, sizeof(int));
+  os.write((char*)&numModels, sizeof(int));
 
-  for (i=0; i < VocalTract::NUM_PARAMS; i++)
+  for (i=0; i < numModels; i++)
   {
-    alphaB = b_degree;
-    alphaD = d_degree;
-    alphaG = g_degree;
-    
-    alphaSum = alphaB + alphaD + alphaG;
+    g = glottis[i];
+    writeSnapshotString(os, g->getName());
 
-    // The sum of the consonantal contributions may be not higher than 1.0.
-    if (alphaSum > 1.0)
+    values.resize(g->staticParam.size());
+    for (k=0; k < (int)g->staticParam.size(); k++)
     {
-      // For the parameters LP, LD, the consonant "b" has priority.
-      if ((i == VocalTract::LP) || (i == VocalTract::LD))
-      {
-        // Reduce the contribution of "d" and "g".
-        sum = alphaD + alphaG;
-        if (sum < EPSILON)
-        {
-          sum = EPSILON;
-        }
-        alphaD*= (1.0 - alphaB) / sum;
-        alphaG*= (1.0 - alphaB) / sum;
-      }
-      else
-
-      // For the parameters TTX, TTY, TS4, the consonant "d" has priority.
-      if ((i == VocalTract::TTX) || (i == VocalTract::TTY) || (i == VocalTract::TS3))
-      {
-        // Reduce the contribution of "b" and "g".
-        sum = alphaB + alphaG;
-        if (sum < EPSILON)
-        {
-          sum = EPSILON;
-        }
-        alphaB*= (1.0 - alphaD) / sum;
-        alphaG*= (1.0 - alphaD) / sum;
-      }
-      else
+      values[k] = g->staticParam[k].x;
+    }
+    writeSnapshotValues(os, values);
 
-      // For the parameters TCX, TCY, TS2, the consonant "g" has priority.
-      if ((i == VocalTract::TCX) || (i == VocalTract::TCY) || (i == VocalTract::TS2))
-      {
-        // Reduce the contribution of "b" and "d".
-        sum = alphaB + alphaD;
-        if (sum < EPSILON)
-        {
-          sum = EPSILON;
-        }
-        alphaB*= (1.0 - alphaG) / sum;
-        alphaD*= (1.0 - alphaG) / sum;
-      }
-      else
+    values.resize(g->controlParam.size());
+    for (k=0; k < (int)g->controlParam.size(); k++)
+    {
+      values[k] = g->controlParam[k].x;
+    }
+    writeSnapshotValues(os, values);
 
-      // Reduce all 3 contributions by equal amounts.
-      {
-        sum = alphaSum;
-        if (sum < EPSILON)
-        {
-          sum = EPSILON;
-        }
-        alphaB/= sum;
-        alphaD/= sum;
-        alphaG/= sum;
-      }
+    numShapes = (int)g->shape.size();
+    os.write((char*)&numShapes, sizeof(int));
+    for (k=0; k < numShapes; k++)
+    {
+      writeSnapshotString(os, g->shape[k].name);
+      writeSnapshotValues(os, g->shape[k].controlParam);
     }
+  }
 
-    vocalTract->param[i].x = vowelParams[i] + 
-      alphaB*bDeltaParams[i] + alphaD*dDeltaParams[i] + alphaG*gDeltaParams[i];
+  if (!os)
+  {
+    return false;
   }
+  content = os.str();
 
-  // ****************************************************************
+  if (file.Create(fileName, false, wxS_IRUSR | wxS_IWUSR) == false)
+  {
+    return false;
+  }
+
+  bool ok = (file.Write(content.data(), content.size()) == content.size());
+  file.Close();
+
+  if (ok == false)
+  {
+    wxRemoveFile(fileName);
+  }
 
-  vocalTract->calculateAll();
+  return ok;
 }
 
 
 // ****************************************************************************
-/// Normalize the audio amplitude in the given track to -1 dB below the max.
+/// Reads the data of the glottis models from the given snapshot file. The
+/// models are only changed when the snapshot belongs to a speaker file with 
+/// the given content hash and matches the glottis models completely. Models
+/// that are not contained in the snapshot (because they were missing in the
+/// speaker file) are left unchanged, as when the XML data are read.
 // ****************************************************************************
 
-void Data::normalizeAudioAmplitude(int trackIndex)
+bool Data::readSpeakerSnapshot(const wxString &fileName, unsigned long long contentHash)
 {
-  if ((trackIndex < 0) || (trackIndex >= NUM_TRACKS))
+  char magic[8];
+  unsigned long long hash = 0;
+  int selected = 0;
+  int numModels = 0;
+  int numShapes = 0;
+  int i, k;
+  string name;
+  Glottis *g = NULL;
+
+  vector<double> staticParams[NUM_GLOTTIS_MODELS];
+  vector<double> controlParams[NUM_GLOTTIS_MODELS];
+  vector<Glottis::Shape> shapes[NUM_GLOTTIS_MODELS];
+
+  ifstream is(fileName.ToStdString(), ios::binary);
+  if (!is)
   {
-    return;
+    return false;
   }
 
-  int i = 0;
-  int maxValue = 0;
-  int firstSample = 0;
-  int lastSample = track[trackIndex]->N - 1;
+  is.read(magic, 8);
+  is.read((char*)&hash, sizeof(hash));
+  is.read((char*)&selected, sizeof(int));
+  is.read((char*)&numModels, sizeof(int));
 
-  for (i = firstSample; i < lastSample; i++)
+  if ((!is) || (memcmp(magic, SPEAKER_SNAPSHOT_MAGIC, 8) != 0) || (hash != contentHash) ||
+    (numModels < 0) || (numModels > NUM_GLOTTIS_MODELS) || 
+    (selected < 0) || (selected >= NUM_GLOTTIS_MODELS))
   {
-    if (abs(track[trackIndex]->getValue(i)) > maxValue)
+    return false;
+  }
+
+  // ****************************************************************
+  // Read and check the data of all models before anything is changed.
+  // ****************************************************************
+
+  for (i=0; i < numModels; i++)
+  {
+    g = glottis[i];
+    if ((readSnapshotString(is, name) == false) || (name != g->getName()) ||
+      (readSnapshotValues(is, staticParams[i]) == false) ||
+      (staticParams[i].size() != g->staticParam.size()) ||
+      (readSnapshotValues(is, controlParams[i]) == false) ||
+      (controlParams[i].size() != g->controlParam.size()))
     {
-      maxValue = abs(track[trackIndex]->getValue(i));
+      return false;
+    }
+
+    is.read((char*)&numShapes, sizeof(int));
+    if ((!is) || (numShapes < 0) || (numShapes > MAX_SNAPSHOT_ITEMS))
+    {
+      return false;
+    }
+
+    shapes[i].resize(numShapes);
+    for (k=0; k < numShapes; k++)
+    {
+      if ((readSnapshotString(is, shapes[i][k].name) == false) ||
+        (readSnapshotValues(is, shapes[i][k].controlParam) == false))
+      {
+        return false;
+      }
     }
   }
 
-  if (maxValue >= 1)
+  // ****************************************************************
+  // Take over the data.
+  // ****************************************************************
+
+  for (i=0; i < numModels; i++)
   {
-    // 0.89 corresponds to -1 dB.
-    double factor = 0.89*32767.0 / maxValue;
-    for (i = firstSample; i < lastSample; i++)
+    g = glottis[i];
+    for (k=0; k < (int)g->staticParam.size(); k++)
     {
-      track[trackIndex]->setValue(i, (int)(factor*track[trackIndex]->getValue(i)));
+      g->staticParam[k].x = staticParams[i][k];
     }
+    for (k=0; k < (int)g->controlParam.size(); k++)
+    {
+      g->controlParam[k].x = controlParams[i][k];
+    }
+    g->shape = shapes[i];
   }
-}
+  selectedGlottis = selected;
 
+  return true;
+}
 
 
 // ****************************************************************************
-/// Load all data that comprise a "speaker".
+/// Load all data that comprise a "speaker". The data of the glottis models
+/// are taken from a binary snapshot, when there is one for the current 
+/// content of the speaker file. Otherwise, they are read from the XML data
+/// and a new snapshot is written for the next time.
 // ****************************************************************************
 
 bool Data::loadSpeaker(const wxString &fileName)
 {
     speakerFileName = fileName;
 
-    // ****************************************************************
-     // Load the XML data from the speaker file.
-     // ****************************************************************
+    wxStopWatch stopWatch;
+    unsigned long long contentHash = 0;
+    bool hasContentHash = getFileContentHash(speakerFileName, contentHash);
+    bool fromSnapshot = false;
+    wxString snapshotFileName;
 
-    vector<XmlError> xmlErrors;
-    XmlNode* rootNode = xmlParseFile(string(speakerFileName), "speaker", &xmlErrors);
-    if (rootNode == NULL)
+    if (hasContentHash)
     {
-        xmlPrintErrors(xmlErrors);
-        return false;
+        snapshotFileName = getSpeakerSnapshotFileName(contentHash);
+        fromSnapshot = (snapshotFileName.IsEmpty() == false) && 
+            readSpeakerSnapshot(snapshotFileName, contentHash);
     }
 
-    // ****************************************************************
-    // Load the data for the glottis models.
-    // ****************************************************************
+    if (fromSnapshot == false)
+    {
+        // ****************************************************************
+        // Load the XML data from the speaker file.
+        // ****************************************************************
+
+        vector<XmlError> xmlErrors;
+        XmlNode* rootNode = xmlParseFile(string(speakerFileName), "speaker", &xmlErrors);
+        if (rootNode == NULL)
+        {
+            xmlPrintErrors(xmlErrors);
+            return false;
+        }
 
-    // This may be overwritten later.
-    selectedGlottis = GEOMETRIC_GLOTTIS;
+        // ****************************************************************
+        // Load the data for the glottis models.
+        // ****************************************************************
 
-    XmlNode* glottisModelsNode = rootNode->getChildElement("glottis_models");
-    if (glottisModelsNode != NULL)
-    {
-        int i;
-        XmlNode* glottisNode;
+        if (SynthesisContext::readGlottisModels(rootNode, glottis, selectedGlottis, 
+            speakerFileName.ToStdString()) == false)
+        {
+            delete rootNode;
+            return false;
+        }
 
-        for (i = 0; (i < (int)glottisModelsNode->childElement.size()) && (i < NUM_GLOTTIS_MODELS); i++)
+        // Only the models that were actually read go into the snapshot.
+
+        XmlNode* glottisModelsNode = rootNode->getChildElement("glottis_models");
+        int numModelsRead = 0;
+        if (glottisModelsNode != NULL)
         {
-            glottisNode = glottisModelsNode->childElement[i];
-            if (glottisNode->getAttributeString("type") == glottis[i]->getName())
+            numModelsRead = (int)glottisModelsNode->childElement.size();
+            if (numModelsRead > NUM_GLOTTIS_MODELS)
             {
-                if (glottisNode->getAttributeInt("selected") == 1)
-                {
-                    selectedGlottis = i;
-                }
-                if (glottis[i]->readFromXml(*glottisNode) == false)
-                {
-                    wxPrintf("Error: Failed to read glottis data for glottis model %d!\n", i);
-                    delete rootNode;
-                    return false;
-                }
+                numModelsRead = NUM_GLOTTIS_MODELS;
             }
-            else
-            {
-                wxPrintf("Error: The type of the glottis model %d in the speaker file is '%s' "
-                    "but should be '%s'!\n", i,
-                    glottisNode->getAttributeString("type").c_str(),
-                    glottis[i]->getName().c_str());
+        }
 
-                delete rootNode;
-                return false;
+        if ((hasContentHash) && (snapshotFileName.IsEmpty() == false))
+        {
+            // Replace an invalid or outdated snapshot with the same name.
+            if (wxFileName::FileExists(snapshotFileName))
+            {
+                wxRemoveFile(snapshotFileName);
             }
+            writeSpeakerSnapshot(snapshotFileName, contentHash, numModelsRead);
         }
-    }
-    else
-    {
-        wxPrintf("Warning: No glottis model data found in the speaker file %s!\n", speakerFileName);
-    }
 
-    // Free the memory of the XML tree !
-    delete rootNode;
+        // Free the memory of the XML tree !
+        delete rootNode;
+    }
 
     // ****************************************************************
     // Load the vocal tract anatomy and vocal tract shapes.
@@ -3216,7 +6607,8 @@ bool Data::loadSpeaker(const wxString &fileName)
     try
     {
         vocalTract->readFromXml(string(speakerFileName));
-        vocalTract->calculateAll();
+        invalidateVocalTract();
+        calculateVocalTract(vocalTract);
     }
     catch (std::string st)
     {
@@ -3225,6 +6617,9 @@ bool Data::loadSpeaker(const wxString &fileName)
         return false;
     }
 
+    wxPrintf("Loaded the speaker file %s in %d ms (glottis data %s).\n", speakerFileName, 
+        (int)stopWatch.Time(), fromSnapshot ? "from the snapshot" : "from XML");
+
     return true;
 }
 
@@ -3337,7 +6732,7 @@ void Data::estimateF0(wxWindow *parent, int trackIndex)
 
   // Do the pre-processing for F0-estimation.
   
-  f0EstimatorYin->init(track[trackIndex], firstRoiSample, numRoiSamples);
+  getF0Estimator()->init(track[trackIndex], firstRoiSample, numRoiSamples);
   int numChunkSamples = SAMPLING_RATE / 2;
 
   // Show the progress dialog
@@ -3354,7 +6749,7 @@ void Data::estimateF0(wxWindow *parent, int trackIndex)
 
   do
   {
-    finished = f0EstimatorYin->processChunk(numChunkSamples);
+    finished = getF0Estimator()->processChunk(numChunkSamples);
     cont = dialog.Update(chunkCounter);
     chunkCounter++;
   } while ((finished == false) && (cont));
@@ -3363,9 +6758,9 @@ void Data::estimateF0(wxWindow *parent, int trackIndex)
 
   if (finished)
   {
-    f0Signal[trackIndex] = f0EstimatorYin->finish();
+    f0Signal[trackIndex] = getF0Estimator()->finish();
     // Take over the time step of this F0 signal.
-    f0TimeStep_s = f0EstimatorYin->timeStep_s;
+    f0TimeStep_s = getF0Estimator()->timeStep_s;
     wxPrintf("F0 estimation finished.\n");
   }
   else
@@ -3437,7 +6832,7 @@ void Data::estimateVoiceQuality(wxWindow *parent, int trackIndex)
 
   // Do the initialization.
   
-  voiceQualityEstimator->init(track[trackIndex], firstRoiSample, numRoiSamples);
+  getVoiceQualityEstimator()->init(track[trackIndex], firstRoiSample, numRoiSamples);
   int numChunkSamples = SAMPLING_RATE / 2;
 
   // Show the progress dialog
@@ -3454,7 +6849,7 @@ void Data::estimateVoiceQuality(wxWindow *parent, int trackIndex)
 
   do
   {
-    finished = voiceQualityEstimator->processChunk(numChunkSamples);
+    finished = getVoiceQualityEstimator()->processChunk(numChunkSamples);
     cont = dialog.Update(chunkCounter);
     chunkCounter++;
   } while ((finished == false) && (cont));
@@ -3463,9 +6858,9 @@ void Data::estimateVoiceQuality(wxWindow *parent, int trackIndex)
 
   if (finished)
   {
-    voiceQualitySignal[trackIndex] = voiceQualityEstimator->finish();
+    voiceQualitySignal[trackIndex] = getVoiceQualityEstimator()->finish();
     // Take over the time step of this F0 signal.
-    voiceQualityTimeStep_s = voiceQualityEstimator->timeStep_s;
+    voiceQualityTimeStep_s = getVoiceQualityEstimator()->timeStep_s;
     wxPrintf("Voice quality estimation finished.\n");
   }
   else
@@ -3477,6 +6872,31 @@ void Data::estimateVoiceQuality(wxWindow *parent, int trackIndex)
 }
 
 
+// ****************************************************************************
+/// Estimates the formant tracks of the given track. Only the frames of the
+/// track that were changed since the last estimation are analyzed again.
+// ****************************************************************************
+
+void Data::estimateFormants(wxWindow *parent, int trackIndex)
+{
+  if ((trackIndex < 0) || (trackIndex >= NUM_TRACKS))
+  {
+    trackIndex = selectTrack(parent, wxString("For which track do you want to estimate the formants?"));
+    if (trackIndex == -1)
+    {
+      return;
+    }
+  }
+
+  wxBusyCursor busyCursor;
+  wxStopWatch stopWatch;
+  int numFrames = formantTracker[trackIndex].update(track[trackIndex], SAMPLING_RATE);
+
+  wxPrintf("Formant estimation finished: %d of %d frames analyzed in %d ms.\n",
+    numFrames, (int)formantTracker[trackIndex].formant_Hz[0].size(), (int)stopWatch.Time());
+}
+
+
 // ****************************************************************************
 /// Determines the natural frequency and the F0 derivative with respect to
 /// tension Q of the triangular glottis model.
@@ -3488,128 +6908,29 @@ void Data::calcTriangularGlottisF0Params()
   wxPrintf("Calculation of the F0 parameters for the triangular glottis model\n");
   wxPrintf("=================================================================\n");
 
-  int duration_samples = 0;
-  double duration_s = 0.0;
   TriangularGlottis *g = (TriangularGlottis*)glottis[TRIANGULAR_GLOTTIS];
-  int i;
-  vector<double> audio;
-
-  // ****************************************************************
-  // Clear the main track.
-  // ****************************************************************
-
-  track[MAIN_TRACK]->setZero();
 
   // ****************************************************************
-  // Keep in mind the control parameters for F0 and pressure.
+  // Synthesize the vowels for Q = 0.7, 1.0 and 1.3 at P = 800 Pa in
+  // parallel on copies of the models and measure their F0.
   // ****************************************************************
 
-  double storedControlParams[Glottis::MAX_CONTROL_PARAMS];
-  for (i = 0; i < (int)g->controlParam.size(); i++)
+  GlottisSweep sweep;
+  sweep.setTriangularGlottisF0Preset();
+  if ((sweep.run() == false) || (sweep.result.size() != 3))
   {
-    storedControlParams[i] = g->controlParam[i].x;
+    wxPrintf("The glottis sweep failed. "
+      "The values are NOT set for the triangular glottis model!\n");
+    return;
   }
 
+  double f0AtLowQ = sweep.result[0].f0_Hz;
+  double f0Neutral = sweep.result[1].f0_Hz;
+  double f0AtHighQ = sweep.result[2].f0_Hz;
 
-  // ****************************************************************
-  // Get the produced F0 for Q=1 and P=800 Pa.
-  // ****************************************************************
-
-  wxPrintf("Synthesizing vowel for Q = 1 and P = 800 Pa ");
-
-  g->staticParam[TriangularGlottis::NATURAL_F0].x = 100.0;
-  g->staticParam[TriangularGlottis::F0_DIV_Q].x = 100.0;
-
-  g->controlParam[TriangularGlottis::FREQUENCY].x = 100.0;
-  g->controlParam[TriangularGlottis::PRESSURE].x = 8000.0;
-
-  Synthesizer::synthesizeStaticPhoneme(g, vocalTract, tdsModel, true, true, audio);
-  Synthesizer::copySignal(audio, *track[MAIN_TRACK], 0);
-  duration_samples = (int)audio.size();
-  duration_s = (double)duration_samples / SAMPLING_RATE;
-
-  // Play the vowel for auditory checking.
-  waveStartPlaying(track[MAIN_TRACK]->x, track[MAIN_TRACK]->N, false);
-  wxThread::Sleep((int)(duration_samples * 1000 / SAMPLING_RATE));
-  waveStopPlaying();
-
-  // Determine the F0 in the middle of the synthesized vowel
-
-  f0EstimatorYin->init(track[MAIN_TRACK], 0, duration_samples);
-  f0EstimatorYin->processChunk(duration_samples);
-  f0Signal[MAIN_TRACK] = f0EstimatorYin->finish();
-  f0TimeStep_s = f0EstimatorYin->timeStep_s;
-  i = (int)(0.5*duration_s / f0TimeStep_s);
-
-  double f0Neutral = f0Signal[MAIN_TRACK][i];
-  wxPrintf("F0 = %2.1f Hz\n\n", f0Neutral);
-
-  // ****************************************************************
-  // Get the produced F0 for Q = 0.7 and P = 800 Pa.
-  // ****************************************************************
-
-  wxPrintf("Synthesizing vowel for Q = 0.7 and P = 800 Pa ");
-
-  g->staticParam[TriangularGlottis::NATURAL_F0].x = 100.0;
-  g->staticParam[TriangularGlottis::F0_DIV_Q].x = 100.0;
-
-  g->controlParam[TriangularGlottis::FREQUENCY].x = 70.0;
-  g->controlParam[TriangularGlottis::PRESSURE].x = 8000.0;
-
-  Synthesizer::synthesizeStaticPhoneme(g, vocalTract, tdsModel, true, true, audio);
-  Synthesizer::copySignal(audio, *track[MAIN_TRACK], 0);
-  duration_samples = (int)audio.size();
-  duration_s = (double)duration_samples / SAMPLING_RATE;
-
-  // Play the vowel for auditory checking.
-  waveStartPlaying(track[MAIN_TRACK]->x, track[MAIN_TRACK]->N, false);
-  wxThread::Sleep((int)(duration_s * 1000));
-  waveStopPlaying();
-
-  // Determine the F0 in the middle of the synthesized vowel
-
-  f0EstimatorYin->init(track[MAIN_TRACK], 0, duration_samples);
-  f0EstimatorYin->processChunk(duration_samples);
-  f0Signal[MAIN_TRACK] = f0EstimatorYin->finish();
-  f0TimeStep_s = f0EstimatorYin->timeStep_s;
-  i = (int)(0.5*duration_s / f0TimeStep_s);
-
-  double f0AtLowQ = f0Signal[MAIN_TRACK][i];
-  wxPrintf("F0 = %2.1f Hz\n\n", f0AtLowQ);
-
-  // ****************************************************************
-  // Get the produced F0 for Q = 1.3 and P = 800 Pa.
-  // ****************************************************************
-
-  wxPrintf("Synthesizing vowel for Q = 1.3 and P = 800 Pa ");
-
-  g->staticParam[TriangularGlottis::NATURAL_F0].x = 100.0;
-  g->staticParam[TriangularGlottis::F0_DIV_Q].x = 100.0;
-
-  g->controlParam[TriangularGlottis::FREQUENCY].x = 130.0;
-  g->controlParam[TriangularGlottis::PRESSURE].x = 8000.0;
-
-  Synthesizer::synthesizeStaticPhoneme(g, vocalTract, tdsModel, true, true, audio);
-  Synthesizer::copySignal(audio, *track[MAIN_TRACK], 0);
-  duration_samples = (int)audio.size();
-  duration_s = (double)duration_samples / SAMPLING_RATE;
-
-  // Play the vowel for auditory checking.
-  waveStartPlaying(track[MAIN_TRACK]->x, track[MAIN_TRACK]->N, false);
-  wxThread::Sleep((int)(duration_s * 1000));
-  waveStopPlaying();
-
-  // Determine the F0 in the middle of the synthesized vowel
-
-  f0EstimatorYin->init(track[MAIN_TRACK], 0, duration_samples);
-  f0EstimatorYin->processChunk(duration_samples);
-  f0Signal[MAIN_TRACK] = f0EstimatorYin->finish();
-  f0TimeStep_s = f0EstimatorYin->timeStep_s;
-  i = (int)(0.5*duration_s / f0TimeStep_s);
-
-  double f0AtHighQ = f0Signal[MAIN_TRACK][i];
-  wxPrintf("F0 = %2.1f Hz\n\n", f0AtHighQ);
-
+  wxPrintf("F0 for Q = 0.7 and P = 800 Pa: %2.1f Hz\n", f0AtLowQ);
+  wxPrintf("F0 for Q = 1   and P = 800 Pa: %2.1f Hz\n", f0Neutral);
+  wxPrintf("F0 for Q = 1.3 and P = 800 Pa: %2.1f Hz\n\n", f0AtHighQ);
 
   // ****************************************************************
   // Calculate the slopes and set the values for the glottis model.
@@ -3635,15 +6956,6 @@ void Data::calcTriangularGlottisF0Params()
     wxPrintf("The measured F0 values or slopes are not plausible. "
       "The values are NOT set for the triangular glottis model!\n");
   }
-
-  // ****************************************************************
-  // Reset the original parameter values for F0 and pressure.
-  // ****************************************************************
-
-  for (i = 0; i < (int)g->controlParam.size(); i++)
-  {
-    g->controlParam[i].x = storedControlParams[i];
-  }
 }
 
 
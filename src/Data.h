@@ -55,6 +55,12 @@
 #include "Graph.h"
 #include "ColorScale.h"
 #include "FormantOptimizationDialog.h"
+#include "ScoreTrajectoryCache.h"
+#include "CrossSectionCache.h"
+#include "SynthesisContext.h"
+#include "TdsCheckpoint.h"
+#include "TdsSectionArrays.h"
+#include "FormantTracker.h"
 
 
 // ****************************************************************************
@@ -94,8 +100,8 @@ class Data
   // **************************************************************************
 
 public:
-  static const int TRACK_DURATION_S = 60;                    // Length of the tracks in s
-  static const int MAX_F0_FRAMES = TRACK_DURATION_S*1000;    // max. one frame for each ms
+  static const int TRACK_DURATION_S = 60;                    // Min. length of the tracks for recording in s
+  static const int TRACK_PAGE_DURATION_S = 10;               // The tracks grow in steps of this length
   // Left margin of the gestural score picture
   // Must not be constant because it is re-calculated at runtime to account for changing DPI
   int LEFT_SCORE_MARGIN = 120;
@@ -181,6 +187,35 @@ public:
     NUM_SPECTRUM_TYPES
   };
 
+  // Output formats for the video frames of the vocal tract
+
+  enum VideoFrameFormat
+  {
+    VIDEO_FRAMES_PNG,
+    VIDEO_FRAMES_BMP,
+    VIDEO_FRAMES_Y4M,     ///< One YUV4MPEG2 stream (file or named pipe)
+    NUM_VIDEO_FRAME_FORMATS
+  };
+
+  // File formats for EMA trajectories
+
+  enum EmaFileFormat
+  {
+    EMA_FILE_TEXT,
+    EMA_FILE_BINARY,      ///< Float32 columns (see writeEmaTrajectories())
+    NUM_EMA_FILE_FORMATS
+  };
+
+  // Output formats for the geometry of the vocal tract along a gestural score
+
+  enum GeometrySequenceFormat
+  {
+    GEOMETRY_SEQUENCE_OBJ,    ///< One Wavefront OBJ file per frame
+    GEOMETRY_SEQUENCE_SVG,    ///< One wireframe SVG file per frame
+    GEOMETRY_SEQUENCE_MESH,   ///< One binary mesh sequence (see exportGeometrySequence())
+    NUM_GEOMETRY_SEQUENCE_FORMATS
+  };
+
   int currentPage;    ///< The current program page
 
   wxFileConfig *config;
@@ -190,6 +225,8 @@ public:
   // ****************************************************************
 
   VocalTract *vocalTract;
+  /// Cut planes and cross-sections of the main vocal tract
+  CrossSectionCache crossSections;
   TlModel *tlModel;
   PoleZeroPlan *poleZeroPlan;
   AnatomyParams *anatomyParams;
@@ -201,17 +238,24 @@ public:
   ComplexSignal *poleZeroSpectrum;
 
   double noiseFilterCutoffFreq;
+  /// Seed of the random streams for the noise synthesized in the frontend
+  unsigned long long randomSeed;
 
   wxString speakerFileName;
   wxString svgFileName;
   wxString spectrumFileName;
   wxString emaFileName;
+  wxString emaBatchFolder;
+  EmaFileFormat emaFileFormat;
+  double emaFrameRate_Hz;
+  wxString emaPointNames;       ///< Space-separated names; empty = all EMA points
   wxString backgroundImageFileName;
 
   // All phonetic parameter values are between 0.0 and 1.0.
   double phoneticParamValue[NUM_PHONETIC_PARAMS];
   static const wxString phoneticParamName[NUM_PHONETIC_PARAMS];
 
+  /// Access only using getFormantOptimizationDialog()
   FormantOptimizationDialog *formantOptimizationDialog;
 
   // ****************************************************************
@@ -232,8 +276,20 @@ public:
   bool showSubglottalSystem;
   bool showAnimation;
   bool normalizeAmplitude;      // After the synthesis
+  bool fastPreview;             ///< Gestural score synthesis at a reduced rate
+  int previewSamplingRate;
+  bool quickRender;             ///< Gestural score rendering without the TDS
   int synthesisSpeed_percent;
   wxString videoFramesFolder;
+  wxString videoStreamFileName;
+  VideoFrameFormat videoFrameFormat;
+  int videoFrameRate;
+  int videoFrameWidth;          ///< 0 = width of the vocal tract picture
+  int videoFrameHeight;         ///< 0 = height of the vocal tract picture
+  wxString geometrySequenceFolder;
+  wxString geometrySequenceFileName;
+  GeometrySequenceFormat geometrySequenceFormat;
+  double geometrySequenceFrameRate_Hz;
   wxString equationSetsFolder;
   Graph *tdsPressureTimeGraph;
   Graph *tdsFlowTimeGraph;
@@ -256,6 +312,8 @@ public:
   double *filteredOutputPressure;
 
   IirFilter outputPressureFilter;
+  /// The section quantities of the TDS model for the pictures
+  TdsSectionArrays tdsSections;
 
   // List with glottis models
   Glottis *glottis[NUM_GLOTTIS_MODELS];
@@ -273,6 +331,10 @@ public:
   ImpulseExcitation *supraglottalInputImpedance;
   ImpulseExcitation *transferFunction;
   GesturalScore *gesturalScore;
+  /// Sampled parameter trajectories of the gestural score
+  ScoreTrajectoryCache scoreTrajectory;
+  /// Checkpoints of the last synthesis of the gestural score
+  TdsCheckpointList gesturalScoreCheckpoints;
 
   // The color scale
   static const int NUM_TDS_SCALE_COLORS = 256;
@@ -283,6 +345,8 @@ public:
   // ****************************************************************
 
   Signal16 *track[NUM_TRACKS];
+  /// Incremented by trackChanged() whenever the samples of a track change
+  int trackGeneration[NUM_TRACKS];
   bool showTrack[NUM_TRACKS];
   int selectionMark_pt[2];
   int mark_pt;
@@ -297,7 +361,8 @@ public:
   bool showFormants;    ///< Show formant tracks ?
   bool showVoiceQuality;  ///< Show voice quality signal ?
 
-  // Analysis objects.
+  // Analysis objects (access only using getF0Estimator() and 
+  // getVoiceQualityEstimator()).
 
   F0EstimatorYin *f0EstimatorYin;
   VoiceQualityEstimator *voiceQualityEstimator;
@@ -312,6 +377,10 @@ public:
   double voiceQualityTimeStep_s;
   vector<double> voiceQualitySignal[NUM_TRACKS];
 
+  // Formant tracks (incrementally updated by estimateFormants(...)).
+
+  FormantTracker formantTracker[NUM_TRACKS];
+
   // Data for the user spectrum calculation
 
   int spectrumWindowLength_pt;
@@ -343,6 +412,10 @@ public:
   /// Path to the executable file
   wxString programPath;
 
+  /// Names and durations of the steps of the program start
+  vector<wxString> startupStepName;
+  vector<double> startupStepTime_ms;
+
   // ****************************************************************
   // Gestural score variables.
   // ****************************************************************
@@ -356,6 +429,66 @@ public:
   int selectedGestureType;
   int selectedGestureIndex;
   int selectedSegmentIndex;
+
+  // ****************************************************************
+  // State of successive searches for release shapes on the linear
+  // transition from a consonant to a context vowel. The release
+  // position of the last search is the starting point of the next
+  // one, and the min. area of the vowel is kept as long as the vowel
+  // parameters don't change.
+  // ****************************************************************
+
+  struct ReleaseSearch
+  {
+    /// Release position of the last search, or -1.0
+    double lastReleasePos;
+    double vowelParams[VocalTract::NUM_PARAMS];
+    double minAreaVowel_cm2;
+    bool hasVowelArea;
+
+    // Statistics
+    int numColdSearches;
+    int numWarmSearches;
+    int numColdRuns;
+    int numWarmRuns;
+    /// Number of calls of VocalTract::calculateAll()
+    int numGeometryEvaluations;
+    int numCachedVowelAreas;
+
+    ReleaseSearch() { reset(); }
+    void reset();
+    void addStatistics(const ReleaseSearch &search);
+    int getNumSavedEvaluations() const;
+  };
+
+  // ****************************************************************
+  // Dirty tracking for the geometry of the main vocal tract. The
+  // parameters of the last calculation are kept, so that
+  // calculateVocalTract() can skip VocalTract::calculateAll() when
+  // no parameter changed since then (e.g., when the gestural score
+  // mark moves within a pause, or a slider is released at the same
+  // position). calculateAll() may constrain the parameters, so both
+  // the requested and the resulting parameters are kept.
+  // ****************************************************************
+
+  struct TractCalculation
+  {
+    VocalTract *tract;
+    bool isValid;
+    double inputParams[VocalTract::NUM_PARAMS];
+    double outputParams[VocalTract::NUM_PARAMS];
+
+    // Statistics
+    int numCalculations;
+    int numSkippedCalculations;
+    double calculationTime_ms;
+
+    TractCalculation() { tract = NULL; reset(); }
+    void reset();
+    bool isUpToDate();
+  };
+
+  TractCalculation vocalTractCalculation;
   
 
   // **************************************************************************
@@ -367,18 +500,43 @@ public:
   void init(const wxString &arg0);
   void readConfig();
   void writeConfig();
+  void addStartupStep(const wxString &name, wxStopWatch &stopWatch);
+  void printStartupReport();
+  static long getResidentMemory_kB();
+
+  FormantOptimizationDialog *getFormantOptimizationDialog();
+  F0EstimatorYin *getF0Estimator();
+  VoiceQualityEstimator *getVoiceQualityEstimator();
 
   bool isValidSelection();
   static int selectTrack(wxWindow *parent, const wxString &message, int defaultSelection = MAIN_TRACK);
   int synthesizeVowelFormantLf(LfPulse &lfPulse, int startPos, bool isLongVowel);
   int synthesizeVowelLf(TlModel *tlModel, LfPulse &lfPulse, int startPos, bool isLongVowel);
+  bool quickRenderGesturalScore(GesturalScore *score, LfPulse &lfPulse, vector<double> &audio);
+  int startGesturalScoreSynthesis();
+  bool compareResumedSynthesis();
 
   void calcUserSpectrum();
   bool calcRadiatedNoiseSpectrum(double noiseSourcePos_cm, double noiseFilterCutoffFreq,
     int spectrumLength, ComplexSignal *spectrum);
-
-  bool exportEmaTrajectories(const wxString &fileName);
-  bool exportVocalTractVideoFrames(const wxString &folderName);
+  void calcRadiatedNoiseSweep(double noiseFilterCutoffFreq, int spectrumLength);
+  bool exportRadiatedNoiseMap(const wxString &fileName);
+
+  bool getEmaPointIndices(const wxString &pointNames, vector<int> &pointIndices);
+  bool calcEmaTrajectories(GesturalScore *score, double frameRate_Hz, 
+    const vector<int> &pointIndices, vector<double> &coord, int &numFrames, 
+    vector<VocalTract*> *workerTracts = NULL);
+  bool writeEmaTrajectories(const wxString &fileName, EmaFileFormat format, double frameRate_Hz,
+    const vector<int> &pointIndices, const vector<double> &coord, int numFrames);
+  bool exportEmaTrajectories(const wxString &fileName, EmaFileFormat format = EMA_FILE_TEXT,
+    double frameRate_Hz = 200.0, const wxString &pointNames = "");
+  int exportEmaTrajectoriesBatch(const wxString &folderName, EmaFileFormat format, 
+    double frameRate_Hz, const wxString &pointNames);
+  bool exportVocalTractVideoFrames(const wxString &name, VideoFrameFormat format = VIDEO_FRAMES_BMP,
+    int frameRate = 30, int frameWidth = 0, int frameHeight = 0);
+  int calcScoreFrameParams(GesturalScore *score, double frameRate_Hz, vector<double> &frameParams);
+  bool exportGeometrySequence(const wxString &name, GeometrySequenceFormat format,
+    double frameRate_Hz, bool renderBothSides);
   bool exportTransferFunctionsFromScore(const wxString &fileName);
   void calcTongueRootData();
   
@@ -391,7 +549,8 @@ public:
     double maxParamChange_cm, double minArea_cm2, double releaseArea_cm2, bool paramFixed[]);
 
   bool getReleaseShape(VocalTract *vt, double *consonantParams, double *vowelParams,
-    double *releaseParams, double &releasePos, double releaseArea_cm2);
+    double *releaseParams, double &releasePos, double releaseArea_cm2,
+    ReleaseSearch *search = NULL);
 
   void createMinVocalTractArea(wxWindow *updateParent, VocalTract *tract, double minAdvisedArea_cm2,
     double skipRegionStart_cm = 0.0, double skipRegionEnd_cm = 0.0);
@@ -399,9 +558,20 @@ public:
     double targetF1, double targetF2, double targetF3);
   bool getVowelFormants(VocalTract *tract, double &F1_Hz, double &F2_Hz, double &F3_Hz, double &minArea_cm2);
   bool getConsonantFormants(VocalTract *tract, const wxString &contextVowel, double releaseArea_cm2,
-	  double &F1_Hz, double &F2_Hz, double &F3_Hz);
+	  double &F1_Hz, double &F2_Hz, double &F3_Hz, TlModel *model = NULL, 
+    ReleaseSearch *search = NULL);
   double getMinArea_cm2(VocalTract *tract, double startPos_cm, double endPos_cm);
   double getMinAreaOutsideConstriction_cm2(VocalTract *tract, double constrictionStartPos_cm, double constrictionEndPos_cm);
+  VocalTract *cloneVocalTract(VocalTract *source);
+  int createWorkerTracts(VocalTract *source, int numWorkers, vector<VocalTract*> &tracts);
+  void deleteWorkerTracts(vector<VocalTract*> &tracts);
+  bool compareWorkerCounts(GesturalScore *score);
+  Glottis *cloneGlottis(int index);
+  SynthesisContext *createSynthesisContext();
+  bool calculateVocalTract(VocalTract *tract, bool forceCalculation = false);
+  void invalidateVocalTract();
+  void vocalTractCalculatedExternally();
+  void benchmarkVocalTractCalculation(int numRepetitions = 20);
 
   void resetTdsBuffers();
 
@@ -412,16 +582,30 @@ public:
   void selectGlottis(int index);
 
   void updateTlModelGeometry(VocalTract *tract);
+  void getTlModelSpectrum(TlModel::SpectrumType type, ComplexSignal *spectrum,
+    int spectrumLength, int section);
+  void invalidateTlModelSpectra();
+  void getPoleZeroSpectrum(ComplexSignal *spectrum, int spectrumLength, double upperFrequencyLimit);
+  void getHigherPoleCorrection(ComplexSignal *spectrum, int spectrumLength, double effectiveLength_cm);
   void updateModelsFromGesturalScore();
   void getTubeSectionQuantity(TdsModel *model, int sectionIndex, double &leftValue, double &rightValue);
   void phoneticParamsToVocalTract();
   void normalizeAudioAmplitude(int trackIndex);
+  bool growTracks(int numSamples);
+  void trackChanged(int trackIndex = -1);
+  int getTrackLength();
 
   bool loadSpeaker(const wxString &fileName);
   bool saveSpeaker(const wxString &fileName);
+  bool getFileContentHash(const wxString &fileName, unsigned long long &hash);
+  wxString getSpeakerSnapshotFileName(unsigned long long contentHash);
+  bool writeSpeakerSnapshot(const wxString &fileName, unsigned long long contentHash, 
+    int numModels);
+  bool readSpeakerSnapshot(const wxString &fileName, unsigned long long contentHash);
 
   void estimateF0(wxWindow *parent, int trackIndex = -1);
   void estimateVoiceQuality(wxWindow *parent, int trackIndex = -1);
+  void estimateFormants(wxWindow *parent, int trackIndex = -1);
 
   void calcTriangularGlottisF0Params();
 
@@ -435,12 +619,103 @@ private:
   /// getSelectedGlottis(...)
   int selectedGlottis;
 
+  // ****************************************************************
+  // Cache for the spectra of the TL model. The tube geometry and the
+  // options of the last cached calculation are kept to find out
+  // which tube sections changed with the next geometry update.
+  // ****************************************************************
+
+  struct TlSpectrumCacheEntry
+  {
+    TlModel::SpectrumType type;
+    int spectrumLength;
+    int section;
+    ComplexSignal *spectrum;
+  };
+
+  vector<TlSpectrumCacheEntry> tlSpectrumCache;
+  TlModel::Options tlCacheOptions;
+  double tlCacheSectionArea_cm2[Tube::NUM_SECTIONS];
+  double tlCacheSectionLength_cm[Tube::NUM_SECTIONS];
+  int tlCacheSectionArticulator[Tube::NUM_SECTIONS];
+  /// Range of tube sections that changed with the last geometry update
+  /// (both -1 if no section changed).
+  int tlFirstChangedSection;
+  int tlLastChangedSection;
+  /// Incremented whenever the cached TL spectra become invalid
+  int tlCacheGeneration;
+
+  // ****************************************************************
+  // Radiated noise spectra for dipole sources at the boundaries of
+  // the pharynx and mouth sections (the first boundary is the
+  // beginning of the first pharynx section, the last one the end of
+  // the last mouth section). They include the noise shaping filter
+  // and the radiation characteristic and are calculated on demand
+  // until the geometry, the TL model options, or the cutoff 
+  // frequency change.
+  // ****************************************************************
+
+  ComplexSignal *noiseSweepSpectrum[Tube::NUM_PHARYNX_MOUTH_SECTIONS + 1];
+  ComplexSignal *noiseSweepShaping;
+  int noiseSweepSpectrumLength;
+  double noiseSweepCutoffFreq;
+  int noiseSweepGeneration;
+
+  // ****************************************************************
+  // The spectrum of the pole-zero plan is kept as the sum of the
+  // log-magnitudes and phases of the individual pole and zero 
+  // factors, so that moving one pole or zero only replaces the
+  // contribution of this factor. There is one cache per spectrum
+  // length, because the pictures request different lengths.
+  // ****************************************************************
+
+  struct PoleZeroFactor
+  {
+    PoleZeroPlan::Location location;
+    bool isPole;
+    vector<double> logMagnitude;
+    vector<double> phase;
+  };
+
+  struct PoleZeroSpectrumCache
+  {
+    int spectrumLength;
+    double upperFrequencyLimit;
+    int numPoles;
+    int numZeros;
+    int numIncrementalUpdates;
+    vector<PoleZeroFactor> factor;
+    vector<double> logMagnitudeSum;
+    vector<double> phaseSum;
+  };
+
+  struct HigherPoleCorrectionCache
+  {
+    int spectrumLength;
+    double effectiveLength_cm;
+    int numPoles;
+    vector<double> re;
+    vector<double> im;
+  };
+
+  vector<PoleZeroSpectrumCache> pzCache;
+  vector<HigherPoleCorrectionCache> pzHpcCache;
+  /// Plan with a single pole or zero to calculate the factors
+  PoleZeroPlan *pzSingleFactorPlan;
+
   // **************************************************************************
   // Private functions.
   // **************************************************************************
 
 private:
   Data();
+  bool tlCacheOptionsChanged();
+  double getTransitionMinArea_cm2(VocalTract *vt, double *consonantParams, double *vowelParams,
+    double transitionPos, double startPos_cm, double endPos_cm);
+  void calcPoleZeroFactor(PoleZeroFactor &factor, int spectrumLength, double upperFrequencyLimit);
+  void rebuildPoleZeroFactors(PoleZeroSpectrumCache &cache, double upperFrequencyLimit);
+  void prepareNoiseSweep(double noiseFilterCutoffFreq, int spectrumLength);
+  ComplexSignal *getNoiseSweepSpectrum(int boundary);
 };
 
 #endif
@@ -0,0 +1,518 @@
+// ****************************************************************************
+// This file is part of VocalTractLab.
+// Copyright (C) 2020, Peter Birkholz, Dresden, Germany
+// www.vocaltractlab.de
+// author: Peter Birkholz
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//
+// ****************************************************************************
+
+
+#include "FormantTracker.h"
+#include "ParallelJob.h"
+#include <cmath>
+#include <complex>
+#include <algorithm>
+
+// ****************************************************************************
+// Static constants.
+// ****************************************************************************
+
+const double FormantTracker::MIN_FORMANT_FREQ_HZ = 90.0;
+const double FormantTracker::MAX_BANDWIDTH_HZ = 400.0;
+const double FormantTracker::MIN_FRAME_RMS = 30.0;
+
+const double FormantTracker::FORMANT_RANGE_HZ[FormantTracker::NUM_FORMANTS][2] =
+{
+  { 150.0, 1100.0 },
+  { 550.0, 3000.0 },
+  { 1400.0, 3800.0 },
+  { 2400.0, 5000.0 }
+};
+
+
+// ****************************************************************************
+/// Analyzes the frames in the list frameIndex in parallel and writes the
+/// formants of each frame into the formant tracks of the tracker.
+// ****************************************************************************
+
+class FormantFrameJob : public ParallelJob
+{
+public:
+  FormantTracker *tracker;
+  Signal16 *signal;
+  vector<int> frameIndex;
+
+  virtual void processItem(int workerIndex, int itemIndex)
+  {
+    int k;
+    double frameFormants_Hz[FormantTracker::NUM_FORMANTS];
+    int frame = frameIndex[itemIndex];
+
+    tracker->analyzeFrame(signal, frame, frameFormants_Hz);
+    for (k=0; k < FormantTracker::NUM_FORMANTS; k++)
+    {
+      tracker->formant_Hz[k][frame] = frameFormants_Hz[k];
+    }
+  }
+};
+
+
+// ****************************************************************************
+/// Constructor. Designs the lowpass filter for the decimation (windowed sinc
+/// with the cutoff frequency slightly below the new Nyquist frequency).
+// ****************************************************************************
+
+FormantTracker::FormantTracker()
+{
+  const int M = FILTER_HALF_LENGTH;
+  const double CUTOFF = 0.45 / (double)DECIMATION_FACTOR;   // Relative to the sampling rate
+  int i;
+  double t;
+  double sum = 0.0;
+
+  timeStep_s = 0.01;
+  windowLength_s = 0.025;
+  samplingRate = 0;
+
+  decimationFilter.resize(2*M + 1);
+  for (i=0; i <= 2*M; i++)
+  {
+    t = (double)(i - M);
+    if (i == M)
+    {
+      decimationFilter[i] = 2.0*CUTOFF;
+    }
+    else
+    {
+      decimationFilter[i] = sin(2.0*M_PI*CUTOFF*t) / (M_PI*t);
+    }
+    decimationFilter[i]*= 0.54 + 0.46*cos(M_PI*t / (double)(M + 1));
+    sum+= decimationFilter[i];
+  }
+
+  // Unit gain at DC.
+  for (i=0; i <= 2*M; i++)
+  {
+    decimationFilter[i]/= sum;
+  }
+}
+
+
+// ****************************************************************************
+/// Discards all formant tracks, so that the next update(...) analyzes all
+/// frames.
+// ****************************************************************************
+
+void FormantTracker::clear()
+{
+  int k;
+  for (k=0; k < NUM_FORMANTS; k++)
+  {
+    formant_Hz[k].clear();
+  }
+  frameKey.clear();
+}
+
+
+// ****************************************************************************
+/// Updates the formant tracks for the given signal. Only the frames that are
+/// new or whose samples have changed since the last update are analyzed.
+/// Returns the number of analyzed frames.
+// ****************************************************************************
+
+int FormantTracker::update(Signal16 *signal, int samplingRate)
+{
+  int i, k;
+  int numFrames;
+  int numOldFrames;
+  int frameStep_pt;
+  unsigned long long key;
+  FormantFrameJob job;
+
+  if (samplingRate != this->samplingRate)
+  {
+    clear();
+    this->samplingRate = samplingRate;
+  }
+
+  frameStep_pt = (int)(timeStep_s*samplingRate + 0.5);
+  if ((signal == NULL) || (signal->N < 1) || (frameStep_pt < 1))
+  {
+    clear();
+    return 0;
+  }
+
+  numFrames = (signal->N - 1) / frameStep_pt + 1;
+  numOldFrames = (int)frameKey.size();
+  if (numOldFrames > numFrames)
+  {
+    numOldFrames = numFrames;
+  }
+
+  frameKey.resize(numFrames);
+  for (k=0; k < NUM_FORMANTS; k++)
+  {
+    formant_Hz[k].resize(numFrames, 0.0);
+  }
+
+  // ****************************************************************
+  // Collect the frames to analyze.
+  // ****************************************************************
+
+  job.tracker = this;
+  job.signal = signal;
+
+  for (i=0; i < numFrames; i++)
+  {
+    key = getFrameKey(signal, i);
+    if ((i >= numOldFrames) || (key != frameKey[i]))
+    {
+      frameKey[i] = key;
+      job.frameIndex.push_back(i);
+    }
+  }
+
+  if (job.frameIndex.empty() == false)
+  {
+    job.run((int)job.frameIndex.size(), ParallelJob::getNumWorkers((int)job.frameIndex.size()));
+  }
+
+  return (int)job.frameIndex.size();
+}
+
+
+// ****************************************************************************
+/// Estimates the formants of the given frame. Returns false, if the frame is
+/// too quiet or the LPC analysis failed. In this case, all formants are 0.
+/// Formants that could not be found are 0 as well.
+// ****************************************************************************
+
+bool FormantTracker::analyzeFrame(Signal16 *signal, int frameIndex, double *frameFormants_Hz)
+{
+  const int M = FILTER_HALF_LENGTH;
+  const double PRE_EMPHASIS = 0.97;
+  int i, j, k;
+  int center, halfLength;
+  int pos, length;
+  int numCandidates;
+  double sum, rms;
+  double decimatedRate_Hz = (double)samplingRate / (double)DECIMATION_FACTOR;
+  double r[LPC_ORDER + 1];
+  double a[LPC_ORDER + 1];
+  double re[LPC_ORDER];
+  double im[LPC_ORDER];
+  double freq_Hz, bandwidth_Hz;
+  vector<double> y;
+  vector<double> candidates;
+
+  for (k=0; k < NUM_FORMANTS; k++)
+  {
+    frameFormants_Hz[k] = 0.0;
+  }
+
+  getFrameRange(frameIndex, center, halfLength);
+  length = 2*halfLength;
+  if (length <= LPC_ORDER)
+  {
+    return false;
+  }
+
+  // ****************************************************************
+  // Lowpass filter and decimate the frame.
+  // ****************************************************************
+
+  y.resize(length);
+  for (i=0; i < length; i++)
+  {
+    pos = center + (i - halfLength)*DECIMATION_FACTOR - M;
+    sum = 0.0;
+    for (j=0; j <= 2*M; j++)
+    {
+      if ((pos + j >= 0) && (pos + j < signal->N))
+      {
+        sum+= decimationFilter[j] * signal->x[pos + j];
+      }
+    }
+    y[i] = sum;
+  }
+
+  // Skip silent frames.
+  sum = 0.0;
+  for (i=0; i < length; i++)
+  {
+    sum+= y[i]*y[i];
+  }
+  rms = sqrt(sum / (double)length);
+  if (rms < MIN_FRAME_RMS)
+  {
+    return false;
+  }
+
+  // ****************************************************************
+  // Pre-emphasis and Hamming window.
+  // ****************************************************************
+
+  for (i=length-1; i > 0; i--)
+  {
+    y[i]-= PRE_EMPHASIS*y[i-1];
+  }
+  y[0]*= 1.0 - PRE_EMPHASIS;
+
+  for (i=0; i < length; i++)
+  {
+    y[i]*= 0.54 - 0.46*cos(2.0*M_PI*i / (double)(length - 1));
+  }
+
+  // ****************************************************************
+  // Autocorrelation and LPC coefficients.
+  // ****************************************************************
+
+  for (k=0; k <= LPC_ORDER; k++)
+  {
+    sum = 0.0;
+    for (i=0; i < length - k; i++)
+    {
+      sum+= y[i]*y[i+k];
+    }
+    r[k] = sum;
+  }
+  // Slight white noise correction for numerical stability.
+  r[0]*= 1.0001;
+
+  if (levinsonDurbin(r, LPC_ORDER, a) == false)
+  {
+    return false;
+  }
+
+  // ****************************************************************
+  // Convert the complex roots in the upper half plane into formant
+  // candidates and keep the narrow-band ones.
+  // ****************************************************************
+
+  numCandidates = findRoots(a, LPC_ORDER, re, im);
+  for (i=0; i < numCandidates; i++)
+  {
+    if (im[i] <= 0.0)
+    {
+      continue;
+    }
+    freq_Hz = atan2(im[i], re[i]) * decimatedRate_Hz / (2.0*M_PI);
+    bandwidth_Hz = -log(sqrt(re[i]*re[i] + im[i]*im[i])) * decimatedRate_Hz / M_PI;
+    if ((freq_Hz > MIN_FORMANT_FREQ_HZ) && (freq_Hz < 0.5*decimatedRate_Hz - MIN_FORMANT_FREQ_HZ) &&
+      (bandwidth_Hz > 0.0) && (bandwidth_Hz < MAX_BANDWIDTH_HZ))
+    {
+      candidates.push_back(freq_Hz);
+    }
+  }
+
+  // ****************************************************************
+  // Assign the candidates in ascending order to the formants. Each 
+  // formant takes the lowest remaining candidate within its range, or
+  // stays 0 when there is none.
+  // ****************************************************************
+
+  sort(candidates.begin(), candidates.end());
+  j = 0;
+  for (k=0; k < NUM_FORMANTS; k++)
+  {
+    while ((j < (int)candidates.size()) && (candidates[j] < FORMANT_RANGE_HZ[k][0]))
+    {
+      j++;
+    }
+    if ((j < (int)candidates.size()) && (candidates[j] <= FORMANT_RANGE_HZ[k][1]))
+    {
+      frameFormants_Hz[k] = candidates[j];
+      j++;
+    }
+  }
+
+  return true;
+}
+
+
+// ****************************************************************************
+/// Returns a hash (FNV-1a) of all samples that the analysis of the given
+/// frame depends on.
+// ****************************************************************************
+
+unsigned long long FormantTracker::getFrameKey(Signal16 *signal, int frameIndex)
+{
+  const unsigned long long FNV_PRIME = 1099511628211ULL;
+  int i;
+  int center, halfLength;
+  int first, last;
+  unsigned long long hash = 14695981039346656037ULL;
+  unsigned short value;
+
+  getFrameRange(frameIndex, center, halfLength);
+  first = center - halfLength*DECIMATION_FACTOR - FILTER_HALF_LENGTH;
+  last = center + (halfLength - 1)*DECIMATION_FACTOR + FILTER_HALF_LENGTH;
+  if (first < 0)
+  {
+    first = 0;
+  }
+  if (last > signal->N - 1)
+  {
+    last = signal->N - 1;
+  }
+
+  for (i=first; i <= last; i++)
+  {
+    value = (unsigned short)signal->x[i];
+    hash = (hash ^ (value & 0xFF)) * FNV_PRIME;
+    hash = (hash ^ (value >> 8)) * FNV_PRIME;
+  }
+
+  return hash;
+}
+
+
+// ****************************************************************************
+/// Returns the center sample of the given frame (at the original sampling
+/// rate) and the half window length in samples at the decimated rate.
+// ****************************************************************************
+
+void FormantTracker::getFrameRange(int frameIndex, int &center, int &halfLength)
+{
+  int frameStep_pt = (int)(timeStep_s*samplingRate + 0.5);
+  center = frameIndex*frameStep_pt;
+  halfLength = (int)(0.5*windowLength_s*samplingRate / (double)DECIMATION_FACTOR);
+}
+
+
+// ****************************************************************************
+/// Calculates the coefficients a[0] = 1, a[1] ... a[order] of the LPC
+/// inverse filter from the autocorrelation r[0] ... r[order].
+/// Returns false, if the prediction error vanishes.
+// ****************************************************************************
+
+bool FormantTracker::levinsonDurbin(const double *r, int order, double *a)
+{
+  int i, j;
+  double error = r[0];
+  double k;
+  double temp[LPC_ORDER + 1];
+
+  if (error <= 0.0)
+  {
+    return false;
+  }
+
+  a[0] = 1.0;
+  for (i=1; i <= order; i++)
+  {
+    a[i] = 0.0;
+  }
+
+  for (i=1; i <= order; i++)
+  {
+    k = r[i];
+    for (j=1; j < i; j++)
+    {
+      k+= a[j]*r[i-j];
+    }
+    k = -k / error;
+
+    for (j=0; j <= i; j++)
+    {
+      temp[j] = a[j];
+    }
+    for (j=1; j < i; j++)
+    {
+      a[j] = temp[j] + k*temp[i-j];
+    }
+    a[i] = k;
+
+    error*= 1.0 - k*k;
+    if (error <= 0.0)
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+
+// ****************************************************************************
+/// Finds the roots of the polynomial z^order + a[1]z^(order-1) + ... + 
+/// a[order] with the Durand-Kerner method. Returns the number of roots.
+// ****************************************************************************
+
+int FormantTracker::findRoots(const double *a, int order, double *re, double *im)
+{
+  const int MAX_ITERATIONS = 500;
+  const double EPSILON = 1e-12;
+  int i, j, n;
+  double maxChange;
+  complex<double> z[LPC_ORDER];
+  complex<double> p, q, delta;
+
+  // Initial values distributed on a spiral.
+  z[0] = complex<double>(1.0, 0.0);
+  for (i=1; i < order; i++)
+  {
+    z[i] = z[i-1] * complex<double>(0.4, 0.9);
+  }
+
+  for (n=0; n < MAX_ITERATIONS; n++)
+  {
+    maxChange = 0.0;
+    for (i=0; i < order; i++)
+    {
+      // Evaluate the polynomial with the Horner scheme.
+      p = 1.0;
+      for (j=1; j <= order; j++)
+      {
+        p = p*z[i] + a[j];
+      }
+
+      q = 1.0;
+      for (j=0; j < order; j++)
+      {
+        if (j != i)
+        {
+          q*= z[i] - z[j];
+        }
+      }
+
+      if (abs(q) > 0.0)
+      {
+        delta = p / q;
+        z[i]-= delta;
+        if (abs(delta) > maxChange)
+        {
+          maxChange = abs(delta);
+        }
+      }
+    }
+
+    if (maxChange < EPSILON)
+    {
+      break;
+    }
+  }
+
+  for (i=0; i < order; i++)
+  {
+    re[i] = z[i].real();
+    im[i] = z[i].imag();
+  }
+
+  return order;
+}
+
+// ****************************************************************************
@@ -0,0 +1,98 @@
+// ****************************************************************************
+// This file is part of VocalTractLab.
+// Copyright (C) 2020, Peter Birkholz, Dresden, Germany
+// www.vocaltractlab.de
+// author: Peter Birkholz
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//
+// ****************************************************************************
+
+
+#ifndef __FORMANT_TRACKER_H__
+#define __FORMANT_TRACKER_H__
+
+#include <vector>
+#include "VocalTractLabBackend/Signal.h"
+
+using namespace std;
+
+// ****************************************************************************
+/// Estimates the formant tracks F1 ... F4 of a whole audio track by LPC
+/// analysis: each frame is lowpass filtered and decimated, pre-emphasized,
+/// windowed, and the roots of the LPC polynomial (Levinson-Durbin) are
+/// converted into formant frequencies. The frames are analyzed in parallel.
+/// The result is kept per track, and a hash of the samples of each frame is
+/// stored along with it, so that update(...) only re-analyzes the frames
+/// whose samples were changed since the last call (e.g., after editing a
+/// region of the track). Frames without a formant estimate have the value 0.
+/// Each formant only takes candidates within its own frequency range, so
+/// that a formant that was not found leaves a 0 instead of shifting the 
+/// higher formants down by one.
+// ****************************************************************************
+
+class FormantTracker
+{
+  // **************************************************************************
+  // Public data.
+  // **************************************************************************
+
+public:
+  static const int NUM_FORMANTS = 4;
+  static const int DECIMATION_FACTOR = 4;
+  static const int LPC_ORDER = 12;
+  static const int FILTER_HALF_LENGTH = 32;   ///< Of the decimation filter
+  static const double MIN_FORMANT_FREQ_HZ;
+  static const double MAX_BANDWIDTH_HZ;
+  static const double MIN_FRAME_RMS;
+  /// Lower and upper frequency limit of each formant.
+  static const double FORMANT_RANGE_HZ[NUM_FORMANTS][2];
+
+  double timeStep_s;
+  double windowLength_s;
+  vector<double> formant_Hz[NUM_FORMANTS];
+
+  // **************************************************************************
+  // Public functions.
+  // **************************************************************************
+
+public:
+  FormantTracker();
+  void clear();
+  int update(Signal16 *signal, int samplingRate);
+  bool analyzeFrame(Signal16 *signal, int frameIndex, double *frameFormants_Hz);
+  unsigned long long getFrameKey(Signal16 *signal, int frameIndex);
+
+  // **************************************************************************
+  // Private data.
+  // **************************************************************************
+
+private:
+  int samplingRate;
+  vector<unsigned long long> frameKey;
+  vector<double> decimationFilter;
+
+  // **************************************************************************
+  // Private functions.
+  // **************************************************************************
+
+private:
+  void getFrameRange(int frameIndex, int &center, int &halfLength);
+  static bool levinsonDurbin(const double *r, int order, double *a);
+  static int findRoots(const double *a, int order, double *re, double *im);
+};
+
+#endif
+
+// ****************************************************************************
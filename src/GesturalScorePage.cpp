@@ -24,6 +24,7 @@
 #include "AnnotationDialog.h"
 #include "SilentMessageBox.h"
 #include "SoundLib.h"
+#include "PreviewSynthesizer.h"
 
 #include <stdio.h>
 #include <wx/config.h>
@@ -33,6 +34,8 @@
 #include <wx/progdlg.h>
 #include <wx/filename.h>
 #include <wx/wupdlock.h>
+#include <wx/busyinfo.h>
+#include <wx/stopwatch.h>
 
 using namespace std;
 
@@ -67,6 +70,8 @@ static const int IDC_SHOW_SEGMENTATION = 4053;
 static const int IDC_SHOW_MODEL_F0_CURVE = 4054;
 static const int IDC_SHOW_ANIMATION    = 4055;
 static const int IDC_NORMALIZE_AMPLITUDE = 4056;
+static const int IDC_FAST_PREVIEW     = 4057;
+static const int IDC_QUICK_RENDER     = 4058;
 
 static const int IDB_SYNTHESIZE       = 4060;
 static const int IDB_ACOUSTICS        = 4061;
@@ -107,6 +112,8 @@ BEGIN_EVENT_TABLE(GesturalScorePage, wxPanel)
   EVT_CHECKBOX(IDC_SHOW_MODEL_F0_CURVE, GesturalScorePage::OnShowModelF0Curve)
   EVT_CHECKBOX(IDC_SHOW_ANIMATION, GesturalScorePage::OnShowAnimation)
   EVT_CHECKBOX(IDC_NORMALIZE_AMPLITUDE, GesturalScorePage::OnNormalizeAmplitude)
+  EVT_CHECKBOX(IDC_FAST_PREVIEW, GesturalScorePage::OnFastPreview)
+  EVT_CHECKBOX(IDC_QUICK_RENDER, GesturalScorePage::OnQuickRender)
 
   EVT_BUTTON(IDB_SYNTHESIZE, GesturalScorePage::OnSynthesize)
   EVT_BUTTON(IDB_ACOUSTICS, GesturalScorePage::OnAcoustics)
@@ -323,6 +330,13 @@ void GesturalScorePage::initWidgets()
   chkNormalizeAmplitude = new wxCheckBox(this, IDC_NORMALIZE_AMPLITUDE, "Normalize audio amplitude");
   leftSizer->Add(chkNormalizeAmplitude, 0, wxALL | wxGROW, 3);
 
+  chkFastPreview = new wxCheckBox(this, IDC_FAST_PREVIEW, 
+    wxString::Format("Fast preview (%d Hz)", data->previewSamplingRate));
+  leftSizer->Add(chkFastPreview, 0, wxALL | wxGROW, 3);
+
+  chkQuickRender = new wxCheckBox(this, IDC_QUICK_RENDER, "Quick render (no TDS)");
+  leftSizer->Add(chkQuickRender, 0, wxALL | wxGROW, 3);
+
   button = new wxButton(this, IDB_SYNTHESIZE, "Synthesize");
   leftSizer->Add(button, 0, wxALL | wxGROW, 3);
   
@@ -513,6 +527,8 @@ void GesturalScorePage::updateWidgets()
 
   chkShowAnimation->SetValue( data->showAnimation );
   chkNormalizeAmplitude->SetValue(data->normalizeAmplitude);
+  chkFastPreview->SetValue(data->fastPreview);
+  chkQuickRender->SetValue(data->quickRender);
 
   // ****************************************************************
   // Vertical scrollbar at the gestural score picture.
@@ -1080,6 +1096,8 @@ void GesturalScorePage::OnUpdateRequest(wxCommandEvent &event)
   if (event.GetInt() == REFRESH_PICTURES_AND_CONTROLS)
   {
     updateWidgets();
+    // Settings may have changed that are not part of the row keys.
+    signalComparisonPicture->invalidateRows();
 
     // Refreshing of pictures is not included in updateWidgets() currently !!!
     timeAxisPicture->Refresh();
@@ -1090,6 +1108,8 @@ void GesturalScorePage::OnUpdateRequest(wxCommandEvent &event)
   if (event.GetInt() == UPDATE_PICTURES_AND_CONTROLS)
   {
     updateWidgets();
+    // Settings may have changed that are not part of the row keys.
+    signalComparisonPicture->invalidateRows();
 
     // Refreshing of pictures is not included in updateWidgets() currently !!!
     timeAxisPicture->Refresh();
@@ -1458,7 +1478,30 @@ void GesturalScorePage::OnNormalizeAmplitude(wxCommandEvent& event)
 
 
 // ****************************************************************************
-/// Starts the synthesis from the gestural score.
+// ****************************************************************************
+
+void GesturalScorePage::OnFastPreview(wxCommandEvent &event)
+{
+  data->fastPreview = !data->fastPreview;
+  updateWidgets();
+}
+
+
+// ****************************************************************************
+// ****************************************************************************
+
+void GesturalScorePage::OnQuickRender(wxCommandEvent &event)
+{
+  data->quickRender = !data->quickRender;
+  updateWidgets();
+}
+
+
+// ****************************************************************************
+/// Starts the synthesis from the gestural score. When the score was 
+/// synthesized before with the same settings, the synthesis continues from
+/// the last checkpoint before the first change of the parameter 
+/// trajectories, and the audio signal before it is taken over.
 // ****************************************************************************
 
 void GesturalScorePage::OnSynthesize(wxCommandEvent &event)
@@ -1470,9 +1513,12 @@ void GesturalScorePage::OnSynthesize(wxCommandEvent &event)
     data->synthesisSpeed_percent = 100.0;
   }
 
-  // Clear the audio track
+  // Clear the audio track and make sure that it can take the whole
+  // utterance.
 
+  data->growTracks(data->gesturalScore->getDuration_pt());
   data->track[Data::MAIN_TRACK]->setZero();
+  data->trackChanged(Data::MAIN_TRACK);
 
   // ****************************************************************
   // Prepare the synthesis.
@@ -1488,9 +1534,18 @@ void GesturalScorePage::OnSynthesize(wxCommandEvent &event)
   // Set the currently selected glottis model.
   data->gesturalScore->glottis = data->getSelectedGlottis();
 
-  tubeSequence->resetSequence();
-  data->tdsModel->resetMotion();
-  data->resetTdsBuffers();
+  if ((data->quickRender) || (data->fastPreview))
+  {
+    synthesizePreview();
+    return;
+  }
+
+  // ****************************************************************
+  // Continue from the last checkpoint of the previous synthesis 
+  // before the first change, if possible.
+  // ****************************************************************
+
+  data->startGesturalScoreSynthesis();
 
   // ****************************************************************
   // Create the synthesis thread (it will be destroyed automatically
@@ -1503,6 +1558,7 @@ void GesturalScorePage::OnSynthesize(wxCommandEvent &event)
     wxPrintf("ERROR: Can't create synthesis thread!");
     return;
   }
+  synthesisThread->setCheckpoints(&data->gesturalScoreCheckpoints);
 
   // Create the progress dialog
 
@@ -1520,6 +1576,98 @@ void GesturalScorePage::OnSynthesize(wxCommandEvent &event)
 }
 
 
+// ****************************************************************************
+/// Synthesizes the gestural score for the preview and plays it: with the 
+/// quick rendering in the frequency domain (see 
+/// Data::quickRenderGesturalScore()), or with the TDS at the reduced 
+/// sampling rate of the fast preview (see PreviewSynthesizer).
+// ****************************************************************************
+
+void GesturalScorePage::synthesizePreview()
+{
+  vector<double> audio;
+  wxStopWatch stopWatch;
+  double value;
+  int i;
+
+  {
+    wxBusyInfo wait("Please wait...");
+    if (data->quickRender)
+    {
+      data->quickRenderGesturalScore(data->gesturalScore, data->lfPulse, audio);
+      wxPrintf("The quick rendering took %ld ms.\n", stopWatch.Time());
+    }
+    else
+    if (PreviewSynthesizer::synthesize(data->gesturalScore, data->tdsModel, 
+      data->previewSamplingRate, audio) == false)
+    {
+      wxPrintf("Error: The preview sampling rate must be between %d and %d Hz.\n",
+        PreviewSynthesizer::MIN_SAMPLING_RATE, SAMPLING_RATE);
+    }
+    // The score calculated the main vocal tract for its frames.
+    data->vocalTractCalculatedExternally();
+  }
+
+  for (i=0; (i < (int)audio.size()) && (i < data->track[Data::MAIN_TRACK]->N); i++)
+  {
+    value = audio[i];
+    if (value > 32767.0)
+    {
+      value = 32767.0;
+    }
+    if (value < -32768.0)
+    {
+      value = -32768.0;
+    }
+    data->track[Data::MAIN_TRACK]->setValue(i, (short)value);
+  }
+  data->trackChanged(Data::MAIN_TRACK);
+
+  if ((audio.empty() == false) && (data->normalizeAmplitude))
+  {
+    data->normalizeAudioAmplitude(Data::MAIN_TRACK);
+  }
+
+  // Set the lung pressure and F0 that the user adjusted before.
+  data->getSelectedGlottis()->controlParam[ Glottis::PRESSURE ].x = data->userPressure_dPa;
+  data->getSelectedGlottis()->controlParam[ Glottis::FREQUENCY ].x = data->userF0_Hz;
+
+  updateWidgets();
+  gesturalScorePicture->Refresh();
+  gesturalScorePicture->Update();
+  signalComparisonPicture->Refresh();
+  signalComparisonPicture->Update();
+
+  if (audio.empty() == false)
+  {
+    playMainTrack();
+  }
+}
+
+
+// ****************************************************************************
+/// Plays the main track until the user presses OK.
+// ****************************************************************************
+
+void GesturalScorePage::playMainTrack()
+{
+  if (waveStartPlaying(data->track[Data::MAIN_TRACK]->x, data->track[Data::MAIN_TRACK]->N, true))
+  {
+    wxYield();
+    SilentMessageBox dialog("Press OK to stop playing!", "Stop playing");
+    dialog.ShowModal();
+    wxYield();
+
+    waveStopPlaying();
+  }
+  else
+  {
+    wxMessageDialog dialog(this, "Playing failed.", "Attention!");
+    dialog.ShowModal();
+  }
+}
+
+
 // ****************************************************************************
 // ****************************************************************************
 
@@ -1528,6 +1676,11 @@ void GesturalScorePage::OnSynthesisThreadEvent(wxCommandEvent& event)
   TubeSequence* sequence = data->getSelectedTubeSequence();
   int n = event.GetInt();
 
+  // The synthesis thread wrote new samples into the main track and
+  // calculated the main vocal tract for the frames of the score.
+  data->trackChanged(Data::MAIN_TRACK);
+  data->vocalTractCalculatedExternally();
+
   // The thread reached its end - either normally or by the call
   // to wxThread::Destroy()
 
@@ -1564,20 +1717,7 @@ void GesturalScorePage::OnSynthesisThreadEvent(wxCommandEvent& event)
 
     if (sequence->getPos_pt() >= sequence->getDuration_pt())
     {
-      if (waveStartPlaying(data->track[Data::MAIN_TRACK]->x, data->track[Data::MAIN_TRACK]->N, true))
-      {
-        wxYield();
-        SilentMessageBox dialog("Press OK to stop playing!", "Stop playing");
-        dialog.ShowModal();
-        wxYield();
-
-        waveStopPlaying();
-      }
-      else
-      {
-        wxMessageDialog dialog(this, "Playing failed.", "Attention!");
-        dialog.ShowModal();
-      }
+      playMainTrack();
     }
 
     // Set the lung pressure and F0 that the user adjusted before the sequence started
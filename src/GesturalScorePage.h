@@ -107,6 +107,8 @@ private:
 
   wxCheckBox *chkShowAnimation;
   wxCheckBox* chkNormalizeAmplitude;
+  wxCheckBox *chkFastPreview;
+  wxCheckBox *chkQuickRender;
 
   GesturalScorePicture *gesturalScorePicture;
   SignalComparisonPicture *signalComparisonPicture;
@@ -118,6 +120,8 @@ private:
 
 private:
   void fillGestureValueList(bool forced = false);
+  void synthesizePreview();
+  void playMainTrack();
 
   void OnUpdateRequest(wxCommandEvent &event);
 
@@ -148,6 +152,8 @@ private:
 
   void OnShowAnimation(wxCommandEvent &event);
   void OnNormalizeAmplitude(wxCommandEvent& event);
+  void OnFastPreview(wxCommandEvent &event);
+  void OnQuickRender(wxCommandEvent &event);
   void OnSynthesize(wxCommandEvent &event);
   
   // Events from the synthesis thread
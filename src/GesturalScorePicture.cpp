@@ -436,6 +436,10 @@ void GesturalScorePicture::paintGesturalScore(wxDC &dc)
   int index;
   double pos_s;
 
+  // The parameters are taken from the sampled trajectories, which
+  // are only recalculated where the score changed.
+  data->scoreTrajectory.update(gs);
+
   // Run through all pixels from left to right.
 
   // Drawing a list of points is MUCH faster than drawing each individual line
@@ -447,7 +451,7 @@ void GesturalScorePicture::paintGesturalScore(wxDC &dc)
     pos_s = data->gsTimeAxisGraph->getAbsXValue(x);
 
     // Get the vocal tract and glottis params into the same array.
-    gs->getParams(pos_s, &params[0], &params[VocalTract::NUM_PARAMS]);
+    data->scoreTrajectory.getParams(pos_s, &params[0], &params[VocalTract::NUM_PARAMS]);
 
     // Transform the F0 parameter from Hz to semitones for the display.
     params[VocalTract::NUM_PARAMS + Glottis::FREQUENCY] = 
@@ -691,6 +695,8 @@ void GesturalScorePicture::paintMotorProgram(wxDC &dc)
   double params[MAX_PARAMS];
   int prevY[MAX_PARAMS] = { 0 };
 
+  data->scoreTrajectory.update(gs);
+
   // Run through all pixels from left to right.
   // Drawing a list of points is MUCH faster than drawing each individual line
   // We therefore gather each sequence of lines in a vector and then draw all of them at the end
@@ -700,7 +706,7 @@ void GesturalScorePicture::paintMotorProgram(wxDC &dc)
     pos_s = data->gsTimeAxisGraph->getAbsXValue(x);
 
     // Get the vocal tract and glottis params into the same array.
-    gs->getParams(pos_s, &params[0], &params[VocalTract::NUM_PARAMS]);
+    data->scoreTrajectory.getParams(pos_s, &params[0], &params[VocalTract::NUM_PARAMS]);
 
     // Run through all rows
     for (i=0; i < N; i++)
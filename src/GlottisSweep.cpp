@@ -0,0 +1,402 @@
+// ****************************************************************************
+// This file is part of VocalTractLab.
+// Copyright (C) 2020, Peter Birkholz, Dresden, Germany
+// www.vocaltractlab.de
+// author: Peter Birkholz
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//
+// ****************************************************************************
+
+
+#include "GlottisSweep.h"
+#include "Data.h"
+#include "ParallelJob.h"
+#include "SynthesisContext.h"
+#include "VocalTractLabBackend/Synthesizer.h"
+
+#include <fstream>
+#include <string>
+#include <cstdio>
+#include <cstring>
+
+
+// ****************************************************************************
+/// Synthesizes and analyzes the vowel of one combination of the sweep. Each
+/// worker has its own synthesis context, whose glottis is set back to the 
+/// base parameter values before each combination.
+// ****************************************************************************
+
+class GlottisSweepJob : public ParallelJob
+{
+public:
+  GlottisSweep *sweep;
+  vector<SynthesisContext*> *context;
+  vector<double> baseStaticParams;
+  vector<double> baseControlParams;
+
+  virtual void processItem(int workerIndex, int itemIndex)
+  {
+    SynthesisContext *c = (*context)[workerIndex];
+    Glottis *g = c->glottis[sweep->glottisIndex];
+    GlottisSweep::Result &r = sweep->result[itemIndex];
+    vector<double> signal;
+    double timeStep_s;
+    double duration_s;
+    int i;
+
+    for (i=0; i < (int)baseStaticParams.size(); i++)
+    {
+      g->staticParam[i].x = baseStaticParams[i];
+    }
+    for (i=0; i < (int)baseControlParams.size(); i++)
+    {
+      g->controlParam[i].x = baseControlParams[i];
+    }
+
+    sweep->getCombination(itemIndex, r.value);
+    for (i=0; i < (int)sweep->range.size(); i++)
+    {
+      if (sweep->range[i].type == GlottisSweep::STATIC_PARAM)
+      {
+        g->staticParam[sweep->range[i].index].x = r.value[i];
+      }
+      else
+      {
+        g->controlParam[sweep->range[i].index].x = r.value[i];
+      }
+    }
+
+    Synthesizer::synthesizeStaticPhoneme(g, c->vocalTract, c->tdsModel, true, true, c->audio);
+    r.numSamples = (int)c->audio.size();
+    r.ok = (r.numSamples > 0);
+    if (r.ok == false)
+    {
+      return;
+    }
+    duration_s = (double)r.numSamples / SAMPLING_RATE;
+
+    // Measure F0 and the voice quality at the analysis position.
+
+    if (c->estimateF0(signal, timeStep_s))
+    {
+      i = (int)(sweep->analysisPos*duration_s / timeStep_s);
+      if ((i >= 0) && (i < (int)signal.size()))
+      {
+        r.f0_Hz = signal[i];
+      }
+    }
+
+    if (c->estimateVoiceQuality(signal, timeStep_s))
+    {
+      i = (int)(sweep->analysisPos*duration_s / timeStep_s);
+      if ((i >= 0) && (i < (int)signal.size()))
+      {
+        r.voiceQuality = signal[i];
+      }
+    }
+  }
+};
+
+
+// ****************************************************************************
+/// Constructor.
+// ****************************************************************************
+
+GlottisSweep::GlottisSweep()
+{
+  glottisIndex = Data::TRIANGULAR_GLOTTIS;
+  analysisPos = 0.5;
+}
+
+
+// ****************************************************************************
+/// Adds a parameter with numValues equally spaced values between min and max
+/// (only min, if numValues is 1).
+// ****************************************************************************
+
+void GlottisSweep::addRange(ParamType type, int index, double min, double max, int numValues)
+{
+  Range r;
+
+  r.type = type;
+  r.index = index;
+  r.min = min;
+  r.max = max;
+  r.numValues = (numValues < 1) ? 1 : numValues;
+  range.push_back(r);
+}
+
+
+// ****************************************************************************
+/// Sets up the sweep for the calibration of the F0 parameters of the
+/// triangular glottis: Vowels with the tension factors Q = 0.7, 1.0 and 1.3
+/// (result 0, 1 and 2) at a lung pressure of 800 Pa.
+// ****************************************************************************
+
+void GlottisSweep::setTriangularGlottisF0Preset()
+{
+  glottisIndex = Data::TRIANGULAR_GLOTTIS;
+  analysisPos = 0.5;
+  range.clear();
+  result.clear();
+
+  addRange(STATIC_PARAM, TriangularGlottis::NATURAL_F0, 100.0, 100.0, 1);
+  addRange(STATIC_PARAM, TriangularGlottis::F0_DIV_Q, 100.0, 100.0, 1);
+  addRange(CONTROL_PARAM, TriangularGlottis::PRESSURE, 8000.0, 8000.0, 1);
+  addRange(CONTROL_PARAM, TriangularGlottis::FREQUENCY, 70.0, 130.0, 3);
+}
+
+
+// ****************************************************************************
+/// Reads the sweep from a definition file (see the class description).
+// ****************************************************************************
+
+bool GlottisSweep::readDefinition(const wxString &fileName)
+{
+  ifstream is(fileName.ToStdString().c_str());
+  string line;
+  char type[32];
+  int index;
+  int numValues;
+  double min, max;
+  int lineNumber = 0;
+
+  if (!is)
+  {
+    wxPrintf("Error: Could not open the sweep definition %s.\n", fileName.c_str());
+    return false;
+  }
+
+  range.clear();
+  result.clear();
+
+  while (getline(is, line))
+  {
+    lineNumber++;
+    if ((line.empty()) || (line[0] == '#'))
+    {
+      continue;
+    }
+
+    if (sscanf(line.c_str(), "glottis %d", &index) == 1)
+    {
+      glottisIndex = index;
+    }
+    else
+    if (sscanf(line.c_str(), "position %lf", &min) == 1)
+    {
+      analysisPos = min;
+    }
+    else
+    if ((sscanf(line.c_str(), "%31s %d %lf %lf %d", type, &index, &min, &max, &numValues) == 5) &&
+      ((strcmp(type, "static") == 0) || (strcmp(type, "control") == 0)))
+    {
+      addRange(strcmp(type, "static") == 0 ? STATIC_PARAM : CONTROL_PARAM, index, min, max, numValues);
+    }
+    else
+    if (line.find_first_not_of(" \t\r") != string::npos)
+    {
+      wxPrintf("Error in line %d of the sweep definition %s.\n", lineNumber, fileName.c_str());
+      return false;
+    }
+  }
+
+  return true;
+}
+
+
+// ****************************************************************************
+/// Returns the number of parameter combinations of the sweep.
+// ****************************************************************************
+
+int GlottisSweep::getNumCombinations()
+{
+  int i;
+  int n = 1;
+
+  for (i=0; i < (int)range.size(); i++)
+  {
+    n*= range[i].numValues;
+  }
+  return n;
+}
+
+
+// ****************************************************************************
+/// Returns the parameter values (one per range) of the given combination. The
+/// values of the last range change fastest.
+// ****************************************************************************
+
+void GlottisSweep::getCombination(int combination, vector<double> &value)
+{
+  int i;
+  int k;
+
+  value.resize(range.size());
+  for (i = (int)range.size() - 1; i >= 0; i--)
+  {
+    k = combination % range[i].numValues;
+    combination /= range[i].numValues;
+
+    if (range[i].numValues < 2)
+    {
+      value[i] = range[i].min;
+    }
+    else
+    {
+      value[i] = range[i].min + k*(range[i].max - range[i].min) / (range[i].numValues - 1);
+    }
+  }
+}
+
+
+// ****************************************************************************
+/// Synthesizes and analyzes all combinations with the given number of workers
+/// (0 = number of CPU cores). The results are put into result.
+// ****************************************************************************
+
+bool GlottisSweep::run(int numWorkers)
+{
+  Data *data = Data::getInstance();
+  int numCombinations = getNumCombinations();
+  vector<SynthesisContext*> context;
+  GlottisSweepJob job;
+  int i;
+
+  if ((glottisIndex < 0) || (glottisIndex >= Data::NUM_GLOTTIS_MODELS) || (range.empty()))
+  {
+    wxPrintf("Error: Invalid glottis sweep.\n");
+    return false;
+  }
+
+  Glottis *g = data->glottis[glottisIndex];
+
+  for (i=0; i < (int)range.size(); i++)
+  {
+    if ((range[i].index < 0) ||
+      ((range[i].type == STATIC_PARAM) && (range[i].index >= (int)g->staticParam.size())) ||
+      ((range[i].type == CONTROL_PARAM) && (range[i].index >= (int)g->controlParam.size())))
+    {
+      wxPrintf("Error: Invalid parameter index %d in the glottis sweep.\n", range[i].index);
+      return false;
+    }
+  }
+
+  // ****************************************************************
+  // Create the synthesis contexts of the workers.
+  // ****************************************************************
+
+  if (numWorkers < 1)
+  {
+    numWorkers = ParallelJob::getNumWorkers(numCombinations);
+  }
+
+  for (i=0; i < numWorkers; i++)
+  {
+    SynthesisContext *c = data->createSynthesisContext();
+    if (c == NULL)
+    {
+      break;
+    }
+    context.push_back(c);
+  }
+
+  if (context.empty())
+  {
+    wxPrintf("Error: Failed to create the models for the glottis sweep.\n");
+    return false;
+  }
+
+  // ****************************************************************
+  // Run the sweep.
+  // ****************************************************************
+
+  for (i=0; i < (int)g->staticParam.size(); i++)
+  {
+    job.baseStaticParams.push_back(g->staticParam[i].x);
+  }
+  for (i=0; i < (int)g->controlParam.size(); i++)
+  {
+    job.baseControlParams.push_back(g->controlParam[i].x);
+  }
+
+  Result emptyResult;
+  emptyResult.ok = false;
+  emptyResult.numSamples = 0;
+  emptyResult.f0_Hz = 0.0;
+  emptyResult.voiceQuality = 0.0;
+  result.assign(numCombinations, emptyResult);
+
+  job.sweep = this;
+  job.context = &context;
+
+  wxStopWatch stopWatch;
+  job.run(numCombinations, (int)context.size());
+
+  wxPrintf("Synthesized and analyzed %d vowels of the glottis sweep in %2.1f s with %d workers.\n",
+    numCombinations, stopWatch.Time() / 1000.0, (int)context.size());
+
+  for (i=0; i < (int)context.size(); i++)
+  {
+    delete context[i];
+  }
+
+  return true;
+}
+
+
+// ****************************************************************************
+/// Writes the results as a tab-separated table with one row per combination.
+// ****************************************************************************
+
+bool GlottisSweep::writeResults(const wxString &fileName)
+{
+  Glottis *g = Data::getInstance()->glottis[glottisIndex];
+  int i, k;
+
+  ofstream os(fileName.ToStdString().c_str());
+  if (!os)
+  {
+    return false;
+  }
+
+  for (i=0; i < (int)range.size(); i++)
+  {
+    if (range[i].type == STATIC_PARAM)
+    {
+      os << "static:" << g->staticParam[range[i].index].description << "\t";
+    }
+    else
+    {
+      os << "control:" << g->controlParam[range[i].index].description << "\t";
+    }
+  }
+  os << "samples\tF0[Hz]\tvoice_quality" << endl;
+
+  for (k=0; k < (int)result.size(); k++)
+  {
+    for (i=0; i < (int)result[k].value.size(); i++)
+    {
+      os << result[k].value[i] << "\t";
+    }
+    os << result[k].numSamples << "\t" << result[k].f0_Hz << "\t" << result[k].voiceQuality << endl;
+  }
+
+  bool ok = os.good();
+  os.close();
+  return ok;
+}
+
+// ****************************************************************************
@@ -0,0 +1,105 @@
+// ****************************************************************************
+// This file is part of VocalTractLab.
+// Copyright (C) 2020, Peter Birkholz, Dresden, Germany
+// www.vocaltractlab.de
+// author: Peter Birkholz
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//
+// ****************************************************************************
+
+
+#ifndef __GLOTTIS_SWEEP_H__
+#define __GLOTTIS_SWEEP_H__
+
+#include <wx/wx.h>
+#include <vector>
+
+using namespace std;
+
+// ****************************************************************************
+/// Synthesizes static vowels for all combinations of the values of a set of
+/// static and control parameters of one glottis model, and measures F0 and 
+/// the voice quality of each vowel. The vowels are synthesized in parallel, 
+/// each worker with its own SynthesisContext (copies of the current vocal 
+/// tract, glottis models and TDS options), so that the models of the program
+/// are not changed.
+/// A sweep can be read from a definition file with lines like
+///
+///   glottis 2                  (GlottisModel, see Data)
+///   position 0.5               (relative position of the measurement)
+///   static <index> <min> <max> <numValues>
+///   control <index> <min> <max> <numValues>
+///
+/// Parameters that are not swept keep the values of the program.
+// ****************************************************************************
+
+class GlottisSweep
+{
+  // **************************************************************************
+  // Public data.
+  // **************************************************************************
+
+public:
+  enum ParamType
+  {
+    STATIC_PARAM,
+    CONTROL_PARAM
+  };
+
+  struct Range
+  {
+    ParamType type;
+    int index;
+    double min;
+    double max;
+    int numValues;
+  };
+
+  struct Result
+  {
+    vector<double> value;     ///< One value per range
+    bool ok;
+    int numSamples;
+    double f0_Hz;             ///< 0 for unvoiced vowels
+    double voiceQuality;
+  };
+
+  int glottisIndex;
+  /// Relative position in the vowels (0 ... 1) where F0 and the voice 
+  /// quality are measured
+  double analysisPos;
+  vector<Range> range;
+  /// One result per combination (see getCombination(...))
+  vector<Result> result;
+
+  // **************************************************************************
+  // Public functions.
+  // **************************************************************************
+
+public:
+  GlottisSweep();
+  void addRange(ParamType type, int index, double min, double max, int numValues);
+  void setTriangularGlottisF0Preset();
+  bool readDefinition(const wxString &fileName);
+
+  int getNumCombinations();
+  void getCombination(int combination, vector<double> &value);
+  bool run(int numWorkers = 0);
+  bool writeResults(const wxString &fileName);
+};
+
+#endif
+
+// ****************************************************************************
@@ -87,6 +87,9 @@ static const int IDM_EXPORT_SECONDARY_SPECTRUM = 1237;
 static const int IDM_EXPORT_EMA_TRAJECTORIES = 1238;
 static const int IDM_EXPORT_VIDEO_FRAMES     = 1239;
 static const int IDM_EXPORT_TRANSFER_FUNCTIONS_FROM_SCORE = 1241;
+static const int IDM_EXPORT_RADIATED_NOISE_MAP = 1242;
+static const int IDM_EXPORT_EMA_TRAJECTORIES_BATCH = 1243;
+static const int IDM_EXPORT_GEOMETRY_SEQUENCE = 1244;
 
 static const int IDM_SHOW_VOCAL_TRACT_DIALOG  = 1250;
 static const int IDM_SHOW_VOCAL_TRACT_SHAPES  = 1251;
@@ -178,8 +181,11 @@ BEGIN_EVENT_TABLE(MainWindow, wxFrame)
   EVT_MENU(IDM_EXPORT_PRIMARY_SPECTRUM, MainWindow::OnExportPrimarySpectrum)
   EVT_MENU(IDM_EXPORT_SECONDARY_SPECTRUM, MainWindow::OnExportSecondarySpectrum)
   EVT_MENU(IDM_EXPORT_EMA_TRAJECTORIES, MainWindow::OnExportEmaTrajectories)
+  EVT_MENU(IDM_EXPORT_EMA_TRAJECTORIES_BATCH, MainWindow::OnExportEmaTrajectoriesBatch)
   EVT_MENU(IDM_EXPORT_VIDEO_FRAMES, MainWindow::OnExportVocalTractVideoFrames)
+  EVT_MENU(IDM_EXPORT_GEOMETRY_SEQUENCE, MainWindow::OnExportGeometrySequence)
   EVT_MENU(IDM_EXPORT_TRANSFER_FUNCTIONS_FROM_SCORE, MainWindow::OnExportTransferFunctionsFromScore)
+  EVT_MENU(IDM_EXPORT_RADIATED_NOISE_MAP, MainWindow::OnExportRadiatedNoiseMap)
 
   EVT_MENU(IDM_SHOW_VOCAL_TRACT_DIALOG, MainWindow::OnShowVocalTractDialog)
   EVT_MENU(IDM_SHOW_VOCAL_TRACT_SHAPES, MainWindow::OnShowVocalTractShapes)
@@ -402,8 +408,11 @@ void MainWindow::initWidgets()
   menu->Append(IDM_EXPORT_PRIMARY_SPECTRUM, "Primary spectrum");
   menu->Append(IDM_EXPORT_SECONDARY_SPECTRUM, "User spectrum");
   menu->Append(IDM_EXPORT_EMA_TRAJECTORIES, "EMA trajectories from gestural score");
+  menu->Append(IDM_EXPORT_EMA_TRAJECTORIES_BATCH, "EMA trajectories from all ges. scores in a folder");
   menu->Append(IDM_EXPORT_VIDEO_FRAMES, "Vocal tract video frames from ges. score");
+  menu->Append(IDM_EXPORT_GEOMETRY_SEQUENCE, "3D vocal tract sequence from ges. score");
   menu->Append(IDM_EXPORT_TRANSFER_FUNCTIONS_FROM_SCORE, "Transfer functions from gestural score");
+  menu->Append(IDM_EXPORT_RADIATED_NOISE_MAP, "Radiated noise spectra of all source positions");
 
   menuBar->Append(menu, "Export");
 
@@ -610,7 +619,7 @@ bool MainWindow::saveAreaFunction(const wxString &fileName)
 
   // ****************************************************************
 
-  vt->calculateAll();
+  data->calculateVocalTract(vt);
 
   // ****************************************************************
   
@@ -686,6 +695,89 @@ bool MainWindow::saveSpectrum(const wxString &fileName, ComplexSignal *spectrum)
 }
 
 
+// ****************************************************************************
+/// Lets the user select the frame rate and the EMA points for the export of
+/// EMA trajectories. Returns false, if the user canceled.
+// ****************************************************************************
+
+bool MainWindow::selectEmaOptions()
+{
+  VocalTract *vt = data->vocalTract;
+  int numEmaPoints = (int)vt->emaPoints.size();
+  vector<int> pointIndices;
+  wxArrayString choices;
+  wxArrayInt selections;
+  double frameRate_Hz;
+  int i;
+
+  if (numEmaPoints < 1)
+  {
+    wxMessageBox("There are no EMA points defined for the vocal tract.", "Error!");
+    return false;
+  }
+
+  wxString text = wxGetTextFromUser("Frame rate of the EMA trajectories in Hz", 
+    "Export EMA trajectories", wxString::Format("%2.1f", data->emaFrameRate_Hz), this);
+  if (text.empty())
+  {
+    return false;
+  }
+
+  if ((text.ToDouble(&frameRate_Hz) == false) || (frameRate_Hz < 1.0) || (frameRate_Hz > 10000.0))
+  {
+    wxMessageBox("Invalid frame rate.", "Error!");
+    return false;
+  }
+
+  // ****************************************************************
+  // Select the EMA points.
+  // ****************************************************************
+
+  for (i=0; i < numEmaPoints; i++)
+  {
+    choices.Add(wxString(vt->emaPoints[i].name));
+  }
+
+  if (data->getEmaPointIndices(data->emaPointNames, pointIndices) == false)
+  {
+    data->getEmaPointIndices("", pointIndices);
+  }
+  for (i=0; i < (int)pointIndices.size(); i++)
+  {
+    selections.Add(pointIndices[i]);
+  }
+
+  wxMultiChoiceDialog dialog(this, "Select the EMA points to export", 
+    "Export EMA trajectories", choices);
+  dialog.SetSelections(selections);
+  if (dialog.ShowModal() != wxID_OK)
+  {
+    return false;
+  }
+
+  selections = dialog.GetSelections();
+  if (selections.GetCount() < 1)
+  {
+    wxMessageBox("No EMA point selected.", "Error!");
+    return false;
+  }
+
+  // All points are stored as empty string, so that points that are
+  // added later are exported, too.
+  data->emaPointNames = "";
+  if ((int)selections.GetCount() < numEmaPoints)
+  {
+    for (i=0; i < (int)selections.GetCount(); i++)
+    {
+      data->emaPointNames+= choices[selections[i]] + " ";
+    }
+  }
+  data->emaFrameRate_Hz = frameRate_Hz;
+
+  return true;
+}
+
+
 // ****************************************************************************
 // ****************************************************************************
 
@@ -832,6 +924,8 @@ void MainWindow::OnLoadWavEgg(wxCommandEvent &event)
       int numTargetSamples = numSourceSamples * (double)SAMPLING_RATE / (double)sourceSamplingRate;
       int sourceIndex = 0;
 
+      data->growTracks(targetPos + numTargetSamples);
+
       for (i = 0; i < numTargetSamples; i++)
       {
         // Make a (linear) sampling rate conversion.
@@ -846,6 +940,8 @@ void MainWindow::OnLoadWavEgg(wxCommandEvent &event)
       updateWidgets();
     }
 
+    data->trackChanged(Data::MAIN_TRACK);
+    data->trackChanged(Data::EGG_TRACK);
     updateWidgets();
   }
 }
@@ -955,6 +1051,8 @@ void MainWindow::OnLoadWav(wxCommandEvent &event)
         int sourceIndex = 0;
         int i;
 
+        data->growTracks(targetPos + numTargetSamples);
+
         for (i = 0; i < numTargetSamples; i++)
         {
           // Make a (linear) sampling rate conversion.
@@ -965,10 +1063,11 @@ void MainWindow::OnLoadWav(wxCommandEvent &event)
           }
           data->track[trackIndex]->setValue(targetPos + i, audioFile.samples[0][sourceIndex] * 32767.0);
         }
-
-        updateWidgets();
       }
 
+      data->trackChanged(trackIndex);
+      updateWidgets();
+
     }
   }
 
@@ -1273,6 +1372,7 @@ void MainWindow::OnSetAudioZero(wxCommandEvent &event)
     {
       data->track[trackIndex]->setValue(i, 0);
     }
+    data->trackChanged(trackIndex);
   }
   updateWidgets();
 }
@@ -1310,6 +1410,7 @@ void MainWindow::OnScaleAmplitudeUp(wxCommandEvent &event)
     if (d > MAX) { d = MAX; }
     s->x[i] = (signed short)d;
   }
+  data->trackChanged(Data::MAIN_TRACK);
 
   updateWidgets();
 }
@@ -1325,6 +1426,7 @@ void MainWindow::OnScaleAmplitudeDown(wxCommandEvent &event)
   {
     s->x[i] = (signed short)(s->x[i] / 1.2);
   }
+  data->trackChanged(Data::MAIN_TRACK);
 
   updateWidgets();
 }
@@ -1810,7 +1912,7 @@ void MainWindow::OnExportModelObj(wxCommandEvent &event)
   if (dialog.ShowModal() == wxID_OK)
   {
     VocalTract *vt = data->vocalTract;
-    vt->calculateAll();
+    data->calculateVocalTract(vt);
 
     exportFileName = wxFileName(dialog.GetPath());
 
@@ -1892,31 +1994,222 @@ void MainWindow::OnExportSecondarySpectrum(wxCommandEvent &event)
 
 void MainWindow::OnExportEmaTrajectories(wxCommandEvent &event)
 {
+  if (selectEmaOptions() == false)
+  {
+    return;
+  }
+
   wxFileName fileName(data->emaFileName);
 
   wxString name = wxFileSelector("Save EMA trajectories from gestural score", fileName.GetPath(), 
-    fileName.GetFullName(), ".txt", "Text files (*.txt)|*.txt", 
+    fileName.GetFullName(), ".txt", "Text files (*.txt)|*.txt|Binary EMA files (*.ema)|*.ema", 
     wxFD_SAVE | wxFD_OVERWRITE_PROMPT, this);
 
   if (name.empty() == false)
   {
     data->emaFileName = name;
-    data->exportEmaTrajectories(name);
+    if (wxFileName(name).GetExt().Lower() == "ema")
+    {
+      data->emaFileFormat = Data::EMA_FILE_BINARY;
+    }
+    else
+    {
+      data->emaFileFormat = Data::EMA_FILE_TEXT;
+    }
+
+    wxBusyCursor busyCursor;
+    data->exportEmaTrajectories(name, data->emaFileFormat, data->emaFrameRate_Hz, data->emaPointNames);
   }
 }
 
 
 // ****************************************************************************
+/// Exports the EMA trajectories of all gestural scores in a folder.
 // ****************************************************************************
 
-void MainWindow::OnExportVocalTractVideoFrames(wxCommandEvent &event)
+void MainWindow::OnExportEmaTrajectoriesBatch(wxCommandEvent &event)
 {
-  wxDirDialog dialog(this, "Select a folder for the video frames");
-  dialog.SetPath(data->videoFramesFolder);
+  if (selectEmaOptions() == false)
+  {
+    return;
+  }
+
+  wxArrayString formats;
+  formats.Add("Text files (*.txt)");
+  formats.Add("Binary EMA files (*.ema)");
+
+  int format = wxGetSingleChoiceIndex("Select the output format of the EMA trajectories",
+    "Export EMA trajectories", formats, (int)data->emaFileFormat, this);
+  if (format == -1)
+  {
+    return;
+  }
+  data->emaFileFormat = (Data::EmaFileFormat)format;
+
+  wxDirDialog dialog(this, "Select a folder with gestural scores (*.ges)");
+  dialog.SetPath(data->emaBatchFolder);
   if (dialog.ShowModal() == wxID_OK)
   {
-    data->videoFramesFolder = dialog.GetPath();
-    data->exportVocalTractVideoFrames(dialog.GetPath());
+    data->emaBatchFolder = dialog.GetPath();
+    data->exportEmaTrajectoriesBatch(dialog.GetPath(), data->emaFileFormat, 
+      data->emaFrameRate_Hz, data->emaPointNames);
+  }
+}
+
+
+// ****************************************************************************
+// ****************************************************************************
+
+void MainWindow::OnExportVocalTractVideoFrames(wxCommandEvent &event)
+{
+  wxArrayString formats;
+  formats.Add("Numbered PNG images");
+  formats.Add("Numbered BMP images");
+  formats.Add("Y4M video stream (file or named pipe)");
+
+  int format = wxGetSingleChoiceIndex("Select the output format of the video frames",
+    "Export video frames", formats, (int)data->videoFrameFormat, this);
+  if (format == -1)
+  {
+    return;
+  }
+
+  // ****************************************************************
+  // Frame rate and frame size (0 0 = size of the vocal tract picture).
+  // ****************************************************************
+
+  wxString text = wxGetTextFromUser(
+    "Frame rate in Hz, frame width and frame height in pixels (0 0 = size of the picture)",
+    "Export video frames", wxString::Format("%d %d %d", data->videoFrameRate, 
+    data->videoFrameWidth, data->videoFrameHeight), this);
+  if (text.empty())
+  {
+    return;
+  }
+
+  wxStringTokenizer tokenizer(text, " ");
+  long values[3] = { data->videoFrameRate, data->videoFrameWidth, data->videoFrameHeight };
+  int i = 0;
+  while ((tokenizer.HasMoreTokens()) && (i < 3))
+  {
+    if (tokenizer.GetNextToken().ToLong(&values[i]) == false)
+    {
+      wxMessageBox("Invalid input.", "Error!");
+      return;
+    }
+    i++;
+  }
+
+  if ((values[0] < 1) || (values[0] > 1000) || (values[1] < 0) || (values[2] < 0))
+  {
+    wxMessageBox("Invalid frame rate or frame size.", "Error!");
+    return;
+  }
+
+  data->videoFrameFormat = (Data::VideoFrameFormat)format;
+  data->videoFrameRate = (int)values[0];
+  data->videoFrameWidth = (int)values[1];
+  data->videoFrameHeight = (int)values[2];
+
+  // ****************************************************************
+  // Select the target folder or stream.
+  // ****************************************************************
+
+  if (data->videoFrameFormat == Data::VIDEO_FRAMES_Y4M)
+  {
+    wxFileName fileName(data->videoStreamFileName);
+
+    wxString name = wxFileSelector("Save video stream", fileName.GetPath(),
+      fileName.GetFullName(), ".y4m", "Y4M video streams (*.y4m)|*.y4m|All files (*.*)|*.*",
+      wxFD_SAVE, this);
+
+    if (name.empty() == false)
+    {
+      data->videoStreamFileName = name;
+      data->exportVocalTractVideoFrames(name, data->videoFrameFormat, 
+        data->videoFrameRate, data->videoFrameWidth, data->videoFrameHeight);
+    }
+  }
+  else
+  {
+    wxDirDialog dialog(this, "Select a folder for the video frames");
+    dialog.SetPath(data->videoFramesFolder);
+    if (dialog.ShowModal() == wxID_OK)
+    {
+      data->videoFramesFolder = dialog.GetPath();
+      data->exportVocalTractVideoFrames(dialog.GetPath(), data->videoFrameFormat, 
+        data->videoFrameRate, data->videoFrameWidth, data->videoFrameHeight);
+    }
+  }
+}
+
+
+// ****************************************************************************
+/// Exports the 3D vocal tract shapes of all frames of the gestural score as
+/// numbered OBJ or SVG files or as one binary mesh sequence.
+// ****************************************************************************
+
+void MainWindow::OnExportGeometrySequence(wxCommandEvent &event)
+{
+  wxArrayString formats;
+  formats.Add("Numbered OBJ files");
+  formats.Add("Numbered wireframe SVG files");
+  formats.Add("Binary mesh sequence (one file)");
+
+  int format = wxGetSingleChoiceIndex("Select the output format of the geometry sequence",
+    "Export 3D vocal tract sequence", formats, (int)data->geometrySequenceFormat, this);
+  if (format == -1)
+  {
+    return;
+  }
+
+  wxString text = wxGetTextFromUser("Frame rate in Hz", "Export 3D vocal tract sequence", 
+    wxString::Format("%2.1f", data->geometrySequenceFrameRate_Hz), this);
+  if (text.empty())
+  {
+    return;
+  }
+
+  double frameRate_Hz = 0.0;
+  if ((text.ToDouble(&frameRate_Hz) == false) || (frameRate_Hz <= 0.0) || (frameRate_Hz > 10000.0))
+  {
+    wxMessageBox("Invalid frame rate.", "Error!");
+    return;
+  }
+
+  data->geometrySequenceFormat = (Data::GeometrySequenceFormat)format;
+  data->geometrySequenceFrameRate_Hz = frameRate_Hz;
+  bool renderBothSides = VocalTractDialog::getInstance(this)->getVocalTractPicture()->renderBothSides;
+
+  // ****************************************************************
+  // Select the target file or folder.
+  // ****************************************************************
+
+  if (data->geometrySequenceFormat == Data::GEOMETRY_SEQUENCE_MESH)
+  {
+    wxFileName fileName(data->geometrySequenceFileName);
+
+    wxString name = wxFileSelector("Save mesh sequence", fileName.GetPath(),
+      fileName.GetFullName(), ".vtm", "Mesh sequences (*.vtm)|*.vtm|All files (*.*)|*.*",
+      wxFD_SAVE | wxFD_OVERWRITE_PROMPT, this);
+
+    if (name.empty() == false)
+    {
+      data->geometrySequenceFileName = name;
+      data->exportGeometrySequence(name, data->geometrySequenceFormat, 
+        data->geometrySequenceFrameRate_Hz, renderBothSides);
+    }
+  }
+  else
+  {
+    wxDirDialog dialog(this, "Select a folder for the geometry files");
+    dialog.SetPath(data->geometrySequenceFolder);
+    if (dialog.ShowModal() == wxID_OK)
+    {
+      data->geometrySequenceFolder = dialog.GetPath();
+      data->exportGeometrySequence(dialog.GetPath(), data->geometrySequenceFormat, 
+        data->geometrySequenceFrameRate_Hz, renderBothSides);
+    }
   }
 }
 
@@ -1940,6 +2233,25 @@ void MainWindow::OnExportTransferFunctionsFromScore(wxCommandEvent &event)
 }
 
 
+// ****************************************************************************
+// ****************************************************************************
+
+void MainWindow::OnExportRadiatedNoiseMap(wxCommandEvent &event)
+{
+  wxFileName fileName(data->spectrumFileName);
+
+  wxString name = wxFileSelector("Save radiated noise spectra of all source positions", fileName.GetPath(),
+    fileName.GetFullName(), ".txt", "Text files (*.txt)|*.txt",
+    wxFD_SAVE | wxFD_OVERWRITE_PROMPT, this);
+
+  if (name.empty() == false)
+  {
+    data->spectrumFileName = name;
+    data->exportRadiatedNoiseMap(name);
+  }
+}
+
+
 // ****************************************************************************
 // ****************************************************************************
 
@@ -2067,8 +2379,12 @@ void MainWindow::OnGesturalScoreFileToAudio(wxCommandEvent &event)
   wxBusyInfo wait("Please wait...");
 
   Synthesizer::synthesizeGesturalScore(gs, data->tdsModel, audio);
+  // The score calculated the main vocal tract for its frames.
+  data->vocalTractCalculatedExternally();
 
+  data->growTracks((int)audio.size());
   data->track[Data::MAIN_TRACK]->setZero();
+  data->trackChanged(Data::MAIN_TRACK);
   Synthesizer::copySignal(audio, *data->track[Data::MAIN_TRACK], 0);
 
   // Set the selection to the newly synthesized gestural score.
@@ -2119,7 +2435,9 @@ void MainWindow::OnTubeSequenceFileToAudio(wxCommandEvent &event)
 
   if (ok)
   {
+    data->growTracks((int)audio.size());
     data->track[Data::MAIN_TRACK]->setZero();
+    data->trackChanged(Data::MAIN_TRACK);
     Synthesizer::copySignal(audio, *data->track[Data::MAIN_TRACK], 0);
 
     // Set the selection to the newly synthesized utterance.
@@ -2169,10 +2487,14 @@ void MainWindow::OnTractSequenceFileToAudio(wxCommandEvent &event)
     ok = Synthesizer::synthesizeTractSequence(name.ToStdString(),
       data->getSelectedGlottis(), data->vocalTract, data->tdsModel, audio);
   }
+  // The sequence was synthesized with the main vocal tract.
+  data->vocalTractCalculatedExternally();
 
   if (ok)
   {
+    data->growTracks((int)audio.size());
     data->track[Data::MAIN_TRACK]->setZero();
+    data->trackChanged(Data::MAIN_TRACK);
     Synthesizer::copySignal(audio, *data->track[Data::MAIN_TRACK], 0);
 
     // Set the selection to the newly synthesized utterance.
@@ -2207,6 +2529,8 @@ void MainWindow::OnGesturalScoreToTubeSequenceFile(wxCommandEvent &event)
   {
     wxMessageBox("The tube sequence file could not be saved.", "Error");
   }
+  // The score calculated the main vocal tract for its frames.
+  data->vocalTractCalculatedExternally();
 
   wxPrintf("The tube sequence file has been successfully saved.\n");
 }
@@ -2230,6 +2554,8 @@ void MainWindow::OnGesturalScoreToTractSequenceFile(wxCommandEvent &event)
   {
     wxMessageBox("The tract sequence file could not be saved.", "Error");
   }
+  // The score may have calculated the main vocal tract for its frames.
+  data->vocalTractCalculatedExternally();
 
   wxPrintf("The tract sequence file has been successfully saved.\n");
 }
@@ -2284,11 +2610,15 @@ void MainWindow::OnAbout(wxCommandEvent &event)
 
 void MainWindow::OnRecord(wxCommandEvent &event)
 {
+  // The tracks start short and are enlarged for the first recording.
+  data->growTracks(Data::TRACK_DURATION_S*SAMPLING_RATE);
+
   if (waveStartRecording(data->track[Data::MAIN_TRACK]->x, data->track[Data::MAIN_TRACK]->N))
   {
     SilentMessageBox dialog("Press [OK] to stop recording!", "Stop recording", this);
     dialog.ShowModal();
     waveStopRecording();
+    data->trackChanged(Data::MAIN_TRACK);
   }
   else
   {
@@ -2381,8 +2711,10 @@ void MainWindow::OnClearMainTrack(wxCommandEvent &event)
   int i = Data::MAIN_TRACK;
   
   data->track[i]->setZero();
+  data->trackChanged(i);
   data->f0Signal[i].clear();
   data->voiceQualitySignal[i].clear();
+  data->formantTracker[i].clear();
 
   updateWidgets();
 }
@@ -2396,8 +2728,10 @@ void MainWindow::OnClearEggTrack(wxCommandEvent &event)
   int i = Data::EGG_TRACK;
   
   data->track[i]->setZero();
+  data->trackChanged(i);
   data->f0Signal[i].clear();
   data->voiceQualitySignal[i].clear();
+  data->formantTracker[i].clear();
 
   updateWidgets();
 }
@@ -2411,8 +2745,10 @@ void MainWindow::OnClearExtraTrack(wxCommandEvent &event)
   int i = Data::EXTRA_TRACK;
   
   data->track[i]->setZero();
+  data->trackChanged(i);
   data->f0Signal[i].clear();
   data->voiceQualitySignal[i].clear();
+  data->formantTracker[i].clear();
 
   updateWidgets();
 }
@@ -2427,6 +2763,7 @@ void MainWindow::OnClearAudioTracks(wxCommandEvent &event)
   for (i=0; i < Data::NUM_TRACKS; i++) 
   { 
     data->track[i]->setZero();
+    data->trackChanged(i);
   }
   OnClearAnalysisTracks(event);
   
@@ -2464,6 +2801,7 @@ void MainWindow::OnClearAnalysisTracks(wxCommandEvent &event)
   { 
     data->f0Signal[i].clear();
     data->voiceQualitySignal[i].clear();
+    data->formantTracker[i].clear();
   }
 
   updateWidgets();
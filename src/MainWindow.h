@@ -99,6 +99,7 @@ private:
   bool saveWaveformAsTxtFile(const wxString &fileName, Signal16 *signal, int pos, int length);
   bool saveAreaFunction(const wxString &fileName);
   bool saveSpectrum(const wxString &fileName, ComplexSignal *spectrum);
+  bool selectEmaOptions();
 
   // Window events
   void OnCloseWindow(wxCloseEvent &event);
@@ -145,8 +146,11 @@ private:
   void OnExportPrimarySpectrum(wxCommandEvent &event);
   void OnExportSecondarySpectrum(wxCommandEvent &event);
   void OnExportEmaTrajectories(wxCommandEvent &event);
+  void OnExportEmaTrajectoriesBatch(wxCommandEvent &event);
   void OnExportVocalTractVideoFrames(wxCommandEvent &event);
+  void OnExportGeometrySequence(wxCommandEvent &event);
   void OnExportTransferFunctionsFromScore(wxCommandEvent &event);
+  void OnExportRadiatedNoiseMap(wxCommandEvent &event);
 
   void OnShowVocalTractDialog(wxCommandEvent &event);
   void OnShowVocalTractShapes(wxCommandEvent &event);
@@ -0,0 +1,185 @@
+// ****************************************************************************
+// This file is part of VocalTractLab.
+// Copyright (C) 2020, Peter Birkholz, Dresden, Germany
+// www.vocaltractlab.de
+// author: Peter Birkholz
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//
+// ****************************************************************************
+
+#include <vector>
+#include "ParallelJob.h"
+
+using namespace std;
+
+// 0 means that the number of CPU cores is the limit.
+int ParallelJob::maxNumWorkers = 0;
+
+
+// ****************************************************************************
+/// A joinable thread that processes items of a parallel job.
+// ****************************************************************************
+
+class ParallelJobThread : public wxThread
+{
+public:
+  ParallelJobThread(ParallelJob *job, int workerIndex) : wxThread(wxTHREAD_JOINABLE)
+  {
+    this->job = job;
+    this->workerIndex = workerIndex;
+  }
+
+  virtual void *Entry()
+  {
+    job->processItems(workerIndex);
+    return NULL;
+  }
+
+private:
+  ParallelJob *job;
+  int workerIndex;
+};
+
+
+// ****************************************************************************
+/// Processes the items 0 ... numItems-1 with the given number of workers.
+// ****************************************************************************
+
+void ParallelJob::run(int numItems, int numWorkers)
+{
+  int i;
+  vector<ParallelJobThread*> threads;
+
+  this->numItems = numItems;
+  nextItem = 0;
+
+  if (numWorkers > numItems)
+  {
+    numWorkers = numItems;
+  }
+
+  // ****************************************************************
+  // Start the additional worker threads. When a thread can't be
+  // started, its items are processed by the other workers.
+  // ****************************************************************
+
+  for (i = 1; i < numWorkers; i++)
+  {
+    ParallelJobThread *thread = new ParallelJobThread(this, i);
+    if (thread->Run() == wxTHREAD_NO_ERROR)
+    {
+      threads.push_back(thread);
+    }
+    else
+    {
+      delete thread;
+    }
+  }
+
+  // The calling thread is the worker 0.
+  processItems(0);
+
+  for (i = 0; i < (int)threads.size(); i++)
+  {
+    threads[i]->Wait();
+    delete threads[i];
+  }
+}
+
+
+// ****************************************************************************
+/// Returns the number of workers to use for the given number of items, i.e.,
+/// getMaxNumWorkers(), but not more than the number of items.
+// ****************************************************************************
+
+int ParallelJob::getNumWorkers(int numItems)
+{
+  int numWorkers = getMaxNumWorkers();
+  if (numWorkers > numItems)
+  {
+    numWorkers = numItems;
+  }
+  if (numWorkers < 1)
+  {
+    numWorkers = 1;
+  }
+  return numWorkers;
+}
+
+
+// ****************************************************************************
+/// Returns the maximal number of workers of a job, i.e., the number of CPU 
+/// cores or the limit set with setMaxNumWorkers(...), whichever is smaller.
+// ****************************************************************************
+
+int ParallelJob::getMaxNumWorkers()
+{
+  int numWorkers = wxThread::GetCPUCount();
+  if ((maxNumWorkers > 0) && (numWorkers > maxNumWorkers))
+  {
+    numWorkers = maxNumWorkers;
+  }
+  if (numWorkers < 1)
+  {
+    numWorkers = 1;
+  }
+  return numWorkers;
+}
+
+
+// ****************************************************************************
+/// Limits the number of workers of the following jobs (e.g., to compare the 
+/// results of a single worker with those of many). A value of 0 removes the
+/// limit.
+// ****************************************************************************
+
+void ParallelJob::setMaxNumWorkers(int maxNumWorkers)
+{
+  ParallelJob::maxNumWorkers = (maxNumWorkers > 0) ? maxNumWorkers : 0;
+}
+
+
+// ****************************************************************************
+/// Returns the index of the next unprocessed item, or -1, if all items are
+/// processed.
+// ****************************************************************************
+
+int ParallelJob::getNextItem()
+{
+  wxCriticalSectionLocker locker(itemCriticalSection);
+
+  if (nextItem >= numItems)
+  {
+    return -1;
+  }
+  return nextItem++;
+}
+
+
+// ****************************************************************************
+/// Processes items until there are no more items left.
+// ****************************************************************************
+
+void ParallelJob::processItems(int workerIndex)
+{
+  int item = getNextItem();
+  while (item != -1)
+  {
+    processItem(workerIndex, item);
+    item = getNextItem();
+  }
+}
+
+// ****************************************************************************
@@ -0,0 +1,74 @@
+// ****************************************************************************
+// This file is part of VocalTractLab.
+// Copyright (C) 2020, Peter Birkholz, Dresden, Germany
+// www.vocaltractlab.de
+// author: Peter Birkholz
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//
+// ****************************************************************************
+
+#ifndef __PARALLEL_JOB_H__
+#define __PARALLEL_JOB_H__
+
+#include <wx/thread.h>
+
+// ****************************************************************************
+/// A job that consists of a number of independent items, which are processed
+/// by a number of worker threads. Derived classes implement processItem(...)
+/// and keep one set of models (vocal tract, TL model, ...) per worker, so that
+/// the items can be processed without any shared state.
+/// run(...) returns when all items are processed. The calling thread is used
+/// as the worker with the index 0.
+// ****************************************************************************
+
+class ParallelJob
+{
+  // **************************************************************************
+  // Public functions.
+  // **************************************************************************
+
+public:
+  virtual ~ParallelJob() {}
+  virtual void processItem(int workerIndex, int itemIndex) = 0;
+
+  void run(int numItems, int numWorkers);
+  static int getNumWorkers(int numItems);
+  static int getMaxNumWorkers();
+  static void setMaxNumWorkers(int maxNumWorkers);
+
+  // **************************************************************************
+  // Private data.
+  // **************************************************************************
+
+private:
+  static int maxNumWorkers;
+  int numItems;
+  int nextItem;
+  wxCriticalSection itemCriticalSection;
+
+  // **************************************************************************
+  // Private functions.
+  // **************************************************************************
+
+private:
+  int getNextItem();
+  void processItems(int workerIndex);
+
+  friend class ParallelJobThread;
+};
+
+#endif
+
+// ****************************************************************************
@@ -332,6 +332,7 @@ void PoleZeroDialog::OnEnterZeros(wxCommandEvent &event)
 void PoleZeroDialog::OnPlayShortVowel(wxCommandEvent &event)
 {
   data->track[Data::MAIN_TRACK]->setZero();
+  data->trackChanged(Data::MAIN_TRACK);
 
   int duration_ms = data->synthesizeVowelFormantLf(data->lfPulse, 0, false);
 
@@ -352,6 +353,7 @@ void PoleZeroDialog::OnPlayShortVowel(wxCommandEvent &event)
 void PoleZeroDialog::OnPlayLongVowel(wxCommandEvent &event)
 {
   data->track[Data::MAIN_TRACK]->setZero();
+  data->trackChanged(Data::MAIN_TRACK);
 
   int duration_ms = data->synthesizeVowelFormantLf(data->lfPulse, 0, true);
 
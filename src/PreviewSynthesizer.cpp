@@ -0,0 +1,497 @@
+// ****************************************************************************
+// This file is part of VocalTractLab.
+// Copyright (C) 2020, Peter Birkholz, Dresden, Germany
+// www.vocaltractlab.de
+// author: Peter Birkholz
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//
+// ****************************************************************************
+
+
+#include "PreviewSynthesizer.h"
+#include "FormantTracker.h"
+#include "VocalTractLabBackend/Constants.h"
+#include "VocalTractLabBackend/Dsp.h"
+#include "VocalTractLabBackend/IirFilter.h"
+#include "VocalTractLabBackend/Tube.h"
+#include "VocalTractLabBackend/F0EstimatorYin.h"
+#include <wx/wx.h>
+#include <wx/stopwatch.h>
+#include <cmath>
+
+
+// ****************************************************************************
+/// Synthesizes the whole tube sequence with the TDS at the given sampling
+/// rate into the audio signal at SAMPLING_RATE. The time step of the TDS 
+/// model is restored at the end, and the model and the sequence are reset.
+// ****************************************************************************
+
+bool PreviewSynthesizer::synthesize(TubeSequence *tubeSequence, TdsModel *tdsModel, 
+  int samplingRate, vector<double> &audio)
+{
+  const double SCALING_FACTOR = 0.003;    // The same as in SynthesisThread
+
+  int duration_pt = tubeSequence->getDuration_pt();
+  double ratio = (double)SAMPLING_RATE / (double)samplingRate;
+  int numSteps = (int)(duration_pt / ratio);
+  double origTimeStep_s = tdsModel->timeStep;
+  double timeStep_s = 1.0 / (double)samplingRate;
+  vector<double> lowRateAudio(numSteps);
+  IirFilter outputPressureFilter;
+  Tube tube;
+
+  int flowSourceSection;
+  int pressureSourceSection;
+  double pressureSource_dPa;
+  double flowSource_cm3_s;
+  double pressure_dPa[4];
+  double totalFlow_cm3_s;
+  double prevTotalFlow_cm3_s = 0.0;
+  double mouthFlow_cm3_s;
+  double nostrilFlow_cm3_s;
+  double skinFlow_cm3_s;
+  int nextPos_pt;
+  int i;
+
+  audio.clear();
+  if ((samplingRate < MIN_SAMPLING_RATE) || (samplingRate > SAMPLING_RATE))
+  {
+    return false;
+  }
+
+  outputPressureFilter.createChebyshev(getBandwidth_Hz(samplingRate) / (double)samplingRate, false, 8);
+
+  tdsModel->timeStep = timeStep_s;
+  tdsModel->resetMotion();
+  tubeSequence->resetSequence();
+
+  for (i=0; i < numSteps; i++)
+  {
+    tubeSequence->getTube(tube);
+    tubeSequence->getFlowSource(flowSource_cm3_s, flowSourceSection);
+    tubeSequence->getPressureSource(pressureSource_dPa, pressureSourceSection);
+
+    tdsModel->setTube(&tube, i > 0);
+    tdsModel->setFlowSource(flowSource_cm3_s, flowSourceSection);
+    tdsModel->setPressureSource(pressureSource_dPa, pressureSourceSection);
+
+    pressure_dPa[0] = tdsModel->getSectionPressure(Tube::LAST_TRACHEA_SECTION);
+    pressure_dPa[1] = tdsModel->getSectionPressure(Tube::LOWER_GLOTTIS_SECTION);
+    pressure_dPa[2] = tdsModel->getSectionPressure(Tube::UPPER_GLOTTIS_SECTION);
+    pressure_dPa[3] = tdsModel->getSectionPressure(Tube::FIRST_PHARYNX_SECTION);
+
+    // Step the sequence forward to the time of the next TDS sample.
+    nextPos_pt = (int)((i + 1)*ratio + 0.5);
+    if (nextPos_pt > duration_pt)
+    {
+      nextPos_pt = duration_pt;
+    }
+    while (tubeSequence->getPos_pt() < nextPos_pt)
+    {
+      tubeSequence->incPos(pressure_dPa);
+    }
+
+    totalFlow_cm3_s = tdsModel->proceedTimeStep(mouthFlow_cm3_s, nostrilFlow_cm3_s, skinFlow_cm3_s);
+    lowRateAudio[i] = SCALING_FACTOR * outputPressureFilter.getOutputSample(
+      (totalFlow_cm3_s - prevTotalFlow_cm3_s) / timeStep_s);
+    prevTotalFlow_cm3_s = totalFlow_cm3_s;
+  }
+
+  tdsModel->timeStep = origTimeStep_s;
+  tdsModel->resetMotion();
+  tubeSequence->resetSequence();
+
+  if (samplingRate == SAMPLING_RATE)
+  {
+    audio = lowRateAudio;
+    audio.resize(duration_pt, 0.0);
+  }
+  else
+  {
+    resample(lowRateAudio, samplingRate, SAMPLING_RATE, duration_pt, audio);
+  }
+
+  return true;
+}
+
+
+// ****************************************************************************
+/// Returns the audio bandwidth of the synthesis at the given sampling rate,
+/// i.e., SYNTHETIC_SPEECH_BANDWIDTH_HZ, but not more than 40% of the rate.
+// ****************************************************************************
+
+double PreviewSynthesizer::getBandwidth_Hz(int samplingRate)
+{
+  double bandwidth_Hz = 0.4*samplingRate;
+  if (bandwidth_Hz > SYNTHETIC_SPEECH_BANDWIDTH_HZ)
+  {
+    bandwidth_Hz = SYNTHETIC_SPEECH_BANDWIDTH_HZ;
+  }
+  return bandwidth_Hz;
+}
+
+
+// ****************************************************************************
+/// Resamples the band-limited input signal to the output rate by the 
+/// interpolation with a Hann-windowed sinc function. When the output rate
+/// is lower than the input rate, the input must already be band-limited to
+/// half the output rate.
+// ****************************************************************************
+
+void PreviewSynthesizer::resample(const vector<double> &input, double inputRate, 
+  double outputRate, int outputLength, vector<double> &output)
+{
+  const int HALF_WIDTH = 16;    // Input samples on each side
+  int numInputSamples = (int)input.size();
+  double t;
+  double x;
+  double sum;
+  int center;
+  int i, k;
+
+  output.assign(outputLength, 0.0);
+
+  for (i=0; i < outputLength; i++)
+  {
+    // Position of the output sample in units of input samples.
+    t = i * inputRate / outputRate;
+    center = (int)t;
+    sum = 0.0;
+
+    for (k = center - HALF_WIDTH + 1; k <= center + HALF_WIDTH; k++)
+    {
+      if ((k < 0) || (k >= numInputSamples))
+      {
+        continue;
+      }
+      x = t - k;
+      if (fabs(x) < 0.000001)
+      {
+        sum+= input[k];
+      }
+      else
+      {
+        sum+= input[k] * sin(M_PI*x) / (M_PI*x) * 
+          (0.5 + 0.5*cos(M_PI*x / (double)HALF_WIDTH));
+      }
+    }
+    output[i] = sum;
+  }
+}
+
+
+// ****************************************************************************
+/// Returns the RMS difference in dB between the long-term average spectra
+/// of the two signals (at SAMPLING_RATE) from 0 to maxFreq_Hz.
+// ****************************************************************************
+
+double PreviewSynthesizer::getSpectralDeviation_dB(const vector<double> &a, 
+  const vector<double> &b, double maxFreq_Hz)
+{
+  const int FRAME_LENGTH_EXPONENT = 10;
+  const int FRAME_LENGTH = 1 << FRAME_LENGTH_EXPONENT;
+  const int HOP_LENGTH = FRAME_LENGTH / 2;
+  const double EPSILON = 0.000000001;
+
+  int length = (int)a.size();
+  int numBins = (int)(maxFreq_Hz * FRAME_LENGTH / SAMPLING_RATE);
+  vector<double> powerA(numBins, 0.0);
+  vector<double> powerB(numBins, 0.0);
+  ComplexSignal frameA(FRAME_LENGTH);
+  ComplexSignal frameB(FRAME_LENGTH);
+  double window;
+  double diff;
+  double sum;
+  int start;
+  int i;
+
+  if ((int)b.size() < length)
+  {
+    length = (int)b.size();
+  }
+  if (numBins > FRAME_LENGTH / 2)
+  {
+    numBins = FRAME_LENGTH / 2;
+  }
+  if ((length < FRAME_LENGTH) || (numBins < 2))
+  {
+    return 0.0;
+  }
+
+  for (start = 0; start + FRAME_LENGTH <= length; start+= HOP_LENGTH)
+  {
+    for (i=0; i < FRAME_LENGTH; i++)
+    {
+      window = 0.5 - 0.5*cos(2.0*M_PI*i / (double)FRAME_LENGTH);
+      frameA.re[i] = a[start + i] * window;
+      frameA.im[i] = 0.0;
+      frameB.re[i] = b[start + i] * window;
+      frameB.im[i] = 0.0;
+    }
+    realFFT(frameA, FRAME_LENGTH_EXPONENT, false);
+    realFFT(frameB, FRAME_LENGTH_EXPONENT, false);
+
+    for (i=0; i < numBins; i++)
+    {
+      powerA[i]+= frameA.re[i]*frameA.re[i] + frameA.im[i]*frameA.im[i];
+      powerB[i]+= frameB.re[i]*frameB.re[i] + frameB.im[i]*frameB.im[i];
+    }
+  }
+
+  // Skip the DC bin.
+  sum = 0.0;
+  for (i=1; i < numBins; i++)
+  {
+    diff = 10.0*log10(powerA[i] + EPSILON) - 10.0*log10(powerB[i] + EPSILON);
+    sum+= diff*diff;
+  }
+
+  return sqrt(sum / (double)(numBins - 1));
+}
+
+
+// ****************************************************************************
+/// Returns the signal-to-noise ratio of the test signal in dB, where the 
+/// noise is the difference to the reference signal.
+// ****************************************************************************
+
+double PreviewSynthesizer::getSnr_dB(const vector<double> &reference, const vector<double> &test)
+{
+  const double EPSILON = 0.000000001;
+  int length = (int)reference.size();
+  double signalEnergy = 0.0;
+  double noiseEnergy = 0.0;
+  double diff;
+  int i;
+
+  if ((int)test.size() < length)
+  {
+    length = (int)test.size();
+  }
+
+  for (i=0; i < length; i++)
+  {
+    diff = test[i] - reference[i];
+    signalEnergy+= reference[i]*reference[i];
+    noiseEnergy+= diff*diff;
+  }
+
+  return 10.0*log10((signalEnergy + EPSILON) / (noiseEnergy + EPSILON));
+}
+
+
+// ****************************************************************************
+/// Returns the mean absolute F0 difference in semitones between the two 
+/// signals (with the scaling of the main track) in the frames that are 
+/// voiced in both, or 0, if there are no such frames.
+// ****************************************************************************
+
+double PreviewSynthesizer::getF0Deviation_st(const vector<double> &reference, const vector<double> &test)
+{
+  F0EstimatorYin estimator;
+  vector<double> f0[2];
+  const vector<double> *signal[2] = { &reference, &test };
+  double sum = 0.0;
+  int numVoicedFrames = 0;
+  int length = (int)reference.size();
+  int i, k;
+
+  if ((int)test.size() < length)
+  {
+    length = (int)test.size();
+  }
+  if (length < 1)
+  {
+    return 0.0;
+  }
+
+  for (k=0; k < 2; k++)
+  {
+    Signal16 s(length);
+    toSignal16(*signal[k], s);
+    estimator.init(&s, 0, length);
+    estimator.processChunk(length);
+    f0[k] = estimator.finish();
+  }
+
+  for (i=0; (i < (int)f0[0].size()) && (i < (int)f0[1].size()); i++)
+  {
+    if ((f0[0][i] > 0.0) && (f0[1][i] > 0.0))
+    {
+      sum+= fabs(12.0*log(f0[1][i] / f0[0][i]) / log(2.0));
+      numVoicedFrames++;
+    }
+  }
+
+  if (numVoicedFrames < 1)
+  {
+    return 0.0;
+  }
+  return sum / (double)numVoicedFrames;
+}
+
+
+// ****************************************************************************
+/// Tracks the formants of both signals and returns the mean absolute 
+/// deviation of each formant of the test signal from the reference in
+/// deviation_Hz[0 ... FormantTracker::NUM_FORMANTS-1]. Only frames where
+/// both signals have the formant are taken into account.
+// ****************************************************************************
+
+void PreviewSynthesizer::getFormantDeviation_Hz(const vector<double> &reference, 
+  const vector<double> &test, double *deviation_Hz)
+{
+  FormantTracker tracker[2];
+  const vector<double> *signal[2] = { &reference, &test };
+  double sum;
+  int numFrames;
+  int length = (int)reference.size();
+  int i, k;
+
+  for (k=0; k < FormantTracker::NUM_FORMANTS; k++)
+  {
+    deviation_Hz[k] = 0.0;
+  }
+
+  if ((int)test.size() < length)
+  {
+    length = (int)test.size();
+  }
+  if (length < 1)
+  {
+    return;
+  }
+
+  for (k=0; k < 2; k++)
+  {
+    Signal16 s(length);
+    toSignal16(*signal[k], s);
+    tracker[k].update(&s, SAMPLING_RATE);
+  }
+
+  for (k=0; k < FormantTracker::NUM_FORMANTS; k++)
+  {
+    sum = 0.0;
+    numFrames = 0;
+    for (i=0; (i < (int)tracker[0].formant_Hz[k].size()) && (i < (int)tracker[1].formant_Hz[k].size()); i++)
+    {
+      if ((tracker[0].formant_Hz[k][i] > 0.0) && (tracker[1].formant_Hz[k][i] > 0.0))
+      {
+        sum+= fabs(tracker[1].formant_Hz[k][i] - tracker[0].formant_Hz[k][i]);
+        numFrames++;
+      }
+    }
+    if (numFrames > 0)
+    {
+      deviation_Hz[k] = sum / (double)numFrames;
+    }
+  }
+}
+
+
+// ****************************************************************************
+/// Copies the first s.N samples of x into s and clips them to 16 bit.
+// ****************************************************************************
+
+void PreviewSynthesizer::toSignal16(const vector<double> &x, Signal16 &s)
+{
+  int i;
+  double value;
+
+  for (i=0; (i < s.N) && (i < (int)x.size()); i++)
+  {
+    value = x[i];
+    if (value > 32767.0)
+    {
+      value = 32767.0;
+    }
+    if (value < -32768.0)
+    {
+      value = -32768.0;
+    }
+    s.setValue(i, (short)value);
+  }
+}
+
+
+// ****************************************************************************
+/// Prints the waveform SNR, the spectral deviation from 0 to maxFreq_Hz, the
+/// F0 deviation and the formant deviations of the test signal from the 
+/// reference signal.
+// ****************************************************************************
+
+void PreviewSynthesizer::printDeviation(const vector<double> &reference, 
+  const vector<double> &test, double maxFreq_Hz)
+{
+  double formantDeviation_Hz[FormantTracker::NUM_FORMANTS];
+  int k;
+
+  wxPrintf("  Waveform SNR: %2.1f dB.\n", getSnr_dB(reference, test));
+  wxPrintf("  Spectral deviation from 0 to %2.0f Hz: %2.2f dB.\n", maxFreq_Hz,
+    getSpectralDeviation_dB(reference, test, maxFreq_Hz));
+  wxPrintf("  F0 deviation: %2.3f semitones.\n", getF0Deviation_st(reference, test));
+
+  getFormantDeviation_Hz(reference, test, formantDeviation_Hz);
+  wxPrintf("  Formant deviation:");
+  for (k=0; k < FormantTracker::NUM_FORMANTS; k++)
+  {
+    wxPrintf(" F%d %2.1f Hz", k+1, formantDeviation_Hz[k]);
+  }
+  wxPrintf(".\n");
+}
+
+
+// ****************************************************************************
+/// Synthesizes the tube sequence at SAMPLING_RATE and at the given rate and
+/// prints the times, the speed gain, and the deviation of the preview from
+/// the full-rate synthesis.
+// ****************************************************************************
+
+bool PreviewSynthesizer::compare(TubeSequence *tubeSequence, TdsModel *tdsModel, int samplingRate)
+{
+  vector<double> reference;
+  vector<double> preview;
+  wxStopWatch stopWatch;
+  double referenceTime_ms;
+  double previewTime_ms;
+
+  if (synthesize(tubeSequence, tdsModel, SAMPLING_RATE, reference) == false)
+  {
+    return false;
+  }
+  referenceTime_ms = (double)stopWatch.Time();
+
+  stopWatch.Start();
+  if (synthesize(tubeSequence, tdsModel, samplingRate, preview) == false)
+  {
+    wxPrintf("Error: The preview sampling rate must be between %d and %d Hz.\n",
+      MIN_SAMPLING_RATE, SAMPLING_RATE);
+    return false;
+  }
+  previewTime_ms = (double)stopWatch.Time();
+  if (previewTime_ms < 1.0)
+  {
+    previewTime_ms = 1.0;
+  }
+
+  wxPrintf("Synthesis at %d Hz: %2.0f ms.\n", SAMPLING_RATE, referenceTime_ms);
+  wxPrintf("Preview at %d Hz: %2.0f ms (%2.2f times faster).\n", samplingRate,
+    previewTime_ms, referenceTime_ms / previewTime_ms);
+  printDeviation(reference, preview, getBandwidth_Hz(samplingRate));
+
+  return true;
+}
+
+// ****************************************************************************
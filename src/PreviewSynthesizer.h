@@ -0,0 +1,82 @@
+// ****************************************************************************
+// This file is part of VocalTractLab.
+// Copyright (C) 2020, Peter Birkholz, Dresden, Germany
+// www.vocaltractlab.de
+// author: Peter Birkholz
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//
+// ****************************************************************************
+
+
+#ifndef __PREVIEW_SYNTHESIZER_H__
+#define __PREVIEW_SYNTHESIZER_H__
+
+#include <vector>
+#include "VocalTractLabBackend/TdsModel.h"
+#include "VocalTractLabBackend/TubeSequence.h"
+#include "VocalTractLabBackend/Signal.h"
+
+using namespace std;
+
+// ****************************************************************************
+/// Fast preview synthesis of a tube sequence with the time-domain simulation
+/// at a reduced sampling rate (e.g., 22050 or 16000 Hz). The TDS model is 
+/// run with the time step of the reduced rate, while the tube sequence (and
+/// the glottis model with it) is stepped forward at SAMPLING_RATE between 
+/// the time steps. The output pressure is low-pass filtered below the 
+/// Nyquist frequency of the reduced rate and resampled to SAMPLING_RATE for 
+/// the playback. The audio samples have the scaling of the main track.
+// ****************************************************************************
+
+class PreviewSynthesizer
+{
+  // **************************************************************************
+  // Public data.
+  // **************************************************************************
+
+public:
+  static const int MIN_SAMPLING_RATE = 8000;
+
+  // **************************************************************************
+  // Public functions.
+  // **************************************************************************
+
+public:
+  static bool synthesize(TubeSequence *tubeSequence, TdsModel *tdsModel, 
+    int samplingRate, vector<double> &audio);
+  static double getBandwidth_Hz(int samplingRate);
+  static void resample(const vector<double> &input, double inputRate, 
+    double outputRate, int outputLength, vector<double> &output);
+  static double getSpectralDeviation_dB(const vector<double> &a, 
+    const vector<double> &b, double maxFreq_Hz);
+  static double getSnr_dB(const vector<double> &reference, const vector<double> &test);
+  static double getF0Deviation_st(const vector<double> &reference, const vector<double> &test);
+  static void getFormantDeviation_Hz(const vector<double> &reference, 
+    const vector<double> &test, double *deviation_Hz);
+  static void printDeviation(const vector<double> &reference, const vector<double> &test,
+    double maxFreq_Hz);
+  static bool compare(TubeSequence *tubeSequence, TdsModel *tdsModel, int samplingRate);
+
+  // **************************************************************************
+  // Private functions.
+  // **************************************************************************
+
+private:
+  static void toSignal16(const vector<double> &x, Signal16 &s);
+};
+
+#endif
+
+// ****************************************************************************
@@ -0,0 +1,151 @@
+// ****************************************************************************
+// This file is part of VocalTractLab.
+// Copyright (C) 2020, Peter Birkholz, Dresden, Germany
+// www.vocaltractlab.de
+// author: Peter Birkholz
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//
+// ****************************************************************************
+
+
+#include "RandomStream.h"
+#include <cmath>
+
+static const double TWO_PI = 6.283185307179586;
+
+// ****************************************************************************
+/// Returns the next value of the SplitMix64 sequence, which is used to 
+/// spread a seed over the state of the generator.
+// ****************************************************************************
+
+static unsigned long long splitMix64(unsigned long long &x)
+{
+  unsigned long long z = (x += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+
+// ****************************************************************************
+/// Constructor. Creates the stream with the given index for the seed.
+// ****************************************************************************
+
+RandomStream::RandomStream(unsigned long long seed, unsigned long long streamIndex)
+{
+  setSeed(seed, streamIndex);
+}
+
+
+// ****************************************************************************
+/// Restarts the stream with the given index for the seed. Different stream
+/// indices give statistically independent sequences.
+// ****************************************************************************
+
+void RandomStream::setSeed(unsigned long long seed, unsigned long long streamIndex)
+{
+  int i;
+  unsigned long long x = seed;
+
+  // Mix the stream index into the seed, so that neighboring indices
+  // give unrelated states.
+  x ^= splitMix64(streamIndex);
+
+  for (i=0; i < 4; i++)
+  {
+    state[i] = splitMix64(x);
+  }
+}
+
+
+// ****************************************************************************
+/// Returns a normally distributed value with the mean 0 and the standard
+/// deviation 1.
+// ****************************************************************************
+
+double RandomStream::getGaussian()
+{
+  double x;
+  fillGaussian(&x, 1);
+  return x;
+}
+
+
+// ****************************************************************************
+/// Fills the array with uniformly distributed values in [0, 1).
+// ****************************************************************************
+
+void RandomStream::fillUniform(double *x, int numValues)
+{
+  int i;
+  for (i=0; i < numValues; i++)
+  {
+    x[i] = getUniform();
+  }
+}
+
+
+// ****************************************************************************
+/// Fills the array with normally distributed values. The values are generated
+/// in pairs with the Box-Muller transform: first all uniform values are drawn,
+/// and then they are transformed in a loop without dependencies between the
+/// iterations, which the compiler can vectorize.
+// ****************************************************************************
+
+void RandomStream::fillGaussian(double *x, int numValues, double mean, double standardDeviation)
+{
+  const int BLOCK_LENGTH = 256;
+  double u1[BLOCK_LENGTH];
+  double u2[BLOCK_LENGTH];
+  double r, phi;
+  int numPairs;
+  int pos = 0;
+  int i;
+
+  while (pos < numValues)
+  {
+    numPairs = (numValues - pos + 1) / 2;
+    if (numPairs > BLOCK_LENGTH)
+    {
+      numPairs = BLOCK_LENGTH;
+    }
+
+    for (i=0; i < numPairs; i++)
+    {
+      // 1 - u is in (0, 1], so that the logarithm is finite.
+      u1[i] = 1.0 - getUniform();
+      u2[i] = getUniform();
+    }
+
+    for (i=0; i < numPairs; i++)
+    {
+      r = sqrt(-2.0*log(u1[i]))*standardDeviation;
+      phi = TWO_PI*u2[i];
+      u1[i] = mean + r*cos(phi);
+      u2[i] = mean + r*sin(phi);
+    }
+
+    for (i=0; (i < numPairs) && (pos < numValues); i++)
+    {
+      x[pos++] = u1[i];
+      if (pos < numValues)
+      {
+        x[pos++] = u2[i];
+      }
+    }
+  }
+}
+
+// ****************************************************************************
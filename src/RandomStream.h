@@ -0,0 +1,90 @@
+// ****************************************************************************
+// This file is part of VocalTractLab.
+// Copyright (C) 2020, Peter Birkholz, Dresden, Germany
+// www.vocaltractlab.de
+// author: Peter Birkholz
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//
+// ****************************************************************************
+
+
+#ifndef __RANDOM_STREAM_H__
+#define __RANDOM_STREAM_H__
+
+// ****************************************************************************
+/// A fast pseudo-random number generator (xoshiro256**) with its own state,
+/// so that independent streams can be used on different threads without 
+/// the shared state of rand(). A stream is defined by a seed and a stream
+/// index (e.g., the index of the item of a ParallelJob), so that the numbers
+/// of each item are the same regardless of the number of threads.
+// ****************************************************************************
+
+class RandomStream
+{
+  // **************************************************************************
+  // Public functions.
+  // **************************************************************************
+
+public:
+  RandomStream(unsigned long long seed = 0, unsigned long long streamIndex = 0);
+  void setSeed(unsigned long long seed, unsigned long long streamIndex = 0);
+
+  /// Returns the next 64 random bits.
+  inline unsigned long long getBits()
+  {
+    const unsigned long long result = rotateLeft(state[1] * 5, 7) * 9;
+    const unsigned long long t = state[1] << 17;
+
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= t;
+    state[3] = rotateLeft(state[3], 45);
+
+    return result;
+  }
+
+  /// Returns a uniformly distributed value in [0, 1).
+  inline double getUniform()
+  {
+    return (double)(getBits() >> 11) * (1.0 / 9007199254740992.0);
+  }
+
+  double getGaussian();
+  void fillUniform(double *x, int numValues);
+  void fillGaussian(double *x, int numValues, double mean = 0.0, double standardDeviation = 1.0);
+
+  // **************************************************************************
+  // Private data.
+  // **************************************************************************
+
+private:
+  unsigned long long state[4];
+
+  // **************************************************************************
+  // Private functions.
+  // **************************************************************************
+
+private:
+  static inline unsigned long long rotateLeft(unsigned long long x, int k)
+  {
+    return (x << k) | (x >> (64 - k));
+  }
+};
+
+#endif
+
+// ****************************************************************************
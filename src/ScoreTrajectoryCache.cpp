@@ -0,0 +1,486 @@
+// ****************************************************************************
+// This file is part of VocalTractLab.
+// Copyright (C) 2020, Peter Birkholz, Dresden, Germany
+// www.vocaltractlab.de
+// author: Peter Birkholz
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//
+// ****************************************************************************
+
+
+#include <algorithm>
+#include <functional>
+#include <string>
+#include "ScoreTrajectoryCache.h"
+
+// Sampling period of 1 ms. The parameter trajectories have time constants 
+// of several ms, so that the linear interpolation error is negligible.
+const double ScoreTrajectoryCache::CONTROL_RATE_HZ = 1000.0;
+
+// The key of each gesture consists of these values.
+static const int GESTURE_KEY_SIZE = 7;
+
+
+// ****************************************************************************
+/// Constructor.
+// ****************************************************************************
+
+ScoreTrajectoryCache::ScoreTrajectoryCache()
+{
+  score = NULL;
+  isValid = false;
+  numGlottisParams = 0;
+  numParams = 0;
+  numSamples = 0;
+
+  numUpdates = 0;
+  numRecalculations = 0;
+  numRecalculatedSamples = 0;
+}
+
+
+// ****************************************************************************
+/// Brings the samples up to date with the given score. Returns true, if any
+/// samples were recalculated.
+// ****************************************************************************
+
+bool ScoreTrajectoryCache::update(GesturalScore *score)
+{
+  vector<double> newGestureKey[GesturalScore::NUM_GESTURE_TYPES];
+  vector<double> newShapeKey;
+  vector<double> params;
+  double start_s, end_s;
+  int newNumGlottisParams = (int)score->glottis->controlParam.size();
+  int newNumSamples;
+  int firstIndex, lastIndex;
+  int numConverged;
+  bool isEqual;
+  int i, k;
+
+  numUpdates++;
+
+  for (i=0; i < GesturalScore::NUM_GESTURE_TYPES; i++)
+  {
+    getGestureKey(&score->gestures[i], newGestureKey[i]);
+  }
+
+  // The shapes can change without any change of the gestures.
+  this->score = score;
+  getShapeKey(newShapeKey);
+
+  newNumSamples = (int)(score->getScoreDuration_s() * CONTROL_RATE_HZ) + 2;
+
+  // ****************************************************************
+  // Determine the range of samples to recalculate.
+  // ****************************************************************
+
+  if ((isValid == false) || (newNumGlottisParams != numGlottisParams) || 
+    (newShapeKey != shapeKey))
+  {
+    firstIndex = 0;
+    lastIndex = newNumSamples - 1;
+    isValid = false;
+  }
+  else
+  if (getChangedSpan(newGestureKey, start_s, end_s) == false)
+  {
+    return false;
+  }
+  else
+  {
+    // One extra sample before the change for the interpolation.
+    firstIndex = (int)(start_s * CONTROL_RATE_HZ) - 1;
+    lastIndex = (int)(end_s * CONTROL_RATE_HZ) + 1;
+  }
+
+  if (firstIndex < 0)
+  {
+    firstIndex = 0;
+  }
+  if (lastIndex > newNumSamples - 1)
+  {
+    lastIndex = newNumSamples - 1;
+  }
+
+  // The time functions of the score may not yet reflect the change.
+  score->calcCurves();
+
+  numGlottisParams = newNumGlottisParams;
+  numParams = VocalTract::NUM_PARAMS + numGlottisParams;
+
+  // Samples beyond the old end are never compared with old values.
+  int numOldSamples = isValid ? numSamples : 0;
+  numSamples = newNumSamples;
+  sample.resize(numSamples * numParams);
+  params.resize(numParams);
+
+  // ****************************************************************
+  // Recalculate the changed span, and beyond it, until the new 
+  // samples equal the cached ones for a while. The trajectories 
+  // are the outputs of target approximation filters, so that a 
+  // change affects the following samples until they converge.
+  // ****************************************************************
+
+  numConverged = 0;
+  for (i=firstIndex; i < numSamples; i++)
+  {
+    calcSample(i, &params[0]);
+    numRecalculatedSamples++;
+
+    isEqual = false;
+    if ((i > lastIndex) && (i < numOldSamples))
+    {
+      isEqual = true;
+      for (k=0; (k < numParams) && (isEqual); k++)
+      {
+        if (params[k] != sample[i*numParams + k])
+        {
+          isEqual = false;
+        }
+      }
+    }
+
+    for (k=0; k < numParams; k++)
+    {
+      sample[i*numParams + k] = params[k];
+    }
+
+    if (isEqual)
+    {
+      numConverged++;
+      if (numConverged >= NUM_CONVERGED_SAMPLES)
+      {
+        break;
+      }
+    }
+    else
+    {
+      numConverged = 0;
+    }
+  }
+
+  for (i=0; i < GesturalScore::NUM_GESTURE_TYPES; i++)
+  {
+    gestureKey[i] = newGestureKey[i];
+  }
+  shapeKey = newShapeKey;
+  isValid = true;
+  numRecalculations++;
+
+  return true;
+}
+
+
+// ****************************************************************************
+/// Forces the recalculation of all samples with the next update.
+// ****************************************************************************
+
+void ScoreTrajectoryCache::invalidate()
+{
+  isValid = false;
+}
+
+
+// ****************************************************************************
+/// Returns the parameters at the given time, interpolated between the 
+/// samples. Outside of the score, the first or last sample is returned.
+/// update(...) must have been called before.
+// ****************************************************************************
+
+void ScoreTrajectoryCache::getParams(double pos_s, double *vocalTractParams, double *glottisParams)
+{
+  double x = pos_s * CONTROL_RATE_HZ;
+  int index;
+  double ratio;
+  double *a, *b;
+  double value;
+  int k;
+
+  if ((isValid == false) || (numSamples < 1))
+  {
+    if (score != NULL)
+    {
+      score->getParams(pos_s, vocalTractParams, glottisParams);
+    }
+    return;
+  }
+
+  if (x < 0.0)
+  {
+    x = 0.0;
+  }
+  if (x > numSamples - 1)
+  {
+    x = numSamples - 1;
+  }
+
+  index = (int)x;
+  if (index >= numSamples - 1)
+  {
+    index = numSamples - 2;
+  }
+  if (index < 0)
+  {
+    index = 0;
+  }
+  ratio = x - index;
+  if (numSamples < 2)
+  {
+    ratio = 0.0;
+  }
+
+  a = &sample[index*numParams];
+  b = (numSamples < 2) ? a : &sample[(index + 1)*numParams];
+
+  for (k=0; k < numParams; k++)
+  {
+    value = a[k] + ratio*(b[k] - a[k]);
+    if (k < VocalTract::NUM_PARAMS)
+    {
+      vocalTractParams[k] = value;
+    }
+    else
+    {
+      glottisParams[k - VocalTract::NUM_PARAMS] = value;
+    }
+  }
+}
+
+
+// ****************************************************************************
+// ****************************************************************************
+
+int ScoreTrajectoryCache::getNumSamples()
+{
+  return numSamples;
+}
+
+
+// ****************************************************************************
+/// Copies the samples of all parameters (numParams values per sample).
+// ****************************************************************************
+
+void ScoreTrajectoryCache::getSamples(vector<double> &samples)
+{
+  samples = sample;
+}
+
+
+// ****************************************************************************
+/// Compares the given samples (from getSamples(...) after an earlier update)
+/// with the current ones and returns the time of the first sample that 
+/// differs, or -1, if all samples are equal.
+// ****************************************************************************
+
+double ScoreTrajectoryCache::getFirstDifference_s(const vector<double> &samples)
+{
+  int i;
+  int n = (int)sample.size();
+
+  if ((isValid == false) || (numParams < 1))
+  {
+    return 0.0;
+  }
+
+  if ((int)samples.size() < n)
+  {
+    n = (int)samples.size();
+  }
+
+  for (i=0; i < n; i++)
+  {
+    if (samples[i] != sample[i])
+    {
+      return (double)(i / numParams) / CONTROL_RATE_HZ;
+    }
+  }
+
+  if (samples.size() != sample.size())
+  {
+    return (double)(n / numParams) / CONTROL_RATE_HZ;
+  }
+  return -1.0;
+}
+
+
+// ****************************************************************************
+/// Returns the values of all gestures of the sequence that have an influence
+/// on the parameter trajectories.
+// ****************************************************************************
+
+void ScoreTrajectoryCache::getGestureKey(GestureSequence *sequence, vector<double> &key)
+{
+  int numGestures = sequence->numGestures();
+  Gesture *g;
+  int i;
+
+  key.resize(numGestures * GESTURE_KEY_SIZE);
+
+  for (i=0; i < numGestures; i++)
+  {
+    g = sequence->getGesture(i);
+    key[i*GESTURE_KEY_SIZE + 0] = sequence->getGestureBegin_s(i);
+    key[i*GESTURE_KEY_SIZE + 1] = g->duration_s;
+    key[i*GESTURE_KEY_SIZE + 2] = g->dVal;
+    key[i*GESTURE_KEY_SIZE + 3] = (double)(std::hash<string>()(string(g->sVal)) & 0xFFFFFFFF);
+    key[i*GESTURE_KEY_SIZE + 4] = g->slope;
+    key[i*GESTURE_KEY_SIZE + 5] = g->tau_s;
+    key[i*GESTURE_KEY_SIZE + 6] = g->neutral ? 1.0 : 0.0;
+  }
+}
+
+
+// ****************************************************************************
+/// Returns the parameters of the vocal tract and glottis shapes, which the
+/// gestures refer to by name.
+// ****************************************************************************
+
+void ScoreTrajectoryCache::getShapeKey(vector<double> &key)
+{
+  VocalTract *vt = score->vocalTract;
+  Glottis *glottis = score->glottis;
+  int i, k;
+
+  key.clear();
+  key.push_back((double)vt->shapes.size());
+
+  for (i=0; i < (int)vt->shapes.size(); i++)
+  {
+    key.push_back((double)(std::hash<string>()(string(vt->shapes[i].name)) & 0xFFFFFFFF));
+    for (k=0; k < VocalTract::NUM_PARAMS; k++)
+    {
+      key.push_back(vt->shapes[i].param[k]);
+    }
+  }
+
+  key.push_back((double)glottis->shape.size());
+
+  for (i=0; i < (int)glottis->shape.size(); i++)
+  {
+    key.push_back((double)(std::hash<string>()(string(glottis->shape[i].name)) & 0xFFFFFFFF));
+    for (k=0; k < (int)glottis->shape[i].controlParam.size(); k++)
+    {
+      key.push_back(glottis->shape[i].controlParam[k]);
+    }
+  }
+}
+
+
+// ****************************************************************************
+/// Compares the new gesture keys with the cached ones and returns the time 
+/// span from the begin of the first changed gesture to the end of the last 
+/// changed gesture (of all gesture types). Returns false, if nothing changed.
+// ****************************************************************************
+
+bool ScoreTrajectoryCache::getChangedSpan(vector<double> *newGestureKey, double &start_s, double &end_s)
+{
+  const int N = GESTURE_KEY_SIZE;
+  vector<double> *oldKey;
+  vector<double> *newKey;
+  int numOld, numNew;
+  int first, lastOld, lastNew;
+  int i, k;
+  double t;
+  bool hasChanged = false;
+
+  start_s = 0.0;
+  end_s = 0.0;
+
+  for (i=0; i < GesturalScore::NUM_GESTURE_TYPES; i++)
+  {
+    oldKey = &gestureKey[i];
+    newKey = &newGestureKey[i];
+    if (*oldKey == *newKey)
+    {
+      continue;
+    }
+
+    numOld = (int)oldKey->size() / N;
+    numNew = (int)newKey->size() / N;
+
+    // First changed gesture from the front.
+    first = 0;
+    while ((first < numOld) && (first < numNew) &&
+      (equal(oldKey->begin() + first*N, oldKey->begin() + (first + 1)*N, newKey->begin() + first*N)))
+    {
+      first++;
+    }
+
+    // Last changed gesture from the back (the end times are compared 
+    // via begin + duration).
+    lastOld = numOld - 1;
+    lastNew = numNew - 1;
+    while ((lastOld >= first) && (lastNew >= first) &&
+      (equal(oldKey->begin() + lastOld*N, oldKey->begin() + (lastOld + 1)*N, newKey->begin() + lastNew*N)))
+    {
+      lastOld--;
+      lastNew--;
+    }
+
+    // The begin of the first changed gesture.
+    t = 1.0e10;
+    if (first < numOld)
+    {
+      t = (*oldKey)[first*N];
+    }
+    if ((first < numNew) && ((*newKey)[first*N] < t))
+    {
+      t = (*newKey)[first*N];
+    }
+    if (t > 1.0e9)
+    {
+      t = 0.0;
+    }
+    if ((hasChanged == false) || (t < start_s))
+    {
+      start_s = t;
+    }
+
+    // The end of the last changed gesture.
+    for (k=0; k < 2; k++)
+    {
+      vector<double> *key = (k == 0) ? oldKey : newKey;
+      int last = (k == 0) ? lastOld : lastNew;
+      if ((last >= 0) && (last < (int)key->size() / N))
+      {
+        t = (*key)[last*N] + (*key)[last*N + 1];
+        if (t > end_s)
+        {
+          end_s = t;
+        }
+      }
+    }
+
+    if (end_s < start_s)
+    {
+      end_s = start_s;
+    }
+    hasChanged = true;
+  }
+
+  return hasChanged;
+}
+
+
+// ****************************************************************************
+/// Evaluates the score for the sample with the given index.
+// ****************************************************************************
+
+void ScoreTrajectoryCache::calcSample(int index, double *params)
+{
+  score->getParams((double)index / CONTROL_RATE_HZ, &params[0], &params[VocalTract::NUM_PARAMS]);
+}
+
+// ****************************************************************************
@@ -0,0 +1,97 @@
+// ****************************************************************************
+// This file is part of VocalTractLab.
+// Copyright (C) 2020, Peter Birkholz, Dresden, Germany
+// www.vocaltractlab.de
+// author: Peter Birkholz
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//
+// ****************************************************************************
+
+
+#ifndef __SCORE_TRAJECTORY_CACHE_H__
+#define __SCORE_TRAJECTORY_CACHE_H__
+
+#include <vector>
+#include "VocalTractLabBackend/GesturalScore.h"
+
+using namespace std;
+
+// ****************************************************************************
+/// Keeps the vocal tract and glottis parameters of a gestural score sampled
+/// at a fixed control rate, so that pictures and the model updates don't
+/// have to evaluate the score for every pixel column. update(...) compares
+/// the gestures and the shapes they refer to with those of the last update
+/// and recalculates only the samples from the first changed gesture up to 
+/// the point where the new trajectories converge to the cached ones.
+/// getParams(...) interpolates linearly between the samples.
+// ****************************************************************************
+
+class ScoreTrajectoryCache
+{
+  // **************************************************************************
+  // Public data.
+  // **************************************************************************
+
+public:
+  static const double CONTROL_RATE_HZ;
+
+  // Statistics
+  int numUpdates;
+  int numRecalculations;
+  long numRecalculatedSamples;
+
+  // **************************************************************************
+  // Public functions.
+  // **************************************************************************
+
+public:
+  ScoreTrajectoryCache();
+  bool update(GesturalScore *score);
+  void invalidate();
+  void getParams(double pos_s, double *vocalTractParams, double *glottisParams);
+  int getNumSamples();
+  void getSamples(vector<double> &samples);
+  double getFirstDifference_s(const vector<double> &samples);
+
+  // **************************************************************************
+  // Private data.
+  // **************************************************************************
+
+private:
+  static const int NUM_CONVERGED_SAMPLES = 20;
+
+  GesturalScore *score;
+  bool isValid;
+  int numGlottisParams;
+  int numParams;          ///< Params per sample (vocal tract + glottis)
+  int numSamples;
+  vector<double> sample;
+  vector<double> gestureKey[GesturalScore::NUM_GESTURE_TYPES];
+  vector<double> shapeKey;
+
+  // **************************************************************************
+  // Private functions.
+  // **************************************************************************
+
+private:
+  void getGestureKey(GestureSequence *sequence, vector<double> &key);
+  void getShapeKey(vector<double> &key);
+  bool getChangedSpan(vector<double> *newGestureKey, double &start_s, double &end_s);
+  void calcSample(int index, double *params);
+};
+
+#endif
+
+// ****************************************************************************
@@ -108,6 +108,11 @@ SignalComparisonPicture::SignalComparisonPicture(wxWindow *parent, wxWindow *upd
 
   spectrogramPlot = new SpectrogramPlot();
 
+  for (i=0; i < NUM_ROWS; i++)
+  {
+    rowBitmap[i] = NULL;
+  }
+
   showExtraTrack = false;
   showSonagrams = true;
   showSegmentation = true;
@@ -207,9 +212,6 @@ double SignalComparisonPicture::getVertOffset_percent()
 
 void SignalComparisonPicture::paintSignals(wxDC &dc)
 {
-  wxColor mainF0Color(255, 128, 0);
-  wxColor extraF0Color(255, 215, 0);
-  wxColor voiceQualityColor(128, 255, 128);
   int x, y;
 
   // Clear the background
@@ -248,38 +250,41 @@ void SignalComparisonPicture::paintSignals(wxDC &dc)
   int index = 0;
 
   // ****************************************************************
-  // Paint the four subplots.
+  // Copy the content of the rows from their cached bitmaps, which
+  // are only repainted when their content changed.
   // ****************************************************************
 
-  dc.SetFont(wxFont(9, wxFONTFAMILY_DEFAULT, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL));
-
-  index = SEGMENTATION_ROW_1;
-  if (rowH[index] > 0)
+  for (index=0; index < NUM_ROWS; index++)
   {
-    paintWordSegmentation(dc, LEFT_MARGIN, rowY[index], 
-      windowWidth-LEFT_MARGIN, rowH[index], startTime_s, duration_s);
-    dc.DrawText("Words", 5, rowY[index]);
-  }
-
-  index = SEGMENTATION_ROW_2;
-  if (rowH[index] > 0)
-  {
-    paintPhoneSegmentation(dc, LEFT_MARGIN, rowY[index], 
-      windowWidth-LEFT_MARGIN, rowH[index], startTime_s, duration_s);
-    dc.DrawText("Phones", 5, rowY[index]);
+    if ((rowH[index] > 0) && (rowY[index] < windowHeight) && (rowY[index] + rowH[index] >= 0))
+    {
+      paintRow(dc, index, LEFT_MARGIN, rowY[index], windowWidth-LEFT_MARGIN, rowH[index],
+        startTime_s, duration_s, firstSample, numSamples);
+    }
   }
 
   // ****************************************************************
+  // Row labels and play buttons.
   // ****************************************************************
 
+  dc.SetFont(wxFont(9, wxFONTFAMILY_DEFAULT, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL));
+
+  const char *ROW_LABEL[NUM_ROWS] = 
+  { 
+    "Words", "Phones", "Main oscillo.", "Main spectro.", "Extra oscillo.", "Extra spectro."
+  };
+
+  for (index=0; index < NUM_ROWS; index++)
+  {
+    if (rowH[index] > 0)
+    {
+      dc.DrawText(ROW_LABEL[index], 5, rowY[index]);
+    }
+  }
+
   index = OSCILLOGRAM_ROW_1;
   if ((rowH[index] > 0) && (rowY[index] < windowHeight) && (rowY[index] + rowH[index] >= 0))
   {
-    // Paint the oscillogram.
-    paintOscillogram(dc, LEFT_MARGIN, rowY[index], windowWidth-LEFT_MARGIN, rowH[index],
-      data->track[Data::MAIN_TRACK], firstSample, numSamples);
-    dc.DrawText("Main oscillo.", 5, rowY[index]);
-
     playButtonX[0] = (LEFT_MARGIN - this->FromDIP(PLAY_BUTTON_WIDTH)) / 2;
     playButtonY[0] = rowY[index] + this->FromDIP(20);
     paintPlayButton(dc, playButtonX[0], playButtonY[0]);
@@ -290,63 +295,9 @@ void SignalComparisonPicture::paintSignals(wxDC &dc)
     playButtonY[0] = 1000000;
   }
 
-  // ****************************************************************
-  // ****************************************************************
-
-  index = SPECTROGRAM_ROW_1;
-  if ((rowH[index] > 0) && (rowY[index] < windowHeight) && (rowY[index] + rowH[index] >= 0))
-  {
-    // Paint the main spectrogram.
-    spectrogramPlot->drawSpectrogram(dc, LEFT_MARGIN, rowY[index], windowWidth-LEFT_MARGIN, rowH[index], 
-      data->track[Data::MAIN_TRACK], firstSample, numSamples);
-    dc.DrawText("Main spectro.", 5, rowY[index]);
-
-    if (showModelF0Curve)
-    {
-      // Paint the model F0 curve for the main track (from the gestural score).
-      vector<double> *modelF0Curve = &data->gesturalScore->glottisParamCurve[Glottis::FREQUENCY];
-      spectrogramPlot->drawCurve(dc, LEFT_MARGIN, rowY[index], windowWidth-LEFT_MARGIN, rowH[index], 
-        *modelF0Curve, 1.0/GesturalScore::CURVE_SAMPLING_RATE, startTime_s, duration_s,
-        0.0, 600.0, mainF0Color, true);
-    }
-
-    if (data->showF0)
-    {
-      // Paint the F0 curve for the main track.
-      spectrogramPlot->drawCurve(dc, LEFT_MARGIN, rowY[index], windowWidth-LEFT_MARGIN, rowH[index], 
-        data->f0Signal[Data::MAIN_TRACK], data->f0TimeStep_s, startTime_s, duration_s,
-        0.0, 600.0, mainF0Color, false);
-
-      // Paint the F0 curve for the extra track.
-      spectrogramPlot->drawCurve(dc, LEFT_MARGIN, rowY[index], windowWidth-LEFT_MARGIN, rowH[index], 
-        data->f0Signal[Data::EXTRA_TRACK], data->f0TimeStep_s, startTime_s, duration_s,
-        0.0, 600.0, extraF0Color, false);
-    }
-
-    if (data->showVoiceQuality)
-    {
-      // Paint the voice quality curve for the main track.
-      spectrogramPlot->drawCurve(dc, LEFT_MARGIN, rowY[index], windowWidth-LEFT_MARGIN, rowH[index], 
-        data->voiceQualitySignal[Data::MAIN_TRACK], data->voiceQualityTimeStep_s, startTime_s, duration_s,
-        VoiceQualityEstimator::MIN_PEAK_SLOPE, VoiceQualityEstimator::MAX_PEAK_SLOPE, voiceQualityColor, false);
-
-      // Paint the voice quality curve for the extra track.
-      spectrogramPlot->drawCurve(dc, LEFT_MARGIN, rowY[index], windowWidth-LEFT_MARGIN, rowH[index], 
-        data->voiceQualitySignal[Data::EXTRA_TRACK], data->voiceQualityTimeStep_s, startTime_s, duration_s,
-        VoiceQualityEstimator::MIN_PEAK_SLOPE, VoiceQualityEstimator::MAX_PEAK_SLOPE, voiceQualityColor, true);
-    }
-  }
-
-  // ****************************************************************
-  // ****************************************************************
-
   index = OSCILLOGRAM_ROW_2;
   if ((rowH[index] > 0) && (rowY[index] < windowHeight) && (rowY[index] + rowH[index] >= 0))
   {
-    paintOscillogram(dc, LEFT_MARGIN, rowY[index], windowWidth-LEFT_MARGIN, rowH[index],
-      data->track[Data::EXTRA_TRACK], firstSample, numSamples);
-    dc.DrawText("Extra oscillo.", 5, rowY[index]);
-
     playButtonX[1] = (LEFT_MARGIN - this->FromDIP(PLAY_BUTTON_WIDTH)) / 2;
     playButtonY[1] = rowY[index] + this->FromDIP(20);
     paintPlayButton(dc, playButtonX[1], playButtonY[1]);
@@ -357,26 +308,6 @@ void SignalComparisonPicture::paintSignals(wxDC &dc)
     playButtonY[1] = 1000000;
   }
 
-  // ****************************************************************
-  // ****************************************************************
-
-  index = SPECTROGRAM_ROW_2;
-  if ((rowH[index] > 0) && (rowY[index] < windowHeight) && (rowY[index] + rowH[index] >= 0))
-  {
-    // Paint the extra spectrogram.
-    spectrogramPlot->drawSpectrogram(dc, LEFT_MARGIN, rowY[index], windowWidth-LEFT_MARGIN, rowH[index], 
-      data->track[Data::EXTRA_TRACK], firstSample, numSamples);
-    dc.DrawText("Extra spectro.", 5, rowY[index]);
-
-    if (data->showF0)
-    {
-      // Paint the F0 curve for the extra track.
-      spectrogramPlot->drawCurve(dc, LEFT_MARGIN, rowY[index], windowWidth-LEFT_MARGIN, rowH[index], 
-        data->f0Signal[Data::EXTRA_TRACK], data->f0TimeStep_s, startTime_s, duration_s,
-        0.0, 600.0, extraF0Color, false);
-    }
-  }
-
   // ****************************************************************
   // Draw black lines separating the rows.
   // ****************************************************************
@@ -501,6 +432,359 @@ void SignalComparisonPicture::paintSignals(wxDC &dc)
 }
 
 
+// ****************************************************************************
+/// Forces the repainting of the content of all rows with the next refresh,
+/// e.g., when data changed that is not covered by the row keys.
+// ****************************************************************************
+
+void SignalComparisonPicture::invalidateRows()
+{
+  int i;
+  for (i=0; i < NUM_ROWS; i++)
+  {
+    rowKey[i].clear();
+  }
+}
+
+
+// ****************************************************************************
+/// Draws the content of the given row at the given position. The content is
+/// taken from the cached bitmap of the row, which is repainted only when the
+/// key of the row (view range, size, and a checksum of the displayed data)
+/// changed. So mouse moves and moving marks don't repaint the spectrograms.
+// ****************************************************************************
+
+void SignalComparisonPicture::paintRow(wxDC &dc, int row, int areaX, int areaY, 
+  int areaWidth, int areaHeight, double startTime_s, double duration_s, 
+  int firstSample, int numSamples)
+{
+  vector<double> key;
+
+  if ((areaWidth < 1) || (areaHeight < 1))
+  {
+    return;
+  }
+
+  getRowKey(row, areaWidth, areaHeight, startTime_s, duration_s, key);
+
+  if ((rowBitmap[row] == NULL) || (rowBitmap[row]->GetWidth() != areaWidth) ||
+    (rowBitmap[row]->GetHeight() != areaHeight))
+  {
+    delete rowBitmap[row];
+    rowBitmap[row] = new wxBitmap(areaWidth, areaHeight);
+    rowKey[row].clear();
+  }
+
+  if ((key != rowKey[row]) || (rowKey[row].empty()))
+  {
+    wxMemoryDC memoryDC(*rowBitmap[row]);
+    memoryDC.SetBackground(*wxWHITE_BRUSH);
+    memoryDC.Clear();
+    memoryDC.SetFont(wxFont(9, wxFONTFAMILY_DEFAULT, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL));
+
+    paintRowContent(memoryDC, row, areaWidth, areaHeight, startTime_s, duration_s, 
+      firstSample, numSamples);
+
+    memoryDC.SelectObject(wxNullBitmap);
+    rowKey[row] = key;
+  }
+
+  dc.DrawBitmap(*rowBitmap[row], areaX, areaY);
+}
+
+
+// ****************************************************************************
+/// Paints the content of the given row into the area (0, 0, areaWidth,
+/// areaHeight) of the device context.
+// ****************************************************************************
+
+void SignalComparisonPicture::paintRowContent(wxDC &dc, int row, int areaWidth, int areaHeight, 
+  double startTime_s, double duration_s, int firstSample, int numSamples)
+{
+  wxColor mainF0Color(255, 128, 0);
+  wxColor extraF0Color(255, 215, 0);
+  wxColor voiceQualityColor(128, 255, 128);
+  wxColor formantColor(255, 0, 255);
+  int i;
+
+  switch (row)
+  {
+  case SEGMENTATION_ROW_1:
+    paintWordSegmentation(dc, 0, 0, areaWidth, areaHeight, startTime_s, duration_s);
+    break;
+
+  case SEGMENTATION_ROW_2:
+    paintPhoneSegmentation(dc, 0, 0, areaWidth, areaHeight, startTime_s, duration_s);
+    break;
+
+  case OSCILLOGRAM_ROW_1:
+    paintOscillogram(dc, 0, 0, areaWidth, areaHeight,
+      data->track[Data::MAIN_TRACK], firstSample, numSamples);
+    break;
+
+  case SPECTROGRAM_ROW_1:
+    // Paint the main spectrogram.
+    spectrogramPlot->drawSpectrogram(dc, 0, 0, areaWidth, areaHeight, 
+      data->track[Data::MAIN_TRACK], firstSample, numSamples);
+
+    if (showModelF0Curve)
+    {
+      // Paint the model F0 curve for the main track (from the gestural score).
+      vector<double> *modelF0Curve = &data->gesturalScore->glottisParamCurve[Glottis::FREQUENCY];
+      spectrogramPlot->drawCurve(dc, 0, 0, areaWidth, areaHeight, 
+        *modelF0Curve, 1.0/GesturalScore::CURVE_SAMPLING_RATE, startTime_s, duration_s,
+        0.0, 600.0, mainF0Color, true);
+    }
+
+    if (data->showF0)
+    {
+      // Paint the F0 curve for the main track.
+      spectrogramPlot->drawCurve(dc, 0, 0, areaWidth, areaHeight, 
+        data->f0Signal[Data::MAIN_TRACK], data->f0TimeStep_s, startTime_s, duration_s,
+        0.0, 600.0, mainF0Color, false);
+
+      // Paint the F0 curve for the extra track.
+      spectrogramPlot->drawCurve(dc, 0, 0, areaWidth, areaHeight, 
+        data->f0Signal[Data::EXTRA_TRACK], data->f0TimeStep_s, startTime_s, duration_s,
+        0.0, 600.0, extraF0Color, false);
+    }
+
+    if (data->showVoiceQuality)
+    {
+      // Paint the voice quality curve for the main track.
+      spectrogramPlot->drawCurve(dc, 0, 0, areaWidth, areaHeight, 
+        data->voiceQualitySignal[Data::MAIN_TRACK], data->voiceQualityTimeStep_s, startTime_s, duration_s,
+        VoiceQualityEstimator::MIN_PEAK_SLOPE, VoiceQualityEstimator::MAX_PEAK_SLOPE, voiceQualityColor, false);
+
+      // Paint the voice quality curve for the extra track.
+      spectrogramPlot->drawCurve(dc, 0, 0, areaWidth, areaHeight, 
+        data->voiceQualitySignal[Data::EXTRA_TRACK], data->voiceQualityTimeStep_s, startTime_s, duration_s,
+        VoiceQualityEstimator::MIN_PEAK_SLOPE, VoiceQualityEstimator::MAX_PEAK_SLOPE, voiceQualityColor, true);
+    }
+
+    if (data->showFormants)
+    {
+      // Paint the formant curves for the main track.
+      for (i=0; i < FormantTracker::NUM_FORMANTS; i++)
+      {
+        spectrogramPlot->drawCurve(dc, 0, 0, areaWidth, areaHeight, 
+          data->formantTracker[Data::MAIN_TRACK].formant_Hz[i], 
+          data->formantTracker[Data::MAIN_TRACK].timeStep_s, startTime_s, duration_s,
+          0.0, spectrogramPlot->viewRange_Hz, formantColor, false, true);
+      }
+    }
+    break;
+
+  case OSCILLOGRAM_ROW_2:
+    paintOscillogram(dc, 0, 0, areaWidth, areaHeight,
+      data->track[Data::EXTRA_TRACK], firstSample, numSamples);
+    break;
+
+  case SPECTROGRAM_ROW_2:
+    // Paint the extra spectrogram.
+    spectrogramPlot->drawSpectrogram(dc, 0, 0, areaWidth, areaHeight, 
+      data->track[Data::EXTRA_TRACK], firstSample, numSamples);
+
+    if (data->showF0)
+    {
+      // Paint the F0 curve for the extra track.
+      spectrogramPlot->drawCurve(dc, 0, 0, areaWidth, areaHeight, 
+        data->f0Signal[Data::EXTRA_TRACK], data->f0TimeStep_s, startTime_s, duration_s,
+        0.0, 600.0, extraF0Color, false);
+    }
+
+    if (data->showFormants)
+    {
+      // Paint the formant curves for the extra track.
+      for (i=0; i < FormantTracker::NUM_FORMANTS; i++)
+      {
+        spectrogramPlot->drawCurve(dc, 0, 0, areaWidth, areaHeight, 
+          data->formantTracker[Data::EXTRA_TRACK].formant_Hz[i], 
+          data->formantTracker[Data::EXTRA_TRACK].timeStep_s, startTime_s, duration_s,
+          0.0, spectrogramPlot->viewRange_Hz, formantColor, false, true);
+      }
+    }
+    break;
+
+  default:
+    break;
+  }
+}
+
+
+// ****************************************************************************
+/// Returns the values that determine the content of the given row. Audio
+/// tracks enter the key with their generation counter, which is incremented
+/// by Data::trackChanged() whenever their samples are modified. Curves enter
+/// the key with a checksum.
+// ****************************************************************************
+
+void SignalComparisonPicture::getRowKey(int row, int areaWidth, int areaHeight, 
+  double startTime_s, double duration_s, vector<double> &key)
+{
+  int i;
+
+  key.clear();
+  key.push_back(areaWidth);
+  key.push_back(areaHeight);
+  key.push_back(startTime_s);
+  key.push_back(duration_s);
+
+  switch (row)
+  {
+  case SEGMENTATION_ROW_1:
+  case SEGMENTATION_ROW_2:
+    addSegmentationKey(key, row == SEGMENTATION_ROW_1);
+    break;
+
+  case OSCILLOGRAM_ROW_1:
+    addSignalKey(key, Data::MAIN_TRACK);
+    break;
+
+  case OSCILLOGRAM_ROW_2:
+    addSignalKey(key, Data::EXTRA_TRACK);
+    break;
+
+  case SPECTROGRAM_ROW_1:
+  case SPECTROGRAM_ROW_2:
+    {
+      int trackIndex = (row == SPECTROGRAM_ROW_1) ? Data::MAIN_TRACK : Data::EXTRA_TRACK;
+
+      key.push_back(spectrogramPlot->windowLength_pt);
+      key.push_back(spectrogramPlot->frameLengthExponent);
+      key.push_back(spectrogramPlot->viewRange_Hz);
+      key.push_back(spectrogramPlot->dynamicRange_dB);
+      addSignalKey(key, trackIndex);
+
+      key.push_back(data->showF0 ? 1.0 : 0.0);
+      key.push_back(data->f0TimeStep_s);
+      if (data->showF0)
+      {
+        addCurveKey(key, data->f0Signal[Data::EXTRA_TRACK]);
+      }
+
+      key.push_back(data->showFormants ? 1.0 : 0.0);
+      if (data->showFormants)
+      {
+        for (i=0; i < FormantTracker::NUM_FORMANTS; i++)
+        {
+          addCurveKey(key, data->formantTracker[trackIndex].formant_Hz[i]);
+        }
+      }
+
+      if (row == SPECTROGRAM_ROW_1)
+      {
+        key.push_back(showModelF0Curve ? 1.0 : 0.0);
+        if (showModelF0Curve)
+        {
+          addCurveKey(key, data->gesturalScore->glottisParamCurve[Glottis::FREQUENCY]);
+        }
+        if (data->showF0)
+        {
+          addCurveKey(key, data->f0Signal[Data::MAIN_TRACK]);
+        }
+        key.push_back(data->showVoiceQuality ? 1.0 : 0.0);
+        key.push_back(data->voiceQualityTimeStep_s);
+        if (data->showVoiceQuality)
+        {
+          addCurveKey(key, data->voiceQualitySignal[Data::MAIN_TRACK]);
+          addCurveKey(key, data->voiceQualitySignal[Data::EXTRA_TRACK]);
+        }
+      }
+    }
+    break;
+
+  default:
+    break;
+  }
+}
+
+
+// ****************************************************************************
+/// Adds the identity, the length and the generation counter of the given
+/// audio track to the key.
+// ****************************************************************************
+
+void SignalComparisonPicture::addSignalKey(vector<double> &key, int trackIndex)
+{
+  Signal16 *s = data->track[trackIndex];
+
+  key.push_back((double)(size_t)s);
+  key.push_back(s->N);
+  key.push_back(data->trackGeneration[trackIndex]);
+}
+
+
+// ****************************************************************************
+/// Adds the length and a checksum of the given curve to the key.
+// ****************************************************************************
+
+void SignalComparisonPicture::addCurveKey(vector<double> &key, const vector<double> &curve)
+{
+  double sum = 0.0;
+  double weightedSum = 0.0;
+  int i;
+
+  for (i=0; i < (int)curve.size(); i++)
+  {
+    sum+= curve[i];
+    weightedSum+= (i + 1)*curve[i];
+  }
+
+  key.push_back(curve.size());
+  key.push_back(sum);
+  key.push_back(weightedSum);
+}
+
+
+// ****************************************************************************
+/// Adds the segment boundaries and labels of the words or of the syllables
+/// and phones to the key.
+// ****************************************************************************
+
+void SignalComparisonPicture::addSegmentationKey(vector<double> &key, bool words)
+{
+  SegmentSequence *sequence = data->segmentSequence;
+  Segment *s = NULL;
+  double startTime_s = 0.0;
+  double endTime_s = 0.0;
+  string label;
+  unsigned int hash;
+  int k;
+
+  key.push_back(sequence->numSegments());
+
+  sequence->resetIteration();
+  while ((s = (words ? sequence->getNextPhrase(startTime_s, endTime_s) : 
+    sequence->getNextSyllable(startTime_s, endTime_s))) != NULL)
+  {
+    key.push_back(startTime_s);
+    key.push_back(endTime_s);
+  }
+
+  sequence->resetIteration();
+  while ((s = (words ? sequence->getNextWord(startTime_s, endTime_s) : 
+    sequence->getNextPhone(startTime_s, endTime_s))) != NULL)
+  {
+    label = s->getValue(words ? "word_orthographic" : "name");
+    hash = 2166136261u;
+    for (k=0; k < (int)label.size(); k++)
+    {
+      hash = (hash ^ (unsigned char)label[k]) * 16777619u;
+    }
+    key.push_back(startTime_s);
+    key.push_back(endTime_s);
+    key.push_back(hash);
+  }
+
+  // The selected phone is highlighted.
+  if (words == false)
+  {
+    key.push_back(data->selectedSegmentIndex);
+  }
+}
+
+
 // ****************************************************************************
 /// Paint the oscillogram of the signal s in the given part of the device
 /// context.
@@ -1678,6 +1962,8 @@ void SignalComparisonPicture::OnSwapTracks(wxCommandEvent &event)
     s1->x[i] = s2->x[i];
     s2->x[i] = temp;
   }
+  data->trackChanged(Data::MAIN_TRACK);
+  data->trackChanged(Data::EXTRA_TRACK);
 
   // ****************************************************************
   // Exchange signals for F0...F3.
@@ -1689,6 +1975,8 @@ void SignalComparisonPicture::OnSwapTracks(wxCommandEvent &event)
   data->f0Signal[Data::MAIN_TRACK] = data->f0Signal[Data::EXTRA_TRACK];
   data->f0Signal[Data::EXTRA_TRACK] = dummy;
 
+  swap(data->formantTracker[Data::MAIN_TRACK], data->formantTracker[Data::EXTRA_TRACK]);
+
   this->Refresh();
 }
 
@@ -1729,7 +2017,7 @@ void SignalComparisonPicture::OnSetSelectionEnd(wxCommandEvent &event)
 void SignalComparisonPicture::OnSelectAll(wxCommandEvent &event)
 {
   data->selectionMark_pt[0] = 0;
-  data->selectionMark_pt[1] = Data::TRACK_DURATION_S*SAMPLING_RATE - 1;
+  data->selectionMark_pt[1] = data->getTrackLength() - 1;
   this->Refresh();
 }
 
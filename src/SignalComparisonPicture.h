@@ -56,6 +56,7 @@ public:
   int getWindowHeight();
   void setVertOffset(double offset_percent);
   double getVertOffset_percent();
+  void invalidateRows();
 
   // **************************************************************************
   // Private data.
@@ -81,6 +82,10 @@ private:
   wxWindow *updateParent;
   int rowY[NUM_ROWS];
   int rowH[NUM_ROWS];
+  /// Cached content of the rows without marks and selection
+  wxBitmap *rowBitmap[NUM_ROWS];
+  /// The data that the cached content of the rows was painted for
+  vector<double> rowKey[NUM_ROWS];
   double verticalOffset_percent;
   int playButtonX[NUM_PLAY_BUTTONS];
   int playButtonY[NUM_PLAY_BUTTONS];
@@ -98,6 +103,15 @@ private:
 
 private:
   void paintSignals(wxDC &dc);
+  void paintRow(wxDC &dc, int row, int areaX, int areaY, int areaWidth, int areaHeight,
+    double startTime_s, double duration_s, int firstSample, int numSamples);
+  void paintRowContent(wxDC &dc, int row, int areaWidth, int areaHeight, 
+    double startTime_s, double duration_s, int firstSample, int numSamples);
+  void getRowKey(int row, int areaWidth, int areaHeight, double startTime_s, double duration_s,
+    vector<double> &key);
+  void addSignalKey(vector<double> &key, int trackIndex);
+  void addCurveKey(vector<double> &key, const vector<double> &curve);
+  void addSegmentationKey(vector<double> &key, bool words);
   void paintOscillogram(wxDC &dc, int areaX, int areaY, int areaWidth, int areaHeight, 
     Signal16 *s, int firstSample, int numSamples);
   void paintPhoneSegmentation(wxDC &dc, int areaX, int areaY, int areaWidth, int areaHeight, 
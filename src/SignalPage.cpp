@@ -101,8 +101,12 @@ SignalPage::SignalPage(wxWindow *parent) : wxPanel(parent)
 
 void SignalPage::updateWidgets()
 {
-  // Update the scroll bar
+  // Update the scroll bar (the tracks may have grown)
   
+  if (scrTime->GetRange() != data->getTrackLength())
+  {
+    scrTime->SetScrollbar(data->centerPos_pt, 500, data->getTrackLength(), 499);
+  }
   scrTime->SetThumbPosition(data->centerPos_pt);
 
   // Update the labels
@@ -152,7 +156,7 @@ void SignalPage::scrollLeft()
 void SignalPage::scrollRight()
 {
   data->centerPos_pt+= 200;
-  const int N = Data::TRACK_DURATION_S*SAMPLING_RATE;
+  const int N = data->getTrackLength();
 
   if (data->centerPos_pt >= N) 
   { 
@@ -325,7 +329,7 @@ void SignalPage::initWidgets()
 
   picSignal = new SignalPicture(topPanel, this);
   scrTime = new wxScrollBar(topPanel, IDS_SCROLL_BAR);
-  scrTime->SetScrollbar(0, 500, Data::TRACK_DURATION_S * SAMPLING_RATE, 499);
+  scrTime->SetScrollbar(0, 500, data->getTrackLength(), 499);
 
   subSizer = new wxBoxSizer(wxVERTICAL);
   subSizer->Add(picSignal, 1, wxGROW);
@@ -551,6 +555,8 @@ void SignalPage::OnExchangeMainEggClicked(wxCommandEvent &event)
     s1->x[i] = s2->x[i];
     s2->x[i] = temp;
   }
+  data->trackChanged(Data::MAIN_TRACK);
+  data->trackChanged(Data::EGG_TRACK);
 
   // ****************************************************************
   // Exchange signals for F0...F3.
@@ -562,6 +568,8 @@ void SignalPage::OnExchangeMainEggClicked(wxCommandEvent &event)
   data->f0Signal[Data::MAIN_TRACK] = data->f0Signal[Data::EGG_TRACK];
   data->f0Signal[Data::EGG_TRACK] = dummy;
 
+  swap(data->formantTracker[Data::MAIN_TRACK], data->formantTracker[Data::EGG_TRACK]);
+
   updateWidgets();
 }
 
@@ -584,6 +592,8 @@ void SignalPage::OnExchangeMainExtraClicked(wxCommandEvent &event)
     s1->x[i] = s2->x[i];
     s2->x[i] = temp;
   }
+  data->trackChanged(Data::MAIN_TRACK);
+  data->trackChanged(Data::EXTRA_TRACK);
 
   // ****************************************************************
   // Exchange signals for F0...F3.
@@ -595,6 +605,8 @@ void SignalPage::OnExchangeMainExtraClicked(wxCommandEvent &event)
   data->f0Signal[Data::MAIN_TRACK] = data->f0Signal[Data::EXTRA_TRACK];
   data->f0Signal[Data::EXTRA_TRACK] = dummy;
 
+  swap(data->formantTracker[Data::MAIN_TRACK], data->formantTracker[Data::EXTRA_TRACK]);
+
   updateWidgets();
 }
 
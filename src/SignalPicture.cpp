@@ -276,7 +276,10 @@ void SignalPicture::paintUpperOscillogram(wxDC &dc, int w, int h)
   for (x=zeroX; x < w; x++)
   {
     sampleIndex = startPos + x*data->oscillogramVisTimeRange_pt / w;
-    sampleIndex = modulo(sampleIndex, data->track[data->MAIN_TRACK]->N);
+    if (sampleIndex >= data->track[Data::MAIN_TRACK]->N)
+    {
+      break;
+    }
 
     // Paint the lines
 
@@ -483,7 +486,10 @@ void SignalPicture::paintLowerOscillogram(wxDC &dc, int yOffset, int w, int h)
   for (i=0; i < numSamples; i++)
   {
     sampleIndex = startPos + i;
-    sampleIndex = modulo(sampleIndex, data->track[Data::MAIN_TRACK]->N);
+    if ((sampleIndex < 0) || (sampleIndex >= data->track[Data::MAIN_TRACK]->N))
+    {
+      continue;
+    }
 
     x = i*w / numSamples;
 
@@ -783,7 +789,7 @@ void SignalPicture::OnSetSelectionEnd(wxCommandEvent &event)
 void SignalPicture::OnSelectAll(wxCommandEvent &event)
 {
   data->selectionMark_pt[0] = 0;
-  data->selectionMark_pt[1] = Data::TRACK_DURATION_S*SAMPLING_RATE - 1;
+  data->selectionMark_pt[1] = data->getTrackLength() - 1;
   this->Refresh();
 }
 
@@ -57,6 +57,7 @@ void SpectrogramPicture::draw(wxDC &dc)
 
 void SpectrogramPicture::paintSpectrogram(wxDC &dc)
 {
+  int i;
   int windowWidth, windowHeight;
   this->GetSize(&windowWidth, &windowHeight);
 
@@ -115,6 +116,21 @@ void SpectrogramPicture::paintSpectrogram(wxDC &dc)
       0.0, 600.0, wxColor(255, 128, 0), false);
   }
 
+  // ****************************************************************
+  // Plot the formant tracks.
+  // ****************************************************************
+
+  if (data->showFormants)
+  {
+    for (i=0; i < FormantTracker::NUM_FORMANTS; i++)
+    {
+      spectrogramPlot->drawCurve(dc, 0, 0, windowWidth, windowHeight,
+        data->formantTracker[data->selectedSpectrogram].formant_Hz[i], 
+        data->formantTracker[data->selectedSpectrogram].timeStep_s, startTime_s, duration_s,
+        0.0, viewRange_Hz, wxColor(255, 0, 255), false, true);
+    }
+  }
+
   // ****************************************************************
   // Plot the F0 contour.
   // ****************************************************************
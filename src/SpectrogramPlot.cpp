@@ -252,13 +252,14 @@ void SpectrogramPlot::getGaussWindow(Signal &window, int windowLength_pt)
 /// The curve is specified by its sample points (samples) and the time step.
 /// The temporal interval of the curve to be drawn is given by startTime_s
 /// and duration_s. minValue and maxValue are the values at the bottem and
-/// the top of the paint area.
+/// the top of the paint area. Samples with the value 0 are drawn at the
+/// bottom, or, with gapsAtZero, they interrupt the curve.
 // ****************************************************************************
 
 void SpectrogramPlot::drawCurve(
   wxDC &dc, int areaX, int areaY, int areaWidth, int areaHeight, 
   vector<double> &samples, double timeStep_s, double startTime_s, double duration_s,
-  double minValue, double maxValue, wxColor color, bool dashed)
+  double minValue, double maxValue, wxColor color, bool dashed, bool gapsAtZero)
 {
   const double EPSILON = 0.000000001;
   double valueDiff = maxValue - minValue;
@@ -288,9 +289,23 @@ void SpectrogramPlot::drawCurve(
     return;
   }
 
+  // ****************************************************************
+  // Set the pen.
+  // ****************************************************************
+
+  if (dashed)
+  {
+    dc.SetPen(wxPen(color, dc.LogicalToDeviceXRel(1), wxPENSTYLE_DOT_DASH));
+  }
+  else
+  {
+    dc.SetPen( wxPen(color, dc.LogicalToDeviceXRel(1)) );
+  }
 
   // ****************************************************************
   // Create the list of corner points: one point for every pixel column.
+  // With gapsAtZero, the points so far are drawn and the list starts
+  // anew at each 0 value.
   // ****************************************************************
 
   for (i=0; i < areaWidth; i++)
@@ -305,6 +320,15 @@ void SpectrogramPlot::drawCurve(
 
       if ((s0 == 0.0) || (s1 == 0.0))
       {
+        if (gapsAtZero)
+        {
+          if (numPoints > 1)
+          {
+            dc.DrawLines(numPoints, points);
+          }
+          numPoints = 0;
+          continue;
+        }
         value = 0.0;
       }
       else
@@ -331,18 +355,9 @@ void SpectrogramPlot::drawCurve(
   }
 
   // ****************************************************************
-  // Set the pen and draw the lines.
+  // Draw the (remaining) lines.
   // ****************************************************************
 
-  if (dashed)
-  {
-    dc.SetPen(wxPen(color, dc.LogicalToDeviceXRel(1), wxPENSTYLE_DOT_DASH));
-  }
-  else
-  {
-    dc.SetPen( wxPen(color, dc.LogicalToDeviceXRel(1)) );
-  }
-
   if (numPoints > 1)
   {
     dc.DrawLines(numPoints, points);
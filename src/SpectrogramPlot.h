@@ -60,7 +60,8 @@ public:
   void drawCurve(
     wxDC &dc, int areaX, int areaY, int areaWidth, int areaHeight, 
     vector<double> &samples, double timeStep_s, double startTime_s, double duration_s,
-    double minValue, double maxValue, wxColor color, bool dashed = false);
+    double minValue, double maxValue, wxColor color, bool dashed = false, 
+    bool gapsAtZero = false);
 
 };
 
@@ -200,16 +200,16 @@ void SpectrumPicture::draw(wxDC &dc)
     {
       if (modelSpectrumType == SPECTRUM_NOSE_UU)
       {
-        tlModel->getSpectrum(TlModel::FLOW_SOURCE_TF, data->primarySpectrum, SPECTRUM_LENGTH, Tube::FIRST_NOSE_SECTION);
+        data->getTlModelSpectrum(TlModel::FLOW_SOURCE_TF, data->primarySpectrum, SPECTRUM_LENGTH, Tube::FIRST_NOSE_SECTION);
       }
       else
       {
-        tlModel->getSpectrum(TlModel::FLOW_SOURCE_TF, data->primarySpectrum, SPECTRUM_LENGTH, Tube::FIRST_PHARYNX_SECTION);
+        data->getTlModelSpectrum(TlModel::FLOW_SOURCE_TF, data->primarySpectrum, SPECTRUM_LENGTH, Tube::FIRST_PHARYNX_SECTION);
       }
 
       if (modelSpectrumType == SPECTRUM_PU) 
       { 
-        tlModel->getSpectrum(TlModel::RADIATION, &radiationSpectrum, SPECTRUM_LENGTH, 0);
+        data->getTlModelSpectrum(TlModel::RADIATION, &radiationSpectrum, SPECTRUM_LENGTH, 0);
         (*data->primarySpectrum)*= radiationSpectrum;
         (*data->primarySpectrum)*= 10.0;
       }
@@ -280,7 +280,7 @@ void SpectrumPicture::draw(wxDC &dc)
 
     if (modelSpectrumType == SPECTRUM_INPUT_IMPEDANCE) 
     { 
-      tlModel->getSpectrum(TlModel::INPUT_IMPEDANCE, data->primarySpectrum, SPECTRUM_LENGTH, 
+      data->getTlModelSpectrum(TlModel::INPUT_IMPEDANCE, data->primarySpectrum, SPECTRUM_LENGTH, 
         Tube::FIRST_PHARYNX_SECTION);
        
       (*data->primarySpectrum)*= 0.1;
@@ -294,7 +294,7 @@ void SpectrumPicture::draw(wxDC &dc)
     
     if (modelSpectrumType == SPECTRUM_SUBGLOTTAL_INPUT_IMPEDANCE) 
     { 
-      tlModel->getSpectrum(TlModel::OUTPUT_IMPEDANCE, data->primarySpectrum, SPECTRUM_LENGTH, 
+      data->getTlModelSpectrum(TlModel::OUTPUT_IMPEDANCE, data->primarySpectrum, SPECTRUM_LENGTH, 
         Tube::LOWER_GLOTTIS_SECTION-1);
 
       (*data->primarySpectrum)*= 0.1;
@@ -315,7 +315,7 @@ void SpectrumPicture::draw(wxDC &dc)
       data->primarySpectrum->reset(pulseLength);
       realDFT(pulseForm, *data->primarySpectrum, pulseLength, true);
 
-      tlModel->getSpectrum(TlModel::RADIATION, &radiationSpectrum, pulseLength, 0);
+      data->getTlModelSpectrum(TlModel::RADIATION, &radiationSpectrum, pulseLength, 0);
       (*data->primarySpectrum)*= radiationSpectrum; 
       (*data->primarySpectrum)*= 500.0;
 
@@ -339,8 +339,8 @@ void SpectrumPicture::draw(wxDC &dc)
       realDFT(pulseForm, pulseSpectrum, pulseLength, true);
 
       // Multiply with the transfer function
-      tlModel->getSpectrum(TlModel::FLOW_SOURCE_TF, data->primarySpectrum, pulseLength, Tube::FIRST_PHARYNX_SECTION);
-      tlModel->getSpectrum(TlModel::RADIATION, &radiationSpectrum, pulseLength, 0);
+      data->getTlModelSpectrum(TlModel::FLOW_SOURCE_TF, data->primarySpectrum, pulseLength, Tube::FIRST_PHARYNX_SECTION);
+      data->getTlModelSpectrum(TlModel::RADIATION, &radiationSpectrum, pulseLength, 0);
 
       (*data->primarySpectrum)*= radiationSpectrum; 
       (*data->primarySpectrum)*= pulseSpectrum; 
@@ -385,7 +385,7 @@ void SpectrumPicture::draw(wxDC &dc)
 
       PoleZeroPlan *plan = data->poleZeroPlan;
 
-      plan->getPoleZeroSpectrum(data->primarySpectrum, pulseLength, upperFrequencyLimit);
+      data->getPoleZeroSpectrum(data->primarySpectrum, pulseLength, upperFrequencyLimit);
 
       if (plan->higherPoleCorrection)
       {
@@ -395,11 +395,11 @@ void SpectrumPicture::draw(wxDC &dc)
 
         effectiveLength += 0.8*sqrt(mouthArea / M_PI);
 
-        plan->getHigherPoleCorrection(&hpc, pulseLength, effectiveLength);
+        data->getHigherPoleCorrection(&hpc, pulseLength, effectiveLength);
         *data->primarySpectrum *= hpc;
       }
 
-      tlModel->getSpectrum(TlModel::RADIATION, &radiationSpectrum, pulseLength, 0);
+      data->getTlModelSpectrum(TlModel::RADIATION, &radiationSpectrum, pulseLength, 0);
 
       (*data->primarySpectrum) *= radiationSpectrum;
       (*data->primarySpectrum) *= pulseSpectrum;
@@ -438,7 +438,7 @@ void SpectrumPicture::draw(wxDC &dc)
     ComplexSignal poleZeroSpectrum(SPECTRUM_LENGTH);
     PoleZeroPlan *plan = data->poleZeroPlan;
 
-    plan->getPoleZeroSpectrum(&poleZeroSpectrum, SPECTRUM_LENGTH, upperFrequencyLimit);
+    data->getPoleZeroSpectrum(&poleZeroSpectrum, SPECTRUM_LENGTH, upperFrequencyLimit);
     
     if (plan->higherPoleCorrection)
     {
@@ -448,14 +448,13 @@ void SpectrumPicture::draw(wxDC &dc)
 
       effectiveLength+= 0.8*sqrt(mouthArea/M_PI);
 
-      plan->getHigherPoleCorrection(&hpc, SPECTRUM_LENGTH, effectiveLength);
+      data->getHigherPoleCorrection(&hpc, SPECTRUM_LENGTH, effectiveLength);
       poleZeroSpectrum*= hpc;
     }
 
     if (modelSpectrumType == SPECTRUM_PU) 
     { 
-      TlModel *tlModel = data->tlModel;
-      tlModel->getSpectrum(TlModel::RADIATION, &radiationSpectrum, SPECTRUM_LENGTH, 0);
+      data->getTlModelSpectrum(TlModel::RADIATION, &radiationSpectrum, SPECTRUM_LENGTH, 0);
       poleZeroSpectrum*= radiationSpectrum; 
       poleZeroSpectrum*= 10.0;
     }
@@ -0,0 +1,563 @@
+// ****************************************************************************
+// This file is part of VocalTractLab.
+// Copyright (C) 2020, Peter Birkholz, Dresden, Germany
+// www.vocaltractlab.de
+// author: Peter Birkholz
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//
+// ****************************************************************************
+
+
+#include "SynthesisContext.h"
+#include "SynthesisContextApi.h"
+#include "VocalTractLabBackend/GeometricGlottis.h"
+#include "VocalTractLabBackend/TwoMassModel.h"
+#include "VocalTractLabBackend/TriangularGlottis.h"
+#include "VocalTractLabBackend/Synthesizer.h"
+
+#include <cstdio>
+#include <cmath>
+
+// ****************************************************************************
+/// Constructor. The speaker models are created by loadSpeaker(...) or 
+/// setModels(...).
+// ****************************************************************************
+
+SynthesisContext::SynthesisContext()
+{
+  int i;
+
+  vocalTract = NULL;
+  for (i=0; i < NUM_GLOTTIS_MODELS; i++)
+  {
+    glottis[i] = NULL;
+  }
+  selectedGlottis = TRIANGULAR_GLOTTIS;
+  gesturalScore = NULL;
+  tdsModel = new TdsModel();
+  tlModel = new TlModel();
+  f0Estimator = NULL;
+  voiceQualityEstimator = NULL;
+}
+
+
+// ****************************************************************************
+/// Destructor.
+// ****************************************************************************
+
+SynthesisContext::~SynthesisContext()
+{
+  deleteSpeaker();
+  delete tdsModel;
+  delete tlModel;
+  delete f0Estimator;
+  delete voiceQualityEstimator;
+}
+
+
+// ****************************************************************************
+/// Loads the vocal tract and the glottis models from the given speaker file.
+// ****************************************************************************
+
+bool SynthesisContext::loadSpeaker(const string &fileName)
+{
+  int i;
+  Glottis *newGlottis[NUM_GLOTTIS_MODELS];
+  int newSelectedGlottis = GEOMETRIC_GLOTTIS;
+  VocalTract *newTract = NULL;
+
+  for (i=0; i < NUM_GLOTTIS_MODELS; i++)
+  {
+    newGlottis[i] = createGlottis(i);
+  }
+
+  vector<XmlError> xmlErrors;
+  XmlNode *rootNode = xmlParseFile(fileName, "speaker", &xmlErrors);
+  bool ok = (rootNode != NULL);
+
+  if (ok == false)
+  {
+    xmlPrintErrors(xmlErrors);
+  }
+  else
+  {
+    ok = readGlottisModels(rootNode, newGlottis, newSelectedGlottis, fileName);
+    delete rootNode;
+  }
+
+  if (ok)
+  {
+    newTract = new VocalTract();
+    try
+    {
+      newTract->readFromXml(fileName);
+      newTract->calculateAll();
+    }
+    catch (std::string st)
+    {
+      printf("%s\n", st.c_str());
+      printf("Error reading the anatomy data from %s.\n", fileName.c_str());
+      ok = false;
+    }
+  }
+
+  if (ok == false)
+  {
+    delete newTract;
+    for (i=0; i < NUM_GLOTTIS_MODELS; i++)
+    {
+      delete newGlottis[i];
+    }
+    return false;
+  }
+
+  setModels(newTract, newGlottis, newSelectedGlottis);
+  return true;
+}
+
+
+// ****************************************************************************
+/// Replaces the speaker models of this context by the given ones. The context
+/// takes the ownership of the models.
+// ****************************************************************************
+
+void SynthesisContext::setModels(VocalTract *tract, Glottis *glottisModels[], int selectedGlottis)
+{
+  int i;
+
+  deleteSpeaker();
+
+  vocalTract = tract;
+  for (i=0; i < NUM_GLOTTIS_MODELS; i++)
+  {
+    glottis[i] = glottisModels[i];
+  }
+  gesturalScore = new GesturalScore(vocalTract, glottis[TRIANGULAR_GLOTTIS]);
+  selectGlottis(selectedGlottis);
+}
+
+
+// ****************************************************************************
+/// Returns true, if the speaker models of this context were created.
+// ****************************************************************************
+
+bool SynthesisContext::isReady()
+{
+  return (vocalTract != NULL) && (gesturalScore != NULL);
+}
+
+
+// ****************************************************************************
+/// Returns the selected glottis model.
+// ****************************************************************************
+
+Glottis *SynthesisContext::getSelectedGlottis()
+{
+  return glottis[selectedGlottis];
+}
+
+
+// ****************************************************************************
+/// Returns the index of the selected glottis model.
+// ****************************************************************************
+
+int SynthesisContext::getSelectedGlottisIndex()
+{
+  return selectedGlottis;
+}
+
+
+// ****************************************************************************
+/// Selects the glottis model, also for the gestural score.
+// ****************************************************************************
+
+void SynthesisContext::selectGlottis(int index)
+{
+  if (index < 0)
+  {
+    index = 0;
+  }
+  if (index >= NUM_GLOTTIS_MODELS)
+  {
+    index = NUM_GLOTTIS_MODELS - 1;
+  }
+
+  selectedGlottis = index;
+  if (gesturalScore != NULL)
+  {
+    gesturalScore->glottis = glottis[index];
+  }
+}
+
+
+// ****************************************************************************
+/// Synthesizes the gestural score, tube sequence or tract sequence in the 
+/// given file into the audio signal of this context.
+// ****************************************************************************
+
+bool SynthesisContext::synthesize(InputType inputType, const string &fileName)
+{
+  bool allValuesInRange = true;
+
+  audio.clear();
+  if (isReady() == false)
+  {
+    return false;
+  }
+
+  switch (inputType)
+  {
+  case INPUT_GESTURAL_SCORE:
+    if (gesturalScore->loadGesturesXml(fileName, allValuesInRange) == false)
+    {
+      return false;
+    }
+    Synthesizer::synthesizeGesturalScore(gesturalScore, tdsModel, audio);
+    return true;
+
+  case INPUT_TUBE_SEQUENCE:
+    return Synthesizer::synthesizeTubeSequence(fileName, getSelectedGlottis(), tdsModel, audio);
+
+  case INPUT_TRACT_SEQUENCE:
+    return Synthesizer::synthesizeTractSequence(fileName, getSelectedGlottis(), vocalTract, 
+      tdsModel, audio);
+
+  default:
+    return false;
+  }
+}
+
+
+// ****************************************************************************
+/// Calculates the volume velocity transfer function of the vocal tract with 
+/// the current parameter values.
+// ****************************************************************************
+
+bool SynthesisContext::getTransferFunction(ComplexSignal *spectrum, int spectrumLength)
+{
+  if ((isReady() == false) || (spectrum == NULL) || (spectrumLength < 1))
+  {
+    return false;
+  }
+
+  vocalTract->calculateAll();
+  vocalTract->getTube(&tlModel->tube);
+  tlModel->tube.setGlottisArea(0.0);
+  tlModel->getSpectrum(TlModel::FLOW_SOURCE_TF, spectrum, spectrumLength, Tube::FIRST_PHARYNX_SECTION);
+
+  return true;
+}
+
+
+// ****************************************************************************
+/// Estimates the F0 contour of the last synthesized audio signal.
+// ****************************************************************************
+
+bool SynthesisContext::estimateF0(vector<double> &f0Signal, double &timeStep_s)
+{
+  int numSamples = (int)audio.size();
+
+  if (numSamples < 1)
+  {
+    return false;
+  }
+
+  if (f0Estimator == NULL)
+  {
+    f0Estimator = new F0EstimatorYin();
+  }
+
+  Signal16 signal(numSamples);
+  Synthesizer::copySignal(audio, signal, 0);
+
+  f0Estimator->init(&signal, 0, numSamples);
+  f0Estimator->processChunk(numSamples);
+  f0Signal = f0Estimator->finish();
+  timeStep_s = f0Estimator->timeStep_s;
+
+  return true;
+}
+
+
+// ****************************************************************************
+/// Estimates the voice quality contour of the last synthesized audio signal.
+// ****************************************************************************
+
+bool SynthesisContext::estimateVoiceQuality(vector<double> &voiceQualitySignal, double &timeStep_s)
+{
+  int numSamples = (int)audio.size();
+
+  if (numSamples < 1)
+  {
+    return false;
+  }
+
+  if (voiceQualityEstimator == NULL)
+  {
+    voiceQualityEstimator = new VoiceQualityEstimator();
+  }
+
+  Signal16 signal(numSamples);
+  Synthesizer::copySignal(audio, signal, 0);
+
+  voiceQualityEstimator->init(&signal, 0, numSamples);
+  voiceQualityEstimator->processChunk(numSamples);
+  voiceQualitySignal = voiceQualityEstimator->finish();
+  timeStep_s = voiceQualityEstimator->timeStep_s;
+
+  return true;
+}
+
+
+// ****************************************************************************
+/// Returns a new glottis model of the given type (GlottisModel), or NULL.
+// ****************************************************************************
+
+Glottis *SynthesisContext::createGlottis(int index)
+{
+  switch (index)
+  {
+  case GEOMETRIC_GLOTTIS: return new GeometricGlottis();
+  case TWO_MASS_MODEL: return new TwoMassModel();
+  case TRIANGULAR_GLOTTIS: return new TriangularGlottis();
+  default: return NULL;
+  }
+}
+
+
+// ****************************************************************************
+/// Reads the data of the glottis models from the root node of a speaker file
+/// into the given models (one for each GlottisModel) and sets the index of
+/// the selected model. A speaker file without glottis data is accepted with
+/// a warning.
+// ****************************************************************************
+
+bool SynthesisContext::readGlottisModels(XmlNode *rootNode, Glottis *glottisModels[], 
+  int &selectedGlottis, const string &fileName)
+{
+  int i;
+  XmlNode *glottisNode;
+
+  // This may be overwritten later.
+  selectedGlottis = GEOMETRIC_GLOTTIS;
+
+  XmlNode *glottisModelsNode = rootNode->getChildElement("glottis_models");
+  if (glottisModelsNode == NULL)
+  {
+    printf("Warning: No glottis model data found in the speaker file %s!\n", fileName.c_str());
+    return true;
+  }
+
+  for (i = 0; (i < (int)glottisModelsNode->childElement.size()) && (i < NUM_GLOTTIS_MODELS); i++)
+  {
+    glottisNode = glottisModelsNode->childElement[i];
+    if (glottisNode->getAttributeString("type") == glottisModels[i]->getName())
+    {
+      if (glottisNode->getAttributeInt("selected") == 1)
+      {
+        selectedGlottis = i;
+      }
+      if (glottisModels[i]->readFromXml(*glottisNode) == false)
+      {
+        printf("Error: Failed to read glottis data for glottis model %d!\n", i);
+        return false;
+      }
+    }
+    else
+    {
+      printf("Error: The type of the glottis model %d in the speaker file is '%s' "
+        "but should be '%s'!\n", i,
+        glottisNode->getAttributeString("type").c_str(),
+        glottisModels[i]->getName().c_str());
+      return false;
+    }
+  }
+
+  return true;
+}
+
+
+// ****************************************************************************
+/// Deletes the speaker models.
+// ****************************************************************************
+
+void SynthesisContext::deleteSpeaker()
+{
+  int i;
+
+  delete gesturalScore;
+  gesturalScore = NULL;
+  delete vocalTract;
+  vocalTract = NULL;
+  for (i=0; i < NUM_GLOTTIS_MODELS; i++)
+  {
+    delete glottis[i];
+    glottis[i] = NULL;
+  }
+}
+
+
+// ****************************************************************************
+// ****************************************************************************
+// C interface (see SynthesisContextApi.h).
+// ****************************************************************************
+// ****************************************************************************
+
+struct VtlContext
+{
+  SynthesisContext context;
+};
+
+
+// ****************************************************************************
+
+VtlContext *vtlContextCreate(const char *speakerFileName)
+{
+  if (speakerFileName == NULL)
+  {
+    return NULL;
+  }
+
+  VtlContext *handle = new VtlContext();
+  if (handle->context.loadSpeaker(speakerFileName) == false)
+  {
+    delete handle;
+    return NULL;
+  }
+  return handle;
+}
+
+
+// ****************************************************************************
+
+void vtlContextDestroy(VtlContext *context)
+{
+  delete context;
+}
+
+
+// ****************************************************************************
+
+int vtlContextSynthesize(VtlContext *context, int inputType, const char *fileName)
+{
+  if ((context == NULL) || (fileName == NULL) || (inputType < 0) ||
+    (inputType >= SynthesisContext::NUM_INPUT_TYPES))
+  {
+    return 1;
+  }
+
+  if (context->context.synthesize((SynthesisContext::InputType)inputType, fileName) == false)
+  {
+    return 2;
+  }
+  return 0;
+}
+
+
+// ****************************************************************************
+
+int vtlContextGetNumSamples(VtlContext *context)
+{
+  if (context == NULL)
+  {
+    return -1;
+  }
+  return (int)context->context.audio.size();
+}
+
+
+// ****************************************************************************
+
+int vtlContextGetAudio(VtlContext *context, double *audio, int maxSamples)
+{
+  int i;
+
+  if ((context == NULL) || (audio == NULL) || (maxSamples < 0))
+  {
+    return 1;
+  }
+
+  vector<double> &signal = context->context.audio;
+  for (i=0; (i < maxSamples) && (i < (int)signal.size()); i++)
+  {
+    audio[i] = signal[i];
+  }
+  return 0;
+}
+
+
+// ****************************************************************************
+
+int vtlContextSetTractParams(VtlContext *context, const double *params, int numParams)
+{
+  int i;
+
+  if ((context == NULL) || (params == NULL) || (numParams != VocalTract::NUM_PARAMS) ||
+    (context->context.isReady() == false))
+  {
+    return 1;
+  }
+
+  VocalTract *tract = context->context.vocalTract;
+  for (i=0; i < VocalTract::NUM_PARAMS; i++)
+  {
+    tract->param[i].x = params[i];
+  }
+  tract->calculateAll();
+  return 0;
+}
+
+
+// ****************************************************************************
+
+int vtlContextGetTransferFunction(VtlContext *context, int spectrumLength, 
+  double *magnitude, double *phase_rad)
+{
+  int i;
+
+  if ((context == NULL) || (magnitude == NULL) || (phase_rad == NULL) || (spectrumLength < 1))
+  {
+    return 1;
+  }
+
+  ComplexSignal spectrum(spectrumLength);
+  if (context->context.getTransferFunction(&spectrum, spectrumLength) == false)
+  {
+    return 2;
+  }
+
+  for (i=0; i < spectrumLength; i++)
+  {
+    magnitude[i] = spectrum.getMagnitude(i);
+    phase_rad[i] = atan2(spectrum.im[i], spectrum.re[i]);
+  }
+  return 0;
+}
+
+
+// ****************************************************************************
+
+int vtlContextSelectGlottis(VtlContext *context, int glottisModel)
+{
+  if ((context == NULL) || (glottisModel < 0) || 
+    (glottisModel >= SynthesisContext::NUM_GLOTTIS_MODELS))
+  {
+    return 1;
+  }
+  context->context.selectGlottis(glottisModel);
+  return 0;
+}
+
+// ****************************************************************************
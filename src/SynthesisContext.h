@@ -0,0 +1,125 @@
+// ****************************************************************************
+// This file is part of VocalTractLab.
+// Copyright (C) 2020, Peter Birkholz, Dresden, Germany
+// www.vocaltractlab.de
+// author: Peter Birkholz
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//
+// ****************************************************************************
+
+
+#ifndef __SYNTHESIS_CONTEXT_H__
+#define __SYNTHESIS_CONTEXT_H__
+
+#include <vector>
+#include <string>
+#include "VocalTractLabBackend/VocalTract.h"
+#include "VocalTractLabBackend/Glottis.h"
+#include "VocalTractLabBackend/TdsModel.h"
+#include "VocalTractLabBackend/TlModel.h"
+#include "VocalTractLabBackend/GesturalScore.h"
+#include "VocalTractLabBackend/F0EstimatorYin.h"
+#include "VocalTractLabBackend/VoiceQualityEstimator.h"
+#include "VocalTractLabBackend/XmlNode.h"
+
+using namespace std;
+
+// ****************************************************************************
+/// A self-contained set of models for synthesis and analysis. A context owns
+/// its speaker (vocal tract and glottis models), its TDS and TL models, its 
+/// gestural score and the last synthesized audio signal, and it does not use
+/// Data::getInstance(). Different contexts can therefore be used on different
+/// threads at the same time, but one context must only be used by one thread
+/// at a time. The C interface is declared in SynthesisContextApi.h.
+// ****************************************************************************
+
+class SynthesisContext
+{
+  // **************************************************************************
+  // Public data.
+  // **************************************************************************
+
+public:
+  // The same order as in Data::GlottisModel.
+  enum GlottisModel
+  {
+    GEOMETRIC_GLOTTIS,
+    TWO_MASS_MODEL,
+    TRIANGULAR_GLOTTIS,
+    NUM_GLOTTIS_MODELS
+  };
+
+  enum InputType
+  {
+    INPUT_GESTURAL_SCORE,
+    INPUT_TUBE_SEQUENCE,
+    INPUT_TRACT_SEQUENCE,
+    NUM_INPUT_TYPES
+  };
+
+  VocalTract *vocalTract;
+  Glottis *glottis[NUM_GLOTTIS_MODELS];
+  TdsModel *tdsModel;
+  TlModel *tlModel;
+  GesturalScore *gesturalScore;
+
+  /// The last synthesized audio signal
+  vector<double> audio;
+
+  // **************************************************************************
+  // Public functions.
+  // **************************************************************************
+
+public:
+  SynthesisContext();
+  ~SynthesisContext();
+
+  bool loadSpeaker(const string &fileName);
+  void setModels(VocalTract *tract, Glottis *glottisModels[], int selectedGlottis);
+  bool isReady();
+
+  Glottis *getSelectedGlottis();
+  int getSelectedGlottisIndex();
+  void selectGlottis(int index);
+
+  bool synthesize(InputType inputType, const string &fileName);
+  bool getTransferFunction(ComplexSignal *spectrum, int spectrumLength);
+  bool estimateF0(vector<double> &f0Signal, double &timeStep_s);
+  bool estimateVoiceQuality(vector<double> &voiceQualitySignal, double &timeStep_s);
+
+  static Glottis *createGlottis(int index);
+  static bool readGlottisModels(XmlNode *rootNode, Glottis *glottisModels[], 
+    int &selectedGlottis, const string &fileName);
+
+  // **************************************************************************
+  // Private data.
+  // **************************************************************************
+
+private:
+  int selectedGlottis;
+  F0EstimatorYin *f0Estimator;
+  VoiceQualityEstimator *voiceQualityEstimator;
+
+  // **************************************************************************
+  // Private functions.
+  // **************************************************************************
+
+private:
+  void deleteSpeaker();
+};
+
+#endif
+
+// ****************************************************************************
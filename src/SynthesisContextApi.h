@@ -0,0 +1,79 @@
+// ****************************************************************************
+// This file is part of VocalTractLab.
+// Copyright (C) 2020, Peter Birkholz, Dresden, Germany
+// www.vocaltractlab.de
+// author: Peter Birkholz
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//
+// ****************************************************************************
+
+
+#ifndef __SYNTHESIS_CONTEXT_API_H__
+#define __SYNTHESIS_CONTEXT_API_H__
+
+// ****************************************************************************
+/// C interface to SynthesisContext for embedding the synthesis into other
+/// programs. Each handle is independent of the others and of the GUI, so that
+/// several handles can be used on different threads at the same time (but 
+/// each handle by one thread at a time).
+/// Unless stated otherwise, the functions return 0 on success, 1 for an 
+/// invalid handle or invalid arguments, and 2 if the operation failed.
+/// The functions are exported from the shared library VocalTractLabContext.
+/// Programs that link against the DLL on Windows define VTL_CONTEXT_USE_DLL.
+// ****************************************************************************
+
+#if defined(WIN32) && defined(VTL_CONTEXT_BUILD_DLL)
+  #define VTL_CONTEXT_API __declspec(dllexport)
+#elif defined(WIN32) && defined(VTL_CONTEXT_USE_DLL)
+  #define VTL_CONTEXT_API __declspec(dllimport)
+#elif defined(__GNUC__)
+  #define VTL_CONTEXT_API __attribute__((visibility("default")))
+#else
+  #define VTL_CONTEXT_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// The input types of vtlContextSynthesize(...).
+#define VTL_CONTEXT_GESTURAL_SCORE  0
+#define VTL_CONTEXT_TUBE_SEQUENCE   1
+#define VTL_CONTEXT_TRACT_SEQUENCE  2
+
+typedef struct VtlContext VtlContext;
+
+/// Returns a new context with the given speaker, or NULL on failure.
+VTL_CONTEXT_API VtlContext *vtlContextCreate(const char *speakerFileName);
+VTL_CONTEXT_API void vtlContextDestroy(VtlContext *context);
+
+VTL_CONTEXT_API int vtlContextSynthesize(VtlContext *context, int inputType, const char *fileName);
+/// Returns the number of samples of the last synthesized signal, or -1.
+VTL_CONTEXT_API int vtlContextGetNumSamples(VtlContext *context);
+/// Copies at most maxSamples samples of the last synthesized signal.
+VTL_CONTEXT_API int vtlContextGetAudio(VtlContext *context, double *audio, int maxSamples);
+
+VTL_CONTEXT_API int vtlContextSetTractParams(VtlContext *context, const double *params, int numParams);
+VTL_CONTEXT_API int vtlContextGetTransferFunction(VtlContext *context, int spectrumLength, 
+  double *magnitude, double *phase_rad);
+VTL_CONTEXT_API int vtlContextSelectGlottis(VtlContext *context, int glottisModel);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+// ****************************************************************************
@@ -0,0 +1,961 @@
+// ****************************************************************************
+// This file is part of VocalTractLab.
+// Copyright (C) 2020, Peter Birkholz, Dresden, Germany
+// www.vocaltractlab.de
+// author: Peter Birkholz
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//
+// ****************************************************************************
+
+
+#include "SynthesisServer.h"
+#include "Data.h"
+#include "ParallelJob.h"
+
+#include <wx/filename.h>
+#include <algorithm>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+
+#ifndef WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <signal.h>
+#include <errno.h>
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+const char *SynthesisServer::INPUT_TYPE_NAME[SynthesisContext::NUM_INPUT_TYPES] =
+{
+  "ges",
+  "tube",
+  "tract"
+};
+
+const char *SynthesisServer::OUTPUT_FORMAT_NAME[SynthesisServer::NUM_OUTPUT_FORMATS] =
+{
+  "pcm",
+  "wav"
+};
+
+
+// ****************************************************************************
+/// A joinable thread that accepts the connections (workerIndex = -1) or 
+/// processes the queued connections with the given worker.
+// ****************************************************************************
+
+class SynthesisServerThread : public wxThread
+{
+public:
+  SynthesisServerThread(SynthesisServer *server, int workerIndex) : wxThread(wxTHREAD_JOINABLE)
+  {
+    this->server = server;
+    this->workerIndex = workerIndex;
+  }
+
+  virtual void *Entry()
+  {
+    if (workerIndex < 0)
+    {
+      server->acceptConnections();
+    }
+    else
+    {
+      server->processConnections(workerIndex);
+    }
+    return NULL;
+  }
+
+private:
+  SynthesisServer *server;
+  int workerIndex;
+};
+
+
+#ifndef WIN32
+
+// ****************************************************************************
+/// Reads exactly numBytes bytes from the socket.
+// ****************************************************************************
+
+static bool readBytes(int socket, char *buffer, int numBytes)
+{
+  int pos = 0;
+  ssize_t n;
+
+  while (pos < numBytes)
+  {
+    n = recv(socket, buffer + pos, numBytes - pos, 0);
+    if (n < 0)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      return false;
+    }
+    if (n == 0)
+    {
+      return false;
+    }
+    pos+= (int)n;
+  }
+  return true;
+}
+
+
+// ****************************************************************************
+/// Writes exactly numBytes bytes to the socket.
+// ****************************************************************************
+
+static bool writeBytes(int socket, const char *buffer, int numBytes)
+{
+  int pos = 0;
+  ssize_t n;
+
+  while (pos < numBytes)
+  {
+    n = send(socket, buffer + pos, numBytes - pos, MSG_NOSIGNAL);
+    if (n < 0)
+    {
+      if (errno == EINTR)
+      {
+        continue;
+      }
+      return false;
+    }
+    pos+= (int)n;
+  }
+  return true;
+}
+
+
+// ****************************************************************************
+/// Reads one line (without the terminating \n) with at most maxLength
+/// characters from the socket.
+// ****************************************************************************
+
+static bool readLine(int socket, string &line, int maxLength)
+{
+  char ch;
+
+  line.clear();
+  while ((int)line.size() < maxLength)
+  {
+    if (readBytes(socket, &ch, 1) == false)
+    {
+      return false;
+    }
+    if (ch == '\n')
+    {
+      return true;
+    }
+    line+= ch;
+  }
+  return false;
+}
+
+
+// ****************************************************************************
+/// Writes the string to the socket.
+// ****************************************************************************
+
+static bool writeString(int socket, const string &st)
+{
+  return writeBytes(socket, st.c_str(), (int)st.size());
+}
+
+
+// ****************************************************************************
+/// Connects to the server listening on the given socket path and returns the
+/// socket, or -1 on failure.
+// ****************************************************************************
+
+static int connectToServer(const string &socketPath)
+{
+  struct sockaddr_un address;
+  int s;
+
+  if (socketPath.size() >= sizeof(address.sun_path))
+  {
+    return -1;
+  }
+
+  s = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (s < 0)
+  {
+    return -1;
+  }
+
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  strcpy(address.sun_path, socketPath.c_str());
+
+  if (connect(s, (struct sockaddr*)&address, sizeof(address)) != 0)
+  {
+    close(s);
+    return -1;
+  }
+  return s;
+}
+
+
+// ****************************************************************************
+/// Removes a (stale) socket file at the given path. Nothing is removed when
+/// the path refers to anything else than a socket, e.g., a regular file or a
+/// symbolic link. Returns false in that case.
+// ****************************************************************************
+
+static bool removeSocketFile(const string &socketPath)
+{
+  struct stat info;
+
+  if (lstat(socketPath.c_str(), &info) != 0)
+  {
+    return (errno == ENOENT);
+  }
+  if (S_ISSOCK(info.st_mode) == false)
+  {
+    return false;
+  }
+  return (unlink(socketPath.c_str()) == 0);
+}
+
+#endif
+
+
+// ****************************************************************************
+/// Appends the value in little endian byte order to the data.
+// ****************************************************************************
+
+static void appendLittleEndian(vector<char> &data, unsigned int value, int numBytes)
+{
+  int i;
+  for (i=0; i < numBytes; i++)
+  {
+    data.push_back((char)((value >> (8*i)) & 0xFF));
+  }
+}
+
+
+// ****************************************************************************
+/// Appends the header of a WAV file with 16 bit mono samples at SAMPLING_RATE
+/// to the data.
+// ****************************************************************************
+
+static void appendWavHeader(vector<char> &data, int numSamples)
+{
+  unsigned int numDataBytes = (unsigned int)numSamples*2;
+
+  data.insert(data.end(), "RIFF", "RIFF" + 4);
+  appendLittleEndian(data, 36 + numDataBytes, 4);
+  data.insert(data.end(), "WAVE", "WAVE" + 4);
+  data.insert(data.end(), "fmt ", "fmt " + 4);
+  appendLittleEndian(data, 16, 4);                  // Size of the fmt chunk
+  appendLittleEndian(data, 1, 2);                   // PCM
+  appendLittleEndian(data, 1, 2);                   // Mono
+  appendLittleEndian(data, SAMPLING_RATE, 4);
+  appendLittleEndian(data, SAMPLING_RATE*2, 4);     // Bytes per second
+  appendLittleEndian(data, 2, 2);                   // Block align
+  appendLittleEndian(data, 16, 2);                  // Bits per sample
+  data.insert(data.end(), "data", "data" + 4);
+  appendLittleEndian(data, numDataBytes, 4);
+}
+
+
+// ****************************************************************************
+/// Appends the audio samples as 16 bit signed little endian values to the 
+/// data.
+// ****************************************************************************
+
+static void appendPcmSamples(vector<char> &data, const vector<double> &audio)
+{
+  int i;
+  int value;
+
+  data.reserve(data.size() + audio.size()*2);
+  for (i=0; i < (int)audio.size(); i++)
+  {
+    value = (int)(audio[i]*32767.0);
+    if (value > 32767)
+    {
+      value = 32767;
+    }
+    if (value < -32768)
+    {
+      value = -32768;
+    }
+    appendLittleEndian(data, (unsigned int)(value & 0xFFFF), 2);
+  }
+}
+
+
+// ****************************************************************************
+/// Constructor.
+// ****************************************************************************
+
+SynthesisServer::SynthesisServer() : queueCondition(queueMutex)
+{
+  listenSocket = -1;
+  acceptThread = NULL;
+  maxQueueLength = 0;
+  stopping = false;
+  numServedRequests = 0;
+  numRejectedRequests = 0;
+}
+
+
+// ****************************************************************************
+/// Destructor.
+// ****************************************************************************
+
+SynthesisServer::~SynthesisServer()
+{
+  stop();
+}
+
+
+// ****************************************************************************
+/// Creates the models of the workers from the current speaker and starts to 
+/// listen on the given socket path. An existing (stale) socket file at this 
+/// path is replaced. Returns false, if the server could not be started.
+// ****************************************************************************
+
+bool SynthesisServer::start(const wxString &socketPath, int numWorkers)
+{
+#ifdef WIN32
+  wxPrintf("Error: The synthesis server is not available on Windows.\n");
+  return false;
+#else
+  Data *data = Data::getInstance();
+  struct sockaddr_un address;
+  int i;
+
+  if (listenSocket != -1)
+  {
+    return false;
+  }
+
+  string path = socketPath.ToStdString();
+  if (path.size() >= sizeof(address.sun_path))
+  {
+    wxPrintf("Error: The socket path %s is too long.\n", socketPath.c_str());
+    return false;
+  }
+
+  if (numWorkers < 1)
+  {
+    numWorkers = 1;
+  }
+
+  // ****************************************************************
+  // Create the warm models of the workers once.
+  // ****************************************************************
+
+  wxStopWatch stopWatch;
+
+  for (i=0; i < numWorkers; i++)
+  {
+    Worker w;
+    w.context = data->createSynthesisContext();
+    if (w.context == NULL)
+    {
+      break;
+    }
+    w.thread = NULL;
+    w.activeSocket = -1;
+    worker.push_back(w);
+  }
+
+  if (worker.empty())
+  {
+    wxPrintf("Error: Failed to create the models for the synthesis server.\n");
+    return false;
+  }
+
+  // ****************************************************************
+  // Create the listening socket.
+  // ****************************************************************
+
+  // A client that closes the connection early must not kill the server.
+  signal(SIGPIPE, SIG_IGN);
+
+  listenSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listenSocket < 0)
+  {
+    wxPrintf("Error: Failed to create the socket for the synthesis server.\n");
+    listenSocket = -1;
+    stop();
+    return false;
+  }
+
+  if (removeSocketFile(path) == false)
+  {
+    wxPrintf("Error: %s exists and is not a socket.\n", socketPath.c_str());
+    close(listenSocket);
+    listenSocket = -1;
+    stop();
+    return false;
+  }
+
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  strcpy(address.sun_path, path.c_str());
+
+  maxQueueLength = MAX_QUEUE_LENGTH_PER_WORKER*(int)worker.size();
+
+  if ((bind(listenSocket, (struct sockaddr*)&address, sizeof(address)) != 0) ||
+    (listen(listenSocket, maxQueueLength) != 0))
+  {
+    wxPrintf("Error: Failed to listen on %s (%s).\n", socketPath.c_str(), strerror(errno));
+    close(listenSocket);
+    listenSocket = -1;
+    stop();
+    return false;
+  }
+
+  this->socketPath = socketPath;
+  stopping = false;
+
+  // ****************************************************************
+  // Start the worker threads and the thread accepting connections.
+  // ****************************************************************
+
+  for (i=0; i < (int)worker.size(); i++)
+  {
+    worker[i].thread = new SynthesisServerThread(this, i);
+    if (worker[i].thread->Run() != wxTHREAD_NO_ERROR)
+    {
+      delete worker[i].thread;
+      worker[i].thread = NULL;
+    }
+  }
+
+  acceptThread = new SynthesisServerThread(this, -1);
+  if (acceptThread->Run() != wxTHREAD_NO_ERROR)
+  {
+    delete acceptThread;
+    acceptThread = NULL;
+    stop();
+    wxPrintf("Error: Failed to start the synthesis server.\n");
+    return false;
+  }
+
+  wxPrintf("The synthesis server listens on %s with %d workers (max. %d queued requests). "
+    "The models were created in %d ms.\n", socketPath.c_str(), (int)worker.size(), 
+    maxQueueLength, (int)stopWatch.Time());
+
+  return true;
+#endif
+}
+
+
+// ****************************************************************************
+/// Stops the server, waits for the running requests to finish, closes the 
+/// queued connections and frees the models of the workers. Workers that are
+/// still waiting for the data of a client are woken up by shutting down the
+/// connection.
+// ****************************************************************************
+
+void SynthesisServer::stop()
+{
+#ifndef WIN32
+  int i;
+
+  {
+    wxMutexLocker locker(queueMutex);
+    stopping = true;
+    queueCondition.Broadcast();
+    for (i=0; i < (int)worker.size(); i++)
+    {
+      if (worker[i].activeSocket != -1)
+      {
+        shutdown(worker[i].activeSocket, SHUT_RDWR);
+      }
+    }
+  }
+
+  // Shutting the socket down wakes up the accept thread.
+  if (listenSocket != -1)
+  {
+    shutdown(listenSocket, SHUT_RDWR);
+  }
+
+  if (acceptThread != NULL)
+  {
+    acceptThread->Wait();
+    delete acceptThread;
+    acceptThread = NULL;
+  }
+
+  for (i=0; i < (int)worker.size(); i++)
+  {
+    if (worker[i].thread != NULL)
+    {
+      worker[i].thread->Wait();
+      delete worker[i].thread;
+    }
+    delete worker[i].context;
+  }
+  worker.clear();
+
+  for (i=0; i < (int)queue.size(); i++)
+  {
+    close(queue[i].socket);
+  }
+  queue.clear();
+
+  if (listenSocket != -1)
+  {
+    close(listenSocket);
+    listenSocket = -1;
+    removeSocketFile(socketPath.ToStdString());
+    wxPrintf("The synthesis server stopped after %d requests (%d rejected).\n",
+      numServedRequests, numRejectedRequests);
+  }
+#endif
+}
+
+
+// ****************************************************************************
+/// Accepts the connections and puts them into the queue for the workers, 
+/// or rejects them with BUSY when the queue is full. Reading from and 
+/// writing to a connection time out after SOCKET_TIMEOUT_S, so that a 
+/// client that stalls can't block a worker forever.
+// ****************************************************************************
+
+void SynthesisServer::acceptConnections()
+{
+#ifndef WIN32
+  Connection connection;
+  int queueLength;
+  struct timeval timeout;
+
+  timeout.tv_sec = SOCKET_TIMEOUT_S;
+  timeout.tv_usec = 0;
+
+  while (true)
+  {
+    connection.socket = accept(listenSocket, NULL, NULL);
+    if (connection.socket < 0)
+    {
+      if ((errno == EINTR) || (errno == ECONNABORTED))
+      {
+        continue;
+      }
+      break;
+    }
+    connection.acceptTime_ms = wxGetLocalTimeMillis();
+
+    setsockopt(connection.socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(connection.socket, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    wxMutexLocker locker(queueMutex);
+    if (stopping)
+    {
+      close(connection.socket);
+      break;
+    }
+
+    queueLength = (int)queue.size();
+    if (queueLength >= maxQueueLength)
+    {
+      numRejectedRequests++;
+      writeString(connection.socket, wxString::Format("BUSY queue=%d\n", queueLength).ToStdString());
+      close(connection.socket);
+    }
+    else
+    {
+      queue.push_back(connection);
+      queueCondition.Signal();
+    }
+  }
+#endif
+}
+
+
+// ****************************************************************************
+/// Waits for the next queued connection and marks it as the active 
+/// connection of the given worker. Returns false when the server stops.
+// ****************************************************************************
+
+bool SynthesisServer::takeConnection(int workerIndex, Connection &connection)
+{
+  wxMutexLocker locker(queueMutex);
+
+  while ((queue.empty()) && (stopping == false))
+  {
+    queueCondition.Wait();
+  }
+  if (stopping)
+  {
+    return false;
+  }
+
+  connection = queue.front();
+  queue.pop_front();
+  worker[workerIndex].activeSocket = connection.socket;
+  return true;
+}
+
+
+// ****************************************************************************
+/// Serves the queued connections with the models of the given worker.
+// ****************************************************************************
+
+void SynthesisServer::processConnections(int workerIndex)
+{
+  Connection connection;
+
+  while (takeConnection(workerIndex, connection))
+  {
+    handleConnection(worker[workerIndex], connection);
+
+    // Close the connection under the lock, so that stop() never shuts
+    // down a socket number that was already reused.
+    wxMutexLocker locker(queueMutex);
+    worker[workerIndex].activeSocket = -1;
+#ifndef WIN32
+    close(connection.socket);
+#endif
+  }
+}
+
+
+// ****************************************************************************
+/// Reads the request of the connection, synthesizes the audio signal and 
+/// sends it back together with the timing of the request. The connection is
+/// closed by the caller.
+// ****************************************************************************
+
+void SynthesisServer::handleConnection(Worker &w, Connection &connection)
+{
+#ifndef WIN32
+  int s = connection.socket;
+  string line;
+  char command[32];
+  char inputName[32];
+  char outputName[32];
+  int numPayloadBytes = 0;
+  int inputType;
+  int outputFormat;
+  vector<char> payload;
+  vector<char> response;
+  double startTime_ms = wxGetLocalTimeMillis().ToDouble();
+  double queueTime_ms = startTime_ms - connection.acceptTime_ms.ToDouble();
+  double synthesisTime_ms = 0.0;
+  double totalTime_ms;
+
+  if (readLine(s, line, MAX_HEADER_LENGTH) == false)
+  {
+    return;
+  }
+
+  // ****************************************************************
+  // Stop the server and the program.
+  // ****************************************************************
+
+  if (line == "SHUTDOWN")
+  {
+    writeString(s, "OK 0\n");
+    {
+      wxMutexLocker locker(queueMutex);
+      stopping = true;
+    }
+    if (wxTheApp != NULL)
+    {
+      wxTheApp->CallAfter(&wxAppConsole::ExitMainLoop);
+    }
+    return;
+  }
+
+  // ****************************************************************
+  // Parse the header and read the payload.
+  // ****************************************************************
+
+  if ((sscanf(line.c_str(), "%31s %31s %31s %d", command, inputName, outputName, 
+    &numPayloadBytes) != 4) || (strcmp(command, "SYNTH") != 0))
+  {
+    writeString(s, "ERROR Invalid request header.\n");
+    return;
+  }
+
+  for (inputType = 0; inputType < SynthesisContext::NUM_INPUT_TYPES; inputType++)
+  {
+    if (strcmp(inputName, INPUT_TYPE_NAME[inputType]) == 0)
+    {
+      break;
+    }
+  }
+
+  for (outputFormat = 0; outputFormat < NUM_OUTPUT_FORMATS; outputFormat++)
+  {
+    if (strcmp(outputName, OUTPUT_FORMAT_NAME[outputFormat]) == 0)
+    {
+      break;
+    }
+  }
+
+  if ((inputType >= SynthesisContext::NUM_INPUT_TYPES) || (outputFormat >= NUM_OUTPUT_FORMATS) ||
+    (numPayloadBytes < 1) || (numPayloadBytes > MAX_PAYLOAD_BYTES))
+  {
+    writeString(s, "ERROR Invalid input type, output format or payload size.\n");
+    return;
+  }
+
+  payload.resize(numPayloadBytes);
+  if (readBytes(s, &payload[0], numPayloadBytes) == false)
+  {
+    return;
+  }
+
+  // ****************************************************************
+  // The backend reads the input from files, so the payload is 
+  // passed via a temporary file.
+  // ****************************************************************
+
+  wxString fileName = wxFileName::CreateTempFileName("vtl-server");
+  bool ok = false;
+
+  if (fileName.IsEmpty() == false)
+  {
+    ofstream os(fileName.ToStdString().c_str(), ios::binary);
+    os.write(&payload[0], numPayloadBytes);
+    os.close();
+
+    wxStopWatch stopWatch;
+    ok = w.context->synthesize((SynthesisContext::InputType)inputType, fileName.ToStdString());
+    synthesisTime_ms = (double)stopWatch.Time();
+
+    wxRemoveFile(fileName);
+  }
+
+  vector<double> &audio = w.context->audio;
+
+  if ((ok == false) || (audio.empty()))
+  {
+    writeString(s, "ERROR The synthesis failed.\n");
+    return;
+  }
+
+  // ****************************************************************
+  // Send the audio data.
+  // ****************************************************************
+
+  if (outputFormat == OUTPUT_WAV)
+  {
+    appendWavHeader(response, (int)audio.size());
+  }
+  appendPcmSamples(response, audio);
+
+  totalTime_ms = wxGetLocalTimeMillis().ToDouble() - connection.acceptTime_ms.ToDouble();
+
+  line = wxString::Format("OK %d samples=%d queue_ms=%.0f synthesis_ms=%.0f total_ms=%.0f\n",
+    (int)response.size(), (int)audio.size(), queueTime_ms, synthesisTime_ms, 
+    totalTime_ms).ToStdString();
+
+  if (writeString(s, line))
+  {
+    writeBytes(s, &response[0], (int)response.size());
+  }
+
+  wxMutexLocker locker(queueMutex);
+  numServedRequests++;
+#endif
+}
+
+
+// ****************************************************************************
+/// Sends the requests of a load test. Each worker of the job is one client
+/// that sends one request after the other. The results are kept per request.
+// ****************************************************************************
+
+class SynthesisLoadTestJob : public ParallelJob
+{
+public:
+  string socketPath;
+  string header;
+  vector<char> *payload;
+
+  vector<int> status;             // 0 = ok, 1 = busy, 2 = error
+  vector<double> latency_ms;
+  vector<double> synthesisTime_ms;
+  vector<double> queueTime_ms;
+  vector<int> numSamples;
+
+  virtual void processItem(int workerIndex, int itemIndex)
+  {
+#ifndef WIN32
+    string line;
+    int numBytes = 0;
+    int samples = 0;
+    double queue_ms = 0.0;
+    double synthesis_ms = 0.0;
+    double total_ms = 0.0;
+    vector<char> data;
+    wxStopWatch stopWatch;
+
+    status[itemIndex] = 2;
+
+    int s = connectToServer(socketPath);
+    if (s < 0)
+    {
+      return;
+    }
+
+    if ((writeString(s, header)) && 
+      (writeBytes(s, &(*payload)[0], (int)payload->size())) &&
+      (readLine(s, line, SynthesisServer::MAX_HEADER_LENGTH)))
+    {
+      if (line.compare(0, 4, "BUSY") == 0)
+      {
+        status[itemIndex] = 1;
+      }
+      else
+      if ((sscanf(line.c_str(), "OK %d samples=%d queue_ms=%lf synthesis_ms=%lf total_ms=%lf",
+        &numBytes, &samples, &queue_ms, &synthesis_ms, &total_ms) == 5) && (numBytes > 0))
+      {
+        data.resize(numBytes);
+        if (readBytes(s, &data[0], numBytes))
+        {
+          status[itemIndex] = 0;
+          numSamples[itemIndex] = samples;
+          queueTime_ms[itemIndex] = queue_ms;
+          synthesisTime_ms[itemIndex] = synthesis_ms;
+        }
+      }
+    }
+    close(s);
+
+    latency_ms[itemIndex] = (double)stopWatch.Time();
+#endif
+  }
+};
+
+
+// ****************************************************************************
+/// Returns the value at the given percentile (0 ... 100) of the values.
+// ****************************************************************************
+
+static double getPercentile(vector<double> values, double percentile)
+{
+  int index;
+
+  if (values.empty())
+  {
+    return 0.0;
+  }
+  sort(values.begin(), values.end());
+  index = (int)(percentile*0.01*(values.size() - 1) + 0.5);
+  return values[index];
+}
+
+
+// ****************************************************************************
+/// Sends numRequests requests with the content of the given file to the 
+/// server with numClients concurrent clients and prints the throughput, the
+/// latencies and the number of rejected requests. inputType is one of 
+/// INPUT_TYPE_NAME. Returns 0 if all requests were served, and 1 otherwise.
+// ****************************************************************************
+
+int SynthesisServer::runLoadTest(const wxString &socketPath, const wxString &inputType,
+  const wxString &fileName, int numRequests, int numClients)
+{
+  SynthesisLoadTestJob job;
+  vector<char> payload;
+  vector<double> latency_ms;
+  vector<double> synthesisTime_ms;
+  vector<double> queueTime_ms;
+  double totalAudio_s = 0.0;
+  double totalSynthesis_s = 0.0;
+  int numOk = 0;
+  int numBusy = 0;
+  int numErrors = 0;
+  int i;
+
+  ifstream is(fileName.ToStdString().c_str(), ios::binary);
+  if (!is)
+  {
+    wxPrintf("Error: Could not open %s.\n", fileName.c_str());
+    return 1;
+  }
+  payload.assign(istreambuf_iterator<char>(is), istreambuf_iterator<char>());
+  is.close();
+
+  if ((payload.empty()) || (numRequests < 1))
+  {
+    wxPrintf("Error: Nothing to send.\n");
+    return 1;
+  }
+  if (numClients < 1)
+  {
+    numClients = 1;
+  }
+
+  job.socketPath = socketPath.ToStdString();
+  job.header = wxString::Format("SYNTH %s pcm %d\n", inputType, (int)payload.size()).ToStdString();
+  job.payload = &payload;
+  job.status.assign(numRequests, 2);
+  job.latency_ms.assign(numRequests, 0.0);
+  job.synthesisTime_ms.assign(numRequests, 0.0);
+  job.queueTime_ms.assign(numRequests, 0.0);
+  job.numSamples.assign(numRequests, 0);
+
+  wxPrintf("Sending %d requests with %d clients to %s...\n", numRequests, numClients, socketPath.c_str());
+
+  wxStopWatch stopWatch;
+  job.run(numRequests, numClients);
+  double duration_s = stopWatch.Time() / 1000.0;
+
+  for (i=0; i < numRequests; i++)
+  {
+    switch (job.status[i])
+    {
+    case 0:
+      numOk++;
+      latency_ms.push_back(job.latency_ms[i]);
+      synthesisTime_ms.push_back(job.synthesisTime_ms[i]);
+      queueTime_ms.push_back(job.queueTime_ms[i]);
+      totalAudio_s+= (double)job.numSamples[i] / SAMPLING_RATE;
+      totalSynthesis_s+= job.synthesisTime_ms[i] / 1000.0;
+      break;
+    case 1: numBusy++; break;
+    default: numErrors++; break;
+    }
+  }
+
+  wxPrintf("Requests: %d ok, %d busy, %d failed in %2.2f s (%2.1f requests/s).\n",
+    numOk, numBusy, numErrors, duration_s, duration_s > 0.0 ? numOk / duration_s : 0.0);
+  wxPrintf("Latency [ms]: p50 = %.0f, p95 = %.0f, max = %.0f\n",
+    getPercentile(latency_ms, 50.0), getPercentile(latency_ms, 95.0), getPercentile(latency_ms, 100.0));
+  wxPrintf("Server time [ms]: queue p50 = %.0f, synthesis p50 = %.0f\n",
+    getPercentile(queueTime_ms, 50.0), getPercentile(synthesisTime_ms, 50.0));
+  if (totalSynthesis_s > 0.0)
+  {
+    wxPrintf("Synthesized %2.1f s of audio at %2.2f times real-time per worker.\n",
+      totalAudio_s, totalAudio_s / totalSynthesis_s);
+  }
+
+  return (numOk == numRequests) ? 0 : 1;
+}
+
+// ****************************************************************************
@@ -0,0 +1,142 @@
+// ****************************************************************************
+// This file is part of VocalTractLab.
+// Copyright (C) 2020, Peter Birkholz, Dresden, Germany
+// www.vocaltractlab.de
+// author: Peter Birkholz
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//
+// ****************************************************************************
+
+
+#ifndef __SYNTHESIS_SERVER_H__
+#define __SYNTHESIS_SERVER_H__
+
+#include <wx/wx.h>
+#include <wx/thread.h>
+#include <wx/stopwatch.h>
+#include <vector>
+#include <deque>
+#include <string>
+#include "SynthesisContext.h"
+
+using namespace std;
+
+// ****************************************************************************
+/// A local synthesis server that listens on a Unix domain socket (not 
+/// available on Windows). Each worker thread keeps its own SynthesisContext,
+/// which is created once when the server starts, so that a request only pays
+/// for the synthesis itself.
+///
+/// A request consists of one header line followed by the payload:
+///
+///   SYNTH <input> <output> <numPayloadBytes>\n<payload>
+///
+/// with <input> = ges (gestural score XML), tube (tube sequence file) or 
+/// tract (tract sequence file), and <output> = pcm (16 bit signed little
+/// endian mono samples at SAMPLING_RATE) or wav. The answer is one of
+///
+///   OK <numBytes> samples=<n> queue_ms=<t> synthesis_ms=<t> total_ms=<t>\n<data>
+///   BUSY queue=<n>\n        (the queue is full; retry later)
+///   ERROR <message>\n
+///
+/// The request SHUTDOWN\n stops the server and quits the program.
+/// Connections that can't be served immediately are queued. When the queue 
+/// is full, new requests are rejected with BUSY (backpressure).
+// ****************************************************************************
+
+class SynthesisServer
+{
+  // **************************************************************************
+  // Public data.
+  // **************************************************************************
+
+public:
+  static const int MAX_QUEUE_LENGTH_PER_WORKER = 4;
+  static const int MAX_HEADER_LENGTH = 256;
+  static const int MAX_PAYLOAD_BYTES = 64*1024*1024;
+  static const int SOCKET_TIMEOUT_S = 10;
+
+  enum OutputFormat
+  {
+    OUTPUT_PCM,
+    OUTPUT_WAV,
+    NUM_OUTPUT_FORMATS
+  };
+
+  static const char *INPUT_TYPE_NAME[SynthesisContext::NUM_INPUT_TYPES];
+  static const char *OUTPUT_FORMAT_NAME[NUM_OUTPUT_FORMATS];
+
+  // **************************************************************************
+  // Public functions.
+  // **************************************************************************
+
+public:
+  SynthesisServer();
+  ~SynthesisServer();
+  bool start(const wxString &socketPath, int numWorkers);
+  void stop();
+
+  static int runLoadTest(const wxString &socketPath, const wxString &inputType,
+    const wxString &fileName, int numRequests, int numClients);
+
+  // **************************************************************************
+  // Private data.
+  // **************************************************************************
+
+private:
+  struct Worker
+  {
+    SynthesisContext *context;
+    wxThread *thread;
+    int activeSocket;           // Guarded by queueMutex
+  };
+
+  struct Connection
+  {
+    int socket;
+    wxLongLong acceptTime_ms;
+  };
+
+  wxString socketPath;
+  int listenSocket;
+  wxThread *acceptThread;
+  vector<Worker> worker;
+  int maxQueueLength;
+
+  deque<Connection> queue;
+  wxMutex queueMutex;
+  wxCondition queueCondition;
+  bool stopping;
+
+  // Statistics
+  int numServedRequests;
+  int numRejectedRequests;
+
+  // **************************************************************************
+  // Private functions.
+  // **************************************************************************
+
+private:
+  void acceptConnections();
+  void processConnections(int workerIndex);
+  bool takeConnection(int workerIndex, Connection &connection);
+  void handleConnection(Worker &w, Connection &connection);
+
+  friend class SynthesisServerThread;
+};
+
+#endif
+
+// ****************************************************************************
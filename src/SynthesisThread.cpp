@@ -27,11 +27,13 @@
 // ****************************************************************************
 // ****************************************************************************
 
-SynthesisThread::SynthesisThread(wxWindow *window, TubeSequence *tubeSequence) : wxThread()
+SynthesisThread::SynthesisThread(wxWindow *window, TubeSequence *tubeSequence, 
+  wxThreadKind kind) : wxThread(kind)
 {
   this->window = window;
   this->tubeSequence = tubeSequence;
   canceled = false;
+  checkpoints = NULL;
 }
 
 
@@ -124,8 +126,9 @@ void *SynthesisThread::Entry()
     // stay reactive (react on Cancel-button).
     // **************************************************************
 
-    if (((data->showAnimation) && ((i % speed_percent) == 0)) ||
-        ((data->showAnimation == false) && ((i % 200) == 0)))
+    if ((window != NULL) && 
+      (((data->showAnimation) && ((i % speed_percent) == 0)) ||
+       ((data->showAnimation == false) && ((i % 200) == 0))))
     {
       // Set guiUpdateFinished to false BEFORE the command event is
       // sent to the GUI
@@ -144,6 +147,16 @@ void *SynthesisThread::Entry()
       }
     }
 
+    // **************************************************************
+    // Keep in mind the state before this time step.
+    // **************************************************************
+
+    if ((checkpoints != NULL) && (i > startPos) && (checkpoints->isDue(i)))
+    {
+      checkpoints->add(i, tdsModel, data->getSelectedGlottis(), &data->outputPressureFilter,
+        data->outputFlow[(i-1) & Data::TDS_BUFFER_MASK]);
+    }
+
     // **************************************************************
     // Make a time step with the current tube geometry.
     // **************************************************************
@@ -226,6 +239,16 @@ void *SynthesisThread::Entry()
   stopWatch.Pause();
   wxPrintf("The synthesis took %ld ms.\n", stopWatch.Time());
 
+  // Keep the audio signal up to the last synthesized sample.
+  if (checkpoints != NULL)
+  {
+    checkpoints->audio.resize(i);
+    for (k = startPos; k < i; k++)
+    {
+      checkpoints->audio[k] = data->track[Data::MAIN_TRACK]->getValue(k);
+    }
+  }
+
 
   // ****************************************************************
   // Calculate a spectrum for some kinds of synthesis.
@@ -308,9 +331,12 @@ void *SynthesisThread::Entry()
   // has finished.
   // ****************************************************************
 
-  wxCommandEvent event( wxEVT_COMMAND_MENU_SELECTED, SYNTHESIS_THREAD_EVENT );
-  event.SetInt(-1); // that's all
-  wxPostEvent(window, event);
+  if (window != NULL)
+  {
+    wxCommandEvent event( wxEVT_COMMAND_MENU_SELECTED, SYNTHESIS_THREAD_EVENT );
+    event.SetInt(-1); // that's all
+    wxPostEvent(window, event);
+  }
 
   return NULL;
 }
@@ -44,6 +44,11 @@ static const int SYNTHESIS_THREAD_EVENT = 54321;
 /// the value -1. When the GUI thread updated the GUI in response to such an
 /// event, it must call signalGuiUpdateFinished() to tell the thread to 
 /// continue its operation.
+/// When a checkpoint list is set with setCheckpoints(...), the state of the
+/// simulation is added to it in regular intervals, and the synthesized audio
+/// signal is copied into it at the end.
+/// Without a window, no events are sent, so that a joinable thread can
+/// synthesize without a GUI (e.g., for tests) and be waited for.
 // ****************************************************************************
 
 class SynthesisThread : public wxThread
@@ -52,10 +57,12 @@ class SynthesisThread : public wxThread
   // **************************************************************************
 
 public:
-  SynthesisThread(wxWindow *window, TubeSequence *tubeSequence);
+  SynthesisThread(wxWindow *window, TubeSequence *tubeSequence, 
+    wxThreadKind kind = wxTHREAD_DETACHED);
   inline void cancelNow() { canceled = true; }
   inline bool wasCanceled() { return canceled; }
   inline void signalGuiUpdateFinished() { guiUpdateFinished = true; }
+  inline void setCheckpoints(TdsCheckpointList *list) { checkpoints = list; }
 
   // Thread execution starts here
   virtual void *Entry();
@@ -71,6 +78,7 @@ private:
   TubeSequence *tubeSequence;
   bool canceled;
   bool guiUpdateFinished;
+  TdsCheckpointList *checkpoints;
 };
 
 // ****************************************************************************
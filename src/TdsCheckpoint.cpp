@@ -0,0 +1,314 @@
+// ****************************************************************************
+// This file is part of VocalTractLab.
+// Copyright (C) 2020, Peter Birkholz, Dresden, Germany
+// www.vocaltractlab.de
+// author: Peter Birkholz
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//
+// ****************************************************************************
+
+
+#include "TdsCheckpoint.h"
+#include "VocalTractLabBackend/Constants.h"
+#include "VocalTractLabBackend/GeometricGlottis.h"
+#include "VocalTractLabBackend/TwoMassModel.h"
+#include "VocalTractLabBackend/TriangularGlottis.h"
+
+const double TdsCheckpointList::DEFAULT_INTERVAL_S = 0.25;
+
+
+// ****************************************************************************
+// ****************************************************************************
+
+TdsCheckpoint::TdsCheckpoint()
+{
+  pos_pt = 0;
+  glottis = NULL;
+  lastOutputFlow_cm3_s = 0.0;
+}
+
+
+// ****************************************************************************
+// ****************************************************************************
+
+TdsCheckpoint::~TdsCheckpoint()
+{
+  delete glottis;
+}
+
+
+// ****************************************************************************
+/// Copies the state of the given models. Returns false, if the type of the
+/// glottis model is unknown.
+// ****************************************************************************
+
+bool TdsCheckpoint::save(int pos_pt, TdsModel *tdsModel, Glottis *glottis, 
+  IirFilter *outputPressureFilter, double lastOutputFlow_cm3_s)
+{
+  delete this->glottis;
+  this->glottis = cloneGlottis(glottis);
+  if (this->glottis == NULL)
+  {
+    return false;
+  }
+
+  this->pos_pt = pos_pt;
+  this->tdsModel = *tdsModel;
+  this->outputPressureFilter = *outputPressureFilter;
+  this->lastOutputFlow_cm3_s = lastOutputFlow_cm3_s;
+
+  return true;
+}
+
+
+// ****************************************************************************
+/// Puts the given models into the saved state. The tube sequence is reset
+/// and stepped forward to pos_pt. Because the glottis model is moved along
+/// with the sequence, its state is overwritten afterwards. The glottis must
+/// be of the same type as the saved one. Only the dynamic state of the TDS 
+/// model is restored; its options are kept as they are.
+// ****************************************************************************
+
+bool TdsCheckpoint::restore(TubeSequence *tubeSequence, TdsModel *tdsModel, 
+  Glottis *glottis, IirFilter *outputPressureFilter, double &lastOutputFlow_cm3_s)
+{
+  double pressure_dPa[4] = { 0.0, 0.0, 0.0, 0.0 };
+  TdsModel::Options options = tdsModel->options;
+  int i;
+
+  if ((this->glottis == NULL) || (pos_pt > tubeSequence->getDuration_pt()))
+  {
+    return false;
+  }
+
+  tubeSequence->resetSequence();
+  for (i = 0; i < pos_pt; i++)
+  {
+    tubeSequence->incPos(pressure_dPa);
+  }
+
+  if (assignGlottis(glottis, this->glottis) == false)
+  {
+    return false;
+  }
+
+  *tdsModel = this->tdsModel;
+  tdsModel->options = options;
+  *outputPressureFilter = this->outputPressureFilter;
+  lastOutputFlow_cm3_s = this->lastOutputFlow_cm3_s;
+
+  return true;
+}
+
+
+// ****************************************************************************
+/// Returns a new copy of the given glottis model, or NULL, if its type is 
+/// unknown.
+// ****************************************************************************
+
+Glottis *TdsCheckpoint::cloneGlottis(Glottis *source)
+{
+  if (dynamic_cast<GeometricGlottis*>(source) != NULL)
+  {
+    return new GeometricGlottis(*dynamic_cast<GeometricGlottis*>(source));
+  }
+  if (dynamic_cast<TwoMassModel*>(source) != NULL)
+  {
+    return new TwoMassModel(*dynamic_cast<TwoMassModel*>(source));
+  }
+  if (dynamic_cast<TriangularGlottis*>(source) != NULL)
+  {
+    return new TriangularGlottis(*dynamic_cast<TriangularGlottis*>(source));
+  }
+  return NULL;
+}
+
+
+// ****************************************************************************
+/// Copies the state of the source glottis into the target glottis. Returns 
+/// false, if the models are not of the same type.
+// ****************************************************************************
+
+bool TdsCheckpoint::assignGlottis(Glottis *target, Glottis *source)
+{
+  GeometricGlottis *geometricGlottis = dynamic_cast<GeometricGlottis*>(source);
+  TwoMassModel *twoMassModel = dynamic_cast<TwoMassModel*>(source);
+  TriangularGlottis *triangularGlottis = dynamic_cast<TriangularGlottis*>(source);
+
+  if ((geometricGlottis != NULL) && (dynamic_cast<GeometricGlottis*>(target) != NULL))
+  {
+    *dynamic_cast<GeometricGlottis*>(target) = *geometricGlottis;
+    return true;
+  }
+  if ((twoMassModel != NULL) && (dynamic_cast<TwoMassModel*>(target) != NULL))
+  {
+    *dynamic_cast<TwoMassModel*>(target) = *twoMassModel;
+    return true;
+  }
+  if ((triangularGlottis != NULL) && (dynamic_cast<TriangularGlottis*>(target) != NULL))
+  {
+    *dynamic_cast<TriangularGlottis*>(target) = *triangularGlottis;
+    return true;
+  }
+  return false;
+}
+
+
+// ****************************************************************************
+// ****************************************************************************
+
+TdsCheckpointList::TdsCheckpointList()
+{
+  interval_pt = (int)(DEFAULT_INTERVAL_S * SAMPLING_RATE);
+}
+
+
+// ****************************************************************************
+// ****************************************************************************
+
+TdsCheckpointList::~TdsCheckpointList()
+{
+  clear();
+}
+
+
+// ****************************************************************************
+/// Removes all checkpoints, the audio signal and the keys.
+// ****************************************************************************
+
+void TdsCheckpointList::clear()
+{
+  int i;
+
+  for (i = 0; i < (int)checkpoint.size(); i++)
+  {
+    delete checkpoint[i];
+  }
+  checkpoint.clear();
+  settingsKey.clear();
+  trajectory.clear();
+  audio.clear();
+  interval_pt = (int)(DEFAULT_INTERVAL_S * SAMPLING_RATE);
+}
+
+
+// ****************************************************************************
+// ****************************************************************************
+
+int TdsCheckpointList::getNumCheckpoints()
+{
+  return (int)checkpoint.size();
+}
+
+
+// ****************************************************************************
+/// Returns true, if a checkpoint should be added at the given position.
+// ****************************************************************************
+
+bool TdsCheckpointList::isDue(int pos_pt)
+{
+  if ((pos_pt <= 0) || ((pos_pt % interval_pt) != 0))
+  {
+    return false;
+  }
+  if ((checkpoint.empty() == false) && (checkpoint.back()->pos_pt >= pos_pt))
+  {
+    return false;
+  }
+  return true;
+}
+
+
+// ****************************************************************************
+/// Adds a checkpoint with the state of the given models behind the existing
+/// ones.
+// ****************************************************************************
+
+void TdsCheckpointList::add(int pos_pt, TdsModel *tdsModel, Glottis *glottis, 
+  IirFilter *outputPressureFilter, double lastOutputFlow_cm3_s)
+{
+  int i, k;
+
+  TdsCheckpoint *c = new TdsCheckpoint();
+  if (c->save(pos_pt, tdsModel, glottis, outputPressureFilter, lastOutputFlow_cm3_s) == false)
+  {
+    delete c;
+    return;
+  }
+  checkpoint.push_back(c);
+
+  // ****************************************************************
+  // Thin out the checkpoints when there are too many.
+  // ****************************************************************
+
+  if ((int)checkpoint.size() >= MAX_CHECKPOINTS)
+  {
+    interval_pt*= 2;
+    k = 0;
+    for (i = 0; i < (int)checkpoint.size(); i++)
+    {
+      if ((checkpoint[i]->pos_pt % interval_pt) == 0)
+      {
+        checkpoint[k++] = checkpoint[i];
+      }
+      else
+      {
+        delete checkpoint[i];
+      }
+    }
+    checkpoint.resize(k);
+  }
+}
+
+
+// ****************************************************************************
+/// Returns the last checkpoint at or before the given position for which 
+/// the audio signal is available, or NULL, if there is none.
+// ****************************************************************************
+
+TdsCheckpoint *TdsCheckpointList::getLastBefore(int pos_pt)
+{
+  int i;
+
+  for (i = (int)checkpoint.size() - 1; i >= 0; i--)
+  {
+    if ((checkpoint[i]->pos_pt <= pos_pt) && (checkpoint[i]->pos_pt <= (int)audio.size()))
+    {
+      return checkpoint[i];
+    }
+  }
+  return NULL;
+}
+
+
+// ****************************************************************************
+/// Removes the checkpoints behind the given position and shortens the audio
+/// signal to it.
+// ****************************************************************************
+
+void TdsCheckpointList::removeAfter(int pos_pt)
+{
+  while ((checkpoint.empty() == false) && (checkpoint.back()->pos_pt > pos_pt))
+  {
+    delete checkpoint.back();
+    checkpoint.pop_back();
+  }
+  if ((int)audio.size() > pos_pt)
+  {
+    audio.resize(pos_pt);
+  }
+}
+
+// ****************************************************************************
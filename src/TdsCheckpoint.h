@@ -0,0 +1,126 @@
+// ****************************************************************************
+// This file is part of VocalTractLab.
+// Copyright (C) 2020, Peter Birkholz, Dresden, Germany
+// www.vocaltractlab.de
+// author: Peter Birkholz
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//
+// ****************************************************************************
+
+
+#ifndef __TDS_CHECKPOINT_H__
+#define __TDS_CHECKPOINT_H__
+
+#include <vector>
+#include "VocalTractLabBackend/TdsModel.h"
+#include "VocalTractLabBackend/Glottis.h"
+#include "VocalTractLabBackend/TubeSequence.h"
+#include "VocalTractLabBackend/IirFilter.h"
+
+using namespace std;
+
+// ****************************************************************************
+/// The complete state of a time-domain simulation before the sample pos_pt
+/// is calculated: a copy of the TDS model and of the glottis model, the state
+/// of the output pressure filter, and the last output flow sample (needed for
+/// the differentiation of the flow). restore(...) puts the models back into
+/// this state, so that a synthesis can continue from here, as often as 
+/// needed. The tube sequence has no accessible state besides its position
+/// and is set to pos_pt by stepping it forward from the start.
+// ****************************************************************************
+
+class TdsCheckpoint
+{
+  // **************************************************************************
+  // Public data.
+  // **************************************************************************
+
+public:
+  int pos_pt;
+  TdsModel tdsModel;
+  Glottis *glottis;
+  IirFilter outputPressureFilter;
+  double lastOutputFlow_cm3_s;
+
+  // **************************************************************************
+  // Public functions.
+  // **************************************************************************
+
+public:
+  TdsCheckpoint();
+  ~TdsCheckpoint();
+  bool save(int pos_pt, TdsModel *tdsModel, Glottis *glottis, 
+    IirFilter *outputPressureFilter, double lastOutputFlow_cm3_s);
+  bool restore(TubeSequence *tubeSequence, TdsModel *tdsModel, Glottis *glottis,
+    IirFilter *outputPressureFilter, double &lastOutputFlow_cm3_s);
+
+  static Glottis *cloneGlottis(Glottis *source);
+  static bool assignGlottis(Glottis *target, Glottis *source);
+};
+
+
+// ****************************************************************************
+/// Checkpoints of one synthesis in the order of their positions, together 
+/// with the audio signal synthesized so far and keys that identify the input
+/// they belong to. Checkpoints are added every interval_pt samples. When 
+/// there are MAX_CHECKPOINTS of them, every second one is removed and the 
+/// interval is doubled, so that the memory stays bounded for long inputs.
+// ****************************************************************************
+
+class TdsCheckpointList
+{
+  // **************************************************************************
+  // Public data.
+  // **************************************************************************
+
+public:
+  static const double DEFAULT_INTERVAL_S;
+  static const int MAX_CHECKPOINTS = 64;
+
+  /// Settings that the checkpoints depend on (e.g., the glottis model and
+  /// the options of the TDS model).
+  vector<double> settingsKey;
+  /// The sampled trajectories of the input (see ScoreTrajectoryCache).
+  vector<double> trajectory;
+  /// The audio signal synthesized up to the last position.
+  vector<short> audio;
+
+  // **************************************************************************
+  // Public functions.
+  // **************************************************************************
+
+public:
+  TdsCheckpointList();
+  ~TdsCheckpointList();
+  void clear();
+  int getNumCheckpoints();
+  bool isDue(int pos_pt);
+  void add(int pos_pt, TdsModel *tdsModel, Glottis *glottis, 
+    IirFilter *outputPressureFilter, double lastOutputFlow_cm3_s);
+  TdsCheckpoint *getLastBefore(int pos_pt);
+  void removeAfter(int pos_pt);
+
+  // **************************************************************************
+  // Private data.
+  // **************************************************************************
+
+private:
+  vector<TdsCheckpoint*> checkpoint;
+  int interval_pt;
+};
+
+#endif
+
+// ****************************************************************************
@@ -525,6 +525,11 @@ void TdsPage::OnSynthesisThreadEvent(wxCommandEvent& event)
 {
   int n = event.GetInt();
 
+  // The synthesis thread wrote new samples into the main track and may
+  // have calculated the main vocal tract for the frames of the score.
+  data->trackChanged(Data::MAIN_TRACK);
+  data->vocalTractCalculatedExternally();
+
   // The thread reached its end - either normally or by the call
   // to wxThread::Destroy()
 
@@ -709,6 +714,9 @@ void TdsPage::OnStartSynthesis(wxCommandEvent &event)
     case Data::SYNTHESIS_GESMOD:
       // Set the currently selected glottis model.
       data->gesturalScore->glottis = data->getSelectedGlottis();
+      // The synthesis thread writes the whole utterance into the main
+      // track, which may be shorter than the gestural score.
+      data->growTracks(tubeSequence->getDuration_pt());
       break;
 
     default: break;
@@ -0,0 +1,107 @@
+// ****************************************************************************
+// This file is part of VocalTractLab.
+// Copyright (C) 2020, Peter Birkholz, Dresden, Germany
+// www.vocaltractlab.de
+// author: Peter Birkholz
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//
+// ****************************************************************************
+
+
+#include "TdsSectionArrays.h"
+
+
+// ****************************************************************************
+/// Allocates the arrays in one block, each starting at a multiple of 
+/// ALIGNMENT bytes.
+// ****************************************************************************
+
+TdsSectionArrays::TdsSectionArrays()
+{
+  double **array[NUM_ARRAYS] = 
+  {
+    &pos_cm, &length_cm, &area_cm2, &pressure_dPa,
+    &inflow_cm3_s, &outflow_cm3_s, &inVelocity_cm_s, &outVelocity_cm_s
+  };
+  int arrayBytes = ((Tube::NUM_SECTIONS*(int)sizeof(double) + ALIGNMENT - 1) / ALIGNMENT) * ALIGNMENT;
+  char *start;
+  int i;
+
+  memory = new char[NUM_ARRAYS*arrayBytes + ALIGNMENT];
+  start = memory + (ALIGNMENT - (int)((size_t)memory % ALIGNMENT)) % ALIGNMENT;
+  for (i=0; i < NUM_ARRAYS; i++)
+  {
+    *array[i] = (double*)(start + i*arrayBytes);
+  }
+
+  for (i=0; i < Tube::NUM_SECTIONS; i++)
+  {
+    pos_cm[i] = 0.0;
+    length_cm[i] = 0.0;
+    area_cm2[i] = 0.0;
+    pressure_dPa[i] = 0.0;
+    inflow_cm3_s[i] = 0.0;
+    outflow_cm3_s[i] = 0.0;
+    inVelocity_cm_s[i] = 0.0;
+    outVelocity_cm_s[i] = 0.0;
+  }
+}
+
+
+// ****************************************************************************
+// ****************************************************************************
+
+TdsSectionArrays::~TdsSectionArrays()
+{
+  delete[] memory;
+}
+
+
+// ****************************************************************************
+/// Copies the quantities of all sections of the given model into the arrays.
+// ****************************************************************************
+
+void TdsSectionArrays::update(TdsModel *model)
+{
+  const double MIN_AREA_CM2 = TdsModel::MIN_AREA_CM2;
+  double area;
+  int i;
+
+  // ****************************************************************
+  // Gather the values from the section structs of the model.
+  // ****************************************************************
+
+  for (i=0; i < Tube::NUM_SECTIONS; i++)
+  {
+    pos_cm[i] = model->tubeSection[i].pos;
+    length_cm[i] = model->tubeSection[i].length;
+    area_cm2[i] = model->tubeSection[i].area;
+    pressure_dPa[i] = model->getSectionPressure(i);
+    model->getSectionFlow(i, inflow_cm3_s[i], outflow_cm3_s[i]);
+  }
+
+  // ****************************************************************
+  // The derived quantities only use the arrays (vectorizable).
+  // ****************************************************************
+
+  for (i=0; i < Tube::NUM_SECTIONS; i++)
+  {
+    area = (area_cm2[i] < MIN_AREA_CM2) ? MIN_AREA_CM2 : area_cm2[i];
+    inVelocity_cm_s[i] = inflow_cm3_s[i] / area;
+    outVelocity_cm_s[i] = outflow_cm3_s[i] / area;
+  }
+}
+
+// ****************************************************************************
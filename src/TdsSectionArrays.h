@@ -0,0 +1,84 @@
+// ****************************************************************************
+// This file is part of VocalTractLab.
+// Copyright (C) 2020, Peter Birkholz, Dresden, Germany
+// www.vocaltractlab.de
+// author: Peter Birkholz
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+//
+// ****************************************************************************
+
+
+#ifndef __TDS_SECTION_ARRAYS_H__
+#define __TDS_SECTION_ARRAYS_H__
+
+#include "VocalTractLabBackend/TdsModel.h"
+#include "VocalTractLabBackend/Tube.h"
+
+// ****************************************************************************
+/// The per-section quantities of a TDS model at one time step as contiguous
+/// arrays (one array per quantity, indexed by the tube section), so that the
+/// loops over the sections in the pictures read memory linearly and can be
+/// vectorized instead of walking through the large section structs of the
+/// model. update(...) gathers the values in one pass over the sections and
+/// must be called again after each time step or change of the tube.
+/// The arrays are placed in one block on the heap, each starting at a 
+/// multiple of ALIGNMENT bytes (alignas() members would not be honoured by
+/// operator new in C++11 for the object that contains them).
+// ****************************************************************************
+
+class TdsSectionArrays
+{
+  // **************************************************************************
+  // Public data.
+  // **************************************************************************
+
+public:
+  static const int ALIGNMENT = 32;
+
+  // Each array has Tube::NUM_SECTIONS values.
+  double *pos_cm;
+  double *length_cm;
+  double *area_cm2;
+  double *pressure_dPa;
+  double *inflow_cm3_s;
+  double *outflow_cm3_s;
+  double *inVelocity_cm_s;
+  double *outVelocity_cm_s;
+
+  // **************************************************************************
+  // Public functions.
+  // **************************************************************************
+
+public:
+  TdsSectionArrays();
+  ~TdsSectionArrays();
+  void update(TdsModel *model);
+
+  // **************************************************************************
+  // Private data and functions.
+  // **************************************************************************
+
+private:
+  static const int NUM_ARRAYS = 8;
+  char *memory;
+
+  // Not copyable, because the arrays point into the own memory block.
+  TdsSectionArrays(const TdsSectionArrays &);
+  TdsSectionArrays &operator=(const TdsSectionArrays &);
+};
+
+#endif
+
+// ****************************************************************************
@@ -110,7 +110,7 @@ void TdsSpatialSignalPicture::draw(wxDC &dc)
   int graphX, graphY, graphW, graphH;
 
   TdsModel *model = data->tdsModel;
-  TdsModel::TubeSection *ts = NULL;
+  TdsSectionArrays *s = &data->tdsSections;
   double lowerLimit = 0.0;
   double upperLimit = 0.0;
   int leftY[MAX_TUBE_SECTIONS];
@@ -170,6 +170,8 @@ void TdsSpatialSignalPicture::draw(wxDC &dc)
 
   // Run through all tube sections **********************************
 
+  s->update(model);
+
   for (i=0; i < Tube::NUM_SECTIONS; i++)
   {
     // Is it a side branch of the vocal tract ?
@@ -208,10 +210,8 @@ void TdsSpatialSignalPicture::draw(wxDC &dc)
 
     if (paintSection)
     {
-      ts = &model->tubeSection[i];
-
-      leftX = graph->getXPos(ts->pos);
-      rightX = graph->getXPos(ts->pos + ts->length);
+      leftX = graph->getXPos(s->pos_cm[i]);
+      rightX = graph->getXPos(s->pos_cm[i] + s->length_cm[i]);
 
       data->getTubeSectionQuantity(model, i, leftValue, rightValue);
       leftY[i] = graph->getYPos(leftValue);
@@ -247,9 +247,7 @@ void TdsSpatialSignalPicture::draw(wxDC &dc)
   i = data->userProbeSection;
   if ((i >= Tube::FIRST_TRACHEA_SECTION) && (i < Tube::NUM_SECTIONS))
   {
-    ts = &model->tubeSection[i];
-
-    leftX = graph->getXPos(ts->pos + 0.5*ts->length);
+    leftX = graph->getXPos(s->pos_cm[i] + 0.5*s->length_cm[i]);
     if ((leftX >= graphX) && (leftX < graphX + graphW))
     {
       dc.SetPen(wxPen(*wxBLACK, lineWidth, wxPENSTYLE_LONG_DASH));
@@ -493,7 +493,7 @@ void TransitionDialog::calcVocalTract()
     vt->param[i].x = (1.0-transitionPos)*consonantParams[i] + transitionPos*vowelParams[i];
   }
 
-  vt->calculateAll();
+  data->calculateVocalTract(vt);
 }
 
 
@@ -44,6 +44,8 @@ static const int IDC_SHOW_CUT_VECTORS		      		= 4102;
 static const int IDC_SMOOTH_CENTER_LINE			    	= 4106;
 static const int IDC_SHOW_EMA_POINTS            	= 4107;
 static const int IDB_EDIT_EMA_POINTS      	    	= 4108;
+static const int IDC_REPORT_FRAME_TIMES           = 4109;
+static const int IDB_BENCHMARK_GEOMETRY           = 4114;
 
 static const int IDB_LOAD_BACKGROUND_IMAGE        = 4110;
 static const int IDB_CURRENT_IMAGE_TO_BACKGROUND  = 4111;
@@ -85,6 +87,8 @@ BEGIN_EVENT_TABLE(VocalTractDialog, wxDialog)
 
   EVT_CHECKBOX(IDC_SHOW_EMA_POINTS, VocalTractDialog::OnShowEmaPoints)
   EVT_BUTTON(IDB_EDIT_EMA_POINTS, VocalTractDialog::OnEditEmaPoints)
+  EVT_CHECKBOX(IDC_REPORT_FRAME_TIMES, VocalTractDialog::OnReportFrameTimes)
+  EVT_BUTTON(IDB_BENCHMARK_GEOMETRY, VocalTractDialog::OnBenchmarkGeometry)
 
   EVT_BUTTON(IDB_LOAD_BACKGROUND_IMAGE, VocalTractDialog::OnLoadBackgroundImage)
   EVT_BUTTON(IDB_CURRENT_IMAGE_TO_BACKGROUND, VocalTractDialog::OnCurrentImageToBackground)
@@ -202,6 +206,7 @@ void VocalTractDialog::updateWidgets()
     chkShowCenterLine->SetValue( picVocalTract->showCenterLine );
     chkSmoothCenterLine->SetValue( !picVocalTract->isRoughCenterLine );
     chkShowEmaPoints->SetValue( picVocalTract->showEmaPoints );
+    chkReportFrameTimes->SetValue( picVocalTract->reportFrameTimes );
 
     if (data->backgroundImageFileName.empty())
     {
@@ -416,6 +421,13 @@ void VocalTractDialog::initWidgets()
   sizer->Add(button, 0, wxALL, 2);
   controlSizer->Add(sizer);
 
+  sizer = new wxBoxSizer(wxHORIZONTAL);
+  chkReportFrameTimes = new wxCheckBox(controlPanel, IDC_REPORT_FRAME_TIMES, "Report frame times");
+  sizer->Add(chkReportFrameTimes, 0, wxALL, 5);
+  button = new wxButton(controlPanel, IDB_BENCHMARK_GEOMETRY, "Benchmark geometry");
+  sizer->Add(button, 0, wxALL, 2);
+  controlSizer->Add(sizer);
+
   // ****************************************************************
 
   sizer = new wxBoxSizer(wxHORIZONTAL);
@@ -541,7 +553,7 @@ void VocalTractDialog::OnTongueSideElevationChanged(wxScrollEvent &event)
   double max = tract->param[VocalTract::TS1+index].max;
   tract->param[VocalTract::TS1+index].x = min + (max-min)*(double)pos / (double)NUM_SCROLLBAR_STEPS;
 
-  tract->calculateAll();
+  data->calculateVocalTract(tract);
   data->updateTlModelGeometry(tract);
   updateWidgets();
   updateVocalTractPage();
@@ -558,7 +570,8 @@ void VocalTractDialog::OnAutomaticTongueRootCalc(wxCommandEvent &event)
   VocalTract *tract = data->vocalTract;
   tract->anatomy.automaticTongueRootCalc = !tract->anatomy.automaticTongueRootCalc;
   
-  tract->calculateAll();
+  data->invalidateVocalTract();
+  data->calculateVocalTract(tract);
   data->updateTlModelGeometry(tract);
   updateWidgets();
   updateVocalTractPage();
@@ -662,6 +675,28 @@ void VocalTractDialog::OnShowEmaPoints(wxCommandEvent &event)
 }
 
 
+// ****************************************************************************
+// ****************************************************************************
+
+void VocalTractDialog::OnReportFrameTimes(wxCommandEvent &event)
+{
+  picVocalTract->reportFrameTimes = !picVocalTract->reportFrameTimes;
+  updateWidgets();
+}
+
+
+// ****************************************************************************
+/// Prints the calculation times of the vocal tract geometry for changes of
+/// the single parameters to the console.
+// ****************************************************************************
+
+void VocalTractDialog::OnBenchmarkGeometry(wxCommandEvent &event)
+{
+  wxBusyCursor busyCursor;
+  data->benchmarkVocalTractCalculation();
+}
+
+
 // ****************************************************************************
 // ****************************************************************************
 
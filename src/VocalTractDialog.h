@@ -86,6 +86,7 @@ private:
   wxCheckBox *chkSmoothCenterLine;
   wxCheckBox *chkShowCutVectors;
   wxCheckBox *chkShowEmaPoints;
+  wxCheckBox *chkReportFrameTimes;
 
   wxStaticText *labBackgroundImageFileName;
   wxCheckBox *chkShowBackgroundImage;
@@ -120,6 +121,8 @@ private:
 
   void OnShowEmaPoints(wxCommandEvent &event);
   void OnEditEmaPoints(wxCommandEvent &event);
+  void OnReportFrameTimes(wxCommandEvent &event);
+  void OnBenchmarkGeometry(wxCommandEvent &event);
 
   void OnLoadBackgroundImage(wxCommandEvent &event);
   void OnCurrentImageToBackground(wxCommandEvent& event);
@@ -36,6 +36,7 @@
 #include "VocalTractDialog.h"
 #include "TransitionDialog.h"
 #include "SoundLib.h"
+#include "RandomStream.h"
 #include "VocalTractLabBackend/Synthesizer.h"
 #include "VocalTractLabBackend/Dsp.h"
 #include "VocalTractLabBackend/Synthesizer.h"
@@ -862,7 +863,7 @@ void VocalTractPage::OnFdsAcoustics(wxCommandEvent &event)
 
 void VocalTractPage::OnImproveFormants(wxCommandEvent &event)
 {
-  FormantOptimizationDialog *dialog = data->formantOptimizationDialog;
+  FormantOptimizationDialog *dialog = data->getFormantOptimizationDialog();
 
   dialog->SetParent(this);
   if (dialog->ShowModal() == wxID_OK)
@@ -1078,7 +1079,7 @@ void VocalTractPage::OnMapShape(wxCommandEvent &event)
 
   // Recalculate the VT and update all widgets.
 
-  vt->calculateAll();
+  data->calculateVocalTract(vt);
 
   updateWidgets();
 
@@ -1146,6 +1147,7 @@ void VocalTractPage::OnPlayShortVowelTds(wxCommandEvent& event)
     data->tdsModel, true, true, audio);
 
   data->track[Data::MAIN_TRACK]->setZero();
+  data->trackChanged(Data::MAIN_TRACK);
   Synthesizer::copySignal(audio, *data->track[Data::MAIN_TRACK], 0);
   data->normalizeAudioAmplitude(Data::MAIN_TRACK);
 
@@ -1211,6 +1213,7 @@ void VocalTractPage::OnPlayLongVowelTds(wxCommandEvent& event)
     data->tdsModel, false, true, audio);
 
   data->track[Data::MAIN_TRACK]->setZero();
+  data->trackChanged(Data::MAIN_TRACK);
   Synthesizer::copySignal(audio, *data->track[Data::MAIN_TRACK], 0);
   data->normalizeAudioAmplitude(Data::MAIN_TRACK);
 
@@ -1275,6 +1278,7 @@ void VocalTractPage::OnPlayFricativeTds(wxCommandEvent& event)
     data->tdsModel, false, true, audio);
 
   data->track[Data::MAIN_TRACK]->setZero();
+  data->trackChanged(Data::MAIN_TRACK);
   Synthesizer::copySignal(audio, *data->track[Data::MAIN_TRACK], 0);
   data->normalizeAudioAmplitude(Data::MAIN_TRACK);
 
@@ -1307,8 +1311,9 @@ void VocalTractPage::OnPlayShortVowelFds(wxCommandEvent &event)
   Data *data = Data::getInstance();
 
   data->track[Data::MAIN_TRACK]->setZero();
+  data->trackChanged(Data::MAIN_TRACK);
 
-  data->vocalTract->calculateAll();
+  data->calculateVocalTract(data->vocalTract);
   data->updateTlModelGeometry( data->vocalTract );
   int duration_ms = data->synthesizeVowelLf(data->tlModel, data->lfPulse, 0, false);
   data->normalizeAudioAmplitude(Data::MAIN_TRACK);
@@ -1332,8 +1337,9 @@ void VocalTractPage::OnPlayLongVowelFds(wxCommandEvent &event)
   Data *data = Data::getInstance();
 
   data->track[Data::MAIN_TRACK]->setZero();
+  data->trackChanged(Data::MAIN_TRACK);
 
-  data->vocalTract->calculateAll();
+  data->calculateVocalTract(data->vocalTract);
   data->updateTlModelGeometry( data->vocalTract );
   int duration_ms = data->synthesizeVowelLf(data->tlModel, data->lfPulse, 0, true);
   data->normalizeAudioAmplitude(Data::MAIN_TRACK);
@@ -1435,15 +1441,14 @@ void VocalTractPage::OnSynthesizeNoise(wxCommandEvent &event)
   double inputNoise[INPUT_SIGNAL_LENGTH];
   double sample = 0.0;
 
+  // The standard deviation keeps the level of the former generator
+  // (sum of 12 uniform values divided by sqrt(12)).
+  RandomStream random(data->randomSeed);
+  random.fillGaussian(inputNoise, INPUT_SIGNAL_LENGTH, 0.0, 1.0 / sqrt(12.0));
+
   for (i = 0; i < INPUT_SIGNAL_LENGTH; i++)
   {
-    sample =
-      rand() + rand() + rand() + rand() + rand() + rand() +
-      rand() + rand() + rand() + rand() + rand() + rand();
-    
-    sample /= (double)RAND_MAX;
-    sample -= 6.0;
-    sample /= sqrt(12.0);    // Divide by the standard deviation of the above sum
+    sample = inputNoise[i];
 
     // Implement the fading-in and fading-out.
     if (i < FADING_LENGTH)
@@ -1469,6 +1474,7 @@ void VocalTractPage::OnSynthesizeNoise(wxCommandEvent &event)
 
   // Clear the audio track.
   data->track[Data::MAIN_TRACK]->setZero();
+  data->trackChanged(Data::MAIN_TRACK);
 
   const int OUTPUT_SIGNAL_LENGTH = INPUT_SIGNAL_LENGTH + IMPULSE_RESPONSE_LENGTH - 1;
   double sum = 0.0;
@@ -32,10 +32,118 @@
 #ifdef WIN32
 #include <windows.h>
 #else
+#include <dlfcn.h>
 typedef unsigned int COLORREF;
 #define RGB(r, g, b)  ((COLORREF)((unsigned char)(b) | ((unsigned char)(g) << 8)) | ((unsigned char)(r) << 16))
 #endif
 
+// ****************************************************************************
+// Framebuffer objects (OpenGL 3.0 or GL_EXT_framebuffer_object), which are 
+// not declared in the OpenGL 1.1 headers of all platforms. The constants are
+// the same for the core and the EXT functions.
+// ****************************************************************************
+
+#ifndef GL_FRAMEBUFFER_EXT
+#define GL_FRAMEBUFFER_EXT              0x8D40
+#define GL_RENDERBUFFER_EXT             0x8D41
+#define GL_COLOR_ATTACHMENT0_EXT        0x8CE0
+#define GL_DEPTH_ATTACHMENT_EXT         0x8D00
+#define GL_FRAMEBUFFER_COMPLETE_EXT     0x8CD5
+#endif
+#ifndef GL_DEPTH_COMPONENT24
+#define GL_DEPTH_COMPONENT24            0x81A6
+#endif
+#ifndef APIENTRY
+#define APIENTRY
+#endif
+
+typedef void (APIENTRY *GenObjectsFunction)(GLsizei n, GLuint *ids);
+typedef void (APIENTRY *DeleteObjectsFunction)(GLsizei n, const GLuint *ids);
+typedef void (APIENTRY *BindObjectFunction)(GLenum target, GLuint id);
+typedef void (APIENTRY *RenderbufferStorageFunction)(GLenum target, GLenum format, 
+  GLsizei width, GLsizei height);
+typedef void (APIENTRY *FramebufferRenderbufferFunction)(GLenum target, GLenum attachment, 
+  GLenum renderbufferTarget, GLuint renderbuffer);
+typedef GLenum (APIENTRY *CheckFramebufferStatusFunction)(GLenum target);
+
+struct FramebufferFunctions
+{
+  GenObjectsFunction genFramebuffers;
+  DeleteObjectsFunction deleteFramebuffers;
+  BindObjectFunction bindFramebuffer;
+  GenObjectsFunction genRenderbuffers;
+  DeleteObjectsFunction deleteRenderbuffers;
+  BindObjectFunction bindRenderbuffer;
+  RenderbufferStorageFunction renderbufferStorage;
+  FramebufferRenderbufferFunction framebufferRenderbuffer;
+  CheckFramebufferStatusFunction checkFramebufferStatus;
+};
+
+
+// ****************************************************************************
+/// Returns the address of the given OpenGL function or the one of its EXT
+/// variant, or NULL, if there is none. A GL context must be current.
+// ****************************************************************************
+
+static void *getGlFunction(const char *name)
+{
+  string names[2] = { name, string(name) + "EXT" };
+  void *function = NULL;
+  int i;
+
+  for (i=0; (i < 2) && (function == NULL); i++)
+  {
+#ifdef WIN32
+    function = (void*)wglGetProcAddress(names[i].c_str());
+#else
+    function = dlsym(RTLD_DEFAULT, names[i].c_str());
+#endif
+  }
+  return function;
+}
+
+
+// ****************************************************************************
+/// Returns the framebuffer functions, or NULL, if they are not supported.
+/// They are looked up once, when a GL context is current.
+// ****************************************************************************
+
+static const FramebufferFunctions *getFramebufferFunctions()
+{
+  static FramebufferFunctions f;
+  static bool isInitialized = false;
+  static bool isSupported = false;
+
+  if (isInitialized == false)
+  {
+    f.genFramebuffers = (GenObjectsFunction)getGlFunction("glGenFramebuffers");
+    f.deleteFramebuffers = (DeleteObjectsFunction)getGlFunction("glDeleteFramebuffers");
+    f.bindFramebuffer = (BindObjectFunction)getGlFunction("glBindFramebuffer");
+    f.genRenderbuffers = (GenObjectsFunction)getGlFunction("glGenRenderbuffers");
+    f.deleteRenderbuffers = (DeleteObjectsFunction)getGlFunction("glDeleteRenderbuffers");
+    f.bindRenderbuffer = (BindObjectFunction)getGlFunction("glBindRenderbuffer");
+    f.renderbufferStorage = (RenderbufferStorageFunction)getGlFunction("glRenderbufferStorage");
+    f.framebufferRenderbuffer = 
+      (FramebufferRenderbufferFunction)getGlFunction("glFramebufferRenderbuffer");
+    f.checkFramebufferStatus = 
+      (CheckFramebufferStatusFunction)getGlFunction("glCheckFramebufferStatus");
+
+    isSupported = (f.genFramebuffers != NULL) && (f.deleteFramebuffers != NULL) &&
+      (f.bindFramebuffer != NULL) && (f.genRenderbuffers != NULL) && 
+      (f.deleteRenderbuffers != NULL) && (f.bindRenderbuffer != NULL) && 
+      (f.renderbufferStorage != NULL) && (f.framebufferRenderbuffer != NULL) && 
+      (f.checkFramebufferStatus != NULL);
+    isInitialized = true;
+
+    if (isSupported == false)
+    {
+      wxPrintf("Error: OpenGL framebuffer objects are not supported.\n");
+    }
+  }
+
+  return (isSupported ? &f : NULL);
+}
+
 
 using namespace std;
 
@@ -66,6 +174,8 @@ VocalTractPicture::VocalTractPicture(wxWindow *parent, VocalTract *vocalTract,
   wxGLCanvas(parent, openGlArgs, wxID_ANY, wxDefaultPosition, 
   wxDefaultSize, wxFULL_REPAINT_ON_RESIZE, "GLCanvas", wxNullPalette)
 {
+  int i;
+
   vtContext = new wxGLContext(this, NULL, NULL);
   this->SetCurrent(*vtContext);
 
@@ -117,7 +227,20 @@ VocalTractPicture::VocalTractPicture(wxWindow *parent, VocalTract *vocalTract,
   renderMode = RM_3DSOLID;
   selectedControlPoint = -1;
   showEmaPoints = false;
+  reportFrameTimes = false;
+
+  for (i=0; i < VocalTract::NUM_SURFACES; i++)
+  {
+    surfaceArrays[i].normalsValid = false;
+  }
+  arraysBothSides = renderBothSides;
+
+  numTimedFrames = 0;
+  sumFrameTime_ms = 0.0;
+  maxFrameTime_ms = 0.0;
 
+  imageWidth_pix = 0;
+  imageHeight_pix = 0;
 }
 
 
@@ -135,14 +258,8 @@ VocalTractPicture::~VocalTractPicture()
 
 void VocalTractPicture::projection2D()
 {
-  int width = this->GetSize().x;
-  int height = this->GetSize().y;
-#ifdef __linux__
-  // On Linux, all pixel coordinates need to be scaled by the current
-  // display scaling factor before passing them to OpenGL
-  width *= GetContentScaleFactor();
-  height *= GetContentScaleFactor();
-#endif
+  int width, height;
+  getRenderSize(width, height);
 
   glMatrixMode(GL_PROJECTION);
   glLoadIdentity();
@@ -161,16 +278,9 @@ void VocalTractPicture::projection2D()
 
 void VocalTractPicture::projection3D()
 {
-  int width = this->GetSize().x;
-  int height = this->GetSize().y;
+  int width, height;
+  getRenderSize(width, height);
 
-#ifdef __linux__
-  // On Linux, all pixel coordinates need to be scaled by the current
-  // display scaling factor before passing them to OpenGL
-  width *= GetContentScaleFactor();
-  height *= GetContentScaleFactor();
-#endif
-	
   glMatrixMode(GL_PROJECTION);
   glLoadIdentity();
   gluPerspective(40.0, (double)width/(double)height, 5.0, 100.0);
@@ -232,22 +342,150 @@ void VocalTractPicture::drawTestImage()
 
 
 // ****************************************************************************
-/// Render the vocal tract with the selected display options.
+/// Render the vocal tract with the selected display options and show it.
 // ****************************************************************************
 
 void VocalTractPicture::display()
 {
-  const double INVALID = VocalTract::INVALID_PROFILE_SAMPLE;
-  int i;
-
   // Important: Make sure that the window is shown !!
   if(this->IsShown() == false) 
   {
     return;
   }
 
+  render();
+  SwapBuffers();
+}
+
+
+// ****************************************************************************
+/// Renders the vocal tract into a framebuffer object of the given size (or 
+/// of the size of the picture, if a size is 0) and returns the image, 
+/// without showing it and without going through the event loop. The image
+/// neither depends on the size of the window nor on whether it is covered.
+/// The picture must be shown nevertheless, because the GL context needs a
+/// drawable. Returns an invalid image otherwise, or when framebuffer objects
+/// are not supported.
+// ****************************************************************************
+
+wxImage VocalTractPicture::renderImage(int width_pix, int height_pix)
+{
+  const FramebufferFunctions *fb;
+  GLuint framebuffer;
+  GLuint renderbuffer[2];     // Color and depth
+  wxImage image;
+
+  if ((this->IsShown() == false) || (wxGLCanvas::SetCurrent(*vtContext) == false))
+  {
+    return wxImage();
+  }
+
+  fb = getFramebufferFunctions();
+  if (fb == NULL)
+  {
+    return wxImage();
+  }
+
+  if ((width_pix < 1) || (height_pix < 1))
+  {
+    getRenderSize(width_pix, height_pix);
+  }
+  if ((width_pix < 1) || (height_pix < 1))
+  {
+    return wxImage();
+  }
+
+  fb->genFramebuffers(1, &framebuffer);
+  fb->genRenderbuffers(2, renderbuffer);
+  fb->bindRenderbuffer(GL_RENDERBUFFER_EXT, renderbuffer[0]);
+  fb->renderbufferStorage(GL_RENDERBUFFER_EXT, GL_RGB8, width_pix, height_pix);
+  fb->bindRenderbuffer(GL_RENDERBUFFER_EXT, renderbuffer[1]);
+  fb->renderbufferStorage(GL_RENDERBUFFER_EXT, GL_DEPTH_COMPONENT24, width_pix, height_pix);
+  fb->bindRenderbuffer(GL_RENDERBUFFER_EXT, 0);
+
+  fb->bindFramebuffer(GL_FRAMEBUFFER_EXT, framebuffer);
+  fb->framebufferRenderbuffer(GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, 
+    GL_RENDERBUFFER_EXT, renderbuffer[0]);
+  fb->framebufferRenderbuffer(GL_FRAMEBUFFER_EXT, GL_DEPTH_ATTACHMENT_EXT, 
+    GL_RENDERBUFFER_EXT, renderbuffer[1]);
+
+  if (fb->checkFramebufferStatus(GL_FRAMEBUFFER_EXT) == GL_FRAMEBUFFER_COMPLETE_EXT)
+  {
+    imageWidth_pix = width_pix;
+    imageHeight_pix = height_pix;
+    render();
+    image = getImage(GL_COLOR_ATTACHMENT0_EXT);
+    imageWidth_pix = 0;
+    imageHeight_pix = 0;
+  }
+
+  fb->bindFramebuffer(GL_FRAMEBUFFER_EXT, 0);
+  fb->deleteFramebuffers(1, &framebuffer);
+  fb->deleteRenderbuffers(2, renderbuffer);
+
+  return image;
+}
+
+
+// ****************************************************************************
+/// Returns the size in pixels of the rendered image: the size passed to
+/// renderImage(...) while it renders, and otherwise the size of the picture.
+// ****************************************************************************
+
+void VocalTractPicture::getRenderSize(int &width_pix, int &height_pix)
+{
+  if ((imageWidth_pix > 0) && (imageHeight_pix > 0))
+  {
+    width_pix = imageWidth_pix;
+    height_pix = imageHeight_pix;
+    return;
+  }
+
+  width_pix = this->GetSize().x;
+  height_pix = this->GetSize().y;
+#ifdef __linux__
+  // On Linux, all pixel coordinates need to be scaled by the current
+  // display scaling factor before passing them to OpenGL
+  width_pix *= GetContentScaleFactor();
+  height_pix *= GetContentScaleFactor();
+#endif
+}
+
+
+// ****************************************************************************
+/// Sets the vocal tract to render. It can temporarily be set to a copy of the
+/// main vocal tract, e.g., for the export of video frames.
+// ****************************************************************************
+
+void VocalTractPicture::setVocalTract(VocalTract *vocalTract)
+{
+  tract = vocalTract;
+}
+
+
+// ****************************************************************************
+// ****************************************************************************
+
+VocalTract *VocalTractPicture::getVocalTract()
+{
+  return tract;
+}
+
+
+// ****************************************************************************
+/// Renders the vocal tract with the selected display options into the back
+/// buffer.
+// ****************************************************************************
+
+void VocalTractPicture::render()
+{
+  const double INVALID = VocalTract::INVALID_PROFILE_SAMPLE;
+  int i;
+
   wxGLCanvas::SetCurrent(*vtContext);
 
+  wxStopWatch frameStopWatch;
+
   // Clear the background *******************************************
 
   if (renderMode == RM_3DSOLID) 
@@ -281,13 +519,7 @@ void VocalTractPicture::display()
   if ((showPoster) && (poster != NULL))
   {
     int pictureWidth, pictureHeight;
-    this->GetSize(&pictureWidth, &pictureHeight);
-#ifdef __linux__
-    // On Linux, all pixel coordinates need to be scaled by the current
-    // display scaling factor before passing them to OpenGL
-    pictureWidth *= GetContentScaleFactor();
-    pictureHeight *= GetContentScaleFactor();
-#endif
+    getRenderSize(pictureWidth, pictureHeight);
 
     glMatrixMode(GL_PROJECTION);
     glLoadIdentity();
@@ -423,8 +655,6 @@ void VocalTractPicture::display()
 
   if ((showCenterLine) && (renderMode != RM_NONE))
   {
-    Tube::Articulator articulator;
-
     glEnable(GL_DEPTH_TEST);
     glDisable(GL_LIGHTING);
 
@@ -457,23 +687,13 @@ void VocalTractPicture::display()
 
     glDisable(GL_DEPTH_TEST);
 
-    Point2D P, v;
-    double upperProfile[VocalTract::NUM_PROFILE_SAMPLES];
-    double lowerProfile[VocalTract::NUM_PROFILE_SAMPLES];
-
-    if (showTongueCrossSections)
-    {
-      i = (int)(cutPlanePos_cm*2.0);
-      if (i < 0) { i = 0; }
-      if (i >= VocalTract::NUM_TONGUE_RIBS) { i = VocalTract::NUM_TONGUE_RIBS-1; }
-      P = tract->tongueRib[i].point;
-      v = tract->tongueRib[i].normal;
-    }
-    else
-    {
-      tract->getCutVector(cutPlanePos_cm, P, v);
-    }
-    tract->getCrossProfiles(P, v, upperProfile, lowerProfile, crossSectionWithTongue, articulator);
+    const CrossSectionCache::Entry *crossSection = 
+      Data::getInstance()->crossSections.getEntry(tract, cutPlanePos_cm, showTongueCrossSections);
+    int withTongue = crossSectionWithTongue ? 1 : 0;
+    Point2D P = crossSection->P;
+    Point2D v = crossSection->v;
+    const double *upperProfile = crossSection->upperProfile[withTongue];
+    const double *lowerProfile = crossSection->lowerProfile[withTongue];
     
     glBegin(GL_LINES);
 
@@ -696,8 +916,31 @@ void VocalTractPicture::display()
   // ****************************************************************
 
   glFlush();
-  SwapBuffers();
 
+  if (reportFrameTimes)
+  {
+    const int NUM_FRAMES_PER_REPORT = 50;
+
+    // Wait until the frame is completely rendered.
+    glFinish();
+    double frameTime_ms = frameStopWatch.TimeInMicro().ToDouble() / 1000.0;
+
+    numTimedFrames++;
+    sumFrameTime_ms+= frameTime_ms;
+    if (frameTime_ms > maxFrameTime_ms)
+    {
+      maxFrameTime_ms = frameTime_ms;
+    }
+
+    if (numTimedFrames >= NUM_FRAMES_PER_REPORT)
+    {
+      wxPrintf("Vocal tract picture: %d frames, mean %2.2f ms, max. %2.2f ms per frame.\n",
+        numTimedFrames, sumFrameTime_ms / (double)numTimedFrames, maxFrameTime_ms);
+      numTimedFrames = 0;
+      sumFrameTime_ms = 0.0;
+      maxFrameTime_ms = 0.0;
+    }
+  }
 }
 
 
@@ -1331,7 +1574,7 @@ void VocalTractPicture::parameterToControlPoint(int pointIndex)
     case CP_CUT_PLANE:
     {
       Point2D P, v;
-      tract->getCutVector(cutPlanePos_cm, P, v);
+      Data::getInstance()->crossSections.getCutVector(tract, cutPlanePos_cm, P, v);
       x = P.x;
       y = P.y;
       z = 0.0;
@@ -1384,8 +1627,8 @@ void VocalTractPicture::get2DRegion(double &left_cm, double &right_cm, double &b
   bottom_cm = -9.0;
   right_cm = 7.5;
 
-  int w = this->GetSize().x;
-  int h = this->GetSize().y;
+  int w, h;
+  getRenderSize(w, h);
   if (w < 1) { w = 1; }
 
   top_cm = bottom_cm + (double)h*(right_cm - left_cm)/(double)w;
@@ -1553,7 +1796,7 @@ bool VocalTractPicture::exportTractWireframeSVG(const wxString &fileName, int it
     return false;
   }
  
-  tract->calculateAll();
+  Data::getInstance()->calculateVocalTract(tract);
 
   // ****************************************************************
   // Render the model on the screen as wireframe, such that the 
@@ -1997,7 +2240,6 @@ bool VocalTractPicture::exportCrossSectionSVG(const wxString &fileName)
 {
   const double INVALID = VocalTract::INVALID_PROFILE_SAMPLE;
   int i;
-  Tube::Articulator articulator;
   char st[1024];
 
   ofstream os(fileName.ToStdString());
@@ -2017,23 +2259,11 @@ bool VocalTractPicture::exportCrossSectionSVG(const wxString &fileName)
 
   // Die eigentlichen Profillinien **********************************
 
-  Point2D P, v;
-  double upperProfile[VocalTract::NUM_PROFILE_SAMPLES];
-  double lowerProfile[VocalTract::NUM_PROFILE_SAMPLES];
-
-  if (showTongueCrossSections)
-  {
-    i = (int)(cutPlanePos_cm*2.0);
-    if (i < 0) { i = 0; }
-    if (i >= VocalTract::NUM_TONGUE_RIBS) { i = VocalTract::NUM_TONGUE_RIBS-1; }
-    P = tract->tongueRib[i].point;
-    v = tract->tongueRib[i].normal;
-  }
-  else
-  {
-    tract->getCutVector(cutPlanePos_cm, P, v);
-  }
-  tract->getCrossProfiles(P, v, upperProfile, lowerProfile, crossSectionWithTongue, articulator);
+  const CrossSectionCache::Entry *crossSection = 
+    Data::getInstance()->crossSections.getEntry(tract, cutPlanePos_cm, showTongueCrossSections);
+  int withTongue = crossSectionWithTongue ? 1 : 0;
+  const double *upperProfile = crossSection->upperProfile[withTongue];
+  const double *lowerProfile = crossSection->lowerProfile[withTongue];
 
   // In die Datei schreiben...
 
@@ -2122,6 +2352,17 @@ bool VocalTractPicture::exportCrossSectionSVG(const wxString &fileName)
 // ****************************************************************************
 
 bool VocalTractPicture::saveImageBmp(const wxString &fileName)
+{
+  return getImage().SaveFile(fileName, wxBITMAP_TYPE_BMP);
+}
+
+
+// ****************************************************************************
+/// Returns the current content of the given buffer (the back buffer by 
+/// default) as image.
+// ****************************************************************************
+
+wxImage VocalTractPicture::getImage(GLenum readBuffer)
 {
   // Read the OpenGL image into a pixel array
   GLint view[4];
@@ -2129,7 +2370,7 @@ bool VocalTractPicture::saveImageBmp(const wxString &fileName)
   void *pixels = malloc(3 * view[2] * view[3]); // must use malloc
   
   glPixelStorei(GL_PACK_ALIGNMENT, 1);
-  glReadBuffer( GL_BACK_LEFT );
+  glReadBuffer(readBuffer);
   glReadPixels(0, 0, view[2], view[3], GL_RGB, GL_UNSIGNED_BYTE, pixels);
  
   // Put the image into a wxImage
@@ -2138,7 +2379,7 @@ bool VocalTractPicture::saveImageBmp(const wxString &fileName)
   image.SetData((unsigned char*) pixels);
   image = image.Mirror(false); 
 
-  return image.SaveFile(fileName, wxBITMAP_TYPE_BMP);
+  return image;
 }
 
 
@@ -2150,14 +2391,8 @@ void VocalTractPicture::setProjectionMatrix3D(double fovy, double nearPlane, dou
 {
   orthogonalProjection = false;
 
-  int w = this->GetSize().x;
-  int h = this->GetSize().y;
-#ifdef __linux__
-  // On Linux, all pixel coordinates need to be scaled by the current
-  // display scaling factor before passing them to OpenGL
-  w *= GetContentScaleFactor();
-  h *= GetContentScaleFactor();
-#endif
+  int w, h;
+  getRenderSize(w, h);
   if (w < 1) { w = 1; }
   if (h < 1) { h = 1; }
 
@@ -2189,14 +2424,8 @@ void VocalTractPicture::setProjectionMatrix3D(double fovy, double nearPlane, dou
 
 void VocalTractPicture::setProjectionMatrix2D(double left, double right, double bottom, double top)
 {
-  int w = this->GetSize().x;
-  int h = this->GetSize().y;
-#ifdef __linux__
-  // On Linux, all pixel coordinates need to be scaled by the current
-  // display scaling factor before passing them to OpenGL
-  w *= GetContentScaleFactor();
-  h *= GetContentScaleFactor();
-#endif
+  int w, h;
+  getRenderSize(w, h);
 
   orthogonalProjection = true;
 
@@ -2463,9 +2692,8 @@ void VocalTractPicture::setLights()
 
 void VocalTractPicture::renderSolid()
 {
-  Point3D *V, *N;
   Point3D P, Q;
-  int i, k;
+  int i, k, n;
 
   // ****************************************************************
   // Material properties 
@@ -2518,20 +2746,30 @@ void VocalTractPicture::renderSolid()
   glDisable(GL_BLEND);
   glDepthMask(GL_TRUE);    // z-buffer is read and write
 
-  tongue->calculateNormals();
+  // The normals of some surfaces are adjusted differently when both
+  // sides are rendered.
 
-  glBegin(GL_TRIANGLES);
-  for (i=0; i < tongue->numTriangles; i++)
+  if (renderBothSides != arraysBothSides)
   {
-    for (k=0; k < 3; k++)
+    for (i=0; i < VocalTract::NUM_SURFACES; i++)
     {
-      N = &tongue->triangle[i].cornerNormal[k];
-      V = &tongue->vertex[ tongue->triangle[i].vertex[k] ].coord;
-      glNormal3d(N->x, N->y, N->z);
-      glVertex3d(V->x, V->y, V->z);
+      surfaceArrays[i].normalsValid = false;
     }
+    arraysBothSides = renderBothSides;
   }
-  glEnd();
+
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glEnableClientState(GL_NORMAL_ARRAY);
+
+  updateSurfaceArrays(VocalTract::TONGUE);
+  if (surfaceArrays[VocalTract::TONGUE].normalsValid == false)
+  {
+    tongue->calculateNormals();
+    updateTriangleArrays(VocalTract::TONGUE);
+  }
+
+  setTriangleArrayPointers(VocalTract::TONGUE);
+  glDrawArrays(GL_TRIANGLES, 0, 3*tongue->numTriangles);
 
   // ****************************************************************
   // Create an array with all transparent surfaces.
@@ -2545,32 +2783,72 @@ void VocalTractPicture::renderSolid()
   };
   Surface *transSurface[NUM_TRANSPARENT_SURFACES] = 
     { NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL };
+  int transSurfaceIndex[NUM_TRANSPARENT_SURFACES];
 
   if (renderBothSides)
   {
-	  transSurface[UPPER_TEETH] = &tract->surface[VocalTract::UPPER_TEETH_TWOSIDE];
-	  transSurface[LOWER_TEETH] = &tract->surface[VocalTract::LOWER_TEETH_TWOSIDE];
-    transSurface[UPPER_LIP]   = &tract->surface[VocalTract::UPPER_LIP_TWOSIDE];
-    transSurface[LOWER_LIP]   = &tract->surface[VocalTract::LOWER_LIP_TWOSIDE];
-    transSurface[UPPER_COVER] = &tract->surface[VocalTract::UPPER_COVER_TWOSIDE];
-    transSurface[LOWER_COVER] = &tract->surface[VocalTract::LOWER_COVER_TWOSIDE];
-    transSurface[LEFT_COVER]  = &tract->surface[VocalTract::LEFT_COVER];
-    transSurface[RIGHT_COVER] = &tract->surface[VocalTract::RIGHT_COVER];
-    transSurface[EPIGLOTTIS]  = &tract->surface[VocalTract::EPIGLOTTIS_TWOSIDE];
-    transSurface[UVULA]       = &tract->surface[VocalTract::UVULA_TWOSIDE];
+    transSurfaceIndex[UPPER_TEETH] = VocalTract::UPPER_TEETH_TWOSIDE;
+    transSurfaceIndex[LOWER_TEETH] = VocalTract::LOWER_TEETH_TWOSIDE;
+    transSurfaceIndex[UPPER_LIP]   = VocalTract::UPPER_LIP_TWOSIDE;
+    transSurfaceIndex[LOWER_LIP]   = VocalTract::LOWER_LIP_TWOSIDE;
+    transSurfaceIndex[UPPER_COVER] = VocalTract::UPPER_COVER_TWOSIDE;
+    transSurfaceIndex[LOWER_COVER] = VocalTract::LOWER_COVER_TWOSIDE;
+    transSurfaceIndex[LEFT_COVER]  = VocalTract::LEFT_COVER;
+    transSurfaceIndex[RIGHT_COVER] = VocalTract::RIGHT_COVER;
+    transSurfaceIndex[EPIGLOTTIS]  = VocalTract::EPIGLOTTIS_TWOSIDE;
+    transSurfaceIndex[UVULA]       = VocalTract::UVULA_TWOSIDE;
   }
   else
   {
-    transSurface[UPPER_TEETH] = &tract->surface[VocalTract::UPPER_TEETH];
-	  transSurface[LOWER_TEETH] = &tract->surface[VocalTract::LOWER_TEETH];
-	  transSurface[UPPER_LIP]   = &tract->surface[VocalTract::UPPER_LIP];
-    transSurface[LOWER_LIP]   = &tract->surface[VocalTract::LOWER_LIP];
-    transSurface[UPPER_COVER] = &tract->surface[VocalTract::UPPER_COVER];
-    transSurface[LOWER_COVER] = &tract->surface[VocalTract::LOWER_COVER];
-    transSurface[LEFT_COVER]  = &tract->surface[VocalTract::LEFT_COVER];
-    transSurface[RIGHT_COVER] = NULL;
-    transSurface[EPIGLOTTIS]  = &tract->surface[VocalTract::EPIGLOTTIS];
-    transSurface[UVULA]       = &tract->surface[VocalTract::UVULA];
+    transSurfaceIndex[UPPER_TEETH] = VocalTract::UPPER_TEETH;
+    transSurfaceIndex[LOWER_TEETH] = VocalTract::LOWER_TEETH;
+    transSurfaceIndex[UPPER_LIP]   = VocalTract::UPPER_LIP;
+    transSurfaceIndex[LOWER_LIP]   = VocalTract::LOWER_LIP;
+    transSurfaceIndex[UPPER_COVER] = VocalTract::UPPER_COVER;
+    transSurfaceIndex[LOWER_COVER] = VocalTract::LOWER_COVER;
+    transSurfaceIndex[LEFT_COVER]  = VocalTract::LEFT_COVER;
+    transSurfaceIndex[RIGHT_COVER] = -1;
+    transSurfaceIndex[EPIGLOTTIS]  = VocalTract::EPIGLOTTIS;
+    transSurfaceIndex[UVULA]       = VocalTract::UVULA;
+  }
+
+  for (i=0; i < NUM_TRANSPARENT_SURFACES; i++)
+  {
+    if (transSurfaceIndex[i] != -1)
+    {
+      transSurface[i] = &tract->surface[ transSurfaceIndex[i] ];
+    }
+  }
+
+  // ****************************************************************
+  // Update the vertex arrays of the surfaces. Only the normals of 
+  // the surfaces whose vertices changed must be recalculated. The
+  // normals of the cover surfaces are adjusted together, so that 
+  // they are also recalculated together.
+  // ****************************************************************
+
+  bool normalsValid[NUM_TRANSPARENT_SURFACES];
+
+  for (i=0; i < NUM_TRANSPARENT_SURFACES; i++)
+  {
+    normalsValid[i] = true;
+    if (transSurface[i] != NULL)
+    {
+      updateSurfaceArrays(transSurfaceIndex[i]);
+      normalsValid[i] = surfaceArrays[ transSurfaceIndex[i] ].normalsValid;
+    }
+  }
+
+  bool coverNormalsValid = 
+    (normalsValid[UPPER_COVER]) && (normalsValid[LOWER_COVER]) && 
+    (normalsValid[LEFT_COVER]) && (normalsValid[RIGHT_COVER]);
+
+  if (coverNormalsValid == false)
+  {
+    normalsValid[UPPER_COVER] = false;
+    normalsValid[LOWER_COVER] = false;
+    normalsValid[LEFT_COVER] = false;
+    normalsValid[RIGHT_COVER] = false;
   }
 
   // ****************************************************************
@@ -2582,7 +2860,10 @@ void VocalTractPicture::renderSolid()
   {
     if (transSurface[i] != NULL)
     {
-      transSurface[i]->calculateNormals();
+      if (normalsValid[i] == false)
+      {
+        transSurface[i]->calculateNormals();
+      }
       transSurface[i]->calculatePaintSequence(modelViewMatrix);
     }
   }
@@ -2592,74 +2873,77 @@ void VocalTractPicture::renderSolid()
   // edges.
   // ****************************************************************
 
-  // Normals at the interface between the upper and lower cover *****
-
-  int numRibs = VocalTract::NUM_LARYNX_RIBS + VocalTract::NUM_PHARYNX_RIBS;
-  Surface *upperCover = transSurface[UPPER_COVER];
-  Surface *lowerCover = transSurface[LOWER_COVER];
-
-  for (i=0; i < numRibs; i++)
+  if (coverNormalsValid == false)
   {
-    P = upperCover->getNormal(i, 0) + lowerCover->getNormal(i, 0);
-    P.normalize();
-    upperCover->setNormal(i, 0, P);
-    lowerCover->setNormal(i, 0, P);
+    // Normals at the interface between the upper and lower cover *****
 
-    if (renderBothSides) 
-    { 
-      P = upperCover->getNormal(i, upperCover->numRibPoints-1) + 
-          lowerCover->getNormal(i, lowerCover->numRibPoints-1);
-      P.normalize();
-      upperCover->setNormal(i, upperCover->numRibPoints-1, P); 
-      lowerCover->setNormal(i, lowerCover->numRibPoints-1, P);
-    }
-  }
+    int numRibs = VocalTract::NUM_LARYNX_RIBS + VocalTract::NUM_PHARYNX_RIBS;
+    Surface *upperCover = transSurface[UPPER_COVER];
+    Surface *lowerCover = transSurface[LOWER_COVER];
 
-  // Normals at the edge of the filling surfaces ********************
+    for (i=0; i < numRibs; i++)
+    {
+      P = upperCover->getNormal(i, 0) + lowerCover->getNormal(i, 0);
+      P.normalize();
+      upperCover->setNormal(i, 0, P);
+      lowerCover->setNormal(i, 0, P);
 
-  Surface *leftCover = transSurface[LEFT_COVER];
-  Surface *rightCover = transSurface[RIGHT_COVER];
+      if (renderBothSides) 
+      { 
+        P = upperCover->getNormal(i, upperCover->numRibPoints-1) + 
+            lowerCover->getNormal(i, lowerCover->numRibPoints-1);
+        P.normalize();
+        upperCover->setNormal(i, upperCover->numRibPoints-1, P); 
+        lowerCover->setNormal(i, lowerCover->numRibPoints-1, P);
+      }
+    }
 
-  int firstRib = VocalTract::NUM_LARYNX_RIBS + VocalTract::NUM_PHARYNX_RIBS - 1;
-  int lastRib  = VocalTract::NUM_LARYNX_RIBS + VocalTract::NUM_PHARYNX_RIBS + VocalTract::NUM_VELUM_RIBS-1;
+    // Normals at the edge of the filling surfaces ********************
 
-  if (leftCover != NULL)
-  {
-    P = upperCover->getNormal(firstRib, 0);
-    for (i=firstRib; i <= lastRib; i++) { upperCover->setNormal(i, 0, P); }
-    leftCover->setNormal(0, 0, P);
-    leftCover->setNormal(0, 1, P);
-    leftCover->setNormal(0, 2, P);
-    leftCover->setNormal(0, 3, P);
-    
-    leftCover->setNormal(1, 0, P);
-    leftCover->setNormal(1, 1, P);
+    Surface *leftCover = transSurface[LEFT_COVER];
+    Surface *rightCover = transSurface[RIGHT_COVER];
 
-    P = lowerCover->getNormal(VocalTract::NUM_LARYNX_RIBS + VocalTract::NUM_THROAT_RIBS, 0);
-    leftCover->setNormal(1, 2, P);
-    leftCover->setNormal(1, 3, P);
-  }
+    int firstRib = VocalTract::NUM_LARYNX_RIBS + VocalTract::NUM_PHARYNX_RIBS - 1;
+    int lastRib  = VocalTract::NUM_LARYNX_RIBS + VocalTract::NUM_PHARYNX_RIBS + VocalTract::NUM_VELUM_RIBS-1;
 
-  if (rightCover != NULL)
-  {
-    P = upperCover->getNormal(firstRib, upperCover->numRibPoints-1);
-    for (i=firstRib; i <= lastRib; i++) { upperCover->setNormal(i, upperCover->numRibPoints-1, P); }
-    rightCover->setNormal(0, 0, P);
-    rightCover->setNormal(0, 1, P);
-    rightCover->setNormal(0, 2, P);
-    rightCover->setNormal(0, 3, P);
-    
-    rightCover->setNormal(1, 0, P);
-    rightCover->setNormal(1, 1, P);
+    if (leftCover != NULL)
+    {
+      P = upperCover->getNormal(firstRib, 0);
+      for (i=firstRib; i <= lastRib; i++) { upperCover->setNormal(i, 0, P); }
+      leftCover->setNormal(0, 0, P);
+      leftCover->setNormal(0, 1, P);
+      leftCover->setNormal(0, 2, P);
+      leftCover->setNormal(0, 3, P);
+
+      leftCover->setNormal(1, 0, P);
+      leftCover->setNormal(1, 1, P);
+
+      P = lowerCover->getNormal(VocalTract::NUM_LARYNX_RIBS + VocalTract::NUM_THROAT_RIBS, 0);
+      leftCover->setNormal(1, 2, P);
+      leftCover->setNormal(1, 3, P);
+    }
 
-    P = lowerCover->getNormal(VocalTract::NUM_LARYNX_RIBS + VocalTract::NUM_THROAT_RIBS, lowerCover->numRibPoints-1);
-    rightCover->setNormal(1, 2, P);
-    rightCover->setNormal(1, 3, P);
+    if (rightCover != NULL)
+    {
+      P = upperCover->getNormal(firstRib, upperCover->numRibPoints-1);
+      for (i=firstRib; i <= lastRib; i++) { upperCover->setNormal(i, upperCover->numRibPoints-1, P); }
+      rightCover->setNormal(0, 0, P);
+      rightCover->setNormal(0, 1, P);
+      rightCover->setNormal(0, 2, P);
+      rightCover->setNormal(0, 3, P);
+
+      rightCover->setNormal(1, 0, P);
+      rightCover->setNormal(1, 1, P);
+
+      P = lowerCover->getNormal(VocalTract::NUM_LARYNX_RIBS + VocalTract::NUM_THROAT_RIBS, lowerCover->numRibPoints-1);
+      rightCover->setNormal(1, 2, P);
+      rightCover->setNormal(1, 3, P);
+    }
   }
   
   // Beginning and end of the uvula ribs ****************************
 
-  if ((renderBothSides) && (transSurface[UVULA] != NULL))
+  if ((renderBothSides) && (transSurface[UVULA] != NULL) && (normalsValid[UVULA] == false))
   {
     Surface *s = transSurface[UVULA];
     for (i=0; i < s->numRibs; i++)
@@ -2673,7 +2957,7 @@ void VocalTractPicture::renderSolid()
 
   // Beginning and end of the epiglottis ribs ***********************
 
-  if ((renderBothSides) && (transSurface[EPIGLOTTIS] != NULL))
+  if ((renderBothSides) && (transSurface[EPIGLOTTIS] != NULL) && (normalsValid[EPIGLOTTIS] == false))
   {
     Surface *s = transSurface[EPIGLOTTIS];
     for (i=0; i < s->numRibs; i++)
@@ -2685,9 +2969,21 @@ void VocalTractPicture::renderSolid()
     }
   }
 
+  // Take the final normals into the vertex arrays.
+
+  for (i=0; i < NUM_TRANSPARENT_SURFACES; i++)
+  {
+    if ((transSurface[i] != NULL) && (normalsValid[i] == false))
+    {
+      updateTriangleArrays(transSurfaceIndex[i]);
+    }
+  }
+
   // ****************************************************************
   // Draw the transparent surfaces using merge sort for the 
-  // individually sorted surfaces.
+  // individually sorted surfaces. The merged sequence is split into
+  // runs of successive triangles of the same surface, and each run
+  // is drawn with one call from the vertex arrays of its surface.
   // ****************************************************************
 
   int nextIndex[NUM_TRANSPARENT_SURFACES] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
@@ -2708,6 +3004,12 @@ void VocalTractPicture::renderSolid()
 
   // Main loop ******************************************************
 
+  int runSurface = -1;
+  vector<int> runSurfaceList;
+  vector<int> runStartList;
+
+  transparentIndex.clear();
+
   while ((nextIndex[0] < numTriangles[0]) || (nextIndex[1] < numTriangles[1]) ||
          (nextIndex[2] < numTriangles[2]) || (nextIndex[3] < numTriangles[3]) ||
 		     (nextIndex[4] < numTriangles[4]) || (nextIndex[5] < numTriangles[5]) ||
@@ -2732,45 +3034,12 @@ void VocalTractPicture::renderSolid()
       }
     }
 
-    // Draw the triangle from the choosen surface *******************
+    // Append the triangle from the choosen surface *****************
 
     if ((winningSurface != -1) && (transSurface[winningSurface] != NULL))
     {
       s = transSurface[winningSurface];
       i = s->sequence[ nextIndex[winningSurface] ];
-		
-	    // Cover ******************************************************
-	    if ((winningSurface == UPPER_COVER) || (winningSurface == LOWER_COVER) ||
-		      (winningSurface == LEFT_COVER)  || (winningSurface == RIGHT_COVER) ||
-		      (winningSurface == EPIGLOTTIS)  || (winningSurface == UVULA))
-	    {
-		    glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT, coverMaterialAmbient);
-		    glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE, coverMaterialDiffuse);
-		    glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, coverMaterialSpecular);
-		    glMaterialfv(GL_FRONT_AND_BACK, GL_SHININESS, coverMaterialShininess);
-	    }
-
-	    // Teeth ******************************************************
-	    if ((winningSurface == UPPER_TEETH) || (winningSurface == LOWER_TEETH))
-	    {
-		    glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT, teethMaterialAmbient);
-		    glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE, teethMaterialDiffuse);
-		    glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, teethMaterialSpecular);
-		    glMaterialfv(GL_FRONT_AND_BACK, GL_SHININESS, teethMaterialShininess);
-	    }
-
-	    // Lips *******************************************************
-	    if ((winningSurface == UPPER_LIP) || (winningSurface == LOWER_LIP))
-	    {
-		    glMaterialfv(GL_FRONT, GL_AMBIENT, frontLipMaterialDiffuse);
-		    glMaterialfv(GL_FRONT, GL_DIFFUSE, frontLipMaterialDiffuse);
-
-		    glMaterialfv(GL_BACK, GL_AMBIENT, backLipMaterialDiffuse);
-		    glMaterialfv(GL_BACK, GL_DIFFUSE, backLipMaterialDiffuse);
-    
-		    glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, lipMaterialSpecular);
-		    glMaterialfv(GL_FRONT_AND_BACK, GL_SHININESS, lipMaterialShininess);
-	    }
 
       // Some triangles of the filling surfaces shall not be drawn
 
@@ -2784,15 +3053,15 @@ void VocalTractPicture::renderSolid()
 
       if (drawTriangle)
       {
-        glBegin(GL_TRIANGLES);
-        for (k=0; k < 3; k++)
+        if (winningSurface != runSurface)
         {
-          N = &s->triangle[i].cornerNormal[k];
-          V = &s->vertex[ s->triangle[i].vertex[k] ].coord;
-          glNormal3d(N->x, N->y, N->z);
-          glVertex3d(V->x, V->y, V->z);
+          runSurface = winningSurface;
+          runSurfaceList.push_back(runSurface);
+          runStartList.push_back((int)transparentIndex.size());
         }
-        glEnd();
+        transparentIndex.push_back(3*i);
+        transparentIndex.push_back(3*i + 1);
+        transparentIndex.push_back(3*i + 2);
       }
 
       nextIndex[winningSurface]++;
@@ -2800,6 +3069,64 @@ void VocalTractPicture::renderSolid()
 
   }
 
+  // Draw the runs **************************************************
+
+  int numRuns = (int)runSurfaceList.size();
+  int runEnd;
+
+  for (n=0; n < numRuns; n++)
+  {
+    runSurface = runSurfaceList[n];
+    if (n < numRuns - 1)
+    {
+      runEnd = runStartList[n + 1];
+    }
+    else
+    {
+      runEnd = (int)transparentIndex.size();
+    }
+
+    // Cover ******************************************************
+    if ((runSurface == UPPER_COVER) || (runSurface == LOWER_COVER) ||
+        (runSurface == LEFT_COVER)  || (runSurface == RIGHT_COVER) ||
+        (runSurface == EPIGLOTTIS)  || (runSurface == UVULA))
+    {
+      glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT, coverMaterialAmbient);
+      glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE, coverMaterialDiffuse);
+      glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, coverMaterialSpecular);
+      glMaterialfv(GL_FRONT_AND_BACK, GL_SHININESS, coverMaterialShininess);
+    }
+
+    // Teeth ******************************************************
+    if ((runSurface == UPPER_TEETH) || (runSurface == LOWER_TEETH))
+    {
+      glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT, teethMaterialAmbient);
+      glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE, teethMaterialDiffuse);
+      glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, teethMaterialSpecular);
+      glMaterialfv(GL_FRONT_AND_BACK, GL_SHININESS, teethMaterialShininess);
+    }
+
+    // Lips *******************************************************
+    if ((runSurface == UPPER_LIP) || (runSurface == LOWER_LIP))
+    {
+      glMaterialfv(GL_FRONT, GL_AMBIENT, frontLipMaterialDiffuse);
+      glMaterialfv(GL_FRONT, GL_DIFFUSE, frontLipMaterialDiffuse);
+
+      glMaterialfv(GL_BACK, GL_AMBIENT, backLipMaterialDiffuse);
+      glMaterialfv(GL_BACK, GL_DIFFUSE, backLipMaterialDiffuse);
+
+      glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, lipMaterialSpecular);
+      glMaterialfv(GL_FRONT_AND_BACK, GL_SHININESS, lipMaterialShininess);
+    }
+
+    setTriangleArrayPointers(transSurfaceIndex[runSurface]);
+    glDrawElements(GL_TRIANGLES, runEnd - runStartList[n], GL_UNSIGNED_INT, 
+      &transparentIndex[ runStartList[n] ]);
+  }
+
+  glDisableClientState(GL_VERTEX_ARRAY);
+  glDisableClientState(GL_NORMAL_ARRAY);
+
   glDepthMask(GL_TRUE);   // z-buffer is read and write enabled
 }
 
@@ -3189,7 +3516,9 @@ void VocalTractPicture::renderWireFrame()
   const int NUM_SURFACES = 9;
   int i, k, n;
   Surface *surface[NUM_SURFACES];
+  int surfaceIndex[NUM_SURFACES];
   Surface *s;
+  SurfaceArrays *a;
   Point3D P;
   const float CLEAR_COLOR[] = { 0.0f, 0.0f, 0.0f, 0 };
 
@@ -3206,27 +3535,33 @@ void VocalTractPicture::renderWireFrame()
 
   if (renderBothSides)
   {
-    surface[0] = &tract->surface[VocalTract::UPPER_TEETH_TWOSIDE];
-    surface[1] = &tract->surface[VocalTract::LOWER_TEETH_TWOSIDE];
-    surface[2] = &tract->surface[VocalTract::UPPER_COVER_TWOSIDE];
-    surface[3] = &tract->surface[VocalTract::LOWER_COVER_TWOSIDE];
-    surface[4] = &tract->surface[VocalTract::EPIGLOTTIS_TWOSIDE];
-    surface[5] = &tract->surface[VocalTract::UVULA_TWOSIDE];
-    surface[6] = &tract->surface[VocalTract::UPPER_LIP_TWOSIDE];
-    surface[7] = &tract->surface[VocalTract::LOWER_LIP_TWOSIDE];
-    surface[8] = &tract->surface[VocalTract::TONGUE];
+    surfaceIndex[0] = VocalTract::UPPER_TEETH_TWOSIDE;
+    surfaceIndex[1] = VocalTract::LOWER_TEETH_TWOSIDE;
+    surfaceIndex[2] = VocalTract::UPPER_COVER_TWOSIDE;
+    surfaceIndex[3] = VocalTract::LOWER_COVER_TWOSIDE;
+    surfaceIndex[4] = VocalTract::EPIGLOTTIS_TWOSIDE;
+    surfaceIndex[5] = VocalTract::UVULA_TWOSIDE;
+    surfaceIndex[6] = VocalTract::UPPER_LIP_TWOSIDE;
+    surfaceIndex[7] = VocalTract::LOWER_LIP_TWOSIDE;
+    surfaceIndex[8] = VocalTract::TONGUE;
   }
   else
   {
-    surface[0] = &tract->surface[VocalTract::UPPER_TEETH];
-    surface[1] = &tract->surface[VocalTract::LOWER_TEETH];
-    surface[2] = &tract->surface[VocalTract::UPPER_COVER];
-    surface[3] = &tract->surface[VocalTract::LOWER_COVER];
-    surface[4] = &tract->surface[VocalTract::EPIGLOTTIS];
-    surface[5] = &tract->surface[VocalTract::UVULA];
-    surface[6] = &tract->surface[VocalTract::UPPER_LIP];
-    surface[7] = &tract->surface[VocalTract::LOWER_LIP];
-    surface[8] = &tract->surface[VocalTract::TONGUE];
+    surfaceIndex[0] = VocalTract::UPPER_TEETH;
+    surfaceIndex[1] = VocalTract::LOWER_TEETH;
+    surfaceIndex[2] = VocalTract::UPPER_COVER;
+    surfaceIndex[3] = VocalTract::LOWER_COVER;
+    surfaceIndex[4] = VocalTract::EPIGLOTTIS;
+    surfaceIndex[5] = VocalTract::UVULA;
+    surfaceIndex[6] = VocalTract::UPPER_LIP;
+    surfaceIndex[7] = VocalTract::LOWER_LIP;
+    surfaceIndex[8] = VocalTract::TONGUE;
+  }
+
+  for (n=0; n < NUM_SURFACES; n++)
+  {
+    surface[n] = &tract->surface[ surfaceIndex[n] ];
+    updateSurfaceArrays(surfaceIndex[n]);
   }
 
   // Determine minimal and maximal z-coord. of all model points. ****
@@ -3265,9 +3600,12 @@ void VocalTractPicture::renderWireFrame()
   // The 3D-vocal tract model.
   // ****************************************************************
 
+  glEnableClientState(GL_VERTEX_ARRAY);
+
   for (n=0; n < NUM_SURFACES; n++)
   {
     s = surface[n];
+    a = &surfaceArrays[ surfaceIndex[n] ];
 
     // Determine the grid color. ************************************
 
@@ -3296,29 +3634,21 @@ void VocalTractPicture::renderWireFrame()
 
     // Paint the main and cross lines. ******************************
 
+    glVertexPointer(3, GL_FLOAT, 0, &a->gridVertex[0]);
+
     for (i=0; i < s->numRibs; i++)
     {
-      glBegin(GL_LINE_STRIP);
-      for (k=0; k < s->numRibPoints; k++)
-      {
-        P = s->getVertex(i, k);
-        glVertex3d(P.x, P.y, P.z);
-      }
-      glEnd();
+      glDrawArrays(GL_LINE_STRIP, i*s->numRibPoints, s->numRibPoints);
     }
 
     for (i=0; i < s->numRibPoints; i++)
     {
-      glBegin(GL_LINE_STRIP);
-      for (k=0; k < s->numRibs; k++)
-      {
-        P = s->getVertex(k, i);
-        glVertex3d(P.x, P.y, P.z);
-      }
-      glEnd();
+      glDrawElements(GL_LINE_STRIP, s->numRibs, GL_UNSIGNED_INT, &a->crossRibIndex[i*s->numRibs]);
     }
   }
 
+  glDisableClientState(GL_VERTEX_ARRAY);
+
   // ****************************************************************
   // Paint the radiation semi-sphere.
   // ****************************************************************
@@ -3355,6 +3685,139 @@ void VocalTractPicture::renderWireFrame()
 }
 
 
+// ****************************************************************************
+/// Updates the vertex arrays of the given surface of the vocal tract, if its
+/// vertices changed since the last call. Returns true, if the vertices 
+/// changed. The normals of the triangle arrays are then marked as invalid.
+// ****************************************************************************
+
+bool VocalTractPicture::updateSurfaceArrays(int surfaceIndex)
+{
+  Surface *s = &tract->surface[surfaceIndex];
+  SurfaceArrays *a = &surfaceArrays[surfaceIndex];
+  Point3D P;
+  int i, k, n;
+
+  // ****************************************************************
+  // Did the vertices change ?
+  // ****************************************************************
+
+  bool hasChanged = ((int)a->lastCoord.size() != 3*s->numVertices);
+
+  for (i=0; (i < s->numVertices) && (hasChanged == false); i++)
+  {
+    if ((s->vertex[i].coord.x != a->lastCoord[3*i]) ||
+        (s->vertex[i].coord.y != a->lastCoord[3*i + 1]) ||
+        (s->vertex[i].coord.z != a->lastCoord[3*i + 2]))
+    {
+      hasChanged = true;
+    }
+  }
+
+  if (hasChanged == false)
+  {
+    return false;
+  }
+
+  a->lastCoord.resize(3*s->numVertices);
+  for (i=0; i < s->numVertices; i++)
+  {
+    a->lastCoord[3*i]     = s->vertex[i].coord.x;
+    a->lastCoord[3*i + 1] = s->vertex[i].coord.y;
+    a->lastCoord[3*i + 2] = s->vertex[i].coord.z;
+  }
+
+  // ****************************************************************
+  // The vertices in the order of the ribs for the line strips of 
+  // the wire frame, and the indices of the strips across the ribs.
+  // ****************************************************************
+
+  a->gridVertex.resize(3*s->numRibs*s->numRibPoints);
+  n = 0;
+  for (i=0; i < s->numRibs; i++)
+  {
+    for (k=0; k < s->numRibPoints; k++)
+    {
+      P = s->getVertex(i, k);
+      a->gridVertex[n++] = (GLfloat)P.x;
+      a->gridVertex[n++] = (GLfloat)P.y;
+      a->gridVertex[n++] = (GLfloat)P.z;
+    }
+  }
+
+  a->crossRibIndex.resize(s->numRibs*s->numRibPoints);
+  n = 0;
+  for (k=0; k < s->numRibPoints; k++)
+  {
+    for (i=0; i < s->numRibs; i++)
+    {
+      a->crossRibIndex[n++] = i*s->numRibPoints + k;
+    }
+  }
+
+  a->normalsValid = false;
+
+  return true;
+}
+
+
+// ****************************************************************************
+/// Fills the triangle arrays of the given surface with the current corner
+/// vertices and corner normals of the surface. The normals must have been
+/// calculated before.
+// ****************************************************************************
+
+void VocalTractPicture::updateTriangleArrays(int surfaceIndex)
+{
+  Surface *s = &tract->surface[surfaceIndex];
+  SurfaceArrays *a = &surfaceArrays[surfaceIndex];
+  Point3D *V, *N;
+  int i, k, n;
+
+  a->triangleVertex.resize(9*s->numTriangles);
+  a->triangleNormal.resize(9*s->numTriangles);
+
+  n = 0;
+  for (i=0; i < s->numTriangles; i++)
+  {
+    for (k=0; k < 3; k++)
+    {
+      N = &s->triangle[i].cornerNormal[k];
+      V = &s->vertex[ s->triangle[i].vertex[k] ].coord;
+
+      a->triangleVertex[n]     = (GLfloat)V->x;
+      a->triangleVertex[n + 1] = (GLfloat)V->y;
+      a->triangleVertex[n + 2] = (GLfloat)V->z;
+      a->triangleNormal[n]     = (GLfloat)N->x;
+      a->triangleNormal[n + 1] = (GLfloat)N->y;
+      a->triangleNormal[n + 2] = (GLfloat)N->z;
+      n+= 3;
+    }
+  }
+
+  a->normalsValid = true;
+}
+
+
+// ****************************************************************************
+/// Sets the vertex and normal array pointers to the triangle arrays of the
+/// given surface.
+// ****************************************************************************
+
+void VocalTractPicture::setTriangleArrayPointers(int surfaceIndex)
+{
+  SurfaceArrays *a = &surfaceArrays[surfaceIndex];
+
+  if (a->triangleVertex.empty())
+  {
+    return;
+  }
+
+  glVertexPointer(3, GL_FLOAT, 0, &a->triangleVertex[0]);
+  glNormalPointer(GL_FLOAT, 0, &a->triangleNormal[0]);
+}
+
+
 // ****************************************************************************
 /// Returns a tooltip with the parameter values corresponding to the given
 /// control point.
@@ -3669,7 +4132,7 @@ void VocalTractPicture::OnMouseChanged(wxMouseEvent &event)
 #endif
               
         // Re-calculate the vocal tract model
-        tract->calculateAll();
+        Data::getInstance()->calculateVocalTract(tract);
 
         // Update all pictures on the vocal tract page including this!
         wxCommandEvent event(updateRequestEvent);
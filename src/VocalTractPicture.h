@@ -21,6 +21,7 @@
 
 #include <wx/wx.h>
 #include <wx/glcanvas.h>
+#include <wx/image.h>
 #ifdef __APPLE__
 #include <OpenGL/gl.h>
 #include <OpenGL/glu.h>
@@ -30,6 +31,7 @@
 #endif
 #include <fstream>
 #include <sstream>
+#include <vector>
 #include "VocalTractLabBackend/VocalTract.h"
 
 #ifndef __VOCALTRACT_PICTURE_H__
@@ -100,6 +102,8 @@ public:
   bool renderBothSides;
   int selectedControlPoint;
   bool showEmaPoints;
+  /// Print the mean and max. rendering times of the frames to the console
+  bool reportFrameTimes;
 
   Point3D controlPoint[NUM_CONTROLPOINTS];
   wxGLContext *vtContext;
@@ -119,6 +123,9 @@ public:
   void drawTestImage();
   
   void display();
+  wxImage renderImage(int width_pix = 0, int height_pix = 0);
+  void setVocalTract(VocalTract *vocalTract);
+  VocalTract *getVocalTract();
 
   Point3D getObjectCoordinates(int screenX, int screenY, const Point3D planePoint,
                                const Point3D planeNormal);
@@ -137,6 +144,7 @@ public:
   bool exportTractWireframeSVG(const wxString &fileName, int item);
   bool exportCrossSectionSVG(const wxString &fileName);
   bool saveImageBmp(const wxString &fileName);
+  wxImage getImage(GLenum readBuffer = GL_BACK_LEFT);
 
   // Set modelview and projection matrices **************************
 
@@ -171,6 +179,38 @@ private:
 
   bool orthogonalProjection;    // is set to "true" for RM_2D and RM_NONE
 
+  // The size of the image rendered by renderImage(...), or 0, when the
+  // picture is rendered into the window.
+  int imageWidth_pix;
+  int imageHeight_pix;
+
+  // ****************************************************************
+  // Vertex arrays of the surfaces that are kept between the frames.
+  // The arrays of a surface are only rebuilt when its vertices 
+  // changed (i.e., after VocalTract::calculateAll()), and the normals
+  // only when the arrays of the triangles are needed.
+  // ****************************************************************
+
+  struct SurfaceArrays
+  {
+    std::vector<double> lastCoord;        // Vertex coordinates of the last update
+    std::vector<GLfloat> gridVertex;      // Vertices in the order of the ribs
+    std::vector<GLuint> crossRibIndex;    // Line strips across the ribs
+    std::vector<GLfloat> triangleVertex;  // Three corners per triangle
+    std::vector<GLfloat> triangleNormal;
+    bool normalsValid;
+  };
+
+  SurfaceArrays surfaceArrays[VocalTract::NUM_SURFACES];
+  bool arraysBothSides;
+  std::vector<GLuint> transparentIndex;
+
+  // Frame time statistics
+
+  int numTimedFrames;
+  double sumFrameTime_ms;
+  double maxFrameTime_ms;
+
   // Arrays *********************************************************
   
   int viewport[4];
@@ -184,10 +224,15 @@ private:
 
 private:
   void setLights();
+  void render();
+  void getRenderSize(int &width_pix, int &height_pix);
 
   void renderSolid();
   void render2D();
   void renderWireFrame();
+  bool updateSurfaceArrays(int surfaceIndex);
+  void updateTriangleArrays(int surfaceIndex);
+  void setTriangleArrayPointers(int surfaceIndex);
   wxString getToolTipText(int controlPointIndex);
   int getControlPointUnderMouse(int mx, int my);
   int getEmaPointUnderMouse(int mx, int my);
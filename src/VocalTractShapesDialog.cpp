@@ -388,7 +388,7 @@ void VocalTractShapesDialog::updateVocalTract()
   {
     tract->param[i].x = tract->shapes[sel].param[i];
   }
-  tract->calculateAll();  //<-- The parameters of the vocal tract shape may change in here due to various constraints
+  data->calculateVocalTract(tract);  //<-- The parameters of the vocal tract shape may change in here due to various constraints
 
   data->updateTlModelGeometry(tract);
 
@@ -691,6 +691,7 @@ void VocalTractShapesDialog::OnListKeyDown(wxKeyEvent &event)
       data->tdsModel, false, true, audio);
 
     data->track[Data::MAIN_TRACK]->setZero();
+    data->trackChanged(Data::MAIN_TRACK);
     Synthesizer::copySignal(audio, *data->track[Data::MAIN_TRACK], 0);
     data->normalizeAudioAmplitude(Data::MAIN_TRACK);
 